@@ -59,6 +59,13 @@ typedef
    }
    OrgType;
 
+/* Wrapped library functions (see fpdebug.h) are recorded in the mean values
+   with a pseudo operation. VEX starts its operations at Iop_INVALID (0x14000),
+   so values below it can not clash. */
+#define FD_FUNCTION_OP_BASE		0x1000
+#define FD_FUNCTION_OP(fn)		((IROp)(FD_FUNCTION_OP_BASE + (fn)))
+#define FD_IS_FUNCTION_OP(op)	((op) >= FD_FUNCTION_OP_BASE && (op) < Iop_INVALID)
+
 typedef
 	enum {
 		Rt_I16S,
@@ -80,6 +87,9 @@ typedef struct _ShadowValue {
 
 		Bool				active;
 		UInt				version;
+		/* scopeEpoch of the last write, code out of scope ran since then 
+		   if it differs */
+		ULong				epoch;
 
 		ULong				opCount;
 		Addr				origin;
@@ -98,6 +108,31 @@ typedef struct _ShadowValue {
 		mpfr_t 				midValue;
 
 		mpfr_t 				oriValue;
+
+		/* one value for each precision of --precision-ladder, otherwise NULL */
+		mpfr_t*				ladder;
+
+		/* one value for each candidate and format of --demote, otherwise NULL */
+		mpfr_t*				demoted;
+
+		/* double-double value of --hybrid-shadows, value, midValue and
+		   oriValue are not up to date while dd is set */
+		Bool				dd;
+		Double				ddHi;
+		Double				ddLo;
+		Double				ddMid;
+		Double				ddOri;
+		/* bound of the relative error of ddHi + ddLo */
+		Double				ddErr;
+
+		/* samples of --shadow-engine=stochastic, otherwise NULL */
+		Double*				sto;
+		Bool				stoValid;
+
+		/* one value for each candidate lane of --pso-lanes, otherwise NULL,
+		   only the first psoValid lanes are up to date */
+		mpfr_t*				pso;
+		UInt				psoValid;
 	} ShadowValue;
 
 typedef struct _MeanValue {
@@ -105,7 +140,10 @@ typedef struct _MeanValue {
 		UWord              	key;
 		
 		IROp				op;
+		/* executions, counted inline with --sample-rate or after --site-budget */
 		UInt				count;
+		/* analyzed executions, the sums are over these */
+		UInt				sampled;
 		mpfr_t				sum;
 		mpfr_t				max;
 
@@ -121,8 +159,115 @@ typedef struct _MeanValue {
 		Bool				visited;
 
 		Bool				overflow;
+
+		/* executions without a new max error or cancellation (--site-budget) */
+		UInt				unchanged;
+		Bool				saturated;
+
+		/* significant digits of the stochastic samples */
+		UInt				stoCount;
+		Int					stoDigitsMin;
+		Long				stoDigitsSum;
+
+		/* first-order condition numbers (--condition-numbers) */
+		UInt				condCount;
+		UInt				condInfinite;
+		Double				condSum;
+		Double				condMax;
 	} MeanValue;
 
+/* Convergence of the two highest precisions of --precision-ladder 
+   for one operation. */
+typedef struct _LadderSite {
+	struct _LadderSite* 	next;
+		UWord              	key;
+
+		IROp				op;
+		UInt				count;
+		UInt				diverged;
+		Double				maxDiff;
+	} LadderSite;
+
+/* Accumulation chain of --reassociation at one addition, with 2, 4 and 8 
+   interleaved accumulators. */
+#define REDUCTION_WIDTHS	3
+#define REDUCTION_MAX_LANES	8
+typedef struct _ReductionSite {
+	struct _ReductionSite* 	next;
+		UWord              	key;
+
+		IROp				op;
+		ULong				chains;
+		ULong				count;
+		ULong				length;
+		ULong				maxLength;
+
+		/* result of the last execution and the state of the current chain */
+		Double				last;
+		Double				lanes[REDUCTION_WIDTHS][REDUCTION_MAX_LANES];
+		Double				refHi;
+		Double				refLo;
+
+		/* relative differences to the sequential sum and relative errors */
+		ULong				diverged[REDUCTION_WIDTHS];
+		Double				maxDiff[REDUCTION_WIDTHS];
+		Double				maxErr[REDUCTION_WIDTHS];
+		Double				maxErrSeq;
+	} ReductionSite;
+
+/* Multiply-add pair of --fma-contraction, at the address of the addition. 
+   Errors are relative to the shadow value of the addition. */
+typedef struct _ContractionSite {
+	struct _ContractionSite* 	next;
+		UWord              	key;
+
+		Addr				mulAddr;
+		IROp				op;
+		ULong				count;
+		ULong				changed;
+		ULong				better;
+		ULong				worse;
+		Double				maxErrSeparate;
+		Double				maxErrFused;
+		Double				maxIncrease;
+	} ContractionSite;
+
+#define MAX_DEMOTE_FORMATS	3
+
+typedef
+	struct {
+		Char*				name;
+		mpfr_prec_t			prec;
+		mpfr_exp_t			emin;
+		mpfr_exp_t			emax;
+	} DemoteFormat;
+
+/* Operation or function of --demote-candidates and the largest difference 
+   between the demoted values and the original precision for each format. */
+typedef
+	struct {
+		Addr				addr;
+		Char*				fn;
+		ULong				executions;
+
+		Double				maxDiff[MAX_DEMOTE_FORMATS];
+		Addr				maxSite[MAX_DEMOTE_FORMATS];
+		ULong				changed[MAX_DEMOTE_FORMATS];
+	} DemoteCandidate;
+
+/* candidate of an operation, -1 for none */
+typedef struct _DemoteSite {
+	struct _DemoteSite* 	next;
+		UWord              	key;
+
+		Int					candidate;
+	} DemoteSite;
+
+/* Four stochastic samples, updated by one AVX or two SSE instructions. */
+#define STO_VEC_LANES	4
+typedef Double	StoVec	__attribute__((vector_size(32), aligned(8)));
+typedef ULong	StoBits	__attribute__((vector_size(32), aligned(8)));
+
 typedef
 	struct {
 		Bool				active;
@@ -210,9 +355,58 @@ typedef
 		IRTemp	arg2;
 		IRTemp	arg3;
 
+		Float	orgFloat;
 		Double 	orgDouble;
 	} TriOp;
 
+typedef
+	struct {
+		IROp	op;
+		IRTemp  wrTmp;
+		IRTemp	arg2;
+		IRTemp	arg3;
+		IRTemp	arg4;
+
+		Double 	orgDouble;
+	} QuadOp;
+
+typedef
+	struct {
+		IROp	op;
+		IRTemp  wrTmp;
+		IRTemp	arg1;
+		IRTemp	arg2;
+	} PackedOp;
+
+/* addition or subtraction of a multiply-add pair (--fma-contraction) */
+typedef
+	struct {
+		IROp	addOp;
+		IRTemp	wrTmp;
+		UInt	mulFirst;
+	} Contraction;
+
+/* Column-major BLAS operand: element (i, j) is at 
+   base + (i * rowStride + j * colStride) * sizeof(Double). */
+typedef
+	struct {
+		Addr	base;
+		Long	rowStride;
+		Long	colStride;
+	} BlasMatrix;
+
+/* Shadow values of the outputs of a BLAS call. They are computed before 
+   the native call and stored when it returns. */
+typedef
+	struct {
+		UWord			fn;
+		Addr			callSite;
+		ULong			opCount;
+		ShadowValue**	outputs;
+		UInt			count;
+		UInt			size;
+	} BlasCall;
+
 typedef
 	struct {
 		IRType 	type;
@@ -256,5 +450,29 @@ typedef struct _PSOperation {
 		Bool 			falsePositive;
 	} PSOperation;
 
+/* Counts of one operation sent by a child of --pso-fork-server, map is 
+   0 for the error map and c + 1 for candidate lane c. */
+typedef
+	struct {
+		UInt	map;
+		UWord	key;
+		int		errCnt;
+		int		ovCnt;
+		int		totalCnt;
+	} PSOForkRecord;
+
+/* Operation of --pso-db or --suspects, keyed by object and symbol with 
+   offset (obj:fn+N) or object and offset (obj:0xN), which do not change 
+   with ASLR, or only by its address if the operation was outside of any 
+   object. */
+typedef
+	struct _PSODbEntry {
+		struct _PSODbEntry*	next;
+		UWord				hash;	/* of key, or addr for entries without key */
+		Addr				addr;
+		Char*				key;
+		UInt				resolved;
+	} PSODbEntry;
+
 #endif /* ndef __FD_INCLUDE_H */
 
@@ -57,11 +57,14 @@
 #include "pub_tool_debuginfo.h"
 #include "pub_tool_oset.h"
 #include "pub_tool_libcfile.h"
+#include "pub_tool_libcproc.h"
 #include "pub_tool_vki.h"
 #include "pub_tool_options.h"
 #include "pub_tool_xarray.h"
 #include "pub_tool_clientstate.h"
 #include "pub_tool_redir.h"
+#include "pub_tool_seqmatch.h"
+#include "pub_tool_aspacemgr.h"
 
 #include "fd_include.h"
 /* for client requests */
@@ -69,6 +72,12 @@
 
 #include "opToString.c"
 
+/* not exported by the tool interface, callgrind uses it in the same way */
+extern void VG_(discard_translations) ( Addr64 start, ULong range, HChar* who );
+/* not exported by the tool interface either, used by --pso-fork-server */
+extern Int VG_(safe_fd) ( Int oldfd );
+extern Int VG_(count_living_threads) ( void );
+
 #define mkU1(_n)							IRExpr_Const(IRConst_U1(_n))
 #define mkU32(_n)                			IRExpr_Const(IRConst_U32(_n))
 #define mkU64(_n)                			IRExpr_Const(IRConst_U64(_n))
@@ -76,9 +85,26 @@
 #define	MAX_STAGES							100
 #define	MAX_TEMPS							1000
 #define	MAX_REGISTERS						1000
+#define	MAX_LANES							4
+#define	BLAS_BLOCK							32
+#define	MAX_SCOPE_PATTERNS					32
+#define	MAX_SUSPECTS						100
+#define	MAX_PRECISION_STACK					32
+#define	MAX_LADDER							4
+#define	MAX_DEMOTE_CANDIDATES				8
+/* precision of double-double, the shadow values of --screen */
+#define	SCREEN_PRECISION					106
 #define	CANCEL_LIMIT						10
-#define TMP_COUNT							4
-#define CONST_COUNT   						4
+/* unit roundoff of double-double and the largest relative error of a 
+   double-double shadow value before it is computed with MPFR (2^-104, 2^-80) */
+#define	DD_EPS								(4.930380657631324e-32)
+#define	DD_MAX_ERROR						(8.271806125530277e-25)
+#define	MAX_STO_SAMPLES						8
+#define	STO_MAX_DIGITS						15
+#define TMP_COUNT							8
+#define CONST_COUNT   						8
+/* flag in constArgs of the helpers: only the shadow value is computed (--site-budget) */
+#define SATURATED_SITE						0x100
 
 /* 10,000 entries -> ~6 MB file */
 #define MAX_ENTRIES_PER_FILE				10000
@@ -88,6 +114,7 @@
 #define MPFR_BUFSIZE						100
 #define FORMATBUF_SIZE						256
 #define DESCRIPTION_SIZE					256
+#define PSO_KEY_SIZE						200	/* fits a line of --pso-db in FORMATBUF_SIZE */
 #define FILENAME_SIZE						256
 #define FWRITE_BUFSIZE 						32000
 #define FWRITE_THROUGH 						10000
@@ -98,6 +125,7 @@
 #define PSO_SV_ZERO_BOUND					(1e-15)
 #define PSO_PERCENTIGE_THRESHOLD			(0.7)
 #define PSO_FALSEPOSITIVE_PERCENTAGE		(0.1)
+#define MAX_PSO_LANES						8
 
 /* standard rounding mode: round to nearest */
 static mpfr_rnd_t 	STD_RND 				= MPFR_RNDN;
@@ -116,10 +144,76 @@ static Bool  		clo_print_every_error   = False;
 static Bool         clo_detect_pso			= False;
 static Bool 		clo_goto_shadow_branch	= False;
 static Bool 		clo_track_int			= False;
+static Bool			clo_wrap_libm			= False;
+static Bool			clo_wrap_blas			= False;
+static Bool			clo_reinstrument		= False;
+static Bool			clo_hybrid				= False;
+static Bool			clo_stochastic			= False;
+static Bool			clo_local_error			= False;
+static Bool			clo_condition			= False;
+static Bool			clo_reassociation		= False;
+static Bool			clo_fma_contraction		= False;
+static UInt			clo_pso_lanes			= 0;
+static Char*		clo_pso_db				= NULL;
+static Bool			clo_pso_fork			= False;
+static UInt			clo_sto_samples			= 4;
+static Char*		clo_start_fn			= NULL;
+static Char*		clo_stop_fn				= NULL;
+static Addr			clo_start_addr			= 0;
+static Addr			clo_stop_addr			= 0;
+/* patterns for function names, source files and objects */
+static Char*		clo_include[MAX_SCOPE_PATTERNS];
+static Char*		clo_exclude[MAX_SCOPE_PATTERNS];
+static Int			clo_include_count		= 0;
+static Int			clo_exclude_count		= 0;
+static UInt			clo_sample_rate			= 1;
+static UInt			clo_sample_window		= 10000;
+static UInt			clo_site_budget			= 0;
+static Char*		clo_screen				= NULL;
+static Char*		clo_suspects			= NULL;
+static Bool			precisionGiven			= False;
+
+/* precision of new results, changed by client requests */
+static mpfr_prec_t	currentPrecision		= 120;
+static mpfr_prec_t	precisionStack[MAX_PRECISION_STACK];
+static Int			precisionStackSize		= 0;
+
+/* working precision of operations which did not cancel (--adaptive-precision) */
+static mpfr_prec_t	clo_adaptive_precision	= 0;
+static UInt			clo_escalate_threshold	= CANCEL_LIMIT;
+static mpfr_prec_t	opPrecision				= 120;
+
+static Char*		clo_precision_ladder	= NULL;
+static mpfr_prec_t	ladderPrec[MAX_LADDER];
+static Int			ladderCount				= 0;
+
+static Char*		clo_demote				= NULL;
+static Char*		clo_demote_candidates	= NULL;
+/* precision and exponent range in the convention of MPFR, with subnormals */
+static DemoteFormat	demoteFormatTable[]		= {
+	{ "fp32", 24, -148, 128 },
+	{ "fp16", 11, -23, 16 },
+	{ "bf16", 8, -132, 128 }
+};
+static DemoteFormat* demoteFormats[MAX_DEMOTE_FORMATS];
+static Int			demoteFormatCount		= 0;
+static DemoteCandidate demoteCandidates[MAX_DEMOTE_CANDIDATES];
+static Int			demoteCandidateCount	= 0;
+/* demoted values of each shadow value, demoteCandidateCount * demoteFormatCount */
+static Int			demoteCount				= 0;
 
 static UInt activeStages 					= 0;
 static ULong sbExecuted 					= 0;
+/* incremented by each superblock out of the scope of --include and --exclude */
+static ULong scopeEpoch 					= 0;
+/* position in the current sampling period of clo_sample_rate windows */
+static ULong samplePos 						= 0;
 static ULong fpOps 							= 0;
+/* operations computed with double-double and promoted shadow values (--hybrid-shadows) */
+static ULong ddOps 							= 0;
+static ULong ddPromoted 					= 0;
+/* operations computed with the samples of --shadow-engine=stochastic */
+static ULong stoOps 						= 0;
 static Int fwrite_pos						= -1;
 static Int fwrite_fd 						= -1;
 
@@ -136,7 +230,12 @@ static UInt putsIgnored 					= 0;
 static UInt maxTemps 						= 0;
 
 static Bool fd_process_cmd_line_option(Char* arg) {
-	if VG_BINT_CLO(arg, "--precision", clo_precision, MPFR_PREC_MIN, MPFR_PREC_MAX) {}
+	Char* pattern;
+	Char* engine;
+
+	if VG_BINT_CLO(arg, "--precision", clo_precision, MPFR_PREC_MIN, MPFR_PREC_MAX) {
+		precisionGiven = True;
+	}
 	else if VG_BOOL_CLO(arg, "--mean-error", clo_computeMeanValue) {}
 	else if VG_BOOL_CLO(arg, "--ignore-libraries", clo_ignoreLibraries) {}
 	else if VG_BOOL_CLO(arg, "--ignore-accurate", clo_ignoreAccurate) {}
@@ -146,8 +245,59 @@ static Bool fd_process_cmd_line_option(Char* arg) {
     else if VG_BOOL_CLO(arg, "--error-localization", clo_error_localization) {}
     else if VG_BOOL_CLO(arg, "--print-every-error", clo_print_every_error) {}
     else if VG_BOOL_CLO(arg, "--detect-pso", clo_detect_pso) {}
+    else if VG_BINT_CLO(arg, "--pso-lanes", clo_pso_lanes, 0, MAX_PSO_LANES) {}
+    else if VG_STR_CLO(arg, "--pso-db", clo_pso_db) {}
+    else if VG_BOOL_CLO(arg, "--pso-fork-server", clo_pso_fork) {}
     else if VG_BOOL_CLO(arg, "--goto-shadow-branch", clo_goto_shadow_branch) {}
     else if VG_BOOL_CLO(arg, "--track-int", clo_track_int) {}
+    else if VG_BOOL_CLO(arg, "--wrap-libm", clo_wrap_libm) {}
+    else if VG_BOOL_CLO(arg, "--wrap-blas", clo_wrap_blas) {}
+    else if VG_BOOL_CLO(arg, "--reinstrument-on-toggle", clo_reinstrument) {}
+    else if VG_STR_CLO(arg, "--start-at-fn", clo_start_fn) {}
+    else if VG_STR_CLO(arg, "--stop-at-fn", clo_stop_fn) {}
+    else if VG_BHEX_CLO(arg, "--start-at-addr", clo_start_addr, 1, ~(Addr)0) {}
+    else if VG_BHEX_CLO(arg, "--stop-at-addr", clo_stop_addr, 1, ~(Addr)0) {}
+    else if VG_BINT_CLO(arg, "--sample-rate", clo_sample_rate, 1, 1000000) {}
+    else if VG_BINT_CLO(arg, "--sample-window", clo_sample_window, 1, 100000000) {}
+    else if VG_BINT_CLO(arg, "--site-budget", clo_site_budget, 0, 1000000000) {}
+    else if VG_BINT_CLO(arg, "--adaptive-precision", clo_adaptive_precision, 0, MPFR_PREC_MAX) {}
+    else if VG_BINT_CLO(arg, "--escalate-threshold", clo_escalate_threshold, 0, 100000) {}
+    else if VG_STR_CLO(arg, "--precision-ladder", clo_precision_ladder) {}
+    else if VG_STR_CLO(arg, "--demote", clo_demote) {}
+    else if VG_STR_CLO(arg, "--demote-candidates", clo_demote_candidates) {}
+    else if VG_BOOL_CLO(arg, "--hybrid-shadows", clo_hybrid) {}
+    else if VG_BOOL_CLO(arg, "--local-error-only", clo_local_error) {}
+    else if VG_BOOL_CLO(arg, "--condition-numbers", clo_condition) {}
+    else if VG_BOOL_CLO(arg, "--reassociation", clo_reassociation) {}
+    else if VG_BOOL_CLO(arg, "--fma-contraction", clo_fma_contraction) {}
+    else if VG_STR_CLO(arg, "--shadow-engine", engine) {
+		if (VG_(strcmp)(engine, "mpfr") == 0) {
+			clo_stochastic = False;
+		} else if (VG_(strcmp)(engine, "stochastic") == 0) {
+			clo_stochastic = True;
+		} else {
+			VG_(fmsg_bad_option)(arg, "Expected mpfr or stochastic\n");
+		}
+    }
+    else if VG_BINT_CLO(arg, "--stochastic-samples", clo_sto_samples, STO_VEC_LANES, MAX_STO_SAMPLES) {
+		if (clo_sto_samples % STO_VEC_LANES != 0) {
+			VG_(fmsg_bad_option)(arg, "Expected 4 or 8 samples\n");
+		}
+    }
+    else if VG_STR_CLO(arg, "--screen", clo_screen) {}
+    else if VG_STR_CLO(arg, "--suspects", clo_suspects) {}
+    else if VG_STR_CLO(arg, "--include", pattern) {
+		if (clo_include_count == MAX_SCOPE_PATTERNS) {
+			VG_(fmsg_bad_option)(arg, "Too many --include patterns\n");
+		}
+		clo_include[clo_include_count++] = pattern;
+    }
+    else if VG_STR_CLO(arg, "--exclude", pattern) {
+		if (clo_exclude_count == MAX_SCOPE_PATTERNS) {
+			VG_(fmsg_bad_option)(arg, "Too many --exclude patterns\n");
+		}
+		clo_exclude[clo_exclude_count++] = pattern;
+    }
 	else 
 		return False;
    
@@ -166,8 +316,37 @@ static void fd_print_usage(void) {
 "    --error-localization=no|yes print large error and its location [no]\n"
 "    --print-every-error=no|yes  print the error of every statement [no]\n"
 "    --detect-pso=no|yes	   detect and fix precision-specific operations [no]\n"
+"    --pso-lanes=<N>           find up to N further precision-specific operations in each run [0]\n"
+"    --pso-db=<file>           fix the precision-specific operations of <file> (written as <exe>_pso.log) [none]\n"
+"    --pso-fork-server=no|yes  run each PSO detection run in a forked child of the process [no]\n"
 "    --goto-shadow-branch=no|yes choose branch according to shadow vlaue (high-precision) [no]\n"
 "    --track-int=no|yes		   continue track the shadow value for integers [no]\n"
+"    --wrap-libm=no|yes        shadow libm calls with MPFR, do not analyze libm itself [no]\n"
+"    --wrap-blas=no|yes        shadow ddot/daxpy/dgemv/dgemm with MPFR kernels, do not analyze BLAS itself [no]\n"
+"    --reinstrument-on-toggle=no|yes  retranslate on begin/end requests, no helpers while not analyzing [no]\n"
+"    --start-at-fn=<name>      do not analyze anything before function <name> is entered [none]\n"
+"    --start-at-addr=<addr>    do not analyze anything before instruction <addr> is executed [none]\n"
+"    --stop-at-fn=<name>       stop the analysis when function <name> is entered [none]\n"
+"    --stop-at-addr=<addr>     stop the analysis when instruction <addr> is executed [none]\n"
+"    --include=<pattern>       only analyze functions, source files or objects matching <pattern> [all]\n"
+"    --exclude=<pattern>       do not analyze functions, source files or objects matching <pattern> [none]\n"
+"    --sample-rate=<N>         analyze only one of N windows of superblock executions [1]\n"
+"    --sample-window=<number>  superblock executions per sampling window [10000]\n"
+"    --site-budget=<K>         stop analyzing an operation after K executions without a new max error [0=never]\n"
+"    --adaptive-precision=<bits> start operations at <bits>, use --precision after cancellations [0=off, else >= 53]\n"
+"    --escalate-threshold=<bits> canceled bits which escalate the precision [10]\n"
+"    --precision-ladder=<p1,p2,..> additionally compute up to 4 ascending precisions and check their convergence [none]\n"
+"    --demote=<f1,f2,..>       simulate the candidates in fp32, fp16 or bf16 and report the errors [none]\n"
+"    --demote-candidates=<file> addresses (0x...) or function names to demote, one per line [none]\n"
+"    --hybrid-shadows=no|yes   keep shadow values of double operations as double-double until MPFR is needed [no]\n"
+"    --shadow-engine=mpfr|stochastic  compute scalar SSE double add/sub/mul/div with MPFR or with randomly rounded samples, the rest always with MPFR [mpfr]\n"
+"    --stochastic-samples=4|8  samples of each shadow value with --shadow-engine=stochastic [4]\n"
+"    --local-error-only=no|yes only compute the rounding error of each operation, no shadow values [no]\n"
+"    --condition-numbers=no|yes  report how much each operation amplifies the errors of its operands [no]\n"
+"    --reassociation=no|yes    compare accumulations with 2, 4 and 8 interleaved partial sums [no]\n"
+"    --fma-contraction=no|yes  compare multiply-add pairs with the fused multiply-add [no]\n"
+"    --screen=<file>           screening run with double-double shadow values, write the suspects and their slices to <file> [none]\n"
+"    --suspects=<file>         only analyze the operations listed in <file> (written by --screen) [all]\n"
 	);
 }
 
@@ -181,16 +360,34 @@ static VgHashTable globalMemory 	= NULL;
 static VgHashTable meanValues 		= NULL;
 static OSet* originAddrSet 			= NULL;
 static OSet* unsupportedOps			= NULL;
+/* operations of --suspects, keyed like the entries of --pso-db, and the 
+   addresses found for them */
+static VgHashTable suspectDb		= NULL;
+static Bool suspectDbHasKeys		= False;
+static OSet* suspectSites			= NULL;
+/* operations computed with the full precision (--adaptive-precision) */
+static OSet* escalatedSites			= NULL;
+/* saturated operations whose translations are not discarded yet (--site-budget) */
+static OSet* saturatedPending		= NULL;
+static VgHashTable ladderSites		= NULL;
+static VgHashTable demoteSites		= NULL;
+static VgHashTable reductionSites	= NULL;
+static VgHashTable contractionSites	= NULL;
 
 static Store* 			storeArgs 	= NULL;
 static Mux0X* 			muxArgs 	= NULL;
 static UnOp* 			unOpArgs 	= NULL;
 static BinOp* 			binOpArgs 	= NULL;
 static TriOp* 			triOpArgs 	= NULL;
+static PackedOp* 		packedOpArgs = NULL;
+static QuadOp* 			quadOpArgs	= NULL;
+static Contraction*		contractionArgs = NULL;
 static CircularRegs* 	circRegs	= NULL;
 
 static ShadowValue* 	threadRegisters[VG_N_THREADS][MAX_REGISTERS];
 static ShadowValue* 	localTemps[MAX_TEMPS];
+/* lanes 1-3 of V128 temporaries, lane 0 is stored in localTemps */
+static ShadowValue* 	laneTemps[MAX_LANES][MAX_TEMPS];
 static ShadowTmp* 		sTmp[TMP_COUNT];
 static ShadowConst* 	sConst[CONST_COUNT];
 static Stage* 			stages[MAX_STAGES];
@@ -209,15 +406,55 @@ static mpfr_t introMaxError, introErr1, introErr2;
 static mpfr_t compareIntroErr1, compareIntroErr2;
 static mpfr_t writeSvOrg, writeSvDiff, writeSvRelError;
 static mpfr_t cancelTemp;
+static mpfr_t demoteTemp;
+static mpfr_t contractA, contractB, contractC, contractFused, contractErr;
+static mpfr_t demoteArgs[3];
+/* arguments and result of a fixed operation in a lane of --pso-lanes */
+static mpfr_t psoTemp;
+static mpfr_t psoArgs[3];
+static mpfr_t ddValue;
+static mpfr_t localExact;
 static mpfr_t arg1tmpX, arg2tmpX, arg3tmpX;
 static mpfr_t arg1midX, arg2midX, arg3midX;
 static mpfr_t arg1oriX, arg2oriX, arg3oriX;
+static mpfr_t arg4tmpX, arg4midX, arg4oriX;
+static mpfr_t qopProduct;
+static mpfr_t blasAVal[BLAS_BLOCK * BLAS_BLOCK], blasAMid[BLAS_BLOCK * BLAS_BLOCK];
+static mpfr_t blasBVal[BLAS_BLOCK * BLAS_BLOCK], blasBMid[BLAS_BLOCK * BLAS_BLOCK];
+static mpfr_t blasMidProd;
+static BlasCall blasCalls[VG_N_THREADS];
+
+/* guard of the helper calls in the current superblock if sampling is on */
+static IRTemp sampleGuard = IRTemp_INVALID;
+
+static void addHelperToIRSB(IRSB* sb, IRDirty* di) {
+	if (sampleGuard != IRTemp_INVALID) {
+		di->guard = IRExpr_RdTmp(sampleGuard);
+	}
+	addStmtToIRSB(sb, IRStmt_Dirty(di));
+}
 
 /* Detecting precision-specific operations*/
 static VgHashTable errorMap			= NULL;
 static VgHashTable detectedPSO		= NULL;
 static Bool findFirstPSO			= False;
 static Bool finishPSO				= False;
+/* Candidates of --pso-lanes. Lane c fixes the candidates 0 to c in addition 
+   to the detected operations and has its own error map. The first candidate 
+   is the first operation found without lanes, each further one is the first 
+   operation found in the lane before it. */
+static Addr psoCandidates[MAX_PSO_LANES];
+static UInt psoLaneCount			= 0;
+static Bool psoLaneFound[MAX_PSO_LANES];
+static VgHashTable psoLaneErrors[MAX_PSO_LANES];
+/* entries of --pso-db, added to detectedPSO when their code is translated */
+static VgHashTable psoDb			= NULL;
+static Int psoDbCount				= 0;
+static Bool psoDbHasKeys			= False;
+/* --pso-fork-server: write end of the pipe in a child, -1 otherwise, and 
+   whether the parent has done the detection runs of the current run */
+static Int psoForkPipe				= -1;
+static Bool psoForkServed			= False;
 static Int defaultEmin				= 0;
 static Int defaultEmax				= 0;
 
@@ -392,6 +629,7 @@ ShadowValue* initShadowValue(UWord key) {
 	sv->key = key;
 	sv->active = True;
 	sv->version = 0;
+	sv->epoch = scopeEpoch;
 	sv->opCount = 0;
 	sv->origin = 0;
 	sv->cancelOrigin = 0;
@@ -401,6 +639,42 @@ ShadowValue* initShadowValue(UWord key) {
 	mpfr_init(sv->midValue);
 	mpfr_init(sv->oriValue);
 
+	sv->dd = False;
+
+	sv->sto = NULL;
+	sv->stoValid = False;
+	if (clo_stochastic) {
+		sv->sto = VG_(malloc)("fd.initShadowValue.3", clo_sto_samples * sizeof(Double));
+	}
+
+	sv->ladder = NULL;
+	if (ladderCount > 0) {
+		Int i;
+		sv->ladder = VG_(malloc)("fd.initShadowValue.2", ladderCount * sizeof(mpfr_t));
+		for (i = 0; i < ladderCount; i++) {
+			mpfr_init2(sv->ladder[i], ladderPrec[i]);
+		}
+	}
+
+	sv->demoted = NULL;
+	if (demoteCount > 0) {
+		Int i;
+		sv->demoted = VG_(malloc)("fd.initShadowValue.4", demoteCount * sizeof(mpfr_t));
+		for (i = 0; i < demoteCount; i++) {
+			mpfr_init2(sv->demoted[i], 53);
+		}
+	}
+
+	sv->pso = NULL;
+	sv->psoValid = 0;
+	if (clo_pso_lanes > 0) {
+		Int i;
+		sv->pso = VG_(malloc)("fd.initShadowValue.5", clo_pso_lanes * sizeof(mpfr_t));
+		for (i = 0; i < clo_pso_lanes; i++) {
+			mpfr_init(sv->pso[i]);
+		}
+	}
+
 	avMallocs++;
 	return sv;
 }
@@ -412,12 +686,102 @@ void freeShadowValue(ShadowValue* sv, Bool freeSvItself) {
 	mpfr_clear(sv->value);
 	mpfr_clear(sv->midValue);
 	mpfr_clear(sv->oriValue);
+	if (sv->ladder != NULL) {
+		Int i;
+		for (i = 0; i < ladderCount; i++) {
+			mpfr_clear(sv->ladder[i]);
+		}
+		VG_(free)(sv->ladder);
+	}
+	if (sv->demoted != NULL) {
+		Int i;
+		for (i = 0; i < demoteCount; i++) {
+			mpfr_clear(sv->demoted[i]);
+		}
+		VG_(free)(sv->demoted);
+	}
+	if (sv->pso != NULL) {
+		Int i;
+		for (i = 0; i < clo_pso_lanes; i++) {
+			mpfr_clear(sv->pso[i]);
+		}
+		VG_(free)(sv->pso);
+	}
+	if (sv->sto != NULL) {
+		VG_(free)(sv->sto);
+	}
 	if (freeSvItself) {
 		VG_(free)(sv);
 	}
 	avFrees++;
 }
 
+/* for shadow values which are not computed by an operation, the precision 
+   ladder, the stochastic samples and the lanes of --pso-lanes restart from 
+   value, the demoted values from the original precision */
+static __inline__
+void resetDerivedValues(ShadowValue* sv) {
+	Int i;
+	sv->stoValid = False;
+	sv->psoValid = 0;
+	if (sv->ladder != NULL) {
+		for (i = 0; i < ladderCount; i++) {
+			mpfr_set(sv->ladder[i], sv->value, STD_RND);
+		}
+	}
+	if (sv->demoted != NULL) {
+		for (i = 0; i < demoteCount; i++) {
+			mpfr_set_prec(sv->demoted[i], mpfr_get_prec(sv->oriValue));
+			mpfr_set(sv->demoted[i], sv->oriValue, STD_RND);
+		}
+	}
+}
+
+/* converts a double-double shadow value (--hybrid-shadows) to MPFR */
+static __inline__
+void promoteShadowValue(ShadowValue* sv) {
+	if (!sv || !sv->dd) {
+		return;
+	}
+	mpfr_set_d(sv->value, sv->ddHi, STD_RND);
+	mpfr_add_d(sv->value, sv->value, sv->ddLo, STD_RND);
+	mpfr_set_prec(sv->midValue, 53);
+	mpfr_set_d(sv->midValue, sv->ddMid, STD_RND);
+	mpfr_set_prec(sv->oriValue, 53);
+	mpfr_set_d(sv->oriValue, sv->ddOri, STD_RND);
+	sv->dd = False;
+	ddPromoted++;
+}
+
+/* Code out of scope is not instrumented (scopeEpoch), a shadow value in 
+   memory written before it ran is kept if the original value is still 
+   stored there. */
+static Bool isValidMemory(ShadowValue* av) {
+	if (!av || !(av->active)) {
+		return False;
+	}
+	if (av->epoch != scopeEpoch) {
+		SizeT size = av->orgType == Ot_FLOAT ? sizeof(Float) : sizeof(Double);
+		if (av->orgType == Ot_INVALID ||
+			!VG_(am_is_valid_for_client)(av->key, size, VKI_PROT_READ) ||
+			VG_(memcmp)((void*)av->key, &(av->Org), size) != 0) {
+			av->active = False;
+			return False;
+		}
+		av->epoch = scopeEpoch;
+	}
+	return True;
+}
+
+/* shadow value of memory which is read and not only copied */
+static __inline__
+ShadowValue* lookupShadow(Addr addr) {
+	ShadowValue* sv = VG_(HT_lookup)(globalMemory, addr);
+	isValidMemory(sv);
+	promoteShadowValue(sv);
+	return sv;
+}
+
 static __inline__
 void copyShadowValue(ShadowValue* newSv, ShadowValue* sv) {
 	tl_assert(newSv != NULL && sv != NULL);
@@ -426,9 +790,23 @@ void copyShadowValue(ShadowValue* newSv, ShadowValue* sv) {
 		mpfr_set_prec(newSv->value, mpfr_get_prec(sv->value));
 		mpfr_set_prec(newSv->midValue, mpfr_get_prec(sv->midValue));
 		mpfr_set_prec(newSv->oriValue, mpfr_get_prec(sv->oriValue));
+	} else if (mpfr_get_prec(newSv->value) != mpfr_get_prec(sv->value)) {
+		/* copies keep the precision of the region they were computed in */
+		mpfr_set_prec(newSv->value, mpfr_get_prec(sv->value));
 	}
 
-	mpfr_set(newSv->value, sv->value, STD_RND);
+	if (sv->dd) {
+		newSv->ddHi = sv->ddHi;
+		newSv->ddLo = sv->ddLo;
+		newSv->ddMid = sv->ddMid;
+		newSv->ddOri = sv->ddOri;
+		newSv->ddErr = sv->ddErr;
+	} else {
+		mpfr_set(newSv->value, sv->value, STD_RND);
+		mpfr_set(newSv->midValue, sv->midValue, STD_RND);
+		mpfr_set(newSv->oriValue, sv->oriValue, STD_RND);
+	}
+	newSv->dd = sv->dd;
 	newSv->opCount = sv->opCount;
 	newSv->origin = sv->origin;
 	newSv->canceled = sv->canceled;
@@ -436,15 +814,40 @@ void copyShadowValue(ShadowValue* newSv, ShadowValue* sv) {
 	// newSv->orgType = Ot_INVALID;
 	newSv->orgType = sv->orgType; // added by ran
 	newSv->Org.db = sv->Org.db; // added by ran
-	mpfr_set(newSv->midValue, sv->midValue, STD_RND);
-	mpfr_set(newSv->oriValue, sv->oriValue, STD_RND);
+	if (newSv->ladder != NULL && sv->ladder != NULL) {
+		Int i;
+		for (i = 0; i < ladderCount; i++) {
+			mpfr_set(newSv->ladder[i], sv->ladder[i], STD_RND);
+		}
+	}
+	if (newSv->demoted != NULL && sv->demoted != NULL) {
+		Int i;
+		for (i = 0; i < demoteCount; i++) {
+			mpfr_set_prec(newSv->demoted[i], mpfr_get_prec(sv->demoted[i]));
+			mpfr_set(newSv->demoted[i], sv->demoted[i], STD_RND);
+		}
+	}
+	newSv->psoValid = 0;
+	if (newSv->pso != NULL && sv->pso != NULL) {
+		UInt i;
+		for (i = 0; i < sv->psoValid; i++) {
+			mpfr_set_prec(newSv->pso[i], mpfr_get_prec(sv->pso[i]));
+			mpfr_set(newSv->pso[i], sv->pso[i], STD_RND);
+		}
+		newSv->psoValid = sv->psoValid;
+	}
+	newSv->stoValid = sv->stoValid && newSv->sto != NULL;
+	if (newSv->stoValid) {
+		VG_(memcpy)(newSv->sto, sv->sto, clo_sto_samples * sizeof(Double));
+	}
 
 	/* Do not overwrite active or version!
 	   They should be set before. */
 }
 
+/* does not promote double-double shadow values, only for copying them */
 static __inline__
-ShadowValue* getTemp(IRTemp tmp) {
+ShadowValue* peekTemp(IRTemp tmp) {
 	tl_assert(tmp >= 0 && tmp < MAX_TEMPS);
 
 	if (localTemps[tmp] && localTemps[tmp]->version == sbExecuted) {
@@ -454,6 +857,69 @@ ShadowValue* getTemp(IRTemp tmp) {
 	}
 }
 
+static __inline__
+ShadowValue* getTemp(IRTemp tmp) {
+	ShadowValue* sv = peekTemp(tmp);
+	promoteShadowValue(sv);
+	return sv;
+}
+
+/* Results are computed with the precision of the current region 
+   (VALGRIND_SET_PRECISION), arguments are converted when they are read. */
+static __inline__
+void adjustPrecision(ShadowValue* sv) {
+	mpfr_prec_t prec = clo_adaptive_precision > 0 ? opPrecision : currentPrecision;
+	if (!clo_simulateOriginal && mpfr_get_prec(sv->value) != prec) {
+		mpfr_set_prec(sv->value, prec);
+	}
+}
+
+/* With --adaptive-precision, operations are computed with the lower working 
+   precision until they or an operation depending on them cancel more than 
+   clo_escalate_threshold bits. Arguments are always read with the full 
+   precision, so escalated chains are not rounded by the others. The result 
+   which triggers the escalation is computed again, the earlier results of 
+   the chain keep the lower precision. */
+static __inline__
+void selectPrecision(Addr addr) {
+	if (clo_adaptive_precision == 0) {
+		return;
+	}
+	if (clo_adaptive_precision < currentPrecision && !VG_(OSetWord_Contains)(escalatedSites, addr)) {
+		opPrecision = clo_adaptive_precision;
+	} else {
+		opPrecision = currentPrecision;
+	}
+}
+
+static void escalateSite(Addr addr, Int level) {
+	if (addr == 0 || level > MAX_LEVEL_OF_GRAPH || VG_(OSetWord_Contains)(escalatedSites, addr)) {
+		return;
+	}
+	VG_(OSetWord_Insert)(escalatedSites, addr);
+
+	MeanValue* mv = VG_(HT_lookup)(meanValues, addr);
+	if (mv != NULL) {
+		escalateSite(mv->arg1, level + 1);
+		escalateSite(mv->arg2, level + 1);
+	}
+}
+
+/* Escalates the operation and the chain of operations its arguments come 
+   from. Returns True if the current result was computed with the lower 
+   precision, it has to be recomputed (recomputeEscalated). The values the 
+   chain has already computed keep the lower precision, only its next 
+   executions use the full precision. */
+static Bool escalatePrecision(Addr addr, mpfr_exp_t canceled, Addr origin1, Addr origin2) {
+	if (clo_adaptive_precision == 0 || canceled <= clo_escalate_threshold) {
+		return False;
+	}
+	escalateSite(addr, 0);
+	escalateSite(origin1, 1);
+	escalateSite(origin2, 1);
+	return opPrecision < currentPrecision;
+}
+
 static __inline__
 ShadowValue* setTemp(IRTemp tmp) {
 	tl_assert(tmp >= 0 && tmp < MAX_TEMPS);
@@ -463,11 +929,152 @@ ShadowValue* setTemp(IRTemp tmp) {
 	} else {
 		localTemps[tmp] = initShadowValue((UWord)tmp);
 	}
+	adjustPrecision(localTemps[tmp]);
 	localTemps[tmp]->version = sbExecuted;
+	localTemps[tmp]->dd = False;
+	localTemps[tmp]->stoValid = False;
+	localTemps[tmp]->psoValid = 0;
 
 	return localTemps[tmp];
 }
 
+static __inline__
+ShadowValue* peekTempLane(IRTemp tmp, Int lane) {
+	if (lane == 0) {
+		return peekTemp(tmp);
+	}
+	tl_assert(tmp >= 0 && tmp < MAX_TEMPS);
+	tl_assert(lane > 0 && lane < MAX_LANES);
+
+	if (laneTemps[lane][tmp] && laneTemps[lane][tmp]->version == sbExecuted) {
+		return laneTemps[lane][tmp];
+	} else {
+		return NULL;
+	}
+}
+
+static __inline__
+ShadowValue* getTempLane(IRTemp tmp, Int lane) {
+	ShadowValue* sv = peekTempLane(tmp, lane);
+	promoteShadowValue(sv);
+	return sv;
+}
+
+static __inline__
+ShadowValue* setTempLane(IRTemp tmp, Int lane) {
+	if (lane == 0) {
+		return setTemp(tmp);
+	}
+	tl_assert(tmp >= 0 && tmp < MAX_TEMPS);
+	tl_assert(lane > 0 && lane < MAX_LANES);
+
+	if (laneTemps[lane][tmp]) {
+		laneTemps[lane][tmp]->active = True;
+	} else {
+		laneTemps[lane][tmp] = initShadowValue((UWord)tmp);
+	}
+	adjustPrecision(laneTemps[lane][tmp]);
+	laneTemps[lane][tmp]->version = sbExecuted;
+	laneTemps[lane][tmp]->dd = False;
+	laneTemps[lane][tmp]->stoValid = False;
+	laneTemps[lane][tmp]->psoValid = 0;
+
+	return laneTemps[lane][tmp];
+}
+
+/* The upper lanes of a scalar SSE operation (e.g. Add64F0x2) are 
+   taken from the first argument without modification. */
+static __inline__
+void copyUpperLanes(IRTemp dst, IRTemp src) {
+	Int lane;
+	for (lane = 1; lane < MAX_LANES; lane++) {
+		ShadowValue* sv = peekTempLane(src, lane);
+		if (sv) {
+			copyShadowValue(setTempLane(dst, lane), sv);
+		}
+	}
+}
+
+/* A V128 value in memory or in a register is shadowed by up to four 
+   shadow values, one for each 4-byte slot. A float lane k lives in 
+   slot k and a double lane k in slot 2*k. */
+static void tempToSlots(Int tmp, ShadowValue** slots) {
+	Int lane;
+	for (lane = 0; lane < MAX_LANES; lane++) {
+		slots[lane] = NULL;
+	}
+	if (!clo_analyze || tmp < 0) {
+		return;
+	}
+
+	for (lane = 0; lane < MAX_LANES; lane++) {
+		ShadowValue* sv = peekTempLane(tmp, lane);
+		if (!sv) continue;
+
+		Int slot = (sv->orgType == Ot_DOUBLE) ? 2 * lane : lane;
+		if (slot < MAX_LANES) {
+			slots[slot] = sv;
+		}
+	}
+}
+
+static void slotsToTemp(Int tmp, ShadowValue** slots) {
+	OrgType type = Ot_INVALID;
+	Int lane;
+	for (lane = 0; lane < MAX_LANES; lane++) {
+		if (slots[lane]) {
+			type = slots[lane]->orgType;
+			break;
+		}
+	}
+
+	for (lane = 0; lane < MAX_LANES; lane++) {
+		Int slot = (type == Ot_DOUBLE) ? 2 * lane : lane;
+		if (slot >= MAX_LANES) break;
+
+		ShadowValue* sv = slots[slot];
+		/* ignore stale shadow values of a different type */
+		if (sv && (lane == 0 || sv->orgType == type)) {
+			copyShadowValue(setTempLane(tmp, lane), sv);
+		}
+	}
+}
+
+/* Entry of the operation at key in meanValues, an empty one is created for 
+   the inline counting of its executions (instrumentSiteCount). */
+static MeanValue* getMeanValue(UWord key, IROp op) {
+	MeanValue* val = VG_(HT_lookup)(meanValues, key);
+	if (val != NULL) {
+		return val;
+	}
+	val = VG_(malloc)("fd.updateMeanValue.1", sizeof(MeanValue));
+	val->key = key;
+	val->op = op;
+	val->count = 0;
+	val->sampled = 0;
+	val->visited = False;
+	val->overflow = False;
+	mpfr_init_set_ui(val->sum, 0, STD_RND);
+	mpfr_init_set_ui(val->max, 0, STD_RND);
+	val->canceledSum = 0;
+	val->canceledMax = 0;
+	val->cancellationBadnessSum = 0;
+	val->cancellationBadnessMax = 0;
+	val->arg1 = 0;
+	val->arg2 = 0;
+	val->unchanged = 0;
+	val->saturated = False;
+	val->stoCount = 0;
+	val->stoDigitsMin = STO_MAX_DIGITS;
+	val->stoDigitsSum = 0;
+	val->condCount = 0;
+	val->condInfinite = 0;
+	val->condSum = 0.0;
+	val->condMax = 0.0;
+	VG_(HT_add_node)(meanValues, val);
+	return val;
+}
+
 static void updateMeanValue(UWord key, IROp op, mpfr_t* shadow, mpfr_exp_t canceled, Addr arg1, Addr arg2, UInt cancellationBadness) {
 	if (mpfr_cmp_ui(meanOrg, 0) != 0 || mpfr_cmp_ui(*shadow, 0) != 0) {
 		mpfr_reldiff(meanRelError, *shadow, meanOrg, STD_RND);
@@ -476,25 +1083,23 @@ static void updateMeanValue(UWord key, IROp op, mpfr_t* shadow, mpfr_exp_t cance
 		mpfr_set_ui(meanRelError, 0, STD_RND);
 	}
 
-	MeanValue* val = VG_(HT_lookup)(meanValues, key);
-	if (val == NULL) {
-		val = VG_(malloc)("fd.updateMeanValue.1", sizeof(MeanValue));
-		val->key = key;
-		val->op = op;
-		val->count = 1;
-		val->visited = False;
-		val->overflow = False;
-		mpfr_init_set(val->sum, meanRelError, STD_RND);
-		mpfr_init_set(val->max, meanRelError, STD_RND);
+	MeanValue* val = getMeanValue(key, op);
+	/* with --sample-rate, the executions are counted inline */
+	if (clo_sample_rate == 1 || FD_IS_FUNCTION_OP(op)) {
+		val->count++;
+	}
+	val->sampled++;
+	if (val->sampled == 1) {
+		mpfr_set(val->sum, meanRelError, STD_RND);
+		mpfr_set(val->max, meanRelError, STD_RND);
 		val->canceledSum = canceled;
 		val->canceledMax = canceled;
 		val->cancellationBadnessSum = cancellationBadness;
 		val->cancellationBadnessMax = cancellationBadness;
-		VG_(HT_add_node)(meanValues, val);
 		val->arg1 = arg1;
 		val->arg2 = arg2;
 	} else {
-		val->count++;
+		Bool changed = False;
 		mpfr_add(val->sum, val->sum, meanRelError, STD_RND);
 
 		mpfr_exp_t oldSum = val->canceledSum;
@@ -510,15 +1115,55 @@ static void updateMeanValue(UWord key, IROp op, mpfr_t* shadow, mpfr_exp_t cance
 			mpfr_set(val->max, meanRelError, STD_RND);
 			val->arg1 = arg1;
 			val->arg2 = arg2;
+			changed = True;
 		}
 
 		if (canceled > val->canceledMax) {
 			val->canceledMax = canceled;
+			changed = True;
 		}
 
 		if (cancellationBadness > val->cancellationBadnessMax) {
 			val->cancellationBadnessMax = cancellationBadness;
 		}
+
+		val->unchanged = changed ? 0 : val->unchanged + 1;
+		if (clo_site_budget > 0 && !val->saturated && val->unchanged >= clo_site_budget && !FD_IS_FUNCTION_OP(op)) {
+			/* retranslated without the analysis of this operation (see instrumentSiteCount) */
+			val->saturated = True;
+			VG_(OSetWord_Insert)(saturatedPending, key);
+		}
+	}
+}
+
+/* The translations of saturated operations cannot be discarded by the 
+   helper which saturates them, the rest of its superblock would run the 
+   discarded code. They are discarded when the scheduler (re)starts the 
+   client code and at client requests. */
+static void discardSaturatedSites(void) {
+	if (saturatedPending == NULL || VG_(OSetWord_Size)(saturatedPending) == 0) {
+		return;
+	}
+	UWord key;
+	VG_(OSetWord_ResetIter)(saturatedPending);
+	while (VG_(OSetWord_Next)(saturatedPending, &key)) {
+		VG_(discard_translations)((Addr64)key, 1, "fpdebug");
+	}
+	VG_(OSetWord_Destroy)(saturatedPending);
+	saturatedPending = VG_(OSetWord_Create)(VG_(malloc), "fd.discardSaturatedSites.1", VG_(free));
+}
+
+static void fd_start_client_code(ThreadId tid, ULong blocksDispatched) {
+	discardSaturatedSites();
+}
+
+static void updateStochasticDigits(UWord key, Int digits) {
+	MeanValue* val = VG_(HT_lookup)(meanValues, key);
+	tl_assert(val);
+	val->stoCount++;
+	val->stoDigitsSum += digits;
+	if (digits < val->stoDigitsMin) {
+		val->stoDigitsMin = digits;
 	}
 }
 
@@ -638,7 +1283,7 @@ static void updateStages(Addr addr, Bool isFloat) {
 		Double d = *(Double*)addr;
 		mpfr_set_d(stageOrg, d, STD_RND);
 	}
-	ShadowValue* svalue = VG_(HT_lookup)(globalMemory, addr);
+	ShadowValue* svalue = lookupShadow(addr);
 
 	if (svalue && svalue->active) {
 		mpfr_sub(stageDiff, svalue->value, stageOrg, STD_RND);
@@ -810,6 +1455,21 @@ void readSTemp(Int num, mpfr_t* fp) {
 	}
 }
 
+static __inline__
+void readSTempLane(Int num, Int lane, Bool isFloat, mpfr_t* fp) {
+	tl_assert(sTmp[num]->type == Ity_V128);
+
+	if (isFloat) {
+		if (clo_simulateOriginal) mpfr_set_prec(*fp, 24);
+		Float* flp = (Float*)(sTmp[num]->U128);
+		mpfr_set_flt(*fp, flp[lane], STD_RND);
+	} else {
+		if (clo_simulateOriginal) mpfr_set_prec(*fp, 53);
+		Double* db = (Double*)(sTmp[num]->U128);
+		mpfr_set_d(*fp, db[lane], STD_RND);
+	}
+}
+
 static void getFileName(Char* name) {
 	Char tempName[256];
 	struct vg_stat st;
@@ -849,6 +1509,32 @@ static void my_fwrite(Int fd, Char* buf, Int len) {
     fwrite_pos += len;
 }
 
+/* Key of the instruction at addr in --pso-db: the name of its object and 
+   its symbol with offset (obj:fn+N), or the offset from the text segment 
+   of the object if it has no symbol (obj:0xN). Both do not change with 
+   ASLR, and the object tells apart the same symbols of different objects. 
+   Returns False for code outside of any object. */
+static Bool getPSOKey(Addr addr, Char* key, Int size) {
+	DebugInfo* di = VG_(find_DebugInfo)(addr);
+	if (di == NULL) {
+		return False;
+	}
+	const UChar* obj = VG_(DebugInfo_get_filename)(di);
+	const UChar* base = VG_(strrchr)(obj, '/');
+	if (base != NULL) {
+		obj = base + 1;
+	}
+	Char sym[DESCRIPTION_SIZE];
+	if (VG_(get_fnname_w_offset)(addr, sym, DESCRIPTION_SIZE)) {
+		VG_(snprintf)(key, size, "%s:%s", obj, sym);
+	} else {
+		VG_(snprintf)(key, size, "%s:0x%lX", obj, addr - VG_(DebugInfo_get_text_avma)(di));
+	}
+	return True;
+}
+
+/* One operation per line: the address, the key of getPSOKey or '-' 
+   and the description as a comment. readPSODb reads it back. */
 static void dumpPSO() {
 	Char fname[256];
 	HChar* clientName = VG_(args_the_exename);
@@ -863,10 +1549,18 @@ static void dumpPSO() {
 	Int file = sr_Res(fileRes);
 
 	VG_(umsg)("Dump PSO into %s\n", fname);
+	VG_(sprintf)(formatBuf, "# precision-specific operations of %s: address, object:symbol+offset, location\n", clientName);
+	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+	Char key[PSO_KEY_SIZE];
 	PSOperation * next;
 	VG_(HT_ResetIter)(detectedPSO);
 	while (next = VG_(HT_Next)(detectedPSO)) {
+		if (!getPSOKey(next->key, key, PSO_KEY_SIZE)) {
+			VG_(strcpy)(key, "-");
+		}
 		VG_(describe_IP)(next->key, description, DESCRIPTION_SIZE);
+		VG_(sprintf)(formatBuf, "0x%lX %s # ", next->key, key);
+		my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
 		VG_(strcat)(description, "\n");
 		my_fwrite(file, (void*)description, VG_(strlen)(description));
 	}
@@ -874,16 +1568,142 @@ static void dumpPSO() {
 	VG_(close)(file);
 }
 
+static UWord hashPSOKey(Char* key) {
+	UWord h = 5381;
+	while (*key != '\0') {
+		h = h * 33 + (UChar)*key++;
+	}
+	return h;
+}
+
+/* Entry of a table of --pso-db or --suspects with the key, or with the 
+   address if key is NULL. Entries with the same hash follow each other in 
+   the chain of the table. */
+static PSODbEntry* lookupPSODb(VgHashTable db, UWord hash, Char* key, Addr addr) {
+	PSODbEntry* e;
+	for (e = VG_(HT_lookup)(db, hash); e != NULL; e = e->next) {
+		if (e->hash != hash) {
+			continue;
+		}
+		if (key != NULL ? (e->key != NULL && VG_(strcmp)(e->key, key) == 0) : (e->key == NULL && e->addr == addr)) {
+			return e;
+		}
+	}
+	return NULL;
+}
+
+/* Entry of the instruction at addr in a table of --pso-db or --suspects: 
+   the entry with its key (getPSOKey), or with its address for entries 
+   outside of any object. */
+static PSODbEntry* findPSODbEntry(VgHashTable db, Bool hasKeys, Addr addr) {
+	Char key[PSO_KEY_SIZE];
+	PSODbEntry* e = NULL;
+	if (hasKeys && getPSOKey(addr, key, PSO_KEY_SIZE)) {
+		e = lookupPSODb(db, hashPSOKey(key), key, 0);
+	}
+	if (e == NULL) {
+		e = lookupPSODb(db, addr, NULL, addr);
+	}
+	return e;
+}
+
+/* Parses the key of getPSOKey after the address of a line whose comment 
+   has been cut off, and adds the entry to db. Returns True if it has a key. */
+static Bool addPSODbEntry(VgHashTable db, Addr addr, Char* key) {
+	/* the key is the rest of the line, demangled C++ symbols contain spaces */
+	while (*key == ' ' || *key == '\t') key++;
+	Int keyLen = VG_(strlen)(key);
+	while (keyLen > 0 && (key[keyLen - 1] == ' ' || key[keyLen - 1] == '\t' || key[keyLen - 1] == '\r')) keyLen--;
+	key[keyLen] = '\0';
+
+	PSODbEntry* e = VG_(malloc)("fd.addPSODbEntry.1", sizeof(PSODbEntry));
+	e->addr = addr;
+	e->key = NULL;
+	e->resolved = 0;
+	if (keyLen > 0 && VG_(strcmp)(key, "-") != 0) {
+		e->key = VG_(strdup)("fd.addPSODbEntry.2", key);
+	}
+	e->hash = e->key ? hashPSOKey(e->key) : addr;
+	VG_(HT_add_node)(db, e);
+	return e->key != NULL;
+}
+
+/* Reads a file in the format of dumpPSO into psoDb, keyed by the hash of 
+   the key or by the address. The entries are resolved by resolvePSODb, 
+   the detection runs of the client are skipped. */
+static void readPSODb(Char* fname) {
+	SysRes fileRes = VG_(open)(fname, VKI_O_RDONLY, 0);
+	if (sr_isError(fileRes)) {
+		VG_(fmsg)("PSO DATABASE (%s): Failed to open the file!\n", fname);
+		VG_(exit)(1);
+	}
+	Int file = sr_Res(fileRes);
+
+	psoDb = VG_(HT_construct)("PSO database");
+	Char line[FORMATBUF_SIZE];
+	Int len = 0;
+	Char c;
+	while (True) {
+		Int n = VG_(read)(file, &c, 1);
+		if (n == 1 && c != '\n') {
+			if (len < FORMATBUF_SIZE - 1) {
+				line[len++] = c;
+			}
+			continue;
+		}
+		line[len] = '\0';
+		Int i;
+		for (i = 0; i < len && line[i] != '#'; i++);
+		line[i] = '\0';
+		Char* end;
+		Addr addr = (Addr)VG_(strtoull16)(line, &end);
+		if (end != line) {
+			if (addPSODbEntry(psoDb, addr, end)) {
+				psoDbHasKeys = True;
+			}
+			psoDbCount++;
+		}
+		len = 0;
+		if (n != 1) break;
+	}
+	VG_(close)(file);
+	VG_(umsg)("PSO DATABASE (%s): %d precision-specific operations\n", fname, psoDbCount);
+	finishPSO = True;
+}
+
+/* Adds the instruction at addr to detectedPSO if an entry of --pso-db has 
+   its key (getPSOKey), or its address for entries outside of any object. 
+   Called for each instruction when it is translated. */
+static void resolvePSODb(Addr addr) {
+	if (VG_(HT_lookup)(detectedPSO, addr) != NULL) {
+		return;
+	}
+	PSODbEntry* e = findPSODbEntry(psoDb, psoDbHasKeys, addr);
+	if (e == NULL) {
+		return;
+	}
+	PSOperation* p = VG_(malloc)("fd.initPSOperation.2", sizeof(PSOperation));
+	p->key = addr;
+	p->falsePositive = False;
+	VG_(HT_add_node)(detectedPSO, p);
+	e->resolved++;
+	VG_(describe_IP)(addr, description, DESCRIPTION_SIZE);
+	VG_(umsg)("PSO from database at	%s\n", description);
+}
+
 static Bool isPSOFinished() {
 	if (!clo_detect_pso) return True;
 	return finishPSO;
 }
 
-static void collectPSO() {
+static void collectPSO(VgHashTable map) {
 	ErrorCount* next;
-	VG_(HT_ResetIter)(errorMap);
-	while (next = VG_(HT_Next)(errorMap)) {
-		if (next->errCnt > next->totalCnt * PSO_PERCENTIGE_THRESHOLD) {
+	VG_(HT_ResetIter)(map);
+	while (next = VG_(HT_Next)(map)) {
+		/* a lane of --pso-lanes may find an operation of the error map again */
+		if (next->errCnt > next->totalCnt * PSO_PERCENTIGE_THRESHOLD && 
+			VG_(HT_lookup)(detectedPSO, next->key) == NULL) 
+		{
 			PSOperation* p = VG_(malloc)("fd.initPSOperation.1", sizeof(PSOperation));
 			p->key = next->key;
 			p->falsePositive = next->ovCnt * 1.0 / next->totalCnt > PSO_FALSEPOSITIVE_PERCENTAGE ? True : False;
@@ -898,21 +1718,63 @@ static void collectPSO() {
 	}
 }
 
+static void servePSORuns(void);
+static void reportForkedRun(void);
+
+static void initOneRun() {
+	errorMap = VG_(HT_construct)("Error map for detecting precision-specific operations");
+	finishPSO = False;
+	psoLaneCount = 0;
+	Int c;
+	for (c = 0; c < clo_pso_lanes; c++) {
+		psoLaneErrors[c] = VG_(HT_construct)("Error map of a candidate lane");
+	}
+}
+
 static void beginOneRun() {
 	if (!clo_detect_pso) return;
 	VG_(umsg)("One run for PSO detection begin.\n");
-	errorMap = VG_(HT_construct)("Error map for detecting precision-specific operations");
-	finishPSO = False;
+	initOneRun();
+	if (clo_pso_fork && psoForkPipe < 0) {
+		servePSORuns();
+	}
 }
 
 static void endOneRun() {
 	if (!clo_detect_pso) return;
+	if (psoForkPipe >= 0) {
+		reportForkedRun();
+	}
+	if (psoForkServed) {
+		/* the runs are done, this one only executed the client code */
+		psoForkServed = False;
+		return;
+	}
 	finishPSO = True;
-	collectPSO();
+	collectPSO(errorMap);
 	UInt n_memory = 0;
 	ErrorCount** memory = VG_(HT_to_array)(errorMap, &n_memory);
 	VG_(free)(memory);
 	VG_(HT_destruct)(errorMap);
+	/* lane c is only meaningful if its candidate was confirmed by the maps 
+	   before it, the lanes from the first rejected candidate on are dropped */
+	Bool confirmed = True;
+	Int c;
+	for (c = 0; c < clo_pso_lanes; c++) {
+		if ((UInt)c < psoLaneCount && confirmed) {
+			VG_(describe_IP)(psoCandidates[c], description, DESCRIPTION_SIZE);
+			if (VG_(HT_lookup)(detectedPSO, psoCandidates[c]) != NULL) {
+				VG_(umsg)("Candidate lane %d fixes %s\n", c, description);
+				collectPSO(psoLaneErrors[c]);
+			} else {
+				VG_(umsg)("Candidate lane %d is dropped, %s is not precision-specific\n", c, description);
+				confirmed = False;
+			}
+		}
+		VG_(HT_destruct)(psoLaneErrors[c]);
+		psoLaneErrors[c] = NULL;
+	}
+	psoLaneCount = 0;
 	VG_(umsg)("One run for PSO detection end.\n");
 	if (finishPSO) {
 		UWord temp[PSO_SIZE];
@@ -944,6 +1806,10 @@ static void endOneRun() {
 static void beginOneInstance() {
 	if (!clo_detect_pso) return;
 	findFirstPSO = False;
+	Int c;
+	for (c = 0; c < MAX_PSO_LANES; c++) {
+		psoLaneFound[c] = False;
+	}
 }
 
 static ErrorCount * initErrorCount() {
@@ -954,14 +1820,151 @@ static ErrorCount * initErrorCount() {
 	return e;
 }
 
-static void checkAndRecover(ShadowValue* svalue) {
-	if (svalue) {
-		mpfr_t org;
-		mpfr_init(org);
+/* Sends the error maps of a run of --pso-fork-server to the parent and 
+   ends the child. The last record has map ~0, without it the parent knows 
+   that the child ended before VALGRIND_PSO_END_RUN. */
+static void reportForkedRun(void) {
+	PSOForkRecord r;
+	UInt m;
+	for (m = 0; m <= psoLaneCount; m++) {
+		VgHashTable map = m == 0 ? errorMap : psoLaneErrors[m - 1];
+		ErrorCount* next;
+		VG_(HT_ResetIter)(map);
+		while (next = VG_(HT_Next)(map)) {
+			r.map = m;
+			r.key = next->key;
+			r.errCnt = next->errCnt;
+			r.ovCnt = next->ovCnt;
+			r.totalCnt = next->totalCnt;
+			VG_(write)(psoForkPipe, &r, sizeof(PSOForkRecord));
+		}
+	}
+	/* the candidates of the lanes, for the messages of the parent */
+	for (m = 0; m < psoLaneCount; m++) {
+		r.map = m + 1;
+		r.key = psoCandidates[m];
+		r.errCnt = r.ovCnt = r.totalCnt = -1;
+		VG_(write)(psoForkPipe, &r, sizeof(PSOForkRecord));
+	}
+	r.map = ~0U;
+	VG_(write)(psoForkPipe, &r, sizeof(PSOForkRecord));
+	VG_(close)(psoForkPipe);
+	VG_(exit)(0);
+}
 
-		if (svalue->orgType == Ot_FLOAT) {
-			mpfr_set_prec(org, 24);
-			mpfr_set_flt(org, svalue->Org.fl, STD_RND);
+static Bool readForkRecord(Int fd, PSOForkRecord* r) {
+	Int got = 0;
+	while (got < sizeof(PSOForkRecord)) {
+		Int n = VG_(read)(fd, (Char*)r + got, sizeof(PSOForkRecord) - got);
+		if (n <= 0) {
+			return False;
+		}
+		got += n;
+	}
+	return True;
+}
+
+/* Reads the error maps of one child into the maps of this run, returns 
+   False if the child ended before the end of its run. */
+static Bool receiveForkedRun(Int fd) {
+	PSOForkRecord r;
+	while (readForkRecord(fd, &r)) {
+		if (r.map == ~0U) {
+			return True;
+		}
+		if (r.map > clo_pso_lanes) {
+			continue;
+		}
+		if (r.map > psoLaneCount) {
+			psoLaneCount = r.map;
+		}
+		if (r.totalCnt < 0) {
+			psoCandidates[r.map - 1] = r.key;
+			continue;
+		}
+		VgHashTable map = r.map == 0 ? errorMap : psoLaneErrors[r.map - 1];
+		ErrorCount* cnt = initErrorCount();
+		cnt->key = r.key;
+		cnt->errCnt = r.errCnt;
+		cnt->ovCnt = r.ovCnt;
+		cnt->totalCnt = r.totalCnt;
+		VG_(HT_add_node)(map, cnt);
+	}
+	return False;
+}
+
+/* --pso-fork-server: at VALGRIND_PSO_BEGIN_RUN, each run is executed by a 
+   forked child which starts with the translations and shadow values of this 
+   point and returns at its VALGRIND_PSO_END_RUN. This process collects the 
+   results and forks the next run until no operation is found. Afterwards it 
+   executes the run once more without detection. */
+static void servePSORuns(void) {
+	while (True) {
+		/* VG_(fork) skips the atfork handling of the core, the scheduler 
+		   lock of a child would still be shared with the other threads */
+		if (VG_(count_living_threads)() > 1) {
+			VG_(umsg)("PSO FORK SERVER: the client has several threads, the runs are executed in this process\n");
+			clo_pso_fork = False;
+			return;
+		}
+		Int fds[2];
+		Int pid = -1;
+		if (VG_(pipe)(fds) == 0) {
+			/* out of the range of the client, which can not close them */
+			fds[0] = VG_(safe_fd)(fds[0]);
+			fds[1] = VG_(safe_fd)(fds[1]);
+			pid = VG_(fork)();
+			if (pid < 0) {
+				VG_(close)(fds[0]);
+				VG_(close)(fds[1]);
+			}
+		}
+		if (pid < 0) {
+			VG_(umsg)("PSO FORK SERVER: fork failed, the runs are executed in this process\n");
+			clo_pso_fork = False;
+			return;
+		}
+		if (pid == 0) {
+			VG_(close)(fds[0]);
+			psoForkPipe = fds[1];
+			return;
+		}
+
+		VG_(close)(fds[1]);
+		Bool complete = receiveForkedRun(fds[0]);
+		VG_(close)(fds[0]);
+		Int status;
+		VG_(waitpid)(pid, &status, 0);
+		if (!complete) {
+			VG_(umsg)("PSO FORK SERVER: the child %d ended before VALGRIND_PSO_END_RUN, the runs are executed in this process\n", pid);
+			clo_pso_fork = False;
+			Int c;
+			VG_(HT_destruct)(errorMap);
+			for (c = 0; c < clo_pso_lanes; c++) {
+				VG_(HT_destruct)(psoLaneErrors[c]);
+			}
+			initOneRun();
+			return;
+		}
+
+		endOneRun();
+		if (finishPSO) {
+			psoForkServed = True;
+			return;
+		}
+		VG_(umsg)("One run for PSO detection begin.\n");
+		initOneRun();
+	}
+}
+
+static void checkAndRecover(ShadowValue* svalue) {
+	if (svalue) {
+		mpfr_t org;
+		mpfr_init(org);
+
+		if (svalue->orgType == Ot_FLOAT) {
+			mpfr_set_prec(org, 24);
+			mpfr_set_flt(org, svalue->Org.fl, STD_RND);
 		} else if (svalue->orgType == Ot_DOUBLE) {
 			mpfr_set_prec(org, 53);
 			mpfr_set_d(org, svalue->Org.db, STD_RND);
@@ -979,6 +1982,7 @@ static void checkAndRecover(ShadowValue* svalue) {
 			mpfr_set(svalue->value, org, STD_RND);
 			mpfr_set(svalue->midValue, org, STD_RND);
 			mpfr_set(svalue->oriValue, org, STD_RND);
+			resetDerivedValues(svalue);
 		}
 
 		mpfr_clear(org);
@@ -1055,16 +2059,10 @@ static void printErrorShort(ShadowValue* svalue) {
 	}
 }
 
-static void analyzePSO(mpfr_t irel, ShadowValue* o) {
-	if (findFirstPSO || (!clo_detect_pso) || finishPSO) {
-		return;
-	}
-
-	// Calculate error inflation
-	mpfr_t orel;
-	mpfr_init(orel);
-	computeRelativeError(o, orel);
-
+/* Counts one execution of the operation of o in map, the output relative 
+   error of o is orel and its shadow value is value. Returns True if the 
+   error inflation exceeds the threshold. */
+static Bool countPSO(VgHashTable map, mpfr_t irel, mpfr_t orel, ShadowValue* o, mpfr_t* value) {
 	mpfr_t inflation;
 	mpfr_init(inflation);
 	if (mpfr_cmp_ui(irel, 0) != 0) {
@@ -1108,30 +2106,51 @@ static void analyzePSO(mpfr_t irel, ShadowValue* o) {
 			// VG_(umsg)("Warning: a precision-specific operation is not fixed at %s\n", description);
 			// printErrorShort(o);
 		}
-		mpfr_clears(orel, inflation, org, NULL);
-		return;
+		mpfr_clears(inflation, org, NULL);
+		return False;
 	}
+	Bool found = False;
 	mpfr_t temp;
 	mpfr_init(temp);
-	ErrorCount* cnt = VG_(HT_lookup)(errorMap, o->origin);
+	ErrorCount* cnt = VG_(HT_lookup)(map, o->origin);
 	if (cnt == NULL) { 
 		cnt = initErrorCount();
 		cnt->key = o->origin;
-		VG_(HT_add_node)(errorMap, cnt);
+		VG_(HT_add_node)(map, cnt);
 	}
 	if (mpfr_cmp_d(inflation, PSO_INFLATION_THRESHOLD) >= 0) {
-		mpfr_abs(temp, o->value, STD_RND);
+		mpfr_abs(temp, *value, STD_RND);
 		if (mpfr_cmp_d(org, PSO_OV_ZERO_BOUND) < 0 && mpfr_cmp_d(temp, PSO_SV_ZERO_BOUND) < 0) {
 			cnt->ovCnt++;
 		}
 		cnt->errCnt++;
 		cnt->totalCnt++;
-		findFirstPSO = True;
+		found = True;
 	} else {
 		cnt->totalCnt++;
 	}
 
-	mpfr_clears(orel, inflation, org, temp, NULL);
+	mpfr_clears(inflation, org, temp, NULL);
+	return found;
+}
+
+static void analyzePSO(mpfr_t irel, ShadowValue* o) {
+	if (findFirstPSO || (!clo_detect_pso) || finishPSO) {
+		return;
+	}
+
+	// Calculate error inflation
+	mpfr_t orel;
+	mpfr_init(orel);
+	computeRelativeError(o, orel);
+	if (countPSO(errorMap, irel, orel, o, &(o->value))) {
+		findFirstPSO = True;
+		/* the first lane of --pso-lanes fixes the first operation found */
+		if (psoLaneCount == 0 && clo_pso_lanes > 0) {
+			psoCandidates[psoLaneCount++] = o->origin;
+		}
+	}
+	mpfr_clear(orel);
 }
 
 static Bool isOpFloat(IROp op) {
@@ -1147,6 +2166,20 @@ static Bool isOpFloat(IROp op) {
 		case Iop_Div32F0x4:
 		case Iop_Min32F0x4:
 		case Iop_Max32F0x4:
+		case Iop_SqrtF32:
+		/* ternary float */
+		case Iop_AddF32:
+		case Iop_SubF32:
+		case Iop_MulF32:
+		case Iop_DivF32:
+		/* packed float */
+		case Iop_Sqrt32Fx4:
+		case Iop_Add32Fx4:
+		case Iop_Sub32Fx4:
+		case Iop_Mul32Fx4:
+		case Iop_Div32Fx4:
+		case Iop_Min32Fx4:
+		case Iop_Max32Fx4:
 			return True;
 		/* unary double */
 		case Iop_Sqrt64F0x2:
@@ -1165,11 +2198,39 @@ static Bool isOpFloat(IROp op) {
 		case Iop_F64toI64S:
 		case Iop_F64toI64U:
 		case Iop_F64toI32U:
+		case Iop_SqrtF64:
+		case Iop_SinF64:
+		case Iop_CosF64:
+		case Iop_TanF64:
+		case Iop_2xm1F64:
+		/* packed double */
+		case Iop_Sqrt64Fx2:
+		case Iop_Add64Fx2:
+		case Iop_Sub64Fx2:
+		case Iop_Mul64Fx2:
+		case Iop_Div64Fx2:
+		case Iop_Min64Fx2:
+		case Iop_Max64Fx2:
 		/* ternary double */
 		case Iop_AddF64:
 		case Iop_SubF64:
 		case Iop_MulF64:
 		case Iop_DivF64:
+		case Iop_AddF64r32:
+		case Iop_SubF64r32:
+		case Iop_MulF64r32:
+		case Iop_DivF64r32:
+		case Iop_AtanF64:
+		case Iop_Yl2xF64:
+		case Iop_Yl2xp1F64:
+		case Iop_PRemF64:
+		case Iop_PRem1F64:
+		case Iop_ScaleF64:
+		/* quaternary double */
+		case Iop_MAddF64:
+		case Iop_MSubF64:
+		case Iop_MAddF64r32:
+		case Iop_MSubF64r32:
 			return False;
 		default:
 			VG_(tool_panic)("Unhandled operation in isOpFloat\n");
@@ -1187,11 +2248,461 @@ static void endEmulate() {
 	mpfr_set_emax(defaultEmax);
 }
 
+/* The composite x87 operations are evaluated with a wider intermediate 
+   result, so the final value is rounded (almost) only once. The return 
+   value is the ternary value of the final rounding. */
+static int compute2xm1(mpfr_t res, mpfr_t x) {
+	mpfr_t t;
+	mpfr_init2(t, 2 * mpfr_get_prec(res) + 32);
+	mpfr_exp2(t, x, STD_RND);
+	int tv = mpfr_sub_ui(res, t, 1, STD_RND);
+	mpfr_clear(t);
+	return tv;
+}
+
+static int computeYl2x(mpfr_t res, mpfr_t y, mpfr_t x, Bool plusOne) {
+	mpfr_t t, ln2;
+	mpfr_init2(t, 2 * mpfr_get_prec(res) + 32);
+	if (plusOne) {
+		mpfr_init2(ln2, mpfr_get_prec(t));
+		mpfr_const_log2(ln2, STD_RND);
+		mpfr_log1p(t, x, STD_RND);
+		mpfr_div(t, t, ln2, STD_RND);
+		mpfr_clear(ln2);
+	} else {
+		mpfr_log2(t, x, STD_RND);
+	}
+	int tv = mpfr_mul(res, y, t, STD_RND);
+	mpfr_clear(t);
+	return tv;
+}
+
+static int computeScale(mpfr_t res, mpfr_t x, mpfr_t n) {
+	mpfr_t t;
+	mpfr_init2(t, mpfr_get_prec(n));
+	mpfr_trunc(t, n);
+	int tv = mpfr_mul_2si(res, x, mpfr_get_si(t, STD_RND), STD_RND);
+	mpfr_clear(t);
+	return tv;
+}
+
+typedef
+	enum {
+		Lk_NONE,
+		Lk_ADD,
+		Lk_SUB,
+		Lk_MUL,
+		Lk_DIV,
+		Lk_MIN,
+		Lk_MAX,
+		Lk_SQRT,
+		Lk_NEG,
+		Lk_ABS,
+		Lk_FMA,
+		Lk_FMS,
+		Lk_SIN,
+		Lk_COS,
+		Lk_TAN,
+		Lk_2XM1,
+		Lk_ATAN,
+		Lk_YL2X,
+		Lk_YL2XP1,
+		Lk_PREM,
+		Lk_PREM1,
+		Lk_SCALE
+	}
+	LadderKind;
+
+static LadderKind ladderKind(IROp op) {
+	switch (op) {
+		case Iop_Add32F0x4: case Iop_Add64F0x2: case Iop_Add32Fx4: case Iop_Add64Fx2:
+		case Iop_AddF64: case Iop_AddF32: case Iop_AddF64r32:
+			return Lk_ADD;
+		case Iop_Sub32F0x4: case Iop_Sub64F0x2: case Iop_Sub32Fx4: case Iop_Sub64Fx2:
+		case Iop_SubF64: case Iop_SubF32: case Iop_SubF64r32:
+			return Lk_SUB;
+		case Iop_Mul32F0x4: case Iop_Mul64F0x2: case Iop_Mul32Fx4: case Iop_Mul64Fx2:
+		case Iop_MulF64: case Iop_MulF32: case Iop_MulF64r32:
+			return Lk_MUL;
+		case Iop_Div32F0x4: case Iop_Div64F0x2: case Iop_Div32Fx4: case Iop_Div64Fx2:
+		case Iop_DivF64: case Iop_DivF32: case Iop_DivF64r32:
+			return Lk_DIV;
+		case Iop_Min32F0x4: case Iop_Min64F0x2: case Iop_Min32Fx4: case Iop_Min64Fx2:
+			return Lk_MIN;
+		case Iop_Max32F0x4: case Iop_Max64F0x2: case Iop_Max32Fx4: case Iop_Max64Fx2:
+			return Lk_MAX;
+		case Iop_Sqrt32F0x4: case Iop_Sqrt64F0x2: case Iop_Sqrt32Fx4: case Iop_Sqrt64Fx2:
+		case Iop_SqrtF32: case Iop_SqrtF64:
+			return Lk_SQRT;
+		case Iop_NegF32: case Iop_NegF64:
+			return Lk_NEG;
+		case Iop_AbsF32: case Iop_AbsF64:
+			return Lk_ABS;
+		case Iop_MAddF64: case Iop_MAddF64r32:
+			return Lk_FMA;
+		case Iop_MSubF64: case Iop_MSubF64r32:
+			return Lk_FMS;
+		case Iop_SinF64:		return Lk_SIN;
+		case Iop_CosF64:		return Lk_COS;
+		case Iop_TanF64:		return Lk_TAN;
+		case Iop_2xm1F64:		return Lk_2XM1;
+		case Iop_AtanF64:		return Lk_ATAN;
+		case Iop_Yl2xF64:		return Lk_YL2X;
+		case Iop_Yl2xp1F64:		return Lk_YL2XP1;
+		case Iop_PRemF64:		return Lk_PREM;
+		case Iop_PRem1F64:		return Lk_PREM1;
+		case Iop_ScaleF64:		return Lk_SCALE;
+		default:
+			return Lk_NONE;
+	}
+}
+
+/* The value of an argument for one precision of the ladder. Arguments 
+   without a shadow value or with a shadow value which has been set by a 
+   client request use the shadow value read by the operation. */
+static __inline__
+mpfr_t* ladderArg(ShadowValue* sv, mpfr_t* argX, Int i) {
+	if (sv != NULL && sv->ladder != NULL && (!mpfr_nan_p(sv->ladder[i]) || mpfr_nan_p(sv->value))) {
+		return &(sv->ladder[i]);
+	}
+	return argX;
+}
+
+static void updateLadderSite(Addr addr, IROp op, ShadowValue* res) {
+	LadderSite* site = VG_(HT_lookup)(ladderSites, addr);
+	if (site == NULL) {
+		site = VG_(malloc)("fd.updateLadderSite.1", sizeof(LadderSite));
+		site->key = addr;
+		site->op = op;
+		site->count = 0;
+		site->diverged = 0;
+		site->maxDiff = 0.0;
+		VG_(HT_add_node)(ladderSites, site);
+	}
+	site->count++;
+
+	/* the highest precision is compared with the next lower one, 
+	   or with the shadow value for a ladder with one precision */
+	mpfr_t* high = &(res->ladder[ladderCount - 1]);
+	mpfr_t* low = ladderCount > 1 ? &(res->ladder[ladderCount - 2]) : &(res->value);
+	if (mpfr_get_d(*high, STD_RND) != mpfr_get_d(*low, STD_RND)) {
+		site->diverged++;
+	}
+	if (mpfr_cmp_ui(*high, 0) != 0) {
+		mpfr_reldiff(cancelTemp, *high, *low, STD_RND);
+		Double diff = mpfr_get_d(cancelTemp, STD_RND);
+		if (diff < 0) diff = -diff;
+		if (diff > site->maxDiff) {
+			site->maxDiff = diff;
+		}
+	}
+}
+
+/* Computes r from the arguments, returns the ternary value */
+static int applyLadderKind(LadderKind kind, mpfr_t r, mpfr_t* a, mpfr_t* b, mpfr_t* c) {
+	switch (kind) {
+		case Lk_ADD:	return mpfr_add(r, *a, *b, STD_RND);
+		case Lk_SUB:	return mpfr_sub(r, *a, *b, STD_RND);
+		case Lk_MUL:	return mpfr_mul(r, *a, *b, STD_RND);
+		case Lk_DIV:	return mpfr_div(r, *a, *b, STD_RND);
+		case Lk_MIN:	return mpfr_min(r, *a, *b, STD_RND);
+		case Lk_MAX:	return mpfr_max(r, *a, *b, STD_RND);
+		case Lk_SQRT:	return mpfr_sqrt(r, *a, STD_RND);
+		case Lk_NEG:	return mpfr_neg(r, *a, STD_RND);
+		case Lk_ABS:	return mpfr_abs(r, *a, STD_RND);
+		case Lk_FMA:	return mpfr_fma(r, *a, *b, *c, STD_RND);
+		case Lk_FMS:	return mpfr_fms(r, *a, *b, *c, STD_RND);
+		case Lk_SIN:	return mpfr_sin(r, *a, STD_RND);
+		case Lk_COS:	return mpfr_cos(r, *a, STD_RND);
+		case Lk_TAN:	return mpfr_tan(r, *a, STD_RND);
+		case Lk_2XM1:	return compute2xm1(r, *a);
+		case Lk_ATAN:	return mpfr_atan2(r, *a, *b, STD_RND);
+		case Lk_YL2X:	return computeYl2x(r, *a, *b, False);
+		case Lk_YL2XP1:	return computeYl2x(r, *a, *b, True);
+		case Lk_PREM:	return mpfr_fmod(r, *a, *b, STD_RND);
+		case Lk_PREM1:	return mpfr_remainder(r, *a, *b, STD_RND);
+		case Lk_SCALE:	return computeScale(r, *a, *b);
+		default:		tl_assert(0); return 0;
+	}
+}
+
+/* Computes the result of an escalated operation (escalatePrecision) again 
+   with the full precision. Only operations which cancel are escalated, 
+   they are all covered by ladderKind. */
+static void recomputeEscalated(ShadowValue* res, IROp op, mpfr_t* a, mpfr_t* b, mpfr_t* c) {
+	LadderKind kind = ladderKind(op);
+	if (kind == Lk_NONE) {
+		return;
+	}
+	opPrecision = currentPrecision;
+	if (!clo_simulateOriginal) {
+		mpfr_set_prec(res->value, currentPrecision);
+	}
+	applyLadderKind(kind, res->value, a, b, c);
+}
+
+/* Computes the values of the ladder (--precision-ladder) of a result from 
+   the ladders of its arguments. Operations not listed in ladderKind keep 
+   the shadow value in every precision and are not reported. Conversions 
+   between F32 and F64 share the shadow value of their argument (tmpInstead), 
+   so its ladder is propagated unchanged. */
+static void computeLadder(Addr addr, IROp op, ShadowValue* res, 
+		ShadowValue* sv1, mpfr_t* x1, ShadowValue* sv2, mpfr_t* x2, ShadowValue* sv3, mpfr_t* x3) {
+	if (ladderCount == 0 || res->ladder == NULL) {
+		return;
+	}
+
+	LadderKind kind = ladderKind(op);
+	Int i;
+	if (kind == Lk_NONE) {
+		for (i = 0; i < ladderCount; i++) {
+			mpfr_set(res->ladder[i], res->value, STD_RND);
+		}
+		return;
+	}
+	for (i = 0; i < ladderCount; i++) {
+		mpfr_t* a = ladderArg(sv1, x1, i);
+		mpfr_t* b = x2 ? ladderArg(sv2, x2, i) : NULL;
+		mpfr_t* c = x3 ? ladderArg(sv3, x3, i) : NULL;
+		applyLadderKind(kind, res->ladder[i], a, b, c);
+	}
+	updateLadderSite(addr, op, res);
+}
+
+/* The value of an argument for one demoted simulation (--demote). Arguments 
+   without demoted values use the value of the original precision. */
+static __inline__
+mpfr_t* demotedArg(ShadowValue* sv, mpfr_t* oriX, Int k) {
+	if (sv != NULL && sv->demoted != NULL && (!mpfr_nan_p(sv->demoted[k]) || mpfr_nan_p(sv->oriValue))) {
+		return &(sv->demoted[k]);
+	}
+	return oriX;
+}
+
+/* Index of the candidate (--demote-candidates) an operation belongs to, 
+   the first match of its address or function, or -1. */
+static Int demoteCandidate(Addr addr) {
+	DemoteSite* site = VG_(HT_lookup)(demoteSites, addr);
+	if (site != NULL) {
+		return site->candidate;
+	}
+
+	site = VG_(malloc)("fd.demoteCandidate.1", sizeof(DemoteSite));
+	site->key = addr;
+	site->candidate = -1;
+	Char fnname[DESCRIPTION_SIZE];
+	Bool hasFn = VG_(get_fnname)(addr, fnname, DESCRIPTION_SIZE);
+	Int c;
+	for (c = 0; c < demoteCandidateCount; c++) {
+		if (demoteCandidates[c].addr == addr || 
+			(hasFn && demoteCandidates[c].fn != NULL && VG_(string_match)(demoteCandidates[c].fn, fnname))) 
+		{
+			site->candidate = c;
+			break;
+		}
+	}
+	VG_(HT_add_node)(demoteSites, site);
+	return site->candidate;
+}
+
+static void updateDemoteCandidate(Int k, Addr addr, ShadowValue* res) {
+	DemoteCandidate* dc = &(demoteCandidates[k / demoteFormatCount]);
+	Int f = k % demoteFormatCount;
+	if (mpfr_equal_p(res->demoted[k], res->oriValue) || !mpfr_number_p(res->oriValue)) {
+		return;
+	}
+	dc->changed[f]++;
+	if (mpfr_cmp_ui(res->oriValue, 0) != 0) {
+		mpfr_reldiff(cancelTemp, res->demoted[k], res->oriValue, STD_RND);
+		Double diff = mpfr_get_d(cancelTemp, STD_RND);
+		if (diff < 0) diff = -diff;
+		if (diff > dc->maxDiff[f]) {
+			dc->maxDiff[f] = diff;
+			dc->maxSite[f] = addr;
+		}
+	}
+}
+
+/* Computes the demoted values (--demote) of a result from the demoted values 
+   of its arguments: one simulation of the original program for each 
+   candidate and format, in which only the operations of the candidate are 
+   computed in the format. The arguments x1, x2 and x3 are the values of 
+   the original precision. */
+static void computeDemoted(Addr addr, IROp op, ShadowValue* res, 
+		ShadowValue* sv1, mpfr_t* x1, ShadowValue* sv2, mpfr_t* x2, ShadowValue* sv3, mpfr_t* x3) {
+	if (demoteCount == 0 || res->demoted == NULL) {
+		return;
+	}
+
+	LadderKind kind = ladderKind(op);
+	Int candidate = demoteCandidate(addr);
+	if (candidate >= 0) {
+		demoteCandidates[candidate].executions++;
+	}
+	mpfr_prec_t prec = mpfr_get_prec(res->oriValue);
+	Int k;
+	for (k = 0; k < demoteCount; k++) {
+		mpfr_t* a = demotedArg(sv1, x1, k);
+		mpfr_t* b = x2 ? demotedArg(sv2, x2, k) : NULL;
+		mpfr_t* c = x3 ? demotedArg(sv3, x3, k) : NULL;
+		mpfr_set_prec(res->demoted[k], prec);
+		if (kind == Lk_NONE) {
+			mpfr_set(res->demoted[k], res->oriValue, STD_RND);
+			continue;
+		}
+
+		int t;
+		if (k / demoteFormatCount == candidate) {
+			/* the arguments and the result are rounded to the format */
+			DemoteFormat* fmt = demoteFormats[k % demoteFormatCount];
+			mpfr_set_emin(fmt->emin);
+			mpfr_set_emax(fmt->emax);
+			mpfr_set_prec(demoteTemp, fmt->prec);
+			mpfr_set_prec(demoteArgs[0], fmt->prec);
+			t = mpfr_set(demoteArgs[0], *a, STD_RND);
+			mpfr_subnormalize(demoteArgs[0], t, STD_RND);
+			if (b) {
+				mpfr_set_prec(demoteArgs[1], fmt->prec);
+				t = mpfr_set(demoteArgs[1], *b, STD_RND);
+				mpfr_subnormalize(demoteArgs[1], t, STD_RND);
+			}
+			if (c) {
+				mpfr_set_prec(demoteArgs[2], fmt->prec);
+				t = mpfr_set(demoteArgs[2], *c, STD_RND);
+				mpfr_subnormalize(demoteArgs[2], t, STD_RND);
+			}
+			t = applyLadderKind(kind, demoteTemp, &(demoteArgs[0]), b ? &(demoteArgs[1]) : NULL, c ? &(demoteArgs[2]) : NULL);
+			mpfr_subnormalize(demoteTemp, t, STD_RND);
+			endEmulate();
+			mpfr_set(res->demoted[k], demoteTemp, STD_RND);
+		} else {
+			beginEmulateDouble();
+			t = applyLadderKind(kind, res->demoted[k], a, b, c);
+			mpfr_subnormalize(res->demoted[k], t, STD_RND);
+			endEmulate();
+		}
+		updateDemoteCandidate(k, addr, res);
+	}
+}
+
+/* The value of an argument in lane c of --pso-lanes. Arguments computed 
+   before the lane was added use the last lane they have. */
+static __inline__
+mpfr_t* psoLaneArg(ShadowValue* sv, mpfr_t* x, UInt c) {
+	if (sv != NULL && sv->pso != NULL && sv->psoValid > 0) {
+		return &(sv->pso[c < sv->psoValid ? c : sv->psoValid - 1]);
+	}
+	return x;
+}
+
+static Bool isPSOFixedInLane(Addr addr, UInt c) {
+	UInt i;
+	for (i = 0; i <= c; i++) {
+		if (psoCandidates[i] == addr) {
+			return True;
+		}
+	}
+	return VG_(HT_lookup)(detectedPSO, addr) != NULL;
+}
+
+/* relative error of the value v of sv in a lane, zero without shadow value */
+static void psoLaneError(mpfr_t rel, mpfr_t* v, ShadowValue* sv) {
+	if (sv == NULL || sv->orgType == Ot_INVALID) {
+		mpfr_set_ui(rel, 0, STD_RND);
+		return;
+	}
+	mpfr_t org;
+	mpfr_init(org);
+	if (sv->orgType == Ot_FLOAT) {
+		mpfr_set_flt(org, sv->Org.fl, STD_RND);
+	} else {
+		mpfr_set_d(org, sv->Org.db, STD_RND);
+	}
+	if (mpfr_cmp_ui(*v, 0) != 0 || mpfr_cmp_ui(org, 0) != 0) {
+		mpfr_reldiff(rel, *v, org, STD_RND);
+		mpfr_abs(rel, rel, STD_RND);
+	} else {
+		mpfr_set_ui(rel, 0, STD_RND);
+	}
+	mpfr_clear(org);
+}
+
+/* Computes the lanes of --pso-lanes of a result and the error inflation of 
+   each lane. Lane c computes the candidates 0 to c and the detected operations 
+   in the original precision like needFix does and everything else in the 
+   precision of the shadow value. The first operation found in the last lane 
+   becomes the candidate of a new lane. Must be called after Org of the result 
+   is set, unary operations are not analyzed like in analyzePSO. */
+static void computePSOLanes(Addr addr, IROp op, ShadowValue* res, Bool analyze, 
+		ShadowValue* sv1, mpfr_t* x1, ShadowValue* sv2, mpfr_t* x2, ShadowValue* sv3, mpfr_t* x3) {
+	if (psoLaneCount == 0 || res->pso == NULL) {
+		return;
+	}
+
+	LadderKind kind = ladderKind(op);
+	mpfr_prec_t fixPrec = mpfr_get_prec(res->midValue);
+	mpfr_t irel, rel;
+	mpfr_inits(irel, rel, NULL);
+	UInt c;
+	/* psoLaneCount grows while a lane finds its first operation */
+	for (c = 0; c < psoLaneCount; c++) {
+		mpfr_t* a = psoLaneArg(sv1, x1, c);
+		mpfr_t* b = x2 ? psoLaneArg(sv2, x2, c) : NULL;
+		mpfr_t* d = x3 ? psoLaneArg(sv3, x3, c) : NULL;
+		Bool fixed = isPSOFixedInLane(addr, c);
+		mpfr_set_prec(res->pso[c], mpfr_get_prec(res->value));
+		if (kind == Lk_NONE) {
+			mpfr_set(res->pso[c], res->value, STD_RND);
+		} else if (fixed) {
+			mpfr_set_prec(psoArgs[0], fixPrec);
+			mpfr_set(psoArgs[0], *a, STD_RND);
+			if (b) {
+				mpfr_set_prec(psoArgs[1], fixPrec);
+				mpfr_set(psoArgs[1], *b, STD_RND);
+			}
+			if (d) {
+				mpfr_set_prec(psoArgs[2], fixPrec);
+				mpfr_set(psoArgs[2], *d, STD_RND);
+			}
+			mpfr_set_prec(psoTemp, fixPrec);
+			applyLadderKind(kind, psoTemp, &(psoArgs[0]), b ? &(psoArgs[1]) : NULL, d ? &(psoArgs[2]) : NULL);
+			mpfr_set(res->pso[c], psoTemp, STD_RND);
+		} else {
+			applyLadderKind(kind, res->pso[c], a, b, d);
+		}
+		res->psoValid = c + 1;
+
+		if (!analyze || finishPSO || psoLaneFound[c] || fixed || res->orgType == Ot_INVALID) {
+			continue;
+		}
+		psoLaneError(irel, a, sv1);
+		if (b) {
+			psoLaneError(rel, b, sv2);
+			mpfr_max(irel, irel, rel, STD_RND);
+		}
+		if (d) {
+			psoLaneError(rel, d, sv3);
+			mpfr_max(irel, irel, rel, STD_RND);
+		}
+		psoLaneError(rel, &(res->pso[c]), res);
+		if (countPSO(psoLaneErrors[c], irel, rel, res, &(res->pso[c]))) {
+			psoLaneFound[c] = True;
+			if (c == psoLaneCount - 1 && psoLaneCount < clo_pso_lanes) {
+				psoCandidates[psoLaneCount++] = addr;
+			}
+		}
+	}
+	mpfr_clears(irel, rel, NULL);
+}
+
+static void updateConditionNumber(UWord key, IROp op, Int num1, Int num2, Int constArgs, Double r);
+
 static VG_REGPARM(2) void processUnOp(Addr addr, UWord ca) {
 	// Do not analyze unary operation, because they are not precision-specific
 	if (!clo_analyze) return;
 
 	Int constArgs = (Int)ca;
+	selectPrecision(addr);
 	ULong argOpCount = 0;
 	Addr argOrigin = 0;
 	mpfr_exp_t argCanceled = 0;
@@ -1319,14 +2830,24 @@ static VG_REGPARM(2) void processUnOp(Addr addr, UWord ca) {
 
 	res->canceled = argCanceled;
 	res->cancelOrigin = argCancelOrigin;
+	if (ladderCount > 0) {
+		computeLadder(addr, unOpArgs->op, res, (constArgs & 0x1) ? NULL : getTemp(unOpArgs->arg), &arg1tmpX, NULL, NULL, NULL, NULL);
+	}
+	if (demoteCount > 0) {
+		computeDemoted(addr, unOpArgs->op, res, (constArgs & 0x1) ? NULL : getTemp(unOpArgs->arg), &arg1oriX, NULL, NULL, NULL, NULL);
+	}
 
-	if (clo_computeMeanValue) {
+	if (clo_computeMeanValue && !(constArgs & SATURATED_SITE)) {
 		if (isOpFloat(unOpArgs->op)) {
 			mpfr_set_flt(meanOrg, unOpArgs->orgFloat, STD_RND);
 		} else {
 			mpfr_set_d(meanOrg, unOpArgs->orgDouble, STD_RND);
 		}
 		updateMeanValue(addr, unOpArgs->op, &(res->value), 0, argOrigin, 0, 0);
+		if (clo_condition && (op == Iop_Sqrt32F0x4 || op == Iop_Sqrt64F0x2)) {
+			updateConditionNumber(addr, op, -1, 0, constArgs, 
+				isOpFloat(op) ? unOpArgs->orgFloat : unOpArgs->orgDouble);
+		}
 	}
 
 	if (isOpFloat(unOpArgs->op)) {
@@ -1336,21 +2857,76 @@ static VG_REGPARM(2) void processUnOp(Addr addr, UWord ca) {
 		res->Org.db = unOpArgs->orgDouble;
 		res->orgType = Ot_DOUBLE;
 	}
+	if (!(constArgs & 0x1) && (op == Iop_Sqrt32F0x4 || op == Iop_Sqrt64F0x2)) {
+		copyUpperLanes(unOpArgs->wrTmp, unOpArgs->arg);
+	}
 	// if (clo_detect_pso && !finishPSO) {
 	// 	analyzePSO(irel, res);
 	// }
 	// mpfr_clear(irel);
+	if (psoLaneCount > 0) {
+		computePSOLanes(addr, unOpArgs->op, res, False, (constArgs & 0x1) ? NULL : getTemp(unOpArgs->arg), &arg1tmpX, NULL, NULL, NULL, NULL);
+	}
 	if (clo_print_every_error) {
 		printErrorShort(res);
 	}
 }
 
+/* The suspects are read before the objects are loaded, so they are 
+   resolved when the operations are translated. */
+static Bool isSuspectSite(Addr addr) {
+	if (suspectSites == NULL || VG_(OSetWord_Contains)(suspectSites, addr)) {
+		return True;
+	}
+	PSODbEntry* e = findPSODbEntry(suspectDb, suspectDbHasKeys, addr);
+	if (e == NULL) {
+		return False;
+	}
+	e->resolved++;
+	VG_(OSetWord_Insert)(suspectSites, addr);
+	return True;
+}
+
+/* The executions of an operation are counted inline (mv->count += lanes) 
+   if its helper does not count them: with --sample-rate the helper is not 
+   called in every execution, and an operation which has been analyzed 
+   clo_site_budget times without a new maximum error or cancellation is 
+   not analyzed anymore (saturated). The helper of a saturated operation 
+   still computes the shadow value of the result, so the error keeps 
+   flowing to the operations depending on it, but does not update its mean 
+   value. Returns SATURATED_SITE for constArgs or 0. */
+static Int instrumentSiteCount(IRSB* sb, Addr addr, IROp op, UInt lanes) {
+	if (!clo_computeMeanValue) {
+		return 0;
+	}
+	MeanValue* mv;
+	if (clo_sample_rate > 1) {
+		mv = getMeanValue(addr, op);
+	} else {
+		mv = clo_site_budget > 0 ? VG_(HT_lookup)(meanValues, addr) : NULL;
+		if (mv == NULL || !mv->saturated) {
+			return 0;
+		}
+	}
+
+	IRTemp t1 = newIRTemp(sb->tyenv, Ity_I32);
+	addStmtToIRSB(sb, IRStmt_WrTmp(t1, IRExpr_Load(Iend_LE, Ity_I32, mkU64(&(mv->count)))));
+	IRTemp t2 = newIRTemp(sb->tyenv, Ity_I32);
+	addStmtToIRSB(sb, IRStmt_WrTmp(t2, IRExpr_Binop(Iop_Add32, IRExpr_RdTmp(t1), mkU32(lanes))));
+	addStmtToIRSB(sb, IRStmt_Store(Iend_LE, mkU64(&(mv->count)), IRExpr_RdTmp(t2)));
+	return mv->saturated ? SATURATED_SITE : 0;
+}
+
 static void instrumentUnOp(IRSB* sb, IRTypeEnv* env, Addr addr, IRTemp wrTemp, IRExpr* unop, Int argTmpInstead) {
 	tl_assert(unop->tag == Iex_Unop);
 
 	if (clo_ignoreLibraries && isInLibrary(addr)) {
 		return;
 	}
+	if (!isSuspectSite(addr)) {
+		return;
+	}
+	Int saturated = instrumentSiteCount(sb, addr, unop->Iex.Unop.op, 1);
 
 	IRExpr* arg = unop->Iex.Unop.arg;
 	tl_assert(arg->tag == Iex_RdTmp || arg->tag == Iex_Const);
@@ -1361,7 +2937,7 @@ static void instrumentUnOp(IRSB* sb, IRTypeEnv* env, Addr addr, IRTemp wrTemp, I
 	store = IRStmt_Store(Iend_LE, mkU64(&(unOpArgs->wrTmp)), mkU32(wrTemp));
 	addStmtToIRSB(sb, store);
 
-	Int constArgs = 0;
+	Int constArgs = saturated;
 	
 	if (arg->tag == Iex_RdTmp) {
 		if (argTmpInstead >= 0) {
@@ -1388,439 +2964,1081 @@ static void instrumentUnOp(IRSB* sb, IRTypeEnv* env, Addr addr, IRTemp wrTemp, I
 
 	IRExpr** argv = mkIRExprVec_2(mkU64(addr), mkU64(constArgs));
 	IRDirty* di = unsafeIRDirty_0_N(2, "processUnOp", VG_(fnptr_to_fnentry)(&processUnOp), argv);
-	addStmtToIRSB(sb, IRStmt_Dirty(di));
+	addHelperToIRSB(sb, di);
 }
 
-static VG_REGPARM(2) void processBinOp(Addr addr, UWord ca) {
-	if (!clo_analyze) return;
+/* Double-double arithmetic of --hybrid-shadows (Dekker, Knuth). Results 
+   are exact up to a relative error of about DD_EPS. */
+static __inline__
+void ddTwoSum(Double a, Double b, Double* s, Double* e) {
+	Double bb;
+	*s = a + b;
+	bb = *s - a;
+	*e = (a - (*s - bb)) + (b - bb);
+}
 
-	Int constArgs = (Int)ca;
-	Bool needFix = clo_detect_pso && VG_(HT_lookup)(detectedPSO, addr) != NULL;
+static __inline__
+void ddSplit(Double a, Double* hi, Double* lo) {
+	Double c = 134217729.0 * a;
+	*hi = c - (c - a);
+	*lo = a - *hi;
+}
 
-	if (clo_simulateOriginal) {
-		if (isOpFloat(binOpArgs->op)) {
-			mpfr_set_prec(arg1tmpX, 24);
-			mpfr_set_prec(arg2tmpX, 24);
-		} else {
-			mpfr_set_prec(arg1tmpX, 53);
-			mpfr_set_prec(arg2tmpX, 53);
-		}
-	}
+static __inline__
+void ddTwoProd(Double a, Double b, Double* p, Double* e) {
+	Double ah, al, bh, bl;
+	*p = a * b;
+	ddSplit(a, &ah, &al);
+	ddSplit(b, &bh, &bl);
+	*e = ((ah * bh - *p) + ah * bl + al * bh) + al * bl;
+}
 
-	if (isOpFloat(binOpArgs->op)) {
-		mpfr_set_prec(arg1midX, 24);
-		mpfr_set_prec(arg2midX, 24);
-		mpfr_set_prec(arg1oriX, 24);
-		mpfr_set_prec(arg2oriX, 24);
-	} else {
-		mpfr_set_prec(arg1midX, 53);
-		mpfr_set_prec(arg2midX, 53);
-		mpfr_set_prec(arg1oriX, 53);
-		mpfr_set_prec(arg2oriX, 53);
-	}
+static __inline__
+void ddAdd(Double ah, Double al, Double bh, Double bl, Double* rh, Double* rl) {
+	Double s, e, t, f;
+	ddTwoSum(ah, bh, &s, &e);
+	ddTwoSum(al, bl, &t, &f);
+	e += t;
+	ddTwoSum(s, e, &s, &e);
+	e += f;
+	ddTwoSum(s, e, rh, rl);
+}
 
-	ULong arg1opCount = 0;
-	ULong arg2opCount = 0;
-	Addr arg1origin = 0;
-	Addr arg2origin = 0;
-	mpfr_exp_t arg1canceled = 0;
-	mpfr_exp_t arg2canceled = 0;
-	mpfr_exp_t canceled = 0;
-	Addr arg1CancelOrigin = 0;
-	Addr arg2CancelOrigin = 0;
-	mpfr_t irel1, irel2;
-	mpfr_inits(irel1, irel2, NULL);
+static __inline__
+void ddMul(Double ah, Double al, Double bh, Double bl, Double* rh, Double* rl) {
+	Double p, e;
+	ddTwoProd(ah, bh, &p, &e);
+	e += ah * bl + al * bh;
+	ddTwoSum(p, e, rh, rl);
+}
 
-	Int exactBitsArg1, exactBitsArg2;
-	if (isOpFloat(binOpArgs->op)) {
-		exactBitsArg1 = 23;
-		exactBitsArg2 = 23;
-	} else {
-		exactBitsArg1 = 52;
-		exactBitsArg2 = 52;
-	}
+static __inline__
+void ddDiv(Double ah, Double al, Double bh, Double bl, Double* rh, Double* rl) {
+	Double q1, q2, ph, pl, sh, sl;
+	q1 = ah / bh;
+	ddMul(q1, 0.0, bh, bl, &ph, &pl);
+	ddAdd(ah, al, -ph, -pl, &sh, &sl);
+	q2 = sh / bh;
+	ddTwoSum(q1, q2, rh, rl);
+}
 
-	if (constArgs & 0x1) {
-		readSConst(0, &(arg1tmpX));
-		mpfr_set(arg1midX, arg1tmpX, STD_RND);
-		beginEmulateDouble();
-		int t = mpfr_set(arg1oriX, arg1tmpX, STD_RND);
-		mpfr_subnormalize(arg1oriX, t, STD_RND);
-		endEmulate();
-	} else {
-		ShadowValue* arg1tmp = getTemp(binOpArgs->arg1);
-		checkAndRecover(arg1tmp);
-		computeRelativeError(arg1tmp, irel1);
-		// if (needFix) printErrorShort(arg1tmp);
-		if (arg1tmp) {
-			// VG_(umsg)("have shadow 1\n");
-			mpfr_set(arg1tmpX, arg1tmp->value, STD_RND);
-			mpfr_set(arg1midX, arg1tmp->midValue, STD_RND);
-			beginEmulateDouble();
-			int t = mpfr_set(arg1oriX, arg1tmp->oriValue, STD_RND);
-			mpfr_subnormalize(arg1oriX, t, STD_RND);
-			endEmulate();
-			arg1opCount = arg1tmp->opCount;
-			arg1origin = arg1tmp->origin;
-			arg1canceled = arg1tmp->canceled;
-			arg1CancelOrigin = arg1tmp->cancelOrigin;
+static __inline__
+UInt ddBiasedExp(Double d) {
+	union { Double d; ULong u; } v;
+	v.d = d;
+	return (UInt)((v.u >> 52) & 0x7FF);
+}
 
-			if (clo_bad_cancellations) {
-				readSTemp(0, &cancelTemp);
-				if (mpfr_get_exp(cancelTemp) == mpfr_get_exp(arg1tmpX)) {
-					mpfr_sub(cancelTemp, arg1tmpX, cancelTemp, STD_RND);
-					if (mpfr_cmp_ui(cancelTemp, 0) != 0) {
-						exactBitsArg1 = abs(mpfr_get_exp(arg1tmpX) - mpfr_get_exp(cancelTemp)) - 2;
-						if (arg1tmp->orgType == Ot_FLOAT && exactBitsArg1 > 23) {
-							exactBitsArg1 = 23;
-						} else if (arg1tmp->orgType == Ot_DOUBLE && exactBitsArg1 > 52) {
-							exactBitsArg1 = 52;
-						}
-					}
-				} else {
-					exactBitsArg1 = 0;
-				}
-			}
-		} else {
-			readSTemp(0, &(arg1tmpX));
-			mpfr_set(arg1midX, arg1tmpX, STD_RND);
-			beginEmulateDouble();
-			int t = mpfr_set(arg1oriX, arg1tmpX, STD_RND);
-			mpfr_subnormalize(arg1oriX, t, STD_RND);
-			endEmulate();
-		}
+static __inline__
+Double ddAbs(Double d) {
+	return d < 0 ? -d : d;
+}
+
+/* Normal numbers far enough from overflow and underflow that neither the 
+   splitting nor the low part of a result leave the double range. */
+static __inline__
+Bool ddInRange(Double d) {
+	UInt e = ddBiasedExp(d);
+	return d == 0 || (e > 0x100 && e < 0x700);
+}
+
+/* midValue is computed with 53 bits and an unbounded exponent, the host 
+   gives the same result as long as it is neither subnormal nor infinite */
+static __inline__
+Bool ddIsNormal(Double d) {
+	UInt e = ddBiasedExp(d);
+	return d == 0 || (e > 0 && e < 0x7FF);
+}
+
+/* exponent of hi + lo as returned by mpfr_get_exp */
+static __inline__
+mpfr_exp_t ddGetExp(Double hi, Double lo) {
+	union { Double d; ULong u; } v;
+	v.d = hi;
+	mpfr_exp_t e = (mpfr_exp_t)ddBiasedExp(hi) - 1022;
+	if ((v.u & 0xFFFFFFFFFFFFFULL) == 0 && lo != 0 && (lo < 0) != (hi < 0)) {
+		e--;
 	}
+	return e;
+}
 
-	if (constArgs & 0x2) {
-		readSConst(1, &(arg2tmpX));
-		mpfr_set(arg2midX, arg2tmpX, STD_RND);
-		beginEmulateDouble();
-		int t = mpfr_set(arg2oriX, arg2tmpX, STD_RND);
-		mpfr_subnormalize(arg2oriX, t, STD_RND);
-		endEmulate();
-	} else {
-		ShadowValue* arg2tmp = getTemp(binOpArgs->arg2);
-		checkAndRecover(arg2tmp);
-		// VG_(umsg)("get %X\n", binOpArgs->arg2);
-		computeRelativeError(arg2tmp, irel2);
-		if (arg2tmp) {
-			// if (needFix) printErrorShort(arg2tmp);
-			// VG_(umsg)("have shadow 2\n");
-			mpfr_set(arg2tmpX, arg2tmp->value, STD_RND);
-			mpfr_set(arg2midX, arg2tmp->midValue, STD_RND);
-			beginEmulateDouble();
-			int t = mpfr_set(arg2oriX, arg2tmp->oriValue, STD_RND);
-			mpfr_subnormalize(arg2oriX, t, STD_RND);
-			endEmulate();
-			arg2opCount = arg2tmp->opCount;
-			arg2origin = arg2tmp->origin;
-			arg2canceled = arg2tmp->canceled;
-			arg2CancelOrigin = arg2tmp->cancelOrigin;
+/* same as getCanceledBits */
+static __inline__
+mpfr_exp_t ddCanceledBits(Double rh, Double rl, Double h1, Double l1, Double h2, Double l2) {
+	if (rh == 0 || h1 == 0 || h2 == 0) {
+		return 0;
+	}
+	mpfr_exp_t resExp = ddGetExp(rh, rl);
+	mpfr_exp_t max = maxExp(ddGetExp(h1, l1), ddGetExp(h2, l2));
+	if (resExp < max) {
+		return max - resExp;
+	}
+	return 0;
+}
 
-			if (clo_bad_cancellations) {
-				readSTemp(1, &cancelTemp);
-				if (mpfr_get_exp(cancelTemp) == mpfr_get_exp(arg2tmpX)) {
-					mpfr_sub(cancelTemp, arg2tmpX, cancelTemp, STD_RND);
-					if (mpfr_cmp_ui(cancelTemp, 0) != 0) {
-						exactBitsArg2 = abs(mpfr_get_exp(arg2tmpX) - mpfr_get_exp(cancelTemp)) - 2;
-						if (arg2tmp->orgType == Ot_FLOAT && exactBitsArg2 > 23) {
-							exactBitsArg2 = 23;
-						} else if (arg2tmp->orgType == Ot_DOUBLE && exactBitsArg2 > 52) {
-							exactBitsArg2 = 52;
-						}
-					}
-				} else {
-					exactBitsArg2 = 0;
-				}
-			}
-		} else {
-			readSTemp(1, &(arg2tmpX));
-			mpfr_set(arg2midX, arg2tmpX, STD_RND);
-			beginEmulateDouble();
-			int t = mpfr_set(arg2oriX, arg2tmpX, STD_RND);
-			mpfr_subnormalize(arg2oriX, t, STD_RND);
-			endEmulate();
-		}
+/* same as the exact bits of an argument in processBinOp */
+static __inline__
+Int ddExactBits(Double org, Double hi, Double lo) {
+	if (org == 0 || hi == 0) {
+		return (org == 0 && hi == 0) ? 52 : 0;
+	}
+	if (ddGetExp(org, 0.0) != ddGetExp(hi, lo)) {
+		return 0;
+	}
+	Double diff = (hi - org) + lo;
+	if (diff == 0) {
+		return 52;
 	}
+	Int exactBits = abs(ddGetExp(hi, lo) - ddGetExp(diff, 0.0)) - 2;
+	return exactBits > 52 ? 52 : exactBits;
+}
 
-	ShadowValue* res = setTemp(binOpArgs->wrTmp);
-	// VG_(umsg)("processBinOp %X\n", binOpArgs->wrTmp);
-	if (clo_simulateOriginal) {
-		if (isOpFloat(binOpArgs->op)) {
-			mpfr_set_prec(res->value, 24);
-		} else {
-			mpfr_set_prec(res->value, 53);
-		}
+/* same as checkAndRecover */
+static __inline__
+void ddCheckAndRecover(ShadowValue* svalue) {
+	if (svalue->Org.db != svalue->ddOri) {
+		VG_(umsg)("There may exists untracked operations! Recovering...\n");
+		svalue->ddHi = svalue->Org.db;
+		svalue->ddLo = 0.0;
+		svalue->ddMid = svalue->Org.db;
+		svalue->ddOri = svalue->Org.db;
+		svalue->ddErr = 0.0;
 	}
+}
 
-	if (isOpFloat(binOpArgs->op)) {
-		mpfr_set_prec(res->midValue, 24);
-		mpfr_set_prec(res->oriValue, 24);
-	} else {
-		mpfr_set_prec(res->midValue, 53);
-		mpfr_set_prec(res->oriValue, 53);
+/* Reads an argument of a double-double operation. Returns False if the 
+   operation has to be computed with MPFR. */
+static Bool readDDArg(Int num, Bool isConst, IRTemp tmp, Double* org, ShadowValue** sv) {
+	*sv = NULL;
+	if (isConst) {
+		if (sConst[num]->tag != Ico_F64) {
+			return False;
+		}
+		*org = sConst[num]->Val.F64;
+		return ddInRange(*org);
 	}
 
-	res->opCount = 1;
-	if (arg1opCount > arg2opCount) {
-		res->opCount += arg1opCount;
+	if (sTmp[num]->type == Ity_F64) {
+		*org = sTmp[num]->Val.F64;
+	} else if (sTmp[num]->type == Ity_V128) {
+		*org = *(Double*)(sTmp[num]->U128);
 	} else {
-		res->opCount += arg2opCount;
+		return False;
 	}
-	res->origin = addr;
-
-	fpOps++;
+	*sv = peekTemp(tmp);
+	if (*sv && !(*sv)->dd) {
+		return False;
+	}
+	if (*sv && (*sv)->orgType != Ot_DOUBLE) {
+		return False;
+	}
+	return ddInRange(*org);
+}
 
-	if (needFix) {
-		// VG_(umsg)("Need fix!\n");
-		mpfr_set(arg1midX, arg1tmpX, STD_RND);
-		mpfr_set(arg2midX, arg2tmpX, STD_RND);
-		// Char mpfrBuf[MPFR_BUFSIZE];
-		// mpfrToString(mpfrBuf, &arg1midX);
-		// VG_(umsg)("Mid1 %s\n", mpfrBuf);
-		// mpfrToString(mpfrBuf, &arg2midX);
-		// VG_(umsg)("Mid2 %s\n", mpfrBuf);
+/* Native operand in slot num (see writeSTemp and writeSConst), lane 0 of 
+   vectors as float or double. */
+static __inline__
+Bool readNativeOperand(Int num, Bool isConst, Bool isFloat, Double* d) {
+	if (isConst) {
+		if (sConst[num]->tag != Ico_F64) {
+			return False;
+		}
+		*d = sConst[num]->Val.F64;
+		return True;
+	}
+	switch (sTmp[num]->type) {
+		case Ity_F32:
+			*d = sTmp[num]->Val.F32;
+			return True;
+		case Ity_F64:
+			*d = sTmp[num]->Val.F64;
+			return True;
+		case Ity_V128:
+			if (isFloat) {
+				*d = ((Float*)(sTmp[num]->U128))[0];
+			} else {
+				*d = ((Double*)(sTmp[num]->U128))[0];
+			}
+			return True;
+		default:
+			return False;
 	}
+}
 
-	int tv;
-	switch (binOpArgs->op) {
+/* First-order relative condition number of r = a op b, the sum of 
+   |x * df/dx| / |f| over the operands: relative errors of the operands 
+   are amplified by at most this factor. b is the operand of square roots. 
+   Returns -1 for operations it is not defined for and -2 for additions and 
+   subtractions which cancel to zero (infinite condition number). */
+static Double conditionNumber(IROp op, Double a, Double b, Double r) {
+	Double cond;
+	switch (op) {
+		case Iop_Add32Fx4:
+		case Iop_Add64Fx2:
 		case Iop_Add32F0x4:
 		case Iop_Add64F0x2:
-			mpfr_add(res->value, arg1tmpX, arg2tmpX, STD_RND);
-			mpfr_add(res->midValue, arg1midX, arg2midX, STD_RND);
-			beginEmulateDouble();
-			tv = mpfr_add(res->oriValue, arg1oriX, arg2oriX, STD_RND);
-			mpfr_subnormalize(res->oriValue, tv, STD_RND);
-			endEmulate();
-			canceled = getCanceledBits(&(res->value), &(arg1tmpX), &(arg2tmpX));
-			break;
+		case Iop_AddF32:
+		case Iop_AddF64:
+		case Iop_AddF64r32:
+		case Iop_Sub32Fx4:
+		case Iop_Sub64Fx2:
 		case Iop_Sub32F0x4:
 		case Iop_Sub64F0x2:
-			mpfr_sub(res->value, arg1tmpX, arg2tmpX, STD_RND);
-			mpfr_sub(res->midValue, arg1midX, arg2midX, STD_RND);
-			beginEmulateDouble();
-			tv = mpfr_sub(res->oriValue, arg1oriX, arg2oriX, STD_RND);
-			mpfr_subnormalize(res->oriValue, tv, STD_RND);
-			endEmulate();
-			canceled = getCanceledBits(&(res->value), &(arg1tmpX), &(arg2tmpX));
-			break;
+		case Iop_SubF32:
+		case Iop_SubF64:
+		case Iop_SubF64r32:
+			if (r == 0) {
+				/* infinite unless both operands are zero */
+				return (a == 0 && b == 0) ? 1.0 : -2.0;
+			}
+			cond = (ddAbs(a) + ddAbs(b)) / ddAbs(r);
+			/* overflows if r is subnormal */
+			return ddBiasedExp(cond) == 0x7FF ? -2.0 : cond;
+		case Iop_Mul32Fx4:
+		case Iop_Mul64Fx2:
 		case Iop_Mul32F0x4:
 		case Iop_Mul64F0x2:
-			mpfr_mul(res->value, arg1tmpX, arg2tmpX, STD_RND);
-			mpfr_mul(res->midValue, arg1midX, arg2midX, STD_RND);
-			beginEmulateDouble();
-			tv = mpfr_mul(res->oriValue, arg1oriX, arg2oriX, STD_RND);
-			mpfr_subnormalize(res->oriValue, tv, STD_RND);
-			endEmulate();
-			break;
+		case Iop_MulF32:
+		case Iop_MulF64:
+		case Iop_MulF64r32:
+		case Iop_Div32Fx4:
+		case Iop_Div64Fx2:
 		case Iop_Div32F0x4:
 		case Iop_Div64F0x2:
-			mpfr_div(res->value, arg1tmpX, arg2tmpX, STD_RND);
-			mpfr_div(res->midValue, arg1midX, arg2midX, STD_RND);
-			beginEmulateDouble();
-			tv = mpfr_div(res->oriValue, arg1oriX, arg2oriX, STD_RND);
-			mpfr_subnormalize(res->oriValue, tv, STD_RND);
-			endEmulate();
-			break;
-		case Iop_Min32F0x4:
-		case Iop_Min64F0x2:
-			mpfr_min(res->value, arg1tmpX, arg2tmpX, STD_RND);
-			mpfr_min(res->midValue, arg1midX, arg2midX, STD_RND);
-			beginEmulateDouble();
-			tv = mpfr_min(res->oriValue, arg1oriX, arg2oriX, STD_RND);
-			mpfr_subnormalize(res->oriValue, tv, STD_RND);
-			endEmulate();
-			break;
-		case Iop_Max32F0x4:
-		case Iop_Max64F0x2:
-			mpfr_max(res->value, arg1tmpX, arg2tmpX, STD_RND);
-			mpfr_max(res->midValue, arg1midX, arg2midX, STD_RND);
-			beginEmulateDouble();
-			tv = mpfr_max(res->oriValue, arg1oriX, arg2oriX, STD_RND);
-			mpfr_subnormalize(res->oriValue, tv, STD_RND);
-			endEmulate();
-			break;
+		case Iop_DivF32:
+		case Iop_DivF64:
+		case Iop_DivF64r32:
+			return 2.0;
+		case Iop_Sqrt32Fx4:
+		case Iop_Sqrt64Fx2:
+		case Iop_Sqrt32F0x4:
+		case Iop_Sqrt64F0x2:
+		case Iop_SqrtF32:
+		case Iop_SqrtF64:
+			return 0.5;
 		default:
-			VG_(tool_panic)("Unhandled case in processBinOp\n");
-			break;
+			return -1.0;
 	}
+}
 
-	mpfr_exp_t maxC = canceled;
-	Addr maxCorigin = addr;
-	if (arg1canceled > maxC) {
-		maxC = arg1canceled;
-		maxCorigin = arg1CancelOrigin;
+/* Condition number of the fused multiply-add r = a * b +- c, the product 
+   contributes twice, once for each factor. */
+static Double fmaConditionNumber(Double a, Double b, Double c, Double r) {
+	Double p = ddAbs(a * b);
+	if (r == 0) {
+		return (p == 0 && c == 0) ? 1.0 : -2.0;
 	}
-	if (arg2canceled > maxC) {
-		maxC = arg2canceled;
-		maxCorigin = arg2CancelOrigin;
+	Double cond = (2 * p + ddAbs(c)) / ddAbs(r);
+	return ddBiasedExp(cond) == 0x7FF ? -2.0 : cond;
+}
+
+static void recordConditionNumber(UWord key, Double cond) {
+	if (cond == -1.0) {
+		return;
 	}
-	res->canceled = maxC;
-	res->cancelOrigin = maxCorigin;
-	
-	if (clo_computeMeanValue) {
-		UInt cancellationBadness = 0;
-		if (clo_bad_cancellations && canceled > 0) {
-			Int exactBits = exactBitsArg1 < exactBitsArg2 ? exactBitsArg1 : exactBitsArg2;
-			if (canceled > exactBits) {
-				cancellationBadness = canceled - exactBits;
-			}
-		}
+	MeanValue* val = VG_(HT_lookup)(meanValues, key);
+	tl_assert(val);
+	if (cond < 0) {
+		val->condInfinite++;
+		return;
+	}
+	val->condCount++;
+	val->condSum += cond;
+	if (cond > val->condMax) {
+		val->condMax = cond;
+	}
+}
 
-		if (isOpFloat(binOpArgs->op)) {
-			mpfr_set_flt(meanOrg, binOpArgs->orgFloat, STD_RND);
-		} else {
-			mpfr_set_d(meanOrg, binOpArgs->orgDouble, STD_RND);
-		}
-		updateMeanValue(addr, binOpArgs->op, &(res->value), canceled, arg1origin, arg2origin, cancellationBadness);
+/* Updates the condition number of the operation at key (--condition-numbers) 
+   from the native operands in the slots num1 and num2. num1 is negative 
+   for unary operations, constArgs has the bit 1 << num set for constants. */
+static void updateConditionNumber(UWord key, IROp op, Int num1, Int num2, Int constArgs, Double r) {
+	Bool isFloat = isOpFloat(op);
+	Double a = 0.0, b = 0.0;
+	if (num1 >= 0 && !readNativeOperand(num1, constArgs & (1 << num1), isFloat, &a)) {
+		return;
+	}
+	if (!readNativeOperand(num2, constArgs & (1 << num2), isFloat, &b)) {
+		return;
+	}
+	/* infinities and NaNs */
+	if (ddBiasedExp(a) == 0x7FF || ddBiasedExp(b) == 0x7FF || ddBiasedExp(r) == 0x7FF) {
+		return;
 	}
+	recordConditionNumber(key, conditionNumber(op, a, b, r));
+}
 
-	if (isOpFloat(binOpArgs->op)) {
-		res->Org.fl = binOpArgs->orgFloat;
-		res->orgType = Ot_FLOAT;
+/* Lane of a packed operation, all lanes are accumulated under key. The 
+   native operands are in the slots 0 and 1, the result in slot 3. */
+static void updatePackedConditionNumber(UWord key, IROp op, Int lane, Bool isUnary) {
+	Double a, b, r;
+	if (isOpFloat(op)) {
+		a = ((Float*)(sTmp[0]->U128))[lane];
+		b = isUnary ? 0.0 : ((Float*)(sTmp[1]->U128))[lane];
+		r = ((Float*)(sTmp[3]->U128))[lane];
 	} else {
-		res->Org.db = binOpArgs->orgDouble;
-		res->orgType = Ot_DOUBLE;
+		a = ((Double*)(sTmp[0]->U128))[lane];
+		b = isUnary ? 0.0 : ((Double*)(sTmp[1]->U128))[lane];
+		r = ((Double*)(sTmp[3]->U128))[lane];
 	}
-	if (needFix) {
-		mpfr_set(res->value, res->midValue, STD_RND);
-		// printErrorShort(res);
+	if (ddBiasedExp(a) == 0x7FF || ddBiasedExp(b) == 0x7FF || ddBiasedExp(r) == 0x7FF) {
+		return;
 	}
-	if (clo_detect_pso && !finishPSO) {
-		mpfr_max(irel1, irel1, irel2, STD_RND);
-		analyzePSO(irel1, res);
+	/* the operand of square roots is expected as b */
+	recordConditionNumber(key, isUnary ? conditionNumber(op, 0.0, a, r) : conditionNumber(op, a, b, r));
+}
+
+/* Fused multiply-add with the native operands in the slots 1 to 3. */
+static void updateFmaConditionNumber(UWord key, Int constArgs, Double r) {
+	Double a, b, c;
+	if (!readNativeOperand(1, constArgs & 0x2, False, &a) ||
+		!readNativeOperand(2, constArgs & 0x4, False, &b) ||
+		!readNativeOperand(3, constArgs & 0x8, False, &c)) 
+	{
+		return;
 	}
-	if (clo_print_every_error) {
-		printErrorShort(res);
+	if (ddBiasedExp(a) == 0x7FF || ddBiasedExp(b) == 0x7FF || 
+		ddBiasedExp(c) == 0x7FF || ddBiasedExp(r) == 0x7FF) 
+	{
+		return;
 	}
+	recordConditionNumber(key, fmaConditionNumber(a, b, c, r));
 }
 
-static void instrumentBinOp(IRSB* sb, IRTypeEnv* env, Addr addr, IRTemp wrTemp, IRExpr* binop, Int arg1tmpInstead, Int arg2tmpInstead) {
-	tl_assert(binop->tag == Iex_Binop);
+/* --reassociation: an addition whose argument is the last result of the 
+   same operation continues an accumulation chain. Next to the sequential 
+   sum, the chain is summed with 2, 4 and 8 interleaved accumulators as a 
+   vectorized loop would do, and in double-double as reference. */
+static __inline__
+Double reductionRound(Bool isFloat, Double d) {
+	return isFloat ? (Double)(Float)d : d;
+}
 
-	if (clo_ignoreLibraries && isInLibrary(addr)) {
+/* horizontal sum of the accumulators, pairwise as with vector registers */
+static Double reductionTotal(Bool isFloat, Double* lanes, Int width) {
+	Double t[REDUCTION_MAX_LANES];
+	Int i, s;
+	for (i = 0; i < width; i++) {
+		t[i] = lanes[i];
+	}
+	for (s = width / 2; s >= 1; s /= 2) {
+		for (i = 0; i < s; i++) {
+			t[i] = reductionRound(isFloat, t[i] + t[i + s]);
+		}
+	}
+	return t[0];
+}
+
+static __inline__
+Double reductionRelDiff(Double x, Double refHi, Double refLo) {
+	if (refHi == 0) {
+		return 0.0;
+	}
+	return ddAbs(((x - refHi) - refLo) / refHi);
+}
+
+static void updateReduction(Addr addr, IROp op, Int num1, Int num2, Int constArgs, Double r) {
+	Bool isSub;
+	switch (op) {
+		case Iop_Add32F0x4:
+		case Iop_Add64F0x2:
+		case Iop_AddF32:
+		case Iop_AddF64:
+		case Iop_AddF64r32:
+			isSub = False;
+			break;
+		case Iop_Sub32F0x4:
+		case Iop_Sub64F0x2:
+		case Iop_SubF32:
+		case Iop_SubF64:
+		case Iop_SubF64r32:
+			isSub = True;
+			break;
+		default:
+			return;
+	}
+
+	Bool isFloat = isOpFloat(op) || op == Iop_AddF64r32 || op == Iop_SubF64r32;
+	Double a, b;
+	if (!readNativeOperand(num1, constArgs & (1 << num1), isOpFloat(op), &a) || 
+		!readNativeOperand(num2, constArgs & (1 << num2), isOpFloat(op), &b)) 
+	{
+		return;
+	}
+	if (ddBiasedExp(a) == 0x7FF || ddBiasedExp(b) == 0x7FF || ddBiasedExp(r) == 0x7FF) {
 		return;
 	}
 
-	IROp op = binop->Iex.Binop.op;
-	IRExpr* arg1 = binop->Iex.Binop.arg1;
-	IRExpr* arg2 = binop->Iex.Binop.arg2;
+	ReductionSite* site = VG_(HT_lookup)(reductionSites, addr);
+	if (site == NULL) {
+		site = VG_(malloc)("fd.updateReduction.1", sizeof(ReductionSite));
+		VG_(memset)(site, 0, sizeof(ReductionSite));
+		site->key = addr;
+		site->op = op;
+		VG_(HT_add_node)(reductionSites, site);
+	}
 
-	tl_assert(arg1->tag == Iex_RdTmp || arg1->tag == Iex_Const);
-	tl_assert(arg2->tag == Iex_RdTmp || arg2->tag == Iex_Const);
+	Double x;
+	Int w, i;
+	if (site->length > 0 && a == site->last) {
+		x = isSub ? -b : b;
+	} else if (site->length > 0 && !isSub && b == site->last) {
+		x = a;
+	} else {
+		/* a new chain starts with a in the first accumulator */
+		site->chains++;
+		site->length = 0;
+		for (w = 0; w < REDUCTION_WIDTHS; w++) {
+			for (i = 0; i < REDUCTION_MAX_LANES; i++) {
+				site->lanes[w][i] = 0.0;
+			}
+			site->lanes[w][0] = a;
+		}
+		site->refHi = a;
+		site->refLo = 0.0;
+		x = isSub ? -b : b;
+	}
 
-	Int constArgs = 0;
+	Double s, e;
+	ddTwoSum(site->refHi, x, &s, &e);
+	e += site->refLo;
+	ddTwoSum(s, e, &(site->refHi), &(site->refLo));
 
-	IRStmt* store = IRStmt_Store(Iend_LE, mkU64(&(binOpArgs->op)), mkU32(op));
-	addStmtToIRSB(sb, store);
-	store = IRStmt_Store(Iend_LE, mkU64(&(binOpArgs->wrTmp)), mkU32(wrTemp));
-	addStmtToIRSB(sb, store);
+	site->last = r;
+	site->length++;
+	site->count++;
+	if (site->length > site->maxLength) {
+		site->maxLength = site->length;
+	}
+	/* a is the element 0 of the chain, x the element length */
+	for (w = 0; w < REDUCTION_WIDTHS; w++) {
+		Int width = 2 << w;
+		Double* lane = &(site->lanes[w][site->length % width]);
+		*lane = reductionRound(isFloat, *lane + x);
+	}
+	if (site->length < 2) {
+		return;
+	}
 
-	if (arg1->tag == Iex_RdTmp) {
-		if (arg1tmpInstead >= 0) {
-			store = IRStmt_Store(Iend_LE, mkU64(&(binOpArgs->arg1)), mkU32(arg1tmpInstead));
-		} else {
-			store = IRStmt_Store(Iend_LE, mkU64(&(binOpArgs->arg1)), mkU32(arg1->Iex.RdTmp.tmp));
+	Double err = reductionRelDiff(r, site->refHi, site->refLo);
+	if (err > site->maxErrSeq) {
+		site->maxErrSeq = err;
+	}
+	for (w = 0; w < REDUCTION_WIDTHS; w++) {
+		Int width = 2 << w;
+		Double total = reductionTotal(isFloat, site->lanes[w], width);
+		if (total != r) {
+			site->diverged[w]++;
+			Double diff = r != 0 ? ddAbs((total - r) / r) : 1.0;
+			if (diff > site->maxDiff[w]) {
+				site->maxDiff[w] = diff;
+			}
 		}
-		addStmtToIRSB(sb, store);
+		err = reductionRelDiff(total, site->refHi, site->refLo);
+		if (err > site->maxErr[w]) {
+			site->maxErr[w] = err;
+		}
+	}
+}
 
-		writeSTemp(sb, env, arg1->Iex.RdTmp.tmp, 0);
-	} else {
-		tl_assert(arg1->tag == Iex_Const);
+/* With --hybrid-shadows, scalar double additions, subtractions, multiplications 
+   and divisions of arguments without shadow values or with double-double 
+   shadow values are computed with double-double. The result stays double-double 
+   as long as its error bound is below DD_MAX_ERROR, otherwise the operation 
+   is computed with MPFR like all other operations. Arguments are promoted to 
+   MPFR when they are read by anything else. Returns False if the operation 
+   has to be computed with MPFR. */
+static Bool processBinOpDD(Addr addr, Int constArgs) {
+	IROp op = binOpArgs->op;
+	if (op != Iop_Add64F0x2 && op != Iop_Sub64F0x2 && op != Iop_Mul64F0x2 && op != Iop_Div64F0x2) {
+		return False;
+	}
+	if (clo_simulateOriginal || clo_detect_pso || clo_print_every_error || 
+		ladderCount > 0 || demoteCount > 0 || clo_adaptive_precision > 0 || currentPrecision != clo_precision) 
+	{
+		return False;
+	}
 
-		writeSConst(sb, arg1->Iex.Const.con, 0);
-		constArgs |= 0x1;
+	Double org1, org2;
+	ShadowValue *arg1tmp, *arg2tmp;
+	if (!readDDArg(0, constArgs & 0x1, binOpArgs->arg1, &org1, &arg1tmp) || 
+		!readDDArg(1, constArgs & 0x2, binOpArgs->arg2, &org2, &arg2tmp)) 
+	{
+		return False;
 	}
-	if (arg2->tag == Iex_RdTmp) {
-		if (arg2tmpInstead >= 0) {
-			store = IRStmt_Store(Iend_LE, mkU64(&(binOpArgs->arg2)), mkU32(arg2tmpInstead));
+
+	Double h1 = org1, l1 = 0.0, m1 = org1, o1 = org1, e1 = 0.0;
+	Double h2 = org2, l2 = 0.0, m2 = org2, o2 = org2, e2 = 0.0;
+	if (arg1tmp) {
+		ddCheckAndRecover(arg1tmp);
+		h1 = arg1tmp->ddHi;
+		l1 = arg1tmp->ddLo;
+		m1 = arg1tmp->ddMid;
+		o1 = arg1tmp->ddOri;
+		e1 = arg1tmp->ddErr;
+	}
+	if (arg2tmp) {
+		ddCheckAndRecover(arg2tmp);
+		h2 = arg2tmp->ddHi;
+		l2 = arg2tmp->ddLo;
+		m2 = arg2tmp->ddMid;
+		o2 = arg2tmp->ddOri;
+		e2 = arg2tmp->ddErr;
+	}
+
+	Double rh, rl, rm, ro, re;
+	mpfr_exp_t canceled = 0;
+	switch (op) {
+		case Iop_Add64F0x2:
+			ddAdd(h1, l1, h2, l2, &rh, &rl);
+			rm = m1 + m2;
+			ro = o1 + o2;
+			break;
+		case Iop_Sub64F0x2:
+			ddAdd(h1, l1, -h2, -l2, &rh, &rl);
+			rm = m1 - m2;
+			ro = o1 - o2;
+			break;
+		case Iop_Mul64F0x2:
+			ddMul(h1, l1, h2, l2, &rh, &rl);
+			rm = m1 * m2;
+			ro = o1 * o2;
+			re = e1 + e2 + 2 * DD_EPS;
+			break;
+		case Iop_Div64F0x2:
+			if (h2 == 0) {
+				return False;
+			}
+			ddDiv(h1, l1, h2, l2, &rh, &rl);
+			rm = m1 / m2;
+			ro = o1 / o2;
+			re = e1 + e2 + 4 * DD_EPS;
+			break;
+		default:
+			tl_assert(False);
+			break;
+	}
+	if (!ddInRange(rh) || !ddIsNormal(rm) || ddBiasedExp(ro) == 0x7FF) {
+		return False;
+	}
+
+	if (op == Iop_Add64F0x2 || op == Iop_Sub64F0x2) {
+		/* errors of the arguments relative to the result */
+		if (rh == 0) {
+			if (e1 != 0 || e2 != 0) {
+				return False;
+			}
+			re = 0.0;
 		} else {
-			store = IRStmt_Store(Iend_LE, mkU64(&(binOpArgs->arg2)), mkU32(arg2->Iex.RdTmp.tmp));
+			re = (ddAbs(h1) * e1 + ddAbs(h2) * e2) / ddAbs(rh) + DD_EPS;
 		}
-		addStmtToIRSB(sb, store);
+		canceled = ddCanceledBits(rh, rl, h1, l1, h2, l2);
+	}
+	if (re > DD_MAX_ERROR) {
+		return False;
+	}
 
-		writeSTemp(sb, env, arg2->Iex.RdTmp.tmp, 1);
-	} else {
-		tl_assert(arg2->tag == Iex_Const);
+	Int exactBitsArg1 = 52;
+	Int exactBitsArg2 = 52;
+	if (clo_bad_cancellations) {
+		if (arg1tmp) exactBitsArg1 = ddExactBits(org1, h1, l1);
+		if (arg2tmp) exactBitsArg2 = ddExactBits(org2, h2, l2);
+	}
 
-		writeSConst(sb, arg2->Iex.Const.con, 1);
-		constArgs |= 0x2;
+	ShadowValue* res = setTemp(binOpArgs->wrTmp);
+	res->dd = True;
+	res->ddHi = rh;
+	res->ddLo = rl;
+	res->ddMid = rm;
+	res->ddOri = ro;
+	res->ddErr = re;
+
+	ULong arg1opCount = arg1tmp ? arg1tmp->opCount : 0;
+	ULong arg2opCount = arg2tmp ? arg2tmp->opCount : 0;
+	Addr arg1origin = arg1tmp ? arg1tmp->origin : 0;
+	Addr arg2origin = arg2tmp ? arg2tmp->origin : 0;
+	res->opCount = 1 + (arg1opCount > arg2opCount ? arg1opCount : arg2opCount);
+	res->origin = addr;
+
+	fpOps++;
+	ddOps++;
+
+	mpfr_exp_t maxC = canceled;
+	Addr maxCorigin = addr;
+	if (arg1tmp && arg1tmp->canceled > maxC) {
+		maxC = arg1tmp->canceled;
+		maxCorigin = arg1tmp->cancelOrigin;
 	}
+	if (arg2tmp && arg2tmp->canceled > maxC) {
+		maxC = arg2tmp->canceled;
+		maxCorigin = arg2tmp->cancelOrigin;
+	}
+	res->canceled = maxC;
+	res->cancelOrigin = maxCorigin;
 
-	if (isOpFloat(op)) {
-		store = IRStmt_Store(Iend_LE, mkU64(&(binOpArgs->orgFloat)), IRExpr_RdTmp(wrTemp));
-		addStmtToIRSB(sb, store);
-	} else {
-		store = IRStmt_Store(Iend_LE, mkU64(&(binOpArgs->orgDouble)), IRExpr_RdTmp(wrTemp));
-		addStmtToIRSB(sb, store);
+	if (clo_computeMeanValue && !(constArgs & SATURATED_SITE)) {
+		UInt cancellationBadness = 0;
+		if (clo_bad_cancellations && canceled > 0) {
+			Int exactBits = exactBitsArg1 < exactBitsArg2 ? exactBitsArg1 : exactBitsArg2;
+			if (canceled > exactBits) {
+				cancellationBadness = canceled - exactBits;
+			}
+		}
+
+		mpfr_set_d(meanOrg, binOpArgs->orgDouble, STD_RND);
+		mpfr_set_d(ddValue, rh, STD_RND);
+		mpfr_add_d(ddValue, ddValue, rl, STD_RND);
+		updateMeanValue(addr, op, &ddValue, canceled, arg1origin, arg2origin, cancellationBadness);
+		if (clo_condition) {
+			updateConditionNumber(addr, op, 0, 1, constArgs, binOpArgs->orgDouble);
+		}
 	}
 
-	IRExpr** argv = mkIRExprVec_2(mkU64(addr), mkU64(constArgs));
-	IRDirty* di = unsafeIRDirty_0_N(2, "processBinOp", VG_(fnptr_to_fnentry)(&processBinOp), argv);
-	addStmtToIRSB(sb, IRStmt_Dirty(di));
+	res->Org.db = binOpArgs->orgDouble;
+	res->orgType = Ot_DOUBLE;
+	if (!(constArgs & 0x1)) {
+		copyUpperLanes(binOpArgs->wrTmp, binOpArgs->arg1);
+	}
+	return True;
 }
 
-static VG_REGPARM(2) void processTriOp(Addr addr, UWord ca) {
-	if (!clo_analyze) return;
+/* Random rounding of --shadow-engine=stochastic (CESTAC): the result of each 
+   operation is rounded up or down with the same probability. The kernels 
+   update STO_VEC_LANES samples at once. */
+static StoBits stoState[MAX_STO_SAMPLES / STO_VEC_LANES];
 
-	Int constArgs = (Int)ca;
-	IROp op = triOpArgs->op;
+static __inline__
+void stoRandom(StoBits* r, Int k) {
+	StoBits s = stoState[k];
+	s ^= s << 13;
+	s ^= s >> 7;
+	s ^= s << 17;
+	stoState[k] = s;
+	*r = s;
+}
 
-	if (clo_simulateOriginal) {
-		if (isOpFloat(op)) {
-			mpfr_set_prec(arg2tmpX, 24);
-			mpfr_set_prec(arg3tmpX, 24);
-		} else {
-			mpfr_set_prec(arg2tmpX, 53);
-			mpfr_set_prec(arg3tmpX, 53);
-		}
-	}
+/* r is the rounded result and e has the sign of the exact result minus r */
+static __inline__
+void stoRound(StoVec* r, StoVec* e, Int k) {
+	StoBits bits = (StoBits)*r;
+	StoBits inexact = (StoBits)(*e != 0.0);
+	/* the next double has a larger magnitude if e has the sign of r */
+	StoBits step = 1 - 2 * ((bits ^ (StoBits)*e) >> 63);
+	StoBits coin;
+	stoRandom(&coin, k);
+	coin = -(coin >> 63);
+	*r = (StoVec)(bits + (step & inexact & coin));
+}
 
-	if (isOpFloat(op)) {
-		mpfr_set_prec(arg2midX, 24);
-		mpfr_set_prec(arg3midX, 24);
-		mpfr_set_prec(arg2oriX, 24);
-		mpfr_set_prec(arg3oriX, 24);
-	} else {
-		mpfr_set_prec(arg2midX, 53);
-		mpfr_set_prec(arg3midX, 53);
-		mpfr_set_prec(arg2oriX, 53);
-		mpfr_set_prec(arg3oriX, 53);
+static __inline__
+void stoProdError(StoVec* e, StoVec* a, StoVec* b, StoVec* p) {
+	StoVec ca = 134217729.0 * *a;
+	StoVec cb = 134217729.0 * *b;
+	StoVec ah = ca - (ca - *a);
+	StoVec bh = cb - (cb - *b);
+	StoVec al = *a - ah;
+	StoVec bl = *b - bh;
+	*e = ((ah * bh - *p) + ah * bl + al * bh) + al * bl;
+}
+
+static __inline__
+void stoAdd(StoVec* r, StoVec* a, StoVec* b, Int k) {
+	StoVec s = *a + *b;
+	StoVec bb = s - *a;
+	StoVec e = (*a - (s - bb)) + (*b - bb);
+	stoRound(&s, &e, k);
+	*r = s;
+}
+
+static __inline__
+void stoMul(StoVec* r, StoVec* a, StoVec* b, Int k) {
+	StoVec p = *a * *b;
+	StoVec e;
+	stoProdError(&e, a, b, &p);
+	stoRound(&p, &e, k);
+	*r = p;
+}
+
+static __inline__
+void stoDiv(StoVec* r, StoVec* a, StoVec* b, Int k) {
+	StoVec q = *a / *b;
+	StoVec p = q * *b;
+	StoVec ep, e;
+	stoProdError(&ep, &q, b, &p);
+	/* the remainder divided by b has the sign of the exact quotient minus q */
+	e = ((*a - p) - ep) / *b;
+	stoRound(&q, &e, k);
+	*r = q;
+}
+
+/* Significant decimal digits of the mean of the samples with a confidence 
+   of 95%: log10(sqrt(N) * |mean| / (tau * sigma)) with Student's tau for 
+   N - 1 degrees of freedom (CESTAC). */
+static Int stoSignificantDigits(Double* samples) {
+	Double mean = 0.0;
+	Int i;
+	for (i = 0; i < clo_sto_samples; i++) {
+		mean += samples[i];
 	}
+	mean /= clo_sto_samples;
 
-	ULong arg2opCount = 0;
-	ULong arg3opCount = 0;
-	Addr arg2origin = 0;
-	Addr arg3origin = 0;
-	mpfr_exp_t arg2canceled = 0;
-	mpfr_exp_t arg3canceled = 0;
-	mpfr_exp_t canceled = 0;
-	Addr arg2CancelOrigin = 0;
-	Addr arg3CancelOrigin = 0;
-	mpfr_t irel2, irel3;
-	mpfr_inits(irel2, irel3, NULL);
+	/* variance relative to the mean, so the squares can not overflow */
+	Double var = 0.0;
+	for (i = 0; i < clo_sto_samples; i++) {
+		Double d = mean == 0 ? samples[i] : (samples[i] - mean) / mean;
+		var += d * d;
+	}
+	if (var == 0) {
+		return STO_MAX_DIGITS;
+	}
+	if (mean == 0) {
+		return 0;
+	}
+	var /= clo_sto_samples - 1;
 
-	Int exactBitsArg2, exactBitsArg3;
-	if (isOpFloat(op)) {
-		exactBitsArg2 = 23;
-		exactBitsArg3 = 23;
-	} else {
-		exactBitsArg2 = 52;
-		exactBitsArg3 = 52;
+	/* tau^2 for 3 and 7 degrees of freedom */
+	Double tau2 = clo_sto_samples == 4 ? 10.125 : 5.593;
+	Double ratio2 = clo_sto_samples / (tau2 * var);
+	if (ratio2 <= 1) {
+		return 0;
 	}
+	/* log10(x) = log2(x^2) / 2 * log10(2) */
+	Int digits = (Int)((ddGetExp(ratio2, 0.0) - 1) * 30103 / 200000);
+	return digits > STO_MAX_DIGITS ? STO_MAX_DIGITS : digits;
+}
 
-	if (constArgs & 0x2) {
-		readSConst(1, &(arg2tmpX));
+/* Reads the samples of an argument of a stochastic operation. Shadow values 
+   computed with MPFR start new samples from their value. Returns False if 
+   the operation has to be computed with MPFR. */
+static Bool readStoArg(Int num, Bool isConst, IRTemp tmp, Double* samples, Double* org, Double* mid, Double* ori, ShadowValue** sv) {
+	Int i;
+	*sv = NULL;
+	if (isConst) {
+		if (sConst[num]->tag != Ico_F64) {
+			return False;
+		}
+		*org = sConst[num]->Val.F64;
+	} else if (sTmp[num]->type == Ity_F64) {
+		*org = sTmp[num]->Val.F64;
+	} else if (sTmp[num]->type == Ity_V128) {
+		*org = *(Double*)(sTmp[num]->U128);
+	} else {
+		return False;
+	}
+	if (!ddInRange(*org)) {
+		return False;
+	}
+
+	if (!isConst) {
+		*sv = getTemp(tmp);
+	}
+	if (*sv) {
+		if ((*sv)->orgType != Ot_DOUBLE) {
+			return False;
+		}
+		checkAndRecover(*sv);
+		*mid = mpfr_get_d((*sv)->midValue, STD_RND);
+		*ori = mpfr_get_d((*sv)->oriValue, STD_RND);
+		if ((*sv)->stoValid) {
+			VG_(memcpy)(samples, (*sv)->sto, clo_sto_samples * sizeof(Double));
+		} else {
+			Double d = mpfr_get_d((*sv)->value, STD_RND);
+			for (i = 0; i < clo_sto_samples; i++) {
+				samples[i] = d;
+			}
+		}
+	} else {
+		*mid = *org;
+		*ori = *org;
+		for (i = 0; i < clo_sto_samples; i++) {
+			samples[i] = *org;
+		}
+	}
+
+	for (i = 0; i < clo_sto_samples; i++) {
+		if (!ddInRange(samples[i])) {
+			return False;
+		}
+	}
+	return ddIsNormal(*mid) && ddBiasedExp(*ori) != 0x7FF;
+}
+
+/* With --shadow-engine=stochastic, scalar double additions, subtractions, 
+   multiplications and divisions are computed with the samples instead of 
+   MPFR. value is the mean of the samples, so all reports work as with MPFR. 
+   Returns False if the operation has to be computed with MPFR, e.g. near 
+   the limits of the exponent range. */
+static Bool processBinOpStochastic(Addr addr, Int constArgs) {
+	IROp op = binOpArgs->op;
+	if (op != Iop_Add64F0x2 && op != Iop_Sub64F0x2 && op != Iop_Mul64F0x2 && op != Iop_Div64F0x2) {
+		return False;
+	}
+	if (clo_simulateOriginal || clo_detect_pso || clo_print_every_error || ladderCount > 0 || demoteCount > 0) {
+		return False;
+	}
+
+	Double s1[MAX_STO_SAMPLES], s2[MAX_STO_SAMPLES], sr[MAX_STO_SAMPLES];
+	Double org1, org2, m1, m2, o1, o2;
+	ShadowValue *arg1tmp, *arg2tmp;
+	if (!readStoArg(0, constArgs & 0x1, binOpArgs->arg1, s1, &org1, &m1, &o1, &arg1tmp) || 
+		!readStoArg(1, constArgs & 0x2, binOpArgs->arg2, s2, &org2, &m2, &o2, &arg2tmp)) 
+	{
+		return False;
+	}
+
+	Double rm, ro;
+	Int i, k;
+	for (k = 0; k < clo_sto_samples / STO_VEC_LANES; k++) {
+		StoVec* a = (StoVec*)(s1 + k * STO_VEC_LANES);
+		StoVec* b = (StoVec*)(s2 + k * STO_VEC_LANES);
+		StoVec* r = (StoVec*)(sr + k * STO_VEC_LANES);
+		StoVec nb;
+		switch (op) {
+			case Iop_Add64F0x2:
+				stoAdd(r, a, b, k);
+				break;
+			case Iop_Sub64F0x2:
+				nb = -*b;
+				stoAdd(r, a, &nb, k);
+				break;
+			case Iop_Mul64F0x2:
+				stoMul(r, a, b, k);
+				break;
+			case Iop_Div64F0x2:
+				stoDiv(r, a, b, k);
+				break;
+			default:
+				tl_assert(False);
+				break;
+		}
+	}
+	switch (op) {
+		case Iop_Add64F0x2:
+			rm = m1 + m2;
+			ro = o1 + o2;
+			break;
+		case Iop_Sub64F0x2:
+			rm = m1 - m2;
+			ro = o1 - o2;
+			break;
+		case Iop_Mul64F0x2:
+			rm = m1 * m2;
+			ro = o1 * o2;
+			break;
+		default:
+			rm = m1 / m2;
+			ro = o1 / o2;
+			break;
+	}
+
+	Double mean1 = 0.0, mean2 = 0.0, mean = 0.0;
+	for (i = 0; i < clo_sto_samples; i++) {
+		if (!ddInRange(sr[i])) {
+			return False;
+		}
+		mean1 += s1[i];
+		mean2 += s2[i];
+		mean += sr[i];
+	}
+	if (!ddIsNormal(rm) || ddBiasedExp(ro) == 0x7FF) {
+		return False;
+	}
+	mean1 /= clo_sto_samples;
+	mean2 /= clo_sto_samples;
+	mean /= clo_sto_samples;
+
+	ShadowValue* res = setTemp(binOpArgs->wrTmp);
+	VG_(memcpy)(res->sto, sr, clo_sto_samples * sizeof(Double));
+	res->stoValid = True;
+	mpfr_set_d(res->value, mean, STD_RND);
+	mpfr_set_prec(res->midValue, 53);
+	mpfr_set_d(res->midValue, rm, STD_RND);
+	mpfr_set_prec(res->oriValue, 53);
+	mpfr_set_d(res->oriValue, ro, STD_RND);
+
+	ULong arg1opCount = arg1tmp ? arg1tmp->opCount : 0;
+	ULong arg2opCount = arg2tmp ? arg2tmp->opCount : 0;
+	Addr arg1origin = arg1tmp ? arg1tmp->origin : 0;
+	Addr arg2origin = arg2tmp ? arg2tmp->origin : 0;
+	res->opCount = 1 + (arg1opCount > arg2opCount ? arg1opCount : arg2opCount);
+	res->origin = addr;
+
+	fpOps++;
+	stoOps++;
+
+	mpfr_exp_t canceled = 0;
+	if (op == Iop_Add64F0x2 || op == Iop_Sub64F0x2) {
+		canceled = ddCanceledBits(mean, 0.0, mean1, 0.0, mean2, 0.0);
+	}
+	mpfr_exp_t maxC = canceled;
+	Addr maxCorigin = addr;
+	if (arg1tmp && arg1tmp->canceled > maxC) {
+		maxC = arg1tmp->canceled;
+		maxCorigin = arg1tmp->cancelOrigin;
+	}
+	if (arg2tmp && arg2tmp->canceled > maxC) {
+		maxC = arg2tmp->canceled;
+		maxCorigin = arg2tmp->cancelOrigin;
+	}
+	res->canceled = maxC;
+	res->cancelOrigin = maxCorigin;
+
+	if (clo_computeMeanValue && !(constArgs & SATURATED_SITE)) {
+		UInt cancellationBadness = 0;
+		if (clo_bad_cancellations && canceled > 0) {
+			Int exactBitsArg1 = arg1tmp ? ddExactBits(org1, mean1, 0.0) : 52;
+			Int exactBitsArg2 = arg2tmp ? ddExactBits(org2, mean2, 0.0) : 52;
+			Int exactBits = exactBitsArg1 < exactBitsArg2 ? exactBitsArg1 : exactBitsArg2;
+			if (canceled > exactBits) {
+				cancellationBadness = canceled - exactBits;
+			}
+		}
+
+		mpfr_set_d(meanOrg, binOpArgs->orgDouble, STD_RND);
+		updateMeanValue(addr, op, &(res->value), canceled, arg1origin, arg2origin, cancellationBadness);
+		updateStochasticDigits(addr, stoSignificantDigits(sr));
+		if (clo_condition) {
+			updateConditionNumber(addr, op, 0, 1, constArgs, binOpArgs->orgDouble);
+		}
+	}
+
+	res->Org.db = binOpArgs->orgDouble;
+	res->orgType = Ot_DOUBLE;
+	if (!(constArgs & 0x1)) {
+		copyUpperLanes(binOpArgs->wrTmp, binOpArgs->arg1);
+	}
+	return True;
+}
+
+static VG_REGPARM(2) void processBinOp(Addr addr, UWord ca) {
+	if (!clo_analyze) return;
+
+	Int constArgs = (Int)ca;
+	if (clo_reassociation) {
+		updateReduction(addr, binOpArgs->op, 0, 1, constArgs, 
+			isOpFloat(binOpArgs->op) ? binOpArgs->orgFloat : binOpArgs->orgDouble);
+	}
+	selectPrecision(addr);
+	if (clo_stochastic && processBinOpStochastic(addr, constArgs)) {
+		return;
+	}
+	if (clo_hybrid && processBinOpDD(addr, constArgs)) {
+		return;
+	}
+	Bool needFix = clo_detect_pso && VG_(HT_lookup)(detectedPSO, addr) != NULL;
+
+	if (clo_simulateOriginal) {
+		if (isOpFloat(binOpArgs->op)) {
+			mpfr_set_prec(arg1tmpX, 24);
+			mpfr_set_prec(arg2tmpX, 24);
+		} else {
+			mpfr_set_prec(arg1tmpX, 53);
+			mpfr_set_prec(arg2tmpX, 53);
+		}
+	}
+
+	if (isOpFloat(binOpArgs->op)) {
+		mpfr_set_prec(arg1midX, 24);
+		mpfr_set_prec(arg2midX, 24);
+		mpfr_set_prec(arg1oriX, 24);
+		mpfr_set_prec(arg2oriX, 24);
+	} else {
+		mpfr_set_prec(arg1midX, 53);
+		mpfr_set_prec(arg2midX, 53);
+		mpfr_set_prec(arg1oriX, 53);
+		mpfr_set_prec(arg2oriX, 53);
+	}
+
+	ULong arg1opCount = 0;
+	ULong arg2opCount = 0;
+	Addr arg1origin = 0;
+	Addr arg2origin = 0;
+	mpfr_exp_t arg1canceled = 0;
+	mpfr_exp_t arg2canceled = 0;
+	mpfr_exp_t canceled = 0;
+	Addr arg1CancelOrigin = 0;
+	Addr arg2CancelOrigin = 0;
+	mpfr_t irel1, irel2;
+	mpfr_inits(irel1, irel2, NULL);
+
+	Int exactBitsArg1, exactBitsArg2;
+	if (isOpFloat(binOpArgs->op)) {
+		exactBitsArg1 = 23;
+		exactBitsArg2 = 23;
+	} else {
+		exactBitsArg1 = 52;
+		exactBitsArg2 = 52;
+	}
+
+	if (constArgs & 0x8) {
+		/* arg1 is the rounding mode, the operation is unary on arg2 */
+		mpfr_set_ui(irel1, 0, STD_RND);
+	} else if (constArgs & 0x1) {
+		readSConst(0, &(arg1tmpX));
+		mpfr_set(arg1midX, arg1tmpX, STD_RND);
+		beginEmulateDouble();
+		int t = mpfr_set(arg1oriX, arg1tmpX, STD_RND);
+		mpfr_subnormalize(arg1oriX, t, STD_RND);
+		endEmulate();
+	} else {
+		ShadowValue* arg1tmp = getTemp(binOpArgs->arg1);
+		checkAndRecover(arg1tmp);
+		computeRelativeError(arg1tmp, irel1);
+		// if (needFix) printErrorShort(arg1tmp);
+		if (arg1tmp) {
+			// VG_(umsg)("have shadow 1\n");
+			mpfr_set(arg1tmpX, arg1tmp->value, STD_RND);
+			mpfr_set(arg1midX, arg1tmp->midValue, STD_RND);
+			beginEmulateDouble();
+			int t = mpfr_set(arg1oriX, arg1tmp->oriValue, STD_RND);
+			mpfr_subnormalize(arg1oriX, t, STD_RND);
+			endEmulate();
+			arg1opCount = arg1tmp->opCount;
+			arg1origin = arg1tmp->origin;
+			arg1canceled = arg1tmp->canceled;
+			arg1CancelOrigin = arg1tmp->cancelOrigin;
+
+			if (clo_bad_cancellations) {
+				readSTemp(0, &cancelTemp);
+				if (mpfr_get_exp(cancelTemp) == mpfr_get_exp(arg1tmpX)) {
+					mpfr_sub(cancelTemp, arg1tmpX, cancelTemp, STD_RND);
+					if (mpfr_cmp_ui(cancelTemp, 0) != 0) {
+						exactBitsArg1 = abs(mpfr_get_exp(arg1tmpX) - mpfr_get_exp(cancelTemp)) - 2;
+						if (arg1tmp->orgType == Ot_FLOAT && exactBitsArg1 > 23) {
+							exactBitsArg1 = 23;
+						} else if (arg1tmp->orgType == Ot_DOUBLE && exactBitsArg1 > 52) {
+							exactBitsArg1 = 52;
+						}
+					}
+				} else {
+					exactBitsArg1 = 0;
+				}
+			}
+		} else {
+			readSTemp(0, &(arg1tmpX));
+			mpfr_set(arg1midX, arg1tmpX, STD_RND);
+			beginEmulateDouble();
+			int t = mpfr_set(arg1oriX, arg1tmpX, STD_RND);
+			mpfr_subnormalize(arg1oriX, t, STD_RND);
+			endEmulate();
+		}
+	}
+
+	if (constArgs & 0x2) {
+		readSConst(1, &(arg2tmpX));
 		mpfr_set(arg2midX, arg2tmpX, STD_RND);
 		beginEmulateDouble();
 		int t = mpfr_set(arg2oriX, arg2tmpX, STD_RND);
 		mpfr_subnormalize(arg2oriX, t, STD_RND);
 		endEmulate();
 	} else {
-		ShadowValue* arg2tmp = getTemp(triOpArgs->arg2);
+		ShadowValue* arg2tmp = getTemp(binOpArgs->arg2);
 		checkAndRecover(arg2tmp);
+		// VG_(umsg)("get %X\n", binOpArgs->arg2);
 		computeRelativeError(arg2tmp, irel2);
 		if (arg2tmp) {
+			// if (needFix) printErrorShort(arg2tmp);
+			// VG_(umsg)("have shadow 2\n");
 			mpfr_set(arg2tmpX, arg2tmp->value, STD_RND);
 			mpfr_set(arg2midX, arg2tmp->midValue, STD_RND);
 			beginEmulateDouble();
@@ -1858,65 +4076,17 @@ static VG_REGPARM(2) void processTriOp(Addr addr, UWord ca) {
 		}
 	}
 
-	if (constArgs & 0x4) {
-		readSConst(2, &(arg3tmpX));
-		mpfr_set(arg3midX, arg3tmpX, STD_RND);
-		beginEmulateDouble();
-		int t = mpfr_set(arg3oriX, arg3tmpX, STD_RND);
-		mpfr_subnormalize(arg3oriX, t, STD_RND);
-		endEmulate();
-	} else {
-		ShadowValue* arg3tmp = getTemp(triOpArgs->arg3);
-		checkAndRecover(arg3tmp);
-		computeRelativeError(arg3tmp, irel3);
-		if (arg3tmp) {
-			mpfr_set(arg3tmpX, arg3tmp->value, STD_RND);
-			mpfr_set(arg3midX, arg3tmp->midValue, STD_RND);
-			beginEmulateDouble();
-			int t = mpfr_set(arg3oriX, arg3tmp->oriValue, STD_RND);
-			mpfr_subnormalize(arg3oriX, t, STD_RND);
-			endEmulate();
-			arg3opCount = arg3tmp->opCount;
-			arg3origin = arg3tmp->origin;
-			arg3canceled = arg3tmp->canceled;
-			arg3CancelOrigin = arg3tmp->cancelOrigin;
-
-			if (clo_bad_cancellations) {
-				readSTemp(2, &cancelTemp);
-				if (mpfr_get_exp(cancelTemp) == mpfr_get_exp(arg3tmpX)) {
-					mpfr_sub(cancelTemp, arg3tmpX, cancelTemp, STD_RND);
-					if (mpfr_cmp_ui(cancelTemp, 0) != 0) {
-						exactBitsArg3 = abs(mpfr_get_exp(arg3tmpX) - mpfr_get_exp(cancelTemp)) - 2;
-						if (arg3tmp->orgType == Ot_FLOAT && exactBitsArg3 > 23) {
-							exactBitsArg3 = 23;
-						} else if (arg3tmp->orgType == Ot_DOUBLE && exactBitsArg3 > 52) {
-							exactBitsArg3 = 52;
-						}
-					}
-				} else {
-					exactBitsArg3 = 0;
-				}
-			}
-		} else {
-			readSTemp(2, &(arg3tmpX));
-			mpfr_set(arg3midX, arg3tmpX, STD_RND);
-			beginEmulateDouble();
-			int t = mpfr_set(arg3oriX, arg3tmpX, STD_RND);
-			mpfr_subnormalize(arg3oriX, t, STD_RND);
-			endEmulate();
-		}
-	}
-
-	ShadowValue* res = setTemp(triOpArgs->wrTmp);
+	ShadowValue* res = setTemp(binOpArgs->wrTmp);
+	// VG_(umsg)("processBinOp %X\n", binOpArgs->wrTmp);
 	if (clo_simulateOriginal) {
-		if (isOpFloat(op)) {
+		if (isOpFloat(binOpArgs->op)) {
 			mpfr_set_prec(res->value, 24);
 		} else {
 			mpfr_set_prec(res->value, 53);
 		}
 	}
 
-	if (isOpFloat(op)) {
+	if (isOpFloat(binOpArgs->op)) {
 		mpfr_set_prec(res->midValue, 24);
 		mpfr_set_prec(res->oriValue, 24);
 	} else {
@@ -1925,435 +4095,656 @@ static VG_REGPARM(2) void processTriOp(Addr addr, UWord ca) {
 	}
 
 	res->opCount = 1;
-	if (arg2opCount > arg3opCount) {
-		res->opCount += arg2opCount;
+	if (arg1opCount > arg2opCount) {
+		res->opCount += arg1opCount;
 	} else {
-		res->opCount += arg3opCount;
+		res->opCount += arg2opCount;
 	}
 	res->origin = addr;
 
 	fpOps++;
 
-	Bool needFix = clo_detect_pso && VG_(HT_lookup)(detectedPSO, addr) != NULL;
 	if (needFix) {
+		// VG_(umsg)("Need fix!\n");
+		mpfr_set(arg1midX, arg1tmpX, STD_RND);
 		mpfr_set(arg2midX, arg2tmpX, STD_RND);
-		mpfr_set(arg3midX, arg3tmpX, STD_RND);
+		// Char mpfrBuf[MPFR_BUFSIZE];
+		// mpfrToString(mpfrBuf, &arg1midX);
+		// VG_(umsg)("Mid1 %s\n", mpfrBuf);
+		// mpfrToString(mpfrBuf, &arg2midX);
+		// VG_(umsg)("Mid2 %s\n", mpfrBuf);
 	}
 
 	int tv;
-	switch (op) {
-		case Iop_AddF64:
-			mpfr_add(res->value, arg2tmpX, arg3tmpX, STD_RND);
-			mpfr_add(res->midValue, arg2midX, arg3midX, STD_RND);
+	switch (binOpArgs->op) {
+		case Iop_Add32F0x4:
+		case Iop_Add64F0x2:
+			mpfr_add(res->value, arg1tmpX, arg2tmpX, STD_RND);
+			mpfr_add(res->midValue, arg1midX, arg2midX, STD_RND);
 			beginEmulateDouble();
-			tv = mpfr_add(res->oriValue, arg2oriX, arg3oriX, STD_RND);
+			tv = mpfr_add(res->oriValue, arg1oriX, arg2oriX, STD_RND);
 			mpfr_subnormalize(res->oriValue, tv, STD_RND);
 			endEmulate();
-			canceled = getCanceledBits(&(res->value), &(arg2tmpX), &(arg3tmpX));
+			canceled = getCanceledBits(&(res->value), &(arg1tmpX), &(arg2tmpX));
 			break;
-		case Iop_SubF64:
-			mpfr_sub(res->value, arg2tmpX, arg3tmpX, STD_RND);
-			mpfr_sub(res->midValue, arg2midX, arg3midX, STD_RND);
+		case Iop_Sub32F0x4:
+		case Iop_Sub64F0x2:
+			mpfr_sub(res->value, arg1tmpX, arg2tmpX, STD_RND);
+			mpfr_sub(res->midValue, arg1midX, arg2midX, STD_RND);
 			beginEmulateDouble();
-			tv = mpfr_sub(res->oriValue, arg2oriX, arg3oriX, STD_RND);
+			tv = mpfr_sub(res->oriValue, arg1oriX, arg2oriX, STD_RND);
 			mpfr_subnormalize(res->oriValue, tv, STD_RND);
 			endEmulate();
-			canceled = getCanceledBits(&(res->value), &(arg2tmpX), &(arg3tmpX));
+			canceled = getCanceledBits(&(res->value), &(arg1tmpX), &(arg2tmpX));
 			break;
-		case Iop_MulF64:
-			mpfr_mul(res->value, arg2tmpX, arg3tmpX, STD_RND);
-			mpfr_mul(res->midValue, arg2midX, arg3midX, STD_RND);
+		case Iop_Mul32F0x4:
+		case Iop_Mul64F0x2:
+			mpfr_mul(res->value, arg1tmpX, arg2tmpX, STD_RND);
+			mpfr_mul(res->midValue, arg1midX, arg2midX, STD_RND);
 			beginEmulateDouble();
-			tv = mpfr_mul(res->oriValue, arg2oriX, arg3oriX, STD_RND);
+			tv = mpfr_mul(res->oriValue, arg1oriX, arg2oriX, STD_RND);
 			mpfr_subnormalize(res->oriValue, tv, STD_RND);
 			endEmulate();
 			break;
-		case Iop_DivF64:
-			mpfr_div(res->value, arg2tmpX, arg3tmpX, STD_RND);
-			mpfr_div(res->midValue, arg2midX, arg3midX, STD_RND);
+		case Iop_Div32F0x4:
+		case Iop_Div64F0x2:
+			mpfr_div(res->value, arg1tmpX, arg2tmpX, STD_RND);
+			mpfr_div(res->midValue, arg1midX, arg2midX, STD_RND);
 			beginEmulateDouble();
-			tv = mpfr_div(res->oriValue, arg2oriX, arg3oriX, STD_RND);
+			tv = mpfr_div(res->oriValue, arg1oriX, arg2oriX, STD_RND);
+			mpfr_subnormalize(res->oriValue, tv, STD_RND);
+			endEmulate();
+			break;
+		case Iop_Min32F0x4:
+		case Iop_Min64F0x2:
+			mpfr_min(res->value, arg1tmpX, arg2tmpX, STD_RND);
+			mpfr_min(res->midValue, arg1midX, arg2midX, STD_RND);
+			beginEmulateDouble();
+			tv = mpfr_min(res->oriValue, arg1oriX, arg2oriX, STD_RND);
+			mpfr_subnormalize(res->oriValue, tv, STD_RND);
+			endEmulate();
+			break;
+		case Iop_Max32F0x4:
+		case Iop_Max64F0x2:
+			mpfr_max(res->value, arg1tmpX, arg2tmpX, STD_RND);
+			mpfr_max(res->midValue, arg1midX, arg2midX, STD_RND);
+			beginEmulateDouble();
+			tv = mpfr_max(res->oriValue, arg1oriX, arg2oriX, STD_RND);
+			mpfr_subnormalize(res->oriValue, tv, STD_RND);
+			endEmulate();
+			break;
+		case Iop_SqrtF32:
+		case Iop_SqrtF64:
+			mpfr_sqrt(res->value, arg2tmpX, STD_RND);
+			mpfr_sqrt(res->midValue, arg2midX, STD_RND);
+			beginEmulateDouble();
+			tv = mpfr_sqrt(res->oriValue, arg2oriX, STD_RND);
+			mpfr_subnormalize(res->oriValue, tv, STD_RND);
+			endEmulate();
+			break;
+		case Iop_SinF64:
+			mpfr_sin(res->value, arg2tmpX, STD_RND);
+			mpfr_sin(res->midValue, arg2midX, STD_RND);
+			beginEmulateDouble();
+			tv = mpfr_sin(res->oriValue, arg2oriX, STD_RND);
+			mpfr_subnormalize(res->oriValue, tv, STD_RND);
+			endEmulate();
+			break;
+		case Iop_CosF64:
+			mpfr_cos(res->value, arg2tmpX, STD_RND);
+			mpfr_cos(res->midValue, arg2midX, STD_RND);
+			beginEmulateDouble();
+			tv = mpfr_cos(res->oriValue, arg2oriX, STD_RND);
+			mpfr_subnormalize(res->oriValue, tv, STD_RND);
+			endEmulate();
+			break;
+		case Iop_TanF64:
+			mpfr_tan(res->value, arg2tmpX, STD_RND);
+			mpfr_tan(res->midValue, arg2midX, STD_RND);
+			beginEmulateDouble();
+			tv = mpfr_tan(res->oriValue, arg2oriX, STD_RND);
+			mpfr_subnormalize(res->oriValue, tv, STD_RND);
+			endEmulate();
+			break;
+		case Iop_2xm1F64:
+			compute2xm1(res->value, arg2tmpX);
+			compute2xm1(res->midValue, arg2midX);
+			beginEmulateDouble();
+			tv = compute2xm1(res->oriValue, arg2oriX);
 			mpfr_subnormalize(res->oriValue, tv, STD_RND);
 			endEmulate();
 			break;
 		default:
-			VG_(tool_panic)("Unhandled case in processTriOp");
+			VG_(tool_panic)("Unhandled case in processBinOp\n");
 			break;
 	}
 
-	if (needFix) {
-		mpfr_set(res->value, res->midValue, STD_RND);
-	}
-
 	mpfr_exp_t maxC = canceled;
 	Addr maxCorigin = addr;
+	if (arg1canceled > maxC) {
+		maxC = arg1canceled;
+		maxCorigin = arg1CancelOrigin;
+	}
 	if (arg2canceled > maxC) {
 		maxC = arg2canceled;
 		maxCorigin = arg2CancelOrigin;
 	}
-	if (arg3canceled > maxC) {
-		maxC = arg3canceled;
-		maxCorigin = arg3CancelOrigin;
-	}
 	res->canceled = maxC;
 	res->cancelOrigin = maxCorigin;
-
-	if (clo_computeMeanValue) {
+	if (escalatePrecision(addr, canceled, arg1origin, arg2origin)) {
+		if (constArgs & 0x8) {
+			recomputeEscalated(res, binOpArgs->op, &arg2tmpX, NULL, NULL);
+		} else {
+			recomputeEscalated(res, binOpArgs->op, &arg1tmpX, &arg2tmpX, NULL);
+		}
+	}
+	if (ladderCount > 0) {
+		ShadowValue* l1 = (constArgs & 0x9) ? NULL : getTemp(binOpArgs->arg1);
+		ShadowValue* l2 = (constArgs & 0x2) ? NULL : getTemp(binOpArgs->arg2);
+		if (constArgs & 0x8) {
+			computeLadder(addr, binOpArgs->op, res, l2, &arg2tmpX, NULL, NULL, NULL, NULL);
+		} else {
+			computeLadder(addr, binOpArgs->op, res, l1, &arg1tmpX, l2, &arg2tmpX, NULL, NULL);
+		}
+	}
+	if (demoteCount > 0) {
+		ShadowValue* d1 = (constArgs & 0x9) ? NULL : getTemp(binOpArgs->arg1);
+		ShadowValue* d2 = (constArgs & 0x2) ? NULL : getTemp(binOpArgs->arg2);
+		if (constArgs & 0x8) {
+			computeDemoted(addr, binOpArgs->op, res, d2, &arg2oriX, NULL, NULL, NULL, NULL);
+		} else {
+			computeDemoted(addr, binOpArgs->op, res, d1, &arg1oriX, d2, &arg2oriX, NULL, NULL);
+		}
+	}
+	
+	if (clo_computeMeanValue && !(constArgs & SATURATED_SITE)) {
 		UInt cancellationBadness = 0;
 		if (clo_bad_cancellations && canceled > 0) {
-			Int exactBits = exactBitsArg2 < exactBitsArg3 ? exactBitsArg2 : exactBitsArg3;
+			Int exactBits = exactBitsArg1 < exactBitsArg2 ? exactBitsArg1 : exactBitsArg2;
 			if (canceled > exactBits) {
 				cancellationBadness = canceled - exactBits;
 			}
 		}
 
-		mpfr_set_d(meanOrg, triOpArgs->orgDouble, STD_RND);
-		updateMeanValue(addr, op, &(res->value), canceled, arg2origin, arg3origin, cancellationBadness);
+		if (isOpFloat(binOpArgs->op)) {
+			mpfr_set_flt(meanOrg, binOpArgs->orgFloat, STD_RND);
+		} else {
+			mpfr_set_d(meanOrg, binOpArgs->orgDouble, STD_RND);
+		}
+		updateMeanValue(addr, binOpArgs->op, &(res->value), canceled, arg1origin, arg2origin, cancellationBadness);
+		if (clo_condition) {
+			updateConditionNumber(addr, binOpArgs->op, (constArgs & 0x8) ? -1 : 0, 1, constArgs, 
+				isOpFloat(binOpArgs->op) ? binOpArgs->orgFloat : binOpArgs->orgDouble);
+		}
 	}
 
-	res->Org.db = triOpArgs->orgDouble;
-	res->orgType = Ot_DOUBLE;
+	if (isOpFloat(binOpArgs->op)) {
+		res->Org.fl = binOpArgs->orgFloat;
+		res->orgType = Ot_FLOAT;
+	} else {
+		res->Org.db = binOpArgs->orgDouble;
+		res->orgType = Ot_DOUBLE;
+	}
+	if (!(constArgs & (0x1 | 0x8))) {
+		copyUpperLanes(binOpArgs->wrTmp, binOpArgs->arg1);
+	}
+	if (needFix) {
+		mpfr_set(res->value, res->midValue, STD_RND);
+		// printErrorShort(res);
+	}
 	if (clo_detect_pso && !finishPSO) {
-		mpfr_max(irel2, irel2, irel3, STD_RND);
-		analyzePSO(irel2, res);
+		mpfr_max(irel1, irel1, irel2, STD_RND);
+		analyzePSO(irel1, res);
+	}
+	if (psoLaneCount > 0) {
+		ShadowValue* p1 = (constArgs & 0x9) ? NULL : getTemp(binOpArgs->arg1);
+		ShadowValue* p2 = (constArgs & 0x2) ? NULL : getTemp(binOpArgs->arg2);
+		if (constArgs & 0x8) {
+			computePSOLanes(addr, binOpArgs->op, res, True, p2, &arg2tmpX, NULL, NULL, NULL, NULL);
+		} else {
+			computePSOLanes(addr, binOpArgs->op, res, True, p1, &arg1tmpX, p2, &arg2tmpX, NULL, NULL);
+		}
 	}
 	if (clo_print_every_error) {
 		printErrorShort(res);
 	}
 }
 
-static void instrumentTriOp(IRSB* sb, IRTypeEnv* env, Addr addr, IRTemp wrTemp, IRExpr* triop, Int arg2tmpInstead, Int arg3tmpInstead) {
-	tl_assert(triop->tag == Iex_Triop);
+static void instrumentBinOp(IRSB* sb, IRTypeEnv* env, Addr addr, IRTemp wrTemp, IRExpr* binop, Int arg1tmpInstead, Int arg2tmpInstead) {
+	tl_assert(binop->tag == Iex_Binop);
 
 	if (clo_ignoreLibraries && isInLibrary(addr)) {
 		return;
 	}
+	if (!isSuspectSite(addr)) {
+		return;
+	}
+	Int saturated = instrumentSiteCount(sb, addr, binop->Iex.Binop.op, 1);
 
-	IROp op = triop->Iex.Triop.op;
-	IRExpr* arg1 = triop->Iex.Triop.arg1;
-	IRExpr* arg2 = triop->Iex.Triop.arg2;
-	IRExpr* arg3 = triop->Iex.Triop.arg3;
+	IROp op = binop->Iex.Binop.op;
+	IRExpr* arg1 = binop->Iex.Binop.arg1;
+	IRExpr* arg2 = binop->Iex.Binop.arg2;
 
-	tl_assert(arg1->tag == Iex_Const);
+	tl_assert(arg1->tag == Iex_RdTmp || arg1->tag == Iex_Const);
 	tl_assert(arg2->tag == Iex_RdTmp || arg2->tag == Iex_Const);
-	tl_assert(arg3->tag == Iex_RdTmp || arg3->tag == Iex_Const);
 
-	Int constArgs = 0;
+	Int constArgs = saturated;
 
-	IRStmt* store = IRStmt_Store(Iend_LE, mkU64(&(triOpArgs->op)), mkU32(op));
+	IRStmt* store = IRStmt_Store(Iend_LE, mkU64(&(binOpArgs->op)), mkU32(op));
 	addStmtToIRSB(sb, store);
-	store = IRStmt_Store(Iend_LE, mkU64(&(triOpArgs->wrTmp)), mkU32(wrTemp));
+	store = IRStmt_Store(Iend_LE, mkU64(&(binOpArgs->wrTmp)), mkU32(wrTemp));
 	addStmtToIRSB(sb, store);
 
-	/* arg1 is ignored because it only contains the rounding mode for 
-	   the operations instructed at the moment */
+	switch (op) {
+		case Iop_SqrtF32:
+		case Iop_SqrtF64:
+		case Iop_SinF64:
+		case Iop_CosF64:
+		case Iop_TanF64:
+		case Iop_2xm1F64:
+			/* arg1 only contains the rounding mode */
+			constArgs |= 0x8;
+			break;
+		default:
+			break;
+	}
+
+	if (constArgs & 0x8) {
+		/* nothing to store */
+	} else if (arg1->tag == Iex_RdTmp) {
+		if (arg1tmpInstead >= 0) {
+			store = IRStmt_Store(Iend_LE, mkU64(&(binOpArgs->arg1)), mkU32(arg1tmpInstead));
+		} else {
+			store = IRStmt_Store(Iend_LE, mkU64(&(binOpArgs->arg1)), mkU32(arg1->Iex.RdTmp.tmp));
+		}
+		addStmtToIRSB(sb, store);
+
+		writeSTemp(sb, env, arg1->Iex.RdTmp.tmp, 0);
+	} else {
+		tl_assert(arg1->tag == Iex_Const);
 
+		writeSConst(sb, arg1->Iex.Const.con, 0);
+		constArgs |= 0x1;
+	}
 	if (arg2->tag == Iex_RdTmp) {
 		if (arg2tmpInstead >= 0) {
-			store = IRStmt_Store(Iend_LE, mkU64(&(triOpArgs->arg2)), mkU32(arg2tmpInstead));
+			store = IRStmt_Store(Iend_LE, mkU64(&(binOpArgs->arg2)), mkU32(arg2tmpInstead));
 		} else {
-			store = IRStmt_Store(Iend_LE, mkU64(&(triOpArgs->arg2)), mkU32(triop->Iex.Triop.arg2->Iex.RdTmp.tmp));
+			store = IRStmt_Store(Iend_LE, mkU64(&(binOpArgs->arg2)), mkU32(arg2->Iex.RdTmp.tmp));
 		}
 		addStmtToIRSB(sb, store);
-		writeSTemp(sb, env, triop->Iex.Triop.arg2->Iex.RdTmp.tmp, 1);
+
+		writeSTemp(sb, env, arg2->Iex.RdTmp.tmp, 1);
 	} else {
 		tl_assert(arg2->tag == Iex_Const);
+
 		writeSConst(sb, arg2->Iex.Const.con, 1);
 		constArgs |= 0x2;
 	}
 
-	if (arg3->tag == Iex_RdTmp) {
-		if (arg3tmpInstead >= 0) {
-			store = IRStmt_Store(Iend_LE, mkU64(&(triOpArgs->arg3)), mkU32(arg3tmpInstead));
-		} else {
-			store = IRStmt_Store(Iend_LE, mkU64(&(triOpArgs->arg3)), mkU32(triop->Iex.Triop.arg3->Iex.RdTmp.tmp));
-		}
+	if (isOpFloat(op)) {
+		store = IRStmt_Store(Iend_LE, mkU64(&(binOpArgs->orgFloat)), IRExpr_RdTmp(wrTemp));
 		addStmtToIRSB(sb, store);
-		writeSTemp(sb, env, triop->Iex.Triop.arg3->Iex.RdTmp.tmp, 2);
 	} else {
-		tl_assert(arg3->tag == Iex_Const);
-		writeSConst(sb, arg3->Iex.Const.con, 2);
-		constArgs |= 0x4;
+		store = IRStmt_Store(Iend_LE, mkU64(&(binOpArgs->orgDouble)), IRExpr_RdTmp(wrTemp));
+		addStmtToIRSB(sb, store);
 	}
 
-	store = IRStmt_Store(Iend_LE, mkU64(&(triOpArgs->orgDouble)), IRExpr_RdTmp(wrTemp));
-	addStmtToIRSB(sb, store);
-
 	IRExpr** argv = mkIRExprVec_2(mkU64(addr), mkU64(constArgs));
-	IRDirty* di = unsafeIRDirty_0_N(2, "processTriOp", VG_(fnptr_to_fnentry)(&processTriOp), argv);
-	addStmtToIRSB(sb, IRStmt_Dirty(di));
+	IRDirty* di = unsafeIRDirty_0_N(2, "processBinOp", VG_(fnptr_to_fnentry)(&processBinOp), argv);
+	addHelperToIRSB(sb, di);
 }
 
-static VG_REGPARM(2) UInt processCmpF64(Addr addr, UWord ca) {
+static __inline__
+void readPackedArg(Int num, Int lane, Bool isFloat, ShadowValue* sv, mpfr_t* tmpX, mpfr_t* midX, mpfr_t* oriX) {
+	int t;
+	if (sv) {
+		mpfr_set(*tmpX, sv->value, STD_RND);
+		mpfr_set(*midX, sv->midValue, STD_RND);
+		beginEmulateDouble();
+		t = mpfr_set(*oriX, sv->oriValue, STD_RND);
+	} else {
+		readSTempLane(num, lane, isFloat, tmpX);
+		mpfr_set(*midX, *tmpX, STD_RND);
+		beginEmulateDouble();
+		t = mpfr_set(*oriX, *tmpX, STD_RND);
+	}
+	mpfr_subnormalize(*oriX, t, STD_RND);
+	endEmulate();
+}
+
+/* Packed SSE operations (e.g. Add64Fx2) compute every lane independently,
+   so each lane gets its own shadow value. The native result is in sTmp[3]. */
+static VG_REGPARM(2) void processPackedOp(Addr addr, UWord ca) {
 	if (!clo_analyze) return;
 
 	Int constArgs = (Int)ca;
+	selectPrecision(addr);
+	IROp op = packedOpArgs->op;
+	Bool isFloat = isOpFloat(op);
+	Bool isUnary = (constArgs & 0x8) != 0;
+	Bool needFix = clo_detect_pso && VG_(HT_lookup)(detectedPSO, addr) != NULL;
+	mpfr_prec_t orgPrec = isFloat ? 24 : 53;
+	Int lanes = isFloat ? 4 : 2;
+	Int lane;
 
 	if (clo_simulateOriginal) {
-		if (isOpFloat(binOpArgs->op)) {
-			mpfr_set_prec(arg1tmpX, 24);
-			mpfr_set_prec(arg2tmpX, 24);
-		} else {
-			mpfr_set_prec(arg1tmpX, 53);
-			mpfr_set_prec(arg2tmpX, 53);
-		}
+		mpfr_set_prec(arg1tmpX, orgPrec);
+		mpfr_set_prec(arg2tmpX, orgPrec);
 	}
+	mpfr_set_prec(arg1midX, orgPrec);
+	mpfr_set_prec(arg2midX, orgPrec);
+	mpfr_set_prec(arg1oriX, orgPrec);
+	mpfr_set_prec(arg2oriX, orgPrec);
 
-	if (isOpFloat(binOpArgs->op)) {
-		mpfr_set_prec(arg1midX, 24);
-		mpfr_set_prec(arg2midX, 24);
-		mpfr_set_prec(arg1oriX, 24);
-		mpfr_set_prec(arg2oriX, 24);
-	} else {
-		mpfr_set_prec(arg1midX, 53);
-		mpfr_set_prec(arg2midX, 53);
-		mpfr_set_prec(arg1oriX, 53);
-		mpfr_set_prec(arg2oriX, 53);
-	}
+	mpfr_t irel1, irel2;
+	mpfr_inits(irel1, irel2, NULL);
 
-	ULong arg1opCount = 0;
-	ULong arg2opCount = 0;
-	Addr arg1origin = 0;
-	Addr arg2origin = 0;
-	mpfr_exp_t arg1canceled = 0;
-	mpfr_exp_t arg2canceled = 0;
-	mpfr_exp_t canceled = 0;
-	Addr arg1CancelOrigin = 0;
-	Addr arg2CancelOrigin = 0;
-	mpfr_t irel1, irel2;
-	mpfr_inits(irel1, irel2, NULL);
-
-	Int exactBitsArg1, exactBitsArg2;
-	if (isOpFloat(binOpArgs->op)) {
-		exactBitsArg1 = 23;
-		exactBitsArg2 = 23;
-	} else {
-		exactBitsArg1 = 52;
-		exactBitsArg2 = 52;
-	}
-
-	if (constArgs & 0x1) {
-		readSConst(0, &(arg1tmpX));
-		mpfr_set(arg1midX, arg1tmpX, STD_RND);
-		beginEmulateDouble();
-		int t = mpfr_set(arg1oriX, arg1tmpX, STD_RND);
-		mpfr_subnormalize(arg1oriX, t, STD_RND);
-		endEmulate();
-	} else {
-		ShadowValue* arg1tmp = getTemp(binOpArgs->arg1);
+	for (lane = 0; lane < lanes; lane++) {
+		ULong arg1opCount = 0;
+		ULong arg2opCount = 0;
+		Addr arg1origin = 0;
+		Addr arg2origin = 0;
+		mpfr_exp_t arg1canceled = 0;
+		mpfr_exp_t arg2canceled = 0;
+		mpfr_exp_t canceled = 0;
+		Addr arg1CancelOrigin = 0;
+		Addr arg2CancelOrigin = 0;
+
+		ShadowValue* arg1tmp = getTempLane(packedOpArgs->arg1, lane);
 		checkAndRecover(arg1tmp);
 		computeRelativeError(arg1tmp, irel1);
-		// if (needFix) printErrorShort(arg1tmp);
+		readPackedArg(0, lane, isFloat, arg1tmp, &arg1tmpX, &arg1midX, &arg1oriX);
 		if (arg1tmp) {
-			// VG_(umsg)("have shadow 1\n");
-			mpfr_set(arg1tmpX, arg1tmp->value, STD_RND);
-			mpfr_set(arg1midX, arg1tmp->midValue, STD_RND);
-			beginEmulateDouble();
-			int t = mpfr_set(arg1oriX, arg1tmp->oriValue, STD_RND);
-			mpfr_subnormalize(arg1oriX, t, STD_RND);
-			endEmulate();
 			arg1opCount = arg1tmp->opCount;
 			arg1origin = arg1tmp->origin;
 			arg1canceled = arg1tmp->canceled;
 			arg1CancelOrigin = arg1tmp->cancelOrigin;
+		}
 
-			if (clo_bad_cancellations) {
-				readSTemp(0, &cancelTemp);
-				if (mpfr_get_exp(cancelTemp) == mpfr_get_exp(arg1tmpX)) {
-					mpfr_sub(cancelTemp, arg1tmpX, cancelTemp, STD_RND);
-					if (mpfr_cmp_ui(cancelTemp, 0) != 0) {
-						exactBitsArg1 = abs(mpfr_get_exp(arg1tmpX) - mpfr_get_exp(cancelTemp)) - 2;
-						if (arg1tmp->orgType == Ot_FLOAT && exactBitsArg1 > 23) {
-							exactBitsArg1 = 23;
-						} else if (arg1tmp->orgType == Ot_DOUBLE && exactBitsArg1 > 52) {
-							exactBitsArg1 = 52;
-						}
-					}
-				} else {
-					exactBitsArg1 = 0;
-				}
-			}
+		if (isUnary) {
+			mpfr_set_ui(irel2, 0, STD_RND);
 		} else {
-			readSTemp(0, &(arg1tmpX));
+			ShadowValue* arg2tmp = getTempLane(packedOpArgs->arg2, lane);
+			checkAndRecover(arg2tmp);
+			computeRelativeError(arg2tmp, irel2);
+			readPackedArg(1, lane, isFloat, arg2tmp, &arg2tmpX, &arg2midX, &arg2oriX);
+			if (arg2tmp) {
+				arg2opCount = arg2tmp->opCount;
+				arg2origin = arg2tmp->origin;
+				arg2canceled = arg2tmp->canceled;
+				arg2CancelOrigin = arg2tmp->cancelOrigin;
+			}
+		}
+
+		ShadowValue* res = setTempLane(packedOpArgs->wrTmp, lane);
+		if (clo_simulateOriginal) {
+			mpfr_set_prec(res->value, orgPrec);
+		}
+		mpfr_set_prec(res->midValue, orgPrec);
+		mpfr_set_prec(res->oriValue, orgPrec);
+
+		res->opCount = 1 + (arg1opCount > arg2opCount ? arg1opCount : arg2opCount);
+		res->origin = addr;
+
+		fpOps++;
+
+		if (needFix) {
 			mpfr_set(arg1midX, arg1tmpX, STD_RND);
-			beginEmulateDouble();
-			int t = mpfr_set(arg1oriX, arg1tmpX, STD_RND);
-			mpfr_subnormalize(arg1oriX, t, STD_RND);
-			endEmulate();
+			mpfr_set(arg2midX, arg2tmpX, STD_RND);
 		}
-	}
 
-	if (constArgs & 0x2) {
-		readSConst(1, &(arg2tmpX));
-		mpfr_set(arg2midX, arg2tmpX, STD_RND);
-		beginEmulateDouble();
-		int t = mpfr_set(arg2oriX, arg2tmpX, STD_RND);
-		mpfr_subnormalize(arg2oriX, t, STD_RND);
-		endEmulate();
-	} else {
-		ShadowValue* arg2tmp = getTemp(binOpArgs->arg2);
-		checkAndRecover(arg2tmp);
-		// VG_(umsg)("get %X\n", binOpArgs->arg2);
-		computeRelativeError(arg2tmp, irel2);
-		if (arg2tmp) {
-			// if (needFix) printErrorShort(arg2tmp);
-			// VG_(umsg)("have shadow 2\n");
-			mpfr_set(arg2tmpX, arg2tmp->value, STD_RND);
-			mpfr_set(arg2midX, arg2tmp->midValue, STD_RND);
-			beginEmulateDouble();
-			int t = mpfr_set(arg2oriX, arg2tmp->oriValue, STD_RND);
-			mpfr_subnormalize(arg2oriX, t, STD_RND);
-			endEmulate();
-			arg2opCount = arg2tmp->opCount;
-			arg2origin = arg2tmp->origin;
-			arg2canceled = arg2tmp->canceled;
-			arg2CancelOrigin = arg2tmp->cancelOrigin;
+		int tv;
+		switch (op) {
+			case Iop_Add32Fx4:
+			case Iop_Add64Fx2:
+				mpfr_add(res->value, arg1tmpX, arg2tmpX, STD_RND);
+				mpfr_add(res->midValue, arg1midX, arg2midX, STD_RND);
+				beginEmulateDouble();
+				tv = mpfr_add(res->oriValue, arg1oriX, arg2oriX, STD_RND);
+				mpfr_subnormalize(res->oriValue, tv, STD_RND);
+				endEmulate();
+				canceled = getCanceledBits(&(res->value), &(arg1tmpX), &(arg2tmpX));
+				break;
+			case Iop_Sub32Fx4:
+			case Iop_Sub64Fx2:
+				mpfr_sub(res->value, arg1tmpX, arg2tmpX, STD_RND);
+				mpfr_sub(res->midValue, arg1midX, arg2midX, STD_RND);
+				beginEmulateDouble();
+				tv = mpfr_sub(res->oriValue, arg1oriX, arg2oriX, STD_RND);
+				mpfr_subnormalize(res->oriValue, tv, STD_RND);
+				endEmulate();
+				canceled = getCanceledBits(&(res->value), &(arg1tmpX), &(arg2tmpX));
+				break;
+			case Iop_Mul32Fx4:
+			case Iop_Mul64Fx2:
+				mpfr_mul(res->value, arg1tmpX, arg2tmpX, STD_RND);
+				mpfr_mul(res->midValue, arg1midX, arg2midX, STD_RND);
+				beginEmulateDouble();
+				tv = mpfr_mul(res->oriValue, arg1oriX, arg2oriX, STD_RND);
+				mpfr_subnormalize(res->oriValue, tv, STD_RND);
+				endEmulate();
+				break;
+			case Iop_Div32Fx4:
+			case Iop_Div64Fx2:
+				mpfr_div(res->value, arg1tmpX, arg2tmpX, STD_RND);
+				mpfr_div(res->midValue, arg1midX, arg2midX, STD_RND);
+				beginEmulateDouble();
+				tv = mpfr_div(res->oriValue, arg1oriX, arg2oriX, STD_RND);
+				mpfr_subnormalize(res->oriValue, tv, STD_RND);
+				endEmulate();
+				break;
+			case Iop_Min32Fx4:
+			case Iop_Min64Fx2:
+				mpfr_min(res->value, arg1tmpX, arg2tmpX, STD_RND);
+				mpfr_min(res->midValue, arg1midX, arg2midX, STD_RND);
+				beginEmulateDouble();
+				tv = mpfr_min(res->oriValue, arg1oriX, arg2oriX, STD_RND);
+				mpfr_subnormalize(res->oriValue, tv, STD_RND);
+				endEmulate();
+				break;
+			case Iop_Max32Fx4:
+			case Iop_Max64Fx2:
+				mpfr_max(res->value, arg1tmpX, arg2tmpX, STD_RND);
+				mpfr_max(res->midValue, arg1midX, arg2midX, STD_RND);
+				beginEmulateDouble();
+				tv = mpfr_max(res->oriValue, arg1oriX, arg2oriX, STD_RND);
+				mpfr_subnormalize(res->oriValue, tv, STD_RND);
+				endEmulate();
+				break;
+			case Iop_Sqrt32Fx4:
+			case Iop_Sqrt64Fx2:
+				mpfr_sqrt(res->value, arg1tmpX, STD_RND);
+				mpfr_sqrt(res->midValue, arg1midX, STD_RND);
+				beginEmulateDouble();
+				tv = mpfr_sqrt(res->oriValue, arg1oriX, STD_RND);
+				mpfr_subnormalize(res->oriValue, tv, STD_RND);
+				endEmulate();
+				break;
+			default:
+				VG_(tool_panic)("Unhandled case in processPackedOp\n");
+				break;
+		}
 
-			if (clo_bad_cancellations) {
-				readSTemp(1, &cancelTemp);
-				if (mpfr_get_exp(cancelTemp) == mpfr_get_exp(arg2tmpX)) {
-					mpfr_sub(cancelTemp, arg2tmpX, cancelTemp, STD_RND);
-					if (mpfr_cmp_ui(cancelTemp, 0) != 0) {
-						exactBitsArg2 = abs(mpfr_get_exp(arg2tmpX) - mpfr_get_exp(cancelTemp)) - 2;
-						if (arg2tmp->orgType == Ot_FLOAT && exactBitsArg2 > 23) {
-							exactBitsArg2 = 23;
-						} else if (arg2tmp->orgType == Ot_DOUBLE && exactBitsArg2 > 52) {
-							exactBitsArg2 = 52;
-						}
-					}
-				} else {
-					exactBitsArg2 = 0;
-				}
-			}
+		mpfr_exp_t maxC = canceled;
+		Addr maxCorigin = addr;
+		if (arg1canceled > maxC) {
+			maxC = arg1canceled;
+			maxCorigin = arg1CancelOrigin;
+		}
+		if (arg2canceled > maxC) {
+			maxC = arg2canceled;
+			maxCorigin = arg2CancelOrigin;
+		}
+		res->canceled = maxC;
+		res->cancelOrigin = maxCorigin;
+		if (escalatePrecision(addr, canceled, arg1origin, arg2origin)) {
+			recomputeEscalated(res, op, &arg1tmpX, isUnary ? NULL : &arg2tmpX, NULL);
+		}
+		if (ladderCount > 0) {
+			computeLadder(addr, op, res, getTempLane(packedOpArgs->arg1, lane), &arg1tmpX,
+				isUnary ? NULL : getTempLane(packedOpArgs->arg2, lane), isUnary ? NULL : &arg2tmpX, NULL, NULL);
+		}
+		if (demoteCount > 0) {
+			computeDemoted(addr, op, res, getTempLane(packedOpArgs->arg1, lane), &arg1oriX,
+				isUnary ? NULL : getTempLane(packedOpArgs->arg2, lane), isUnary ? NULL : &arg2oriX, NULL, NULL);
+		}
+
+		if (isFloat) {
+			res->Org.fl = ((Float*)(sTmp[3]->U128))[lane];
+			res->orgType = Ot_FLOAT;
 		} else {
-			readSTemp(1, &(arg2tmpX));
-			mpfr_set(arg2midX, arg2tmpX, STD_RND);
-			beginEmulateDouble();
-			int t = mpfr_set(arg2oriX, arg2tmpX, STD_RND);
-			mpfr_subnormalize(arg2oriX, t, STD_RND);
-			endEmulate();
+			res->Org.db = ((Double*)(sTmp[3]->U128))[lane];
+			res->orgType = Ot_DOUBLE;
 		}
-	}
 
-	int tv, oritv;
-	// Char mpfrBuf[MPFR_BUFSIZE];
-	// mpfrToString(mpfrBuf, &arg1tmpX);
-	// VG_(umsg)("ARG1:         %s\n", mpfrBuf);
-	// mpfrToString(mpfrBuf, &arg2tmpX);
-	// VG_(umsg)("ARG2:         %s\n", mpfrBuf);
-	// VG_(umsg)("original cond %d\n", binOpArgs->orgInt);
-	IRExpr* lastBranchResult = NULL;
-	switch (binOpArgs->op) {
-		case Iop_CmpF64:
-			tv = mpfr_cmp(arg1tmpX, arg2tmpX);
-			oritv = mpfr_cmp(arg1oriX, arg2oriX);
-			if (tv != oritv) {
-				VG_(describe_IP)(addr, description, DESCRIPTION_SIZE);
-				VG_(umsg)("Change branch at %s\n", description);
-			}
-			if (tv > 0) {
-				return Ircr_GT;
-			} else if (tv == 0) {
-				return Ircr_EQ;
+		if (clo_computeMeanValue && !(constArgs & SATURATED_SITE)) {
+			/* all lanes of one instruction are accumulated under the same address */
+			if (isFloat) {
+				mpfr_set_flt(meanOrg, res->Org.fl, STD_RND);
 			} else {
-				return Ircr_LT;
+				mpfr_set_d(meanOrg, res->Org.db, STD_RND);
 			}
-			break;
-		default:
-			VG_(tool_panic)("Unhandled case in processCmpF64\n");
-			break;
+			updateMeanValue(addr, op, &(res->value), canceled, arg1origin, arg2origin, 0);
+			if (clo_condition) {
+				updatePackedConditionNumber(addr, op, lane, isUnary);
+			}
+		}
+
+		if (needFix) {
+			mpfr_set(res->value, res->midValue, STD_RND);
+		}
+		if (clo_detect_pso && !finishPSO) {
+			mpfr_max(irel1, irel1, irel2, STD_RND);
+			analyzePSO(irel1, res);
+		}
+		if (psoLaneCount > 0) {
+			computePSOLanes(addr, op, res, True, getTempLane(packedOpArgs->arg1, lane), &arg1tmpX,
+				isUnary ? NULL : getTempLane(packedOpArgs->arg2, lane), isUnary ? NULL : &arg2tmpX, NULL, NULL);
+		}
+		if (clo_print_every_error) {
+			printErrorShort(res);
+		}
 	}
 
-	return lastBranchResult;
+	mpfr_clears(irel1, irel2, NULL);
 }
 
-static void instrumentCmpF64(IRSB* sb, IRTypeEnv* env, Addr addr, IRTemp wrTemp, IRExpr* binop, Int arg1tmpInstead, Int arg2tmpInstead) {
-	tl_assert(binop->tag == Iex_Binop);
+static void instrumentPackedOp(IRSB* sb, IRTypeEnv* env, Addr addr, IRTemp wrTemp, IRExpr* expr, Int arg1tmpInstead, Int arg2tmpInstead) {
+	tl_assert(expr->tag == Iex_Unop || expr->tag == Iex_Binop);
 
 	if (clo_ignoreLibraries && isInLibrary(addr)) {
 		return;
 	}
+	if (!isSuspectSite(addr)) {
+		return;
+	}
 
-	IROp op = binop->Iex.Binop.op;
-	IRExpr* arg1 = binop->Iex.Binop.arg1;
-	IRExpr* arg2 = binop->Iex.Binop.arg2;
+	IROp op;
+	IRExpr* arg1;
+	IRExpr* arg2 = NULL;
+	Int constArgs = 0;
 
-	tl_assert(arg1->tag == Iex_RdTmp || arg1->tag == Iex_Const);
-	tl_assert(arg2->tag == Iex_RdTmp || arg2->tag == Iex_Const);
+	if (expr->tag == Iex_Unop) {
+		op = expr->Iex.Unop.op;
+		arg1 = expr->Iex.Unop.arg;
+		constArgs |= 0x8;
+	} else {
+		op = expr->Iex.Binop.op;
+		arg1 = expr->Iex.Binop.arg1;
+		arg2 = expr->Iex.Binop.arg2;
+	}
+	constArgs |= instrumentSiteCount(sb, addr, op, isOpFloat(op) ? 4 : 2);
 
-	Int constArgs = 0;
+	/* V128 constants are byte masks (mostly zero), there is nothing to shadow */
+	if (arg1->tag != Iex_RdTmp || (arg2 && arg2->tag != Iex_RdTmp)) {
+		return;
+	}
 
-	IRStmt* store = IRStmt_Store(Iend_LE, mkU64(&(binOpArgs->op)), mkU32(op));
+	IRStmt* store = IRStmt_Store(Iend_LE, mkU64(&(packedOpArgs->op)), mkU32(op));
+	addStmtToIRSB(sb, store);
+	store = IRStmt_Store(Iend_LE, mkU64(&(packedOpArgs->wrTmp)), mkU32(wrTemp));
 	addStmtToIRSB(sb, store);
 
-	if (arg1->tag == Iex_RdTmp) {
-		if (arg1tmpInstead >= 0) {
-			store = IRStmt_Store(Iend_LE, mkU64(&(binOpArgs->arg1)), mkU32(arg1tmpInstead));
-		} else {
-			store = IRStmt_Store(Iend_LE, mkU64(&(binOpArgs->arg1)), mkU32(arg1->Iex.RdTmp.tmp));
-		}
-		addStmtToIRSB(sb, store);
-
-		writeSTemp(sb, env, arg1->Iex.RdTmp.tmp, 0);
+	if (arg1tmpInstead >= 0) {
+		store = IRStmt_Store(Iend_LE, mkU64(&(packedOpArgs->arg1)), mkU32(arg1tmpInstead));
 	} else {
-		tl_assert(arg1->tag == Iex_Const);
-
-		writeSConst(sb, arg1->Iex.Const.con, 0);
-		constArgs |= 0x1;
+		store = IRStmt_Store(Iend_LE, mkU64(&(packedOpArgs->arg1)), mkU32(arg1->Iex.RdTmp.tmp));
 	}
-	if (arg2->tag == Iex_RdTmp) {
+	addStmtToIRSB(sb, store);
+	writeSTemp(sb, env, arg1->Iex.RdTmp.tmp, 0);
+
+	if (arg2) {
 		if (arg2tmpInstead >= 0) {
-			store = IRStmt_Store(Iend_LE, mkU64(&(binOpArgs->arg2)), mkU32(arg2tmpInstead));
+			store = IRStmt_Store(Iend_LE, mkU64(&(packedOpArgs->arg2)), mkU32(arg2tmpInstead));
 		} else {
-			store = IRStmt_Store(Iend_LE, mkU64(&(binOpArgs->arg2)), mkU32(arg2->Iex.RdTmp.tmp));
+			store = IRStmt_Store(Iend_LE, mkU64(&(packedOpArgs->arg2)), mkU32(arg2->Iex.RdTmp.tmp));
 		}
 		addStmtToIRSB(sb, store);
-
 		writeSTemp(sb, env, arg2->Iex.RdTmp.tmp, 1);
-	} else {
-		tl_assert(arg2->tag == Iex_Const);
-
-		writeSConst(sb, arg2->Iex.Const.con, 1);
-		constArgs |= 0x2;
 	}
 
+	writeSTemp(sb, env, wrTemp, 3);
+
 	IRExpr** argv = mkIRExprVec_2(mkU64(addr), mkU64(constArgs));
-	IRDirty* di = unsafeIRDirty_1_N(wrTemp, 2, "processCmpF64", VG_(fnptr_to_fnentry)(&processCmpF64), argv);
-	addStmtToIRSB(sb, IRStmt_Dirty(di));
+	IRDirty* di = unsafeIRDirty_0_N(2, "processPackedOp", VG_(fnptr_to_fnentry)(&processPackedOp), argv);
+	addHelperToIRSB(sb, di);
 }
 
-static Double processCvtOpKernel(Addr addr, UWord ca) {
+static VG_REGPARM(2) void processTriOp(Addr addr, UWord ca) {
+	if (!clo_analyze) return;
+
 	Int constArgs = (Int)ca;
+	if (clo_reassociation) {
+		updateReduction(addr, triOpArgs->op, 1, 2, constArgs, 
+			isOpFloat(triOpArgs->op) ? triOpArgs->orgFloat : triOpArgs->orgDouble);
+	}
+	selectPrecision(addr);
+	IROp op = triOpArgs->op;
+	/* the r32 variants operate on doubles but round the result to single precision */
+	Bool isR32 = (op == Iop_AddF64r32 || op == Iop_SubF64r32 || op == Iop_MulF64r32 || op == Iop_DivF64r32);
 
 	if (clo_simulateOriginal) {
-		if (isOpFloat(binOpArgs->op)) {
+		if (isOpFloat(op)) {
 			mpfr_set_prec(arg2tmpX, 24);
+			mpfr_set_prec(arg3tmpX, 24);
 		} else {
 			mpfr_set_prec(arg2tmpX, 53);
+			mpfr_set_prec(arg3tmpX, 53);
 		}
 	}
 
-	if (isOpFloat(binOpArgs->op)) {
+	if (isOpFloat(op)) {
 		mpfr_set_prec(arg2midX, 24);
+		mpfr_set_prec(arg3midX, 24);
 		mpfr_set_prec(arg2oriX, 24);
+		mpfr_set_prec(arg3oriX, 24);
 	} else {
 		mpfr_set_prec(arg2midX, 53);
+		mpfr_set_prec(arg3midX, 53);
 		mpfr_set_prec(arg2oriX, 53);
+		mpfr_set_prec(arg3oriX, 53);
 	}
 
 	ULong arg2opCount = 0;
+	ULong arg3opCount = 0;
 	Addr arg2origin = 0;
+	Addr arg3origin = 0;
 	mpfr_exp_t arg2canceled = 0;
+	mpfr_exp_t arg3canceled = 0;
 	mpfr_exp_t canceled = 0;
 	Addr arg2CancelOrigin = 0;
-	mpfr_t irel2;
-	mpfr_inits(irel2, NULL);
+	Addr arg3CancelOrigin = 0;
+	mpfr_t irel2, irel3;
+	mpfr_inits(irel2, irel3, NULL);
 
-	Int exactBitsArg1, exactBitsArg2;
-	if (isOpFloat(binOpArgs->op)) {
+	Int exactBitsArg2, exactBitsArg3;
+	if (isOpFloat(op)) {
 		exactBitsArg2 = 23;
+		exactBitsArg3 = 23;
 	} else {
 		exactBitsArg2 = 52;
+		exactBitsArg3 = 52;
 	}
 
 	if (constArgs & 0x2) {
@@ -2364,7 +4755,7 @@ static Double processCvtOpKernel(Addr addr, UWord ca) {
 		mpfr_subnormalize(arg2oriX, t, STD_RND);
 		endEmulate();
 	} else {
-		ShadowValue* arg2tmp = getTemp(binOpArgs->arg2);
+		ShadowValue* arg2tmp = getTemp(triOpArgs->arg2);
 		checkAndRecover(arg2tmp);
 		computeRelativeError(arg2tmp, irel2);
 		if (arg2tmp) {
@@ -2405,1010 +4796,3349 @@ static Double processCvtOpKernel(Addr addr, UWord ca) {
 		}
 	}
 
-	return mpfr_get_d(arg2tmpX, STD_RND);
-}
-
-static VG_REGPARM(2) UInt processCvtI32U(Addr addr, UWord ca) {
-	if (!clo_analyze) return;
-	Double shadow_double = processCvtOpKernel(addr, ca);
-	return shadow_double;
-}
-
-static VG_REGPARM(2) Int processCvtI32S(Addr addr, UWord ca) {
-	if (!clo_analyze) return;
-	Double shadow_double = processCvtOpKernel(addr, ca);
-	return shadow_double;
-}
-
-static VG_REGPARM(2) ULong processCvtI64U(Addr addr, UWord ca) {
-	if (!clo_analyze) return;
-	Double shadow_double = processCvtOpKernel(addr, ca);
-	return shadow_double;
-}
-
-static VG_REGPARM(2) Long processCvtI64S(Addr addr, UWord ca) {
-	if (!clo_analyze) return;
-	Double shadow_double = processCvtOpKernel(addr, ca);
-	return shadow_double;
-}
-
-static VG_REGPARM(2) Short processCvtI16S(Addr addr, UWord ca) {
-	if (!clo_analyze) return;
-	Double shadow_double = processCvtOpKernel(addr, ca);
-	return shadow_double;
-}
-
-static void instrumentCvtOp (IRSB* sb, IRTypeEnv* env, Addr addr, IRTemp wrTemp, IRExpr* binop, Int arg2tmpInstead, RetType retType) {
-	tl_assert(binop->tag == Iex_Binop);
+	if (constArgs & 0x4) {
+		readSConst(2, &(arg3tmpX));
+		mpfr_set(arg3midX, arg3tmpX, STD_RND);
+		beginEmulateDouble();
+		int t = mpfr_set(arg3oriX, arg3tmpX, STD_RND);
+		mpfr_subnormalize(arg3oriX, t, STD_RND);
+		endEmulate();
+	} else {
+		ShadowValue* arg3tmp = getTemp(triOpArgs->arg3);
+		checkAndRecover(arg3tmp);
+		computeRelativeError(arg3tmp, irel3);
+		if (arg3tmp) {
+			mpfr_set(arg3tmpX, arg3tmp->value, STD_RND);
+			mpfr_set(arg3midX, arg3tmp->midValue, STD_RND);
+			beginEmulateDouble();
+			int t = mpfr_set(arg3oriX, arg3tmp->oriValue, STD_RND);
+			mpfr_subnormalize(arg3oriX, t, STD_RND);
+			endEmulate();
+			arg3opCount = arg3tmp->opCount;
+			arg3origin = arg3tmp->origin;
+			arg3canceled = arg3tmp->canceled;
+			arg3CancelOrigin = arg3tmp->cancelOrigin;
 
-	if (clo_ignoreLibraries && isInLibrary(addr)) {
-		return;
+			if (clo_bad_cancellations) {
+				readSTemp(2, &cancelTemp);
+				if (mpfr_get_exp(cancelTemp) == mpfr_get_exp(arg3tmpX)) {
+					mpfr_sub(cancelTemp, arg3tmpX, cancelTemp, STD_RND);
+					if (mpfr_cmp_ui(cancelTemp, 0) != 0) {
+						exactBitsArg3 = abs(mpfr_get_exp(arg3tmpX) - mpfr_get_exp(cancelTemp)) - 2;
+						if (arg3tmp->orgType == Ot_FLOAT && exactBitsArg3 > 23) {
+							exactBitsArg3 = 23;
+						} else if (arg3tmp->orgType == Ot_DOUBLE && exactBitsArg3 > 52) {
+							exactBitsArg3 = 52;
+						}
+					}
+				} else {
+					exactBitsArg3 = 0;
+				}
+			}
+		} else {
+			readSTemp(2, &(arg3tmpX));
+			mpfr_set(arg3midX, arg3tmpX, STD_RND);
+			beginEmulateDouble();
+			int t = mpfr_set(arg3oriX, arg3tmpX, STD_RND);
+			mpfr_subnormalize(arg3oriX, t, STD_RND);
+			endEmulate();
+		}
 	}
 
-	IROp op = binop->Iex.Binop.op;
-	IRExpr* arg2 = binop->Iex.Binop.arg2;
-
-	tl_assert(arg2->tag == Iex_RdTmp || arg2->tag == Iex_Const);
-
-	Int constArgs = 0;
-
-	IRStmt* store = IRStmt_Store(Iend_LE, mkU64(&(binOpArgs->op)), mkU32(op));
-	addStmtToIRSB(sb, store);
-
-	if (arg2->tag == Iex_RdTmp) {
-		if (arg2tmpInstead >= 0) {
-			store = IRStmt_Store(Iend_LE, mkU64(&(binOpArgs->arg2)), mkU32(arg2tmpInstead));
+	ShadowValue* res = setTemp(triOpArgs->wrTmp);
+	if (clo_simulateOriginal) {
+		if (isOpFloat(op) || isR32) {
+			mpfr_set_prec(res->value, 24);
 		} else {
-			store = IRStmt_Store(Iend_LE, mkU64(&(binOpArgs->arg2)), mkU32(arg2->Iex.RdTmp.tmp));
+			mpfr_set_prec(res->value, 53);
 		}
-		addStmtToIRSB(sb, store);
+	}
 
-		writeSTemp(sb, env, arg2->Iex.RdTmp.tmp, 1);
+	if (isOpFloat(op) || isR32) {
+		mpfr_set_prec(res->midValue, 24);
+		mpfr_set_prec(res->oriValue, 24);
 	} else {
-		tl_assert(arg2->tag == Iex_Const);
+		mpfr_set_prec(res->midValue, 53);
+		mpfr_set_prec(res->oriValue, 53);
+	}
 
-		writeSConst(sb, arg2->Iex.Const.con, 1);
-		constArgs |= 0x2;
+	res->opCount = 1;
+	if (arg2opCount > arg3opCount) {
+		res->opCount += arg2opCount;
+	} else {
+		res->opCount += arg3opCount;
 	}
+	res->origin = addr;
 
-	IRExpr** argv = mkIRExprVec_2(mkU64(addr), mkU64(constArgs));
-	IRDirty* di;
-	switch(retType) {
-		case Rt_I16S:
-			di = unsafeIRDirty_1_N(wrTemp, 2, "processCvtI16S", VG_(fnptr_to_fnentry)(&processCvtI16S), argv);
+	fpOps++;
+
+	Bool needFix = clo_detect_pso && VG_(HT_lookup)(detectedPSO, addr) != NULL;
+	if (needFix) {
+		mpfr_set(arg2midX, arg2tmpX, STD_RND);
+		mpfr_set(arg3midX, arg3tmpX, STD_RND);
+	}
+
+	int tv;
+	switch (op) {
+		case Iop_AddF64:
+		case Iop_AddF32:
+		case Iop_AddF64r32:
+			mpfr_add(res->value, arg2tmpX, arg3tmpX, STD_RND);
+			mpfr_add(res->midValue, arg2midX, arg3midX, STD_RND);
+			beginEmulateDouble();
+			tv = mpfr_add(res->oriValue, arg2oriX, arg3oriX, STD_RND);
+			mpfr_subnormalize(res->oriValue, tv, STD_RND);
+			endEmulate();
+			canceled = getCanceledBits(&(res->value), &(arg2tmpX), &(arg3tmpX));
 			break;
-		case Rt_I32S:
-			di = unsafeIRDirty_1_N(wrTemp, 2, "processCvtI32S", VG_(fnptr_to_fnentry)(&processCvtI32S), argv);
+		case Iop_SubF64:
+		case Iop_SubF32:
+		case Iop_SubF64r32:
+			mpfr_sub(res->value, arg2tmpX, arg3tmpX, STD_RND);
+			mpfr_sub(res->midValue, arg2midX, arg3midX, STD_RND);
+			beginEmulateDouble();
+			tv = mpfr_sub(res->oriValue, arg2oriX, arg3oriX, STD_RND);
+			mpfr_subnormalize(res->oriValue, tv, STD_RND);
+			endEmulate();
+			canceled = getCanceledBits(&(res->value), &(arg2tmpX), &(arg3tmpX));
 			break;
-		case Rt_I64S:
-			di = unsafeIRDirty_1_N(wrTemp, 2, "processCvtI64S", VG_(fnptr_to_fnentry)(&processCvtI64S), argv);
+		case Iop_MulF64:
+		case Iop_MulF32:
+		case Iop_MulF64r32:
+			mpfr_mul(res->value, arg2tmpX, arg3tmpX, STD_RND);
+			mpfr_mul(res->midValue, arg2midX, arg3midX, STD_RND);
+			beginEmulateDouble();
+			tv = mpfr_mul(res->oriValue, arg2oriX, arg3oriX, STD_RND);
+			mpfr_subnormalize(res->oriValue, tv, STD_RND);
+			endEmulate();
 			break;
-		case Rt_I32U:
-			di = unsafeIRDirty_1_N(wrTemp, 2, "processCvtI32U", VG_(fnptr_to_fnentry)(&processCvtI32U), argv);
+		case Iop_DivF64:
+		case Iop_DivF32:
+		case Iop_DivF64r32:
+			mpfr_div(res->value, arg2tmpX, arg3tmpX, STD_RND);
+			mpfr_div(res->midValue, arg2midX, arg3midX, STD_RND);
+			beginEmulateDouble();
+			tv = mpfr_div(res->oriValue, arg2oriX, arg3oriX, STD_RND);
+			mpfr_subnormalize(res->oriValue, tv, STD_RND);
+			endEmulate();
 			break;
-		case Rt_I64U:
-			di = unsafeIRDirty_1_N(wrTemp, 2, "processCvtI64U", VG_(fnptr_to_fnentry)(&processCvtI64U), argv);
+		case Iop_AtanF64:
+			/* arctan(arg2 / arg3) */
+			mpfr_atan2(res->value, arg2tmpX, arg3tmpX, STD_RND);
+			mpfr_atan2(res->midValue, arg2midX, arg3midX, STD_RND);
+			beginEmulateDouble();
+			tv = mpfr_atan2(res->oriValue, arg2oriX, arg3oriX, STD_RND);
+			mpfr_subnormalize(res->oriValue, tv, STD_RND);
+			endEmulate();
+			break;
+		case Iop_Yl2xF64:
+		case Iop_Yl2xp1F64:
+			/* arg2 * log2(arg3) or arg2 * log2(arg3 + 1.0) */
+			computeYl2x(res->value, arg2tmpX, arg3tmpX, op == Iop_Yl2xp1F64);
+			computeYl2x(res->midValue, arg2midX, arg3midX, op == Iop_Yl2xp1F64);
+			beginEmulateDouble();
+			tv = computeYl2x(res->oriValue, arg2oriX, arg3oriX, op == Iop_Yl2xp1F64);
+			mpfr_subnormalize(res->oriValue, tv, STD_RND);
+			endEmulate();
+			break;
+		case Iop_PRemF64:
+			/* FPREM truncates the quotient */
+			mpfr_fmod(res->value, arg2tmpX, arg3tmpX, STD_RND);
+			mpfr_fmod(res->midValue, arg2midX, arg3midX, STD_RND);
+			beginEmulateDouble();
+			tv = mpfr_fmod(res->oriValue, arg2oriX, arg3oriX, STD_RND);
+			mpfr_subnormalize(res->oriValue, tv, STD_RND);
+			endEmulate();
+			break;
+		case Iop_PRem1F64:
+			/* FPREM1 rounds the quotient to nearest (IEEE remainder) */
+			mpfr_remainder(res->value, arg2tmpX, arg3tmpX, STD_RND);
+			mpfr_remainder(res->midValue, arg2midX, arg3midX, STD_RND);
+			beginEmulateDouble();
+			tv = mpfr_remainder(res->oriValue, arg2oriX, arg3oriX, STD_RND);
+			mpfr_subnormalize(res->oriValue, tv, STD_RND);
+			endEmulate();
+			break;
+		case Iop_ScaleF64:
+			/* arg2 * 2^trunc(arg3) */
+			computeScale(res->value, arg2tmpX, arg3tmpX);
+			computeScale(res->midValue, arg2midX, arg3midX);
+			beginEmulateDouble();
+			tv = computeScale(res->oriValue, arg2oriX, arg3oriX);
+			mpfr_subnormalize(res->oriValue, tv, STD_RND);
+			endEmulate();
 			break;
 		default:
-			VG_(tool_panic)("Should not reach here\n");
+			VG_(tool_panic)("Unhandled case in processTriOp");
+			break;
 	}
-	
-	addStmtToIRSB(sb, IRStmt_Dirty(di));
-}
 
-static VG_REGPARM(1) void processMux0X(UWord ca) {
-	// VG_(umsg)("processMux0X\n");
-	if (!clo_analyze) return;
+	if (needFix) {
+		mpfr_set(res->value, res->midValue, STD_RND);
+	}
 
-	Int constArgs = (Int)ca;
-	ShadowValue *aexpr0 = NULL;
-	ShadowValue *aexprX = NULL;
+	mpfr_exp_t maxC = canceled;
+	Addr maxCorigin = addr;
+	if (arg2canceled > maxC) {
+		maxC = arg2canceled;
+		maxCorigin = arg2CancelOrigin;
+	}
+	if (arg3canceled > maxC) {
+		maxC = arg3canceled;
+		maxCorigin = arg3CancelOrigin;
+	}
+	res->canceled = maxC;
+	res->cancelOrigin = maxCorigin;
+	if (escalatePrecision(addr, canceled, arg2origin, arg3origin)) {
+		recomputeEscalated(res, triOpArgs->op, &arg2tmpX, &arg3tmpX, NULL);
+	}
+	if (ladderCount > 0) {
+		computeLadder(addr, triOpArgs->op, res, (constArgs & 0x2) ? NULL : getTemp(triOpArgs->arg2), &arg2tmpX,
+			(constArgs & 0x4) ? NULL : getTemp(triOpArgs->arg3), &arg3tmpX, NULL, NULL);
+	}
+	if (demoteCount > 0) {
+		computeDemoted(addr, triOpArgs->op, res, (constArgs & 0x2) ? NULL : getTemp(triOpArgs->arg2), &arg2oriX,
+			(constArgs & 0x4) ? NULL : getTemp(triOpArgs->arg3), &arg3oriX, NULL, NULL);
+	}
 
-	if (constArgs & 0x2) {
-		if (!muxArgs->condVal) {
-			return;
-		}
-	} else {
-		aexpr0 = getTemp(muxArgs->expr0);
-		if (!aexpr0 && !muxArgs->condVal) {
-			return;
+	if (clo_computeMeanValue && !(constArgs & SATURATED_SITE)) {
+		UInt cancellationBadness = 0;
+		if (clo_bad_cancellations && canceled > 0) {
+			Int exactBits = exactBitsArg2 < exactBitsArg3 ? exactBitsArg2 : exactBitsArg3;
+			if (canceled > exactBits) {
+				cancellationBadness = canceled - exactBits;
+			}
 		}
-	}
 
-	if (constArgs & 0x4) {
-		if (muxArgs->condVal) {
-			return;
+		if (isOpFloat(op)) {
+			mpfr_set_flt(meanOrg, triOpArgs->orgFloat, STD_RND);
+		} else {
+			mpfr_set_d(meanOrg, triOpArgs->orgDouble, STD_RND);
 		}
-	} else {
-		aexprX = getTemp(muxArgs->exprX);
-		if (!aexprX && muxArgs->condVal) {
-			return;
+		updateMeanValue(addr, op, &(res->value), canceled, arg2origin, arg3origin, cancellationBadness);
+		if (clo_condition) {
+			updateConditionNumber(addr, op, 1, 2, constArgs, isOpFloat(op) ? triOpArgs->orgFloat : triOpArgs->orgDouble);
 		}
 	}
 
-	ShadowValue* res = setTemp(muxArgs->wrTmp);
-	// VG_(umsg)("processMux0X %X\n", muxArgs->wrTmp);
-	if (muxArgs->condVal) {
-		copyShadowValue(res, aexprX);
+	if (isOpFloat(op)) {
+		res->Org.fl = triOpArgs->orgFloat;
+		res->orgType = Ot_FLOAT;
 	} else {
-		copyShadowValue(res, aexpr0);
+		res->Org.db = triOpArgs->orgDouble;
+		res->orgType = Ot_DOUBLE;
+	}
+	if (clo_detect_pso && !finishPSO) {
+		mpfr_max(irel2, irel2, irel3, STD_RND);
+		analyzePSO(irel2, res);
+	}
+	if (psoLaneCount > 0) {
+		computePSOLanes(addr, op, res, True, (constArgs & 0x2) ? NULL : getTemp(triOpArgs->arg2), &arg2tmpX,
+			(constArgs & 0x4) ? NULL : getTemp(triOpArgs->arg3), &arg3tmpX, NULL, NULL);
+	}
+	if (clo_print_every_error) {
+		printErrorShort(res);
 	}
 }
 
-static void instrumentMux0X(IRSB* sb, IRTypeEnv* env, IRTemp wrTemp, IRExpr* mux, Int arg0tmpInstead, Int argXtmpInstead) {
-	tl_assert(mux->tag == Iex_Mux0X);
-
-	IRExpr* cond = mux->Iex.Mux0X.cond;
-	IRExpr* expr0 = mux->Iex.Mux0X.expr0;
-	IRExpr* exprX = mux->Iex.Mux0X.exprX;
+static void instrumentTriOp(IRSB* sb, IRTypeEnv* env, Addr addr, IRTemp wrTemp, IRExpr* triop, Int arg2tmpInstead, Int arg3tmpInstead) {
+	tl_assert(triop->tag == Iex_Triop);
 
-	tl_assert(cond->tag == Iex_RdTmp);
-	tl_assert(expr0->tag == Iex_RdTmp || expr0->tag == Iex_Const);
-	tl_assert(exprX->tag == Iex_RdTmp || exprX->tag == Iex_Const);
+	if (clo_ignoreLibraries && isInLibrary(addr)) {
+		return;
+	}
+	if (!isSuspectSite(addr)) {
+		return;
+	}
+	Int saturated = instrumentSiteCount(sb, addr, triop->Iex.Triop.op, 1);
 
-	Int constArgs = 0;
-	IRStmt* store = IRStmt_Store(Iend_LE, mkU64(&(muxArgs->wrTmp)), mkU32(wrTemp));
+	IROp op = triop->Iex.Triop.op;
+	IRExpr* arg1 = triop->Iex.Triop.arg1;
+	IRExpr* arg2 = triop->Iex.Triop.arg2;
+	IRExpr* arg3 = triop->Iex.Triop.arg3;
+
+	tl_assert(arg1->tag == Iex_Const);
+	tl_assert(arg2->tag == Iex_RdTmp || arg2->tag == Iex_Const);
+	tl_assert(arg3->tag == Iex_RdTmp || arg3->tag == Iex_Const);
+
+	Int constArgs = saturated;
+
+	IRStmt* store = IRStmt_Store(Iend_LE, mkU64(&(triOpArgs->op)), mkU32(op));
 	addStmtToIRSB(sb, store);
-	store = IRStmt_Store(Iend_LE, mkU64(&(muxArgs->condVal)), mux->Iex.Mux0X.cond);
+	store = IRStmt_Store(Iend_LE, mkU64(&(triOpArgs->wrTmp)), mkU32(wrTemp));
 	addStmtToIRSB(sb, store);
 
-	if (expr0->tag == Iex_RdTmp) {
-		if (arg0tmpInstead >= 0) {
-			store = IRStmt_Store(Iend_LE, mkU64(&(muxArgs->expr0)), mkU32(arg0tmpInstead));
+	/* arg1 is ignored because it only contains the rounding mode for 
+	   the operations instructed at the moment */
+
+	if (arg2->tag == Iex_RdTmp) {
+		if (arg2tmpInstead >= 0) {
+			store = IRStmt_Store(Iend_LE, mkU64(&(triOpArgs->arg2)), mkU32(arg2tmpInstead));
 		} else {
-			store = IRStmt_Store(Iend_LE, mkU64(&(muxArgs->expr0)), mkU32(mux->Iex.Mux0X.expr0->Iex.RdTmp.tmp));
+			store = IRStmt_Store(Iend_LE, mkU64(&(triOpArgs->arg2)), mkU32(triop->Iex.Triop.arg2->Iex.RdTmp.tmp));
 		}
 		addStmtToIRSB(sb, store);
+		writeSTemp(sb, env, triop->Iex.Triop.arg2->Iex.RdTmp.tmp, 1);
 	} else {
+		tl_assert(arg2->tag == Iex_Const);
+		writeSConst(sb, arg2->Iex.Const.con, 1);
 		constArgs |= 0x2;
 	}
 
-	if (exprX->tag == Iex_RdTmp) {
-		if (argXtmpInstead >= 0) {
-			store = IRStmt_Store(Iend_LE, mkU64(&(muxArgs->exprX)), mkU32(argXtmpInstead));
+	if (arg3->tag == Iex_RdTmp) {
+		if (arg3tmpInstead >= 0) {
+			store = IRStmt_Store(Iend_LE, mkU64(&(triOpArgs->arg3)), mkU32(arg3tmpInstead));
 		} else {
-			store = IRStmt_Store(Iend_LE, mkU64(&(muxArgs->exprX)), mkU32(mux->Iex.Mux0X.exprX->Iex.RdTmp.tmp));
+			store = IRStmt_Store(Iend_LE, mkU64(&(triOpArgs->arg3)), mkU32(triop->Iex.Triop.arg3->Iex.RdTmp.tmp));
 		}
 		addStmtToIRSB(sb, store);
+		writeSTemp(sb, env, triop->Iex.Triop.arg3->Iex.RdTmp.tmp, 2);
 	} else {
+		tl_assert(arg3->tag == Iex_Const);
+		writeSConst(sb, arg3->Iex.Const.con, 2);
 		constArgs |= 0x4;
 	}
 
-	IRExpr** argv = mkIRExprVec_1(mkU64(constArgs));
-	IRDirty* di = unsafeIRDirty_0_N(1, "processMux0X", VG_(fnptr_to_fnentry)(&processMux0X), argv);
-	addStmtToIRSB(sb, IRStmt_Dirty(di));
+	if (typeOfIRTemp(env, wrTemp) == Ity_F32) {
+		store = IRStmt_Store(Iend_LE, mkU64(&(triOpArgs->orgFloat)), IRExpr_RdTmp(wrTemp));
+	} else {
+		store = IRStmt_Store(Iend_LE, mkU64(&(triOpArgs->orgDouble)), IRExpr_RdTmp(wrTemp));
+	}
+	addStmtToIRSB(sb, store);
+
+	IRExpr** argv = mkIRExprVec_2(mkU64(addr), mkU64(constArgs));
+	IRDirty* di = unsafeIRDirty_0_N(2, "processTriOp", VG_(fnptr_to_fnentry)(&processTriOp), argv);
+	addHelperToIRSB(sb, di);
 }
 
-static VG_REGPARM(2) void processLoad(UWord tmp, Addr addr) {
-	if (!clo_analyze) return;
+static ShadowValue* readQopArg(Int num, Bool isConst, IRTemp tmp, mpfr_t* tmpX, mpfr_t* midX, mpfr_t* oriX, mpfr_t irel, Int* exactBits) {
+	ShadowValue* sv = NULL;
+	int t;
 
-	/* check if this memory address is shadowed */
-	ShadowValue* av = VG_(HT_lookup)(globalMemory, addr);
-	if (!av || !(av->active)) {
-		return;
+	if (isConst) {
+		readSConst(num, tmpX);
+		mpfr_set_ui(irel, 0, STD_RND);
+	} else {
+		sv = getTemp(tmp);
+		checkAndRecover(sv);
+		computeRelativeError(sv, irel);
 	}
-	// VG_(umsg)("processLoad %X\n", tmp);
-	// VG_(umsg)("load address: %lX\n", addr);
-	ShadowValue* res = setTemp(tmp);
-	copyShadowValue(res, av);
-	// VG_(umsg)("av\n");
-	// printErrorShort(av);
-	// VG_(umsg)("res\n");
-	// printErrorShort(res);
-}
 
-static void instrumentLoad(IRSB* sb, IRTypeEnv* env, IRStmt* wrTmp) {
-	tl_assert(wrTmp->tag == Ist_WrTmp);
-	tl_assert(wrTmp->Ist.WrTmp.data->tag == Iex_Load);
-	IRExpr* load = wrTmp->Ist.WrTmp.data;
+	if (sv) {
+		mpfr_set(*tmpX, sv->value, STD_RND);
+		mpfr_set(*midX, sv->midValue, STD_RND);
+		beginEmulateDouble();
+		t = mpfr_set(*oriX, sv->oriValue, STD_RND);
+		mpfr_subnormalize(*oriX, t, STD_RND);
+		endEmulate();
 
-	if (load->Iex.Load.addr->tag != Iex_RdTmp) {
-		return;
+		if (clo_bad_cancellations) {
+			readSTemp(num, &cancelTemp);
+			if (mpfr_get_exp(cancelTemp) == mpfr_get_exp(*tmpX)) {
+				mpfr_sub(cancelTemp, *tmpX, cancelTemp, STD_RND);
+				if (mpfr_cmp_ui(cancelTemp, 0) != 0) {
+					*exactBits = abs(mpfr_get_exp(*tmpX) - mpfr_get_exp(cancelTemp)) - 2;
+					if (*exactBits > 52) {
+						*exactBits = 52;
+					}
+				}
+			} else {
+				*exactBits = 0;
+			}
+		}
+	} else {
+		if (!isConst) {
+			readSTemp(num, tmpX);
+		}
+		mpfr_set(*midX, *tmpX, STD_RND);
+		beginEmulateDouble();
+		t = mpfr_set(*oriX, *tmpX, STD_RND);
+		mpfr_subnormalize(*oriX, t, STD_RND);
+		endEmulate();
 	}
-	
-	IRExpr** argv = mkIRExprVec_2(mkU64(wrTmp->Ist.WrTmp.tmp), load->Iex.Load.addr);
-	IRDirty* di = unsafeIRDirty_0_N(2, "processLoad", VG_(fnptr_to_fnentry)(&processLoad), argv);
-	addStmtToIRSB(sb, IRStmt_Dirty(di));
+	return sv;
 }
 
-static VG_REGPARM(3) void processStore(Addr addr, UWord t, UWord isFloat) {
-	// VG_(umsg)("processStore\n");
-	Int tmp = (Int)t;
-	ShadowValue* res = NULL;
-	ShadowValue* currentVal = VG_(HT_lookup)(globalMemory, addr);
+/* Fused multiply-add: arg2 * arg3 + arg4 (or - arg4) with a single rounding. 
+   The r32 variants round the result to single precision. */
+static VG_REGPARM(2) void processQop(Addr addr, UWord ca) {
+	if (!clo_analyze) return;
 
-	if (clo_analyze && tmp >= 0) {
-		/* check if this memory address is shadowed */
-		ShadowValue* av = getTemp(tmp);
-		// VG_(umsg)("processStore %X\n", tmp);
-		// VG_(umsg)("Store address: %lX\n", addr);
-		// Addr lastAddr = addr - 4;
+	Int constArgs = (Int)ca;
+	selectPrecision(addr);
+	IROp op = quadOpArgs->op;
+	Bool isR32 = (op == Iop_MAddF64r32 || op == Iop_MSubF64r32);
+	Bool needFix = clo_detect_pso && VG_(HT_lookup)(detectedPSO, addr) != NULL;
 
-		if (av) {
-			// VG_(umsg)("processStore2 %X\n", tmp);
-			if (currentVal) {
-				res = currentVal;
-				copyShadowValue(res, av);
-				res->active = True;
-			} else {
-				res = initShadowValue((UWord)addr);
-				copyShadowValue(res, av);
-				VG_(HT_add_node)(globalMemory, res);
-				// VG_(umsg)("processStore create\n");
-			}
+	if (clo_simulateOriginal) {
+		mpfr_set_prec(arg2tmpX, 53);
+		mpfr_set_prec(arg3tmpX, 53);
+		mpfr_set_prec(arg4tmpX, 53);
+	}
+	mpfr_set_prec(arg2midX, 53);
+	mpfr_set_prec(arg3midX, 53);
+	mpfr_set_prec(arg4midX, 53);
+	mpfr_set_prec(arg2oriX, 53);
+	mpfr_set_prec(arg3oriX, 53);
+	mpfr_set_prec(arg4oriX, 53);
+
+	mpfr_t irel2, irel3, irel4;
+	mpfr_inits(irel2, irel3, irel4, NULL);
+	Int exactBitsArg2 = 52;
+	Int exactBitsArg3 = 52;
+	Int exactBitsArg4 = 52;
+
+	ShadowValue* arg2tmp = readQopArg(1, constArgs & 0x2, quadOpArgs->arg2, &arg2tmpX, &arg2midX, &arg2oriX, irel2, &exactBitsArg2);
+	ShadowValue* arg3tmp = readQopArg(2, constArgs & 0x4, quadOpArgs->arg3, &arg3tmpX, &arg3midX, &arg3oriX, irel3, &exactBitsArg3);
+	ShadowValue* arg4tmp = readQopArg(3, constArgs & 0x8, quadOpArgs->arg4, &arg4tmpX, &arg4midX, &arg4oriX, irel4, &exactBitsArg4);
+
+	ShadowValue* res = setTemp(quadOpArgs->wrTmp);
+	if (clo_simulateOriginal) {
+		mpfr_set_prec(res->value, isR32 ? 24 : 53);
+	}
+	mpfr_set_prec(res->midValue, isR32 ? 24 : 53);
+	mpfr_set_prec(res->oriValue, isR32 ? 24 : 53);
+
+	res->opCount = 0;
+	res->canceled = 0;
+	res->cancelOrigin = addr;
+	if (arg2tmp) {
+		res->opCount = arg2tmp->opCount;
+		res->canceled = arg2tmp->canceled;
+		res->cancelOrigin = arg2tmp->cancelOrigin;
+	}
+	if (arg3tmp) {
+		if (arg3tmp->opCount > res->opCount) res->opCount = arg3tmp->opCount;
+		if (arg3tmp->canceled > res->canceled) {
+			res->canceled = arg3tmp->canceled;
+			res->cancelOrigin = arg3tmp->cancelOrigin;
+		}
+	}
+	if (arg4tmp) {
+		if (arg4tmp->opCount > res->opCount) res->opCount = arg4tmp->opCount;
+		if (arg4tmp->canceled > res->canceled) {
+			res->canceled = arg4tmp->canceled;
+			res->cancelOrigin = arg4tmp->cancelOrigin;
+		}
+	}
+	res->opCount += 1;
+	res->origin = addr;
 
-			if ((Bool)isFloat) {
-				res->orgType = Ot_FLOAT;
-			} else {
-				res->orgType = Ot_DOUBLE;
-			}
-			if (res->orgType == Ot_FLOAT) {
-				res->Org.fl = storeArgs->orgFloat;
-			} else if (res->orgType == Ot_DOUBLE) {
-				res->Org.db = storeArgs->orgDouble;
-			} else {
-				tl_assert(False);
+	fpOps++;
+
+	if (needFix) {
+		mpfr_set(arg2midX, arg2tmpX, STD_RND);
+		mpfr_set(arg3midX, arg3tmpX, STD_RND);
+		mpfr_set(arg4midX, arg4tmpX, STD_RND);
+	}
+
+	int tv;
+	switch (op) {
+		case Iop_MAddF64:
+		case Iop_MAddF64r32:
+			mpfr_fma(res->value, arg2tmpX, arg3tmpX, arg4tmpX, STD_RND);
+			mpfr_fma(res->midValue, arg2midX, arg3midX, arg4midX, STD_RND);
+			beginEmulateDouble();
+			tv = mpfr_fma(res->oriValue, arg2oriX, arg3oriX, arg4oriX, STD_RND);
+			mpfr_subnormalize(res->oriValue, tv, STD_RND);
+			endEmulate();
+			break;
+		case Iop_MSubF64:
+		case Iop_MSubF64r32:
+			mpfr_fms(res->value, arg2tmpX, arg3tmpX, arg4tmpX, STD_RND);
+			mpfr_fms(res->midValue, arg2midX, arg3midX, arg4midX, STD_RND);
+			beginEmulateDouble();
+			tv = mpfr_fms(res->oriValue, arg2oriX, arg3oriX, arg4oriX, STD_RND);
+			mpfr_subnormalize(res->oriValue, tv, STD_RND);
+			endEmulate();
+			break;
+		default:
+			VG_(tool_panic)("Unhandled case in processQop");
+			break;
+	}
+
+	/* cancellation happens in the add stage, between the exact product and the addend */
+	mpfr_set_prec(qopProduct, mpfr_get_prec(arg2tmpX) + mpfr_get_prec(arg3tmpX));
+	mpfr_mul(qopProduct, arg2tmpX, arg3tmpX, STD_RND);
+	mpfr_exp_t canceled = getCanceledBits(&(res->value), &qopProduct, &(arg4tmpX));
+	if (canceled > res->canceled) {
+		res->canceled = canceled;
+		res->cancelOrigin = addr;
+	}
+	if (escalatePrecision(addr, canceled, arg2tmp ? arg2tmp->origin : 0, arg4tmp ? arg4tmp->origin : 0)) {
+		recomputeEscalated(res, quadOpArgs->op, &arg2tmpX, &arg3tmpX, &arg4tmpX);
+	}
+	computeLadder(addr, quadOpArgs->op, res, arg2tmp, &arg2tmpX, arg3tmp, &arg3tmpX, arg4tmp, &arg4tmpX);
+	computeDemoted(addr, quadOpArgs->op, res, arg2tmp, &arg2oriX, arg3tmp, &arg3oriX, arg4tmp, &arg4oriX);
+
+	if (clo_computeMeanValue && !(constArgs & SATURATED_SITE)) {
+		UInt cancellationBadness = 0;
+		if (clo_bad_cancellations && canceled > 0) {
+			Int exactBits = exactBitsArg2 < exactBitsArg3 ? exactBitsArg2 : exactBitsArg3;
+			if (exactBitsArg4 < exactBits) {
+				exactBits = exactBitsArg4;
 			}
-	
-			if (activeStages > 0) {
-				updateStages(addr, res->orgType == Ot_FLOAT);
+			if (canceled > exactBits) {
+				cancellationBadness = canceled - exactBits;
 			}
 		}
+
+		/* the product is reported as the first argument, the addend as the second */
+		Addr productOrigin = 0;
+		if (arg2tmp) {
+			productOrigin = arg2tmp->origin;
+		} else if (arg3tmp) {
+			productOrigin = arg3tmp->origin;
+		}
+		mpfr_set_d(meanOrg, quadOpArgs->orgDouble, STD_RND);
+		updateMeanValue(addr, op, &(res->value), canceled, productOrigin, arg4tmp ? arg4tmp->origin : 0, cancellationBadness);
+		if (clo_condition) {
+			updateFmaConditionNumber(addr, constArgs, quadOpArgs->orgDouble);
+		}
 	}
 
-	if (currentVal && !res) {
-		currentVal->active = False;
+	if (needFix) {
+		mpfr_set(res->value, res->midValue, STD_RND);
+	}
+
+	res->Org.db = quadOpArgs->orgDouble;
+	res->orgType = Ot_DOUBLE;
+	if (clo_detect_pso && !finishPSO) {
+		mpfr_max(irel2, irel2, irel3, STD_RND);
+		mpfr_max(irel2, irel2, irel4, STD_RND);
+		analyzePSO(irel2, res);
+	}
+	if (psoLaneCount > 0) {
+		computePSOLanes(addr, op, res, True, arg2tmp, &arg2tmpX, arg3tmp, &arg3tmpX, arg4tmp, &arg4tmpX);
 	}
+	if (clo_print_every_error) {
+		printErrorShort(res);
+	}
+	mpfr_clears(irel2, irel3, irel4, NULL);
 }
 
-static void instrumentStore(IRSB* sb, IRTypeEnv* env, IRStmt* store, Int argTmpInstead) {
-	tl_assert(store->tag == Ist_Store);
+static void instrumentQop(IRSB* sb, IRTypeEnv* env, Addr addr, IRTemp wrTemp, IRExpr* qop, Int* argTmpInstead) {
+	tl_assert(qop->tag == Iex_Qop);
 
-	Bool isFloat = True;
-	IRExpr* data = store->Ist.Store.data;
-	if (data->tag == Iex_RdTmp) {
-		/* I32 and I64 have to be instrumented due to SSE */
-		switch (typeOfIRTemp(env, data->Iex.RdTmp.tmp)) {
-			case Ity_I64:
-			case Ity_F64:
-			case Ity_V128:
-				isFloat = False;
-				break;
-			default:
-				break;
-		}
+	if (clo_ignoreLibraries && isInLibrary(addr)) {
+		return;
 	}
+	if (!isSuspectSite(addr)) {
+		return;
+	}
+	Int saturated = instrumentSiteCount(sb, addr, qop->Iex.Qop.op, 1);
 
-	IRExpr* addr = store->Ist.Store.addr;
-	/* const needed, but only to delete */
-	tl_assert(data->tag == Iex_RdTmp || data->tag == Iex_Const);
+	IROp op = qop->Iex.Qop.op;
+	IRExpr* args[3];
+	args[0] = qop->Iex.Qop.arg2;
+	args[1] = qop->Iex.Qop.arg3;
+	args[2] = qop->Iex.Qop.arg4;
+	IRTemp* fields[3];
+	fields[0] = &(quadOpArgs->arg2);
+	fields[1] = &(quadOpArgs->arg3);
+	fields[2] = &(quadOpArgs->arg4);
 
-	Int num = -1;
-	IRType type = Ity_F32;
-	if (data->tag != Iex_Const) {
-		if (argTmpInstead >= 0) {
-			num = argTmpInstead;
-		} else {
-			num = data->Iex.RdTmp.tmp;
-		}
-		type = typeOfIRTemp(env, num);
+	Int constArgs = saturated;
 
-		if (isFloat) {
-			IRStmt* store = IRStmt_Store(Iend_LE, mkU64(&(storeArgs->orgFloat)), IRExpr_RdTmp(data->Iex.RdTmp.tmp));
-			addStmtToIRSB(sb, store);
-		} else {
-			IRStmt* store = IRStmt_Store(Iend_LE, mkU64(&(storeArgs->orgDouble)), IRExpr_RdTmp(data->Iex.RdTmp.tmp));
-			addStmtToIRSB(sb, store);
-		}
-	}
-	
-	IRExpr** argv = mkIRExprVec_3(addr, mkU64(num), mkU64(isFloat));
-	IRDirty* di = unsafeIRDirty_0_N(3, "processStore", VG_(fnptr_to_fnentry)(&processStore), argv);
-	addStmtToIRSB(sb, IRStmt_Dirty(di));
-}
+	IRStmt* store = IRStmt_Store(Iend_LE, mkU64(&(quadOpArgs->op)), mkU32(op));
+	addStmtToIRSB(sb, store);
+	store = IRStmt_Store(Iend_LE, mkU64(&(quadOpArgs->wrTmp)), mkU32(wrTemp));
+	addStmtToIRSB(sb, store);
 
-static VG_REGPARM(2) void processPut(UWord offset, UWord t) {
-	// VG_(umsg)("processPut\n");
-	ShadowValue* res = NULL;
-	ThreadId tid = VG_(get_running_tid)();
-	ShadowValue* currentVal = threadRegisters[tid][offset];
+	/* arg1 is ignored because it only contains the rounding mode */
 
-	Int tmp = (Int)t;
-	if (clo_analyze && tmp >= 0) {
-		/* check if a shadow value exits */
-		ShadowValue* av = getTemp(tmp);
-		if (av) {
-			if (currentVal) {
-				/* reuse allocated space if possible ... */
-				res = currentVal;
-				copyShadowValue(res, av);
+	Int k;
+	for (k = 0; k < 3; k++) {
+		tl_assert(args[k]->tag == Iex_RdTmp || args[k]->tag == Iex_Const);
+
+		if (args[k]->tag == Iex_RdTmp) {
+			if (argTmpInstead[k] >= 0) {
+				store = IRStmt_Store(Iend_LE, mkU64(fields[k]), mkU32(argTmpInstead[k]));
 			} else {
-				/* ... else allocate new space */
-				res = initShadowValue((UWord)offset);
-				copyShadowValue(res, av);
-				threadRegisters[tid][offset] = res;
+				store = IRStmt_Store(Iend_LE, mkU64(fields[k]), mkU32(args[k]->Iex.RdTmp.tmp));
 			}
-			res->active = True;
+			addStmtToIRSB(sb, store);
+			writeSTemp(sb, env, args[k]->Iex.RdTmp.tmp, k + 1);
+		} else {
+			writeSConst(sb, args[k]->Iex.Const.con, k + 1);
+			constArgs |= 0x2 << k;
 		}
 	}
 
-	if (currentVal && !res) {
-		/* Invalidate existing shadow value (not free) because 
-           something was stored in this register */
-		currentVal->active = False;
-	}
+	store = IRStmt_Store(Iend_LE, mkU64(&(quadOpArgs->orgDouble)), IRExpr_RdTmp(wrTemp));
+	addStmtToIRSB(sb, store);
+
+	IRExpr** argv = mkIRExprVec_2(mkU64(addr), mkU64(constArgs));
+	IRDirty* di = unsafeIRDirty_0_N(2, "processQop", VG_(fnptr_to_fnentry)(&processQop), argv);
+	addHelperToIRSB(sb, di);
 }
 
-static void instrumentPut(IRSB* sb, IRTypeEnv* env, IRStmt* st, Int argTmpInstead) {
-	tl_assert(st->tag == Ist_Put);
-	IRExpr* data = st->Ist.Put.data;
-	tl_assert(data->tag == Iex_RdTmp || data->tag == Iex_Const);
+static VG_REGPARM(2) UInt processCmpF64(Addr addr, UWord ca) {
+	if (!clo_analyze) return;
 
-	Int offset = st->Ist.Put.offset;
-	tl_assert(offset >= 0 && offset < MAX_REGISTERS);
+	Int constArgs = (Int)ca;
 
-	Int tmpNum = -1;
-	if (data->tag == Iex_RdTmp) {
-		if (argTmpInstead >= 0) {
-			tmpNum = argTmpInstead;
+	if (clo_simulateOriginal) {
+		if (isOpFloat(binOpArgs->op)) {
+			mpfr_set_prec(arg1tmpX, 24);
+			mpfr_set_prec(arg2tmpX, 24);
 		} else {
-			tmpNum = data->Iex.RdTmp.tmp;
+			mpfr_set_prec(arg1tmpX, 53);
+			mpfr_set_prec(arg2tmpX, 53);
 		}
 	}
 
-	IRExpr** argv = mkIRExprVec_2(mkU64(offset), mkU64(tmpNum));
-	IRDirty* di = unsafeIRDirty_0_N(2, "processPut", VG_(fnptr_to_fnentry)(&processPut), argv);
-	addStmtToIRSB(sb, IRStmt_Dirty(di));
-}
-
-static VG_REGPARM(2) void processGet(UWord offset, UWord tmp) {
-	// VG_(umsg)("processGet\n");
-	if (!clo_analyze) return;
-
-	ThreadId tid = VG_(get_running_tid)();
-	ShadowValue* av = threadRegisters[tid][offset];
-	if (!av || !(av->active)) {
-		return;
+	if (isOpFloat(binOpArgs->op)) {
+		mpfr_set_prec(arg1midX, 24);
+		mpfr_set_prec(arg2midX, 24);
+		mpfr_set_prec(arg1oriX, 24);
+		mpfr_set_prec(arg2oriX, 24);
+	} else {
+		mpfr_set_prec(arg1midX, 53);
+		mpfr_set_prec(arg2midX, 53);
+		mpfr_set_prec(arg1oriX, 53);
+		mpfr_set_prec(arg2oriX, 53);
 	}
 
-	ShadowValue* res = setTemp((Int)tmp);
-	// VG_(umsg)("processGet %X\n", tmp);
-	copyShadowValue(res, av);
-}
-
-static void instrumentGet(IRSB* sb, IRTypeEnv* env, IRStmt* st) {
-	tl_assert(st->tag == Ist_WrTmp);
-	tl_assert(st->Ist.WrTmp.data->tag == Iex_Get);
-
-	Int tmpNum = st->Ist.WrTmp.tmp;
-	Int offset = st->Ist.WrTmp.data->Iex.Get.offset;
-	tl_assert(offset >= 0 && offset < MAX_REGISTERS);
+	ULong arg1opCount = 0;
+	ULong arg2opCount = 0;
+	Addr arg1origin = 0;
+	Addr arg2origin = 0;
+	mpfr_exp_t arg1canceled = 0;
+	mpfr_exp_t arg2canceled = 0;
+	mpfr_exp_t canceled = 0;
+	Addr arg1CancelOrigin = 0;
+	Addr arg2CancelOrigin = 0;
+	mpfr_t irel1, irel2;
+	mpfr_inits(irel1, irel2, NULL);
 
-	IRExpr** argv = mkIRExprVec_2(mkU64(offset), mkU64(tmpNum));
-	IRDirty* di = unsafeIRDirty_0_N(2, "processGet", VG_(fnptr_to_fnentry)(&processGet), argv);
-	addStmtToIRSB(sb, IRStmt_Dirty(di));
-}
+	Int exactBitsArg1, exactBitsArg2;
+	if (isOpFloat(binOpArgs->op)) {
+		exactBitsArg1 = 23;
+		exactBitsArg2 = 23;
+	} else {
+		exactBitsArg1 = 52;
+		exactBitsArg2 = 52;
+	}
 
-static VG_REGPARM(3) void processPutI(UWord t, UWord b, UWord n) {
-	// VG_(umsg)("processPutI\n");
-	Int tmp = (Int)t;
-	Int nElems = (Int)n;
-	Int base = (Int)b;
-	Int bias = (Int)(circRegs->bias);
+	if (constArgs & 0x1) {
+		readSConst(0, &(arg1tmpX));
+		mpfr_set(arg1midX, arg1tmpX, STD_RND);
+		beginEmulateDouble();
+		int t = mpfr_set(arg1oriX, arg1tmpX, STD_RND);
+		mpfr_subnormalize(arg1oriX, t, STD_RND);
+		endEmulate();
+	} else {
+		ShadowValue* arg1tmp = getTemp(binOpArgs->arg1);
+		checkAndRecover(arg1tmp);
+		computeRelativeError(arg1tmp, irel1);
+		// if (needFix) printErrorShort(arg1tmp);
+		if (arg1tmp) {
+			// VG_(umsg)("have shadow 1\n");
+			mpfr_set(arg1tmpX, arg1tmp->value, STD_RND);
+			mpfr_set(arg1midX, arg1tmp->midValue, STD_RND);
+			beginEmulateDouble();
+			int t = mpfr_set(arg1oriX, arg1tmp->oriValue, STD_RND);
+			mpfr_subnormalize(arg1oriX, t, STD_RND);
+			endEmulate();
+			arg1opCount = arg1tmp->opCount;
+			arg1origin = arg1tmp->origin;
+			arg1canceled = arg1tmp->canceled;
+			arg1CancelOrigin = arg1tmp->cancelOrigin;
 
-	/* (ix + bias) % num-of-elems-in-the-array */
-	Int offset = base + ((circRegs->ix + bias) % nElems);
-	tl_assert(offset >= 0 && offset < MAX_REGISTERS);
+			if (clo_bad_cancellations) {
+				readSTemp(0, &cancelTemp);
+				if (mpfr_get_exp(cancelTemp) == mpfr_get_exp(arg1tmpX)) {
+					mpfr_sub(cancelTemp, arg1tmpX, cancelTemp, STD_RND);
+					if (mpfr_cmp_ui(cancelTemp, 0) != 0) {
+						exactBitsArg1 = abs(mpfr_get_exp(arg1tmpX) - mpfr_get_exp(cancelTemp)) - 2;
+						if (arg1tmp->orgType == Ot_FLOAT && exactBitsArg1 > 23) {
+							exactBitsArg1 = 23;
+						} else if (arg1tmp->orgType == Ot_DOUBLE && exactBitsArg1 > 52) {
+							exactBitsArg1 = 52;
+						}
+					}
+				} else {
+					exactBitsArg1 = 0;
+				}
+			}
+		} else {
+			readSTemp(0, &(arg1tmpX));
+			mpfr_set(arg1midX, arg1tmpX, STD_RND);
+			beginEmulateDouble();
+			int t = mpfr_set(arg1oriX, arg1tmpX, STD_RND);
+			mpfr_subnormalize(arg1oriX, t, STD_RND);
+			endEmulate();
+		}
+	}
 
-	ShadowValue* res = NULL;
-	ThreadId tid = VG_(get_running_tid)();
-	ShadowValue* currentVal = threadRegisters[tid][offset];
+	if (constArgs & 0x2) {
+		readSConst(1, &(arg2tmpX));
+		mpfr_set(arg2midX, arg2tmpX, STD_RND);
+		beginEmulateDouble();
+		int t = mpfr_set(arg2oriX, arg2tmpX, STD_RND);
+		mpfr_subnormalize(arg2oriX, t, STD_RND);
+		endEmulate();
+	} else {
+		ShadowValue* arg2tmp = getTemp(binOpArgs->arg2);
+		checkAndRecover(arg2tmp);
+		// VG_(umsg)("get %X\n", binOpArgs->arg2);
+		computeRelativeError(arg2tmp, irel2);
+		if (arg2tmp) {
+			// if (needFix) printErrorShort(arg2tmp);
+			// VG_(umsg)("have shadow 2\n");
+			mpfr_set(arg2tmpX, arg2tmp->value, STD_RND);
+			mpfr_set(arg2midX, arg2tmp->midValue, STD_RND);
+			beginEmulateDouble();
+			int t = mpfr_set(arg2oriX, arg2tmp->oriValue, STD_RND);
+			mpfr_subnormalize(arg2oriX, t, STD_RND);
+			endEmulate();
+			arg2opCount = arg2tmp->opCount;
+			arg2origin = arg2tmp->origin;
+			arg2canceled = arg2tmp->canceled;
+			arg2CancelOrigin = arg2tmp->cancelOrigin;
 
-	if (clo_analyze && tmp >= 0) {
-		/* check if a shadow value exits */
-		ShadowValue* av = getTemp(tmp);
-		if (av) {
-			if (currentVal) {
-				/* reuse allocated space if possible ... */
-				res = currentVal;
-				copyShadowValue(res, av);
-			} else {
-				/* ... else allocate new space */
-				res = initShadowValue((UWord)offset);
-				copyShadowValue(res, av);
-				threadRegisters[tid][offset] = res;
+			if (clo_bad_cancellations) {
+				readSTemp(1, &cancelTemp);
+				if (mpfr_get_exp(cancelTemp) == mpfr_get_exp(arg2tmpX)) {
+					mpfr_sub(cancelTemp, arg2tmpX, cancelTemp, STD_RND);
+					if (mpfr_cmp_ui(cancelTemp, 0) != 0) {
+						exactBitsArg2 = abs(mpfr_get_exp(arg2tmpX) - mpfr_get_exp(cancelTemp)) - 2;
+						if (arg2tmp->orgType == Ot_FLOAT && exactBitsArg2 > 23) {
+							exactBitsArg2 = 23;
+						} else if (arg2tmp->orgType == Ot_DOUBLE && exactBitsArg2 > 52) {
+							exactBitsArg2 = 52;
+						}
+					}
+				} else {
+					exactBitsArg2 = 0;
+				}
 			}
-			res->active = True;
+		} else {
+			readSTemp(1, &(arg2tmpX));
+			mpfr_set(arg2midX, arg2tmpX, STD_RND);
+			beginEmulateDouble();
+			int t = mpfr_set(arg2oriX, arg2tmpX, STD_RND);
+			mpfr_subnormalize(arg2oriX, t, STD_RND);
+			endEmulate();
 		}
 	}
 
-	if (currentVal && !res) {
-		/* Invalidate existing shadow value (not free) because 
-           something was stored in this register. */
-		currentVal->active = False;
+	int tv, oritv;
+	// Char mpfrBuf[MPFR_BUFSIZE];
+	// mpfrToString(mpfrBuf, &arg1tmpX);
+	// VG_(umsg)("ARG1:         %s\n", mpfrBuf);
+	// mpfrToString(mpfrBuf, &arg2tmpX);
+	// VG_(umsg)("ARG2:         %s\n", mpfrBuf);
+	// VG_(umsg)("original cond %d\n", binOpArgs->orgInt);
+	IRExpr* lastBranchResult = NULL;
+	switch (binOpArgs->op) {
+		case Iop_CmpF64:
+			tv = mpfr_cmp(arg1tmpX, arg2tmpX);
+			oritv = mpfr_cmp(arg1oriX, arg2oriX);
+			if (tv != oritv) {
+				VG_(describe_IP)(addr, description, DESCRIPTION_SIZE);
+				VG_(umsg)("Change branch at %s\n", description);
+			}
+			if (tv > 0) {
+				return Ircr_GT;
+			} else if (tv == 0) {
+				return Ircr_EQ;
+			} else {
+				return Ircr_LT;
+			}
+			break;
+		default:
+			VG_(tool_panic)("Unhandled case in processCmpF64\n");
+			break;
 	}
+
+	return lastBranchResult;
 }
 
-static void instrumentPutI(IRSB* sb, IRTypeEnv* env, IRStmt* st, Int argTmpInstead) {
-	tl_assert(st->tag == Ist_PutI);
-	IRExpr* data = st->Ist.PutI.data;
-	IRExpr* ix = st->Ist.PutI.ix;
-	IRRegArray* descr = st->Ist.PutI.descr;
-	Int bias = st->Ist.PutI.bias;
+static void instrumentCmpF64(IRSB* sb, IRTypeEnv* env, Addr addr, IRTemp wrTemp, IRExpr* binop, Int arg1tmpInstead, Int arg2tmpInstead) {
+	tl_assert(binop->tag == Iex_Binop);
 
-	tl_assert(data->tag == Iex_RdTmp || data->tag == Iex_Const);
-	tl_assert(ix->tag == Iex_RdTmp || ix->tag == Iex_Const);
+	if (clo_ignoreLibraries && isInLibrary(addr)) {
+		return;
+	}
 
-	tl_assert(ix->tag == Iex_RdTmp ? typeOfIRTemp(env, ix->Iex.RdTmp.tmp) == Ity_I32 : True);
-	tl_assert(ix->tag == Iex_Const ? ix->Iex.Const.con->tag == Ico_U32 : True);
+	IROp op = binop->Iex.Binop.op;
+	IRExpr* arg1 = binop->Iex.Binop.arg1;
+	IRExpr* arg2 = binop->Iex.Binop.arg2;
 
-	Int tmpNum = -1;
-	if (data->tag == Iex_RdTmp) {
-		if (argTmpInstead >= 0) {
-			tmpNum = argTmpInstead;
-		} else {
-			tmpNum = data->Iex.RdTmp.tmp;
-		}
-	}
+	tl_assert(arg1->tag == Iex_RdTmp || arg1->tag == Iex_Const);
+	tl_assert(arg2->tag == Iex_RdTmp || arg2->tag == Iex_Const);
 
-	IRStmt* store = IRStmt_Store(Iend_LE, mkU64(&(circRegs->bias)), mkU64(bias));
-	addStmtToIRSB(sb, store);
-	store = IRStmt_Store(Iend_LE, mkU64(&(circRegs->ix)), ix);
+	Int constArgs = 0;
+
+	IRStmt* store = IRStmt_Store(Iend_LE, mkU64(&(binOpArgs->op)), mkU32(op));
 	addStmtToIRSB(sb, store);
 
-	IRExpr** argv = mkIRExprVec_3(mkU64(tmpNum), mkU64(descr->base), mkU64(descr->nElems));
-	IRDirty* di = unsafeIRDirty_0_N(3, "processPutI", VG_(fnptr_to_fnentry)(&processPutI), argv);
-	addStmtToIRSB(sb, IRStmt_Dirty(di));
-}
+	if (arg1->tag == Iex_RdTmp) {
+		if (arg1tmpInstead >= 0) {
+			store = IRStmt_Store(Iend_LE, mkU64(&(binOpArgs->arg1)), mkU32(arg1tmpInstead));
+		} else {
+			store = IRStmt_Store(Iend_LE, mkU64(&(binOpArgs->arg1)), mkU32(arg1->Iex.RdTmp.tmp));
+		}
+		addStmtToIRSB(sb, store);
 
-static VG_REGPARM(3) void processGetI(UWord tmp, UWord b, UWord n) {
-	// VG_(umsg)("processGetI\n");
-	if (!clo_analyze) return;
+		writeSTemp(sb, env, arg1->Iex.RdTmp.tmp, 0);
+	} else {
+		tl_assert(arg1->tag == Iex_Const);
 
-	Int nElems = (Int)n;
-	Int base = (Int)b;
-	Int bias = (Int)(circRegs->bias);
+		writeSConst(sb, arg1->Iex.Const.con, 0);
+		constArgs |= 0x1;
+	}
+	if (arg2->tag == Iex_RdTmp) {
+		if (arg2tmpInstead >= 0) {
+			store = IRStmt_Store(Iend_LE, mkU64(&(binOpArgs->arg2)), mkU32(arg2tmpInstead));
+		} else {
+			store = IRStmt_Store(Iend_LE, mkU64(&(binOpArgs->arg2)), mkU32(arg2->Iex.RdTmp.tmp));
+		}
+		addStmtToIRSB(sb, store);
 
-	/* (ix + bias) % num-of-elems-in-the-array */
-	Int offset = base + ((circRegs->ix + bias) % nElems);
-	tl_assert(offset >= 0 && offset < MAX_REGISTERS);
+		writeSTemp(sb, env, arg2->Iex.RdTmp.tmp, 1);
+	} else {
+		tl_assert(arg2->tag == Iex_Const);
 
-	ThreadId tid = VG_(get_running_tid)();
-	ShadowValue* av = threadRegisters[tid][offset];
-	if (!av || !(av->active)) {
-		return;
+		writeSConst(sb, arg2->Iex.Const.con, 1);
+		constArgs |= 0x2;
 	}
 
-	ShadowValue* res = setTemp((Int)tmp);
-	// VG_(umsg)("processGetI %X\n", tmp);
-	copyShadowValue(res, av);
+	IRExpr** argv = mkIRExprVec_2(mkU64(addr), mkU64(constArgs));
+	IRDirty* di = unsafeIRDirty_1_N(wrTemp, 2, "processCmpF64", VG_(fnptr_to_fnentry)(&processCmpF64), argv);
+	/* computes the result of the comparison, never guarded by sampling */
+	addStmtToIRSB(sb, IRStmt_Dirty(di));
 }
 
-static void instrumentGetI(IRSB* sb, IRTypeEnv* env, IRStmt* st) {
-	tl_assert(st->tag == Ist_WrTmp);
-	tl_assert(st->Ist.WrTmp.data->tag == Iex_GetI);
-	IRExpr* get = st->Ist.WrTmp.data;
+static Double processCvtOpKernel(Addr addr, UWord ca) {
+	Int constArgs = (Int)ca;
 
-	IRExpr* ix = get->Iex.GetI.ix;
-	IRRegArray* descr = get->Iex.GetI.descr;
-	Int bias = get->Iex.GetI.bias;
+	if (clo_simulateOriginal) {
+		if (isOpFloat(binOpArgs->op)) {
+			mpfr_set_prec(arg2tmpX, 24);
+		} else {
+			mpfr_set_prec(arg2tmpX, 53);
+		}
+	}
 
-	tl_assert(ix->tag == Iex_RdTmp || ix->tag == Iex_Const);
-	tl_assert(ix->tag == Iex_RdTmp ? typeOfIRTemp(env, ix->Iex.RdTmp.tmp) == Ity_I32 : True);
-	tl_assert(ix->tag == Iex_Const ? ix->Iex.Const.con->tag == Ico_U32 : True);
+	if (isOpFloat(binOpArgs->op)) {
+		mpfr_set_prec(arg2midX, 24);
+		mpfr_set_prec(arg2oriX, 24);
+	} else {
+		mpfr_set_prec(arg2midX, 53);
+		mpfr_set_prec(arg2oriX, 53);
+	}
 
-	Int tmpNum = st->Ist.WrTmp.tmp;
+	ULong arg2opCount = 0;
+	Addr arg2origin = 0;
+	mpfr_exp_t arg2canceled = 0;
+	mpfr_exp_t canceled = 0;
+	Addr arg2CancelOrigin = 0;
+	mpfr_t irel2;
+	mpfr_inits(irel2, NULL);
 
-	IRStmt* store = IRStmt_Store(Iend_LE, mkU64(&(circRegs->bias)), mkU64(bias));
-	addStmtToIRSB(sb, store);
-	store = IRStmt_Store(Iend_LE, mkU64(&(circRegs->ix)), ix);
-	addStmtToIRSB(sb, store);
+	Int exactBitsArg1, exactBitsArg2;
+	if (isOpFloat(binOpArgs->op)) {
+		exactBitsArg2 = 23;
+	} else {
+		exactBitsArg2 = 52;
+	}
 
-	IRExpr** argv = mkIRExprVec_3(mkU64(tmpNum), mkU64(descr->base), mkU64(descr->nElems));
-	IRDirty* di = unsafeIRDirty_0_N(3, "processGetI", VG_(fnptr_to_fnentry)(&processGetI), argv);
-	addStmtToIRSB(sb, IRStmt_Dirty(di));
+	if (constArgs & 0x2) {
+		readSConst(1, &(arg2tmpX));
+		mpfr_set(arg2midX, arg2tmpX, STD_RND);
+		beginEmulateDouble();
+		int t = mpfr_set(arg2oriX, arg2tmpX, STD_RND);
+		mpfr_subnormalize(arg2oriX, t, STD_RND);
+		endEmulate();
+	} else {
+		ShadowValue* arg2tmp = getTemp(binOpArgs->arg2);
+		checkAndRecover(arg2tmp);
+		computeRelativeError(arg2tmp, irel2);
+		if (arg2tmp) {
+			mpfr_set(arg2tmpX, arg2tmp->value, STD_RND);
+			mpfr_set(arg2midX, arg2tmp->midValue, STD_RND);
+			beginEmulateDouble();
+			int t = mpfr_set(arg2oriX, arg2tmp->oriValue, STD_RND);
+			mpfr_subnormalize(arg2oriX, t, STD_RND);
+			endEmulate();
+			arg2opCount = arg2tmp->opCount;
+			arg2origin = arg2tmp->origin;
+			arg2canceled = arg2tmp->canceled;
+			arg2CancelOrigin = arg2tmp->cancelOrigin;
+
+			if (clo_bad_cancellations) {
+				readSTemp(1, &cancelTemp);
+				if (mpfr_get_exp(cancelTemp) == mpfr_get_exp(arg2tmpX)) {
+					mpfr_sub(cancelTemp, arg2tmpX, cancelTemp, STD_RND);
+					if (mpfr_cmp_ui(cancelTemp, 0) != 0) {
+						exactBitsArg2 = abs(mpfr_get_exp(arg2tmpX) - mpfr_get_exp(cancelTemp)) - 2;
+						if (arg2tmp->orgType == Ot_FLOAT && exactBitsArg2 > 23) {
+							exactBitsArg2 = 23;
+						} else if (arg2tmp->orgType == Ot_DOUBLE && exactBitsArg2 > 52) {
+							exactBitsArg2 = 52;
+						}
+					}
+				} else {
+					exactBitsArg2 = 0;
+				}
+			}
+		} else {
+			readSTemp(1, &(arg2tmpX));
+			mpfr_set(arg2midX, arg2tmpX, STD_RND);
+			beginEmulateDouble();
+			int t = mpfr_set(arg2oriX, arg2tmpX, STD_RND);
+			mpfr_subnormalize(arg2oriX, t, STD_RND);
+			endEmulate();
+		}
+	}
+
+	return mpfr_get_d(arg2tmpX, STD_RND);
 }
 
-static void instrumentEnterSB(IRSB* sb) {
-	/* inlining of sbExecuted++ */
-	IRExpr* load = IRExpr_Load(Iend_LE, Ity_I64, mkU64(&sbExecuted));
-	IRTemp t1 = newIRTemp(sb->tyenv, Ity_I64);
-  	addStmtToIRSB(sb, IRStmt_WrTmp(t1, load));
-	IRExpr* add = IRExpr_Binop(Iop_Add64, IRExpr_RdTmp(t1), mkU64(1));
-  	IRTemp t2 = newIRTemp(sb->tyenv, Ity_I64);
-  	addStmtToIRSB(sb, IRStmt_WrTmp(t2, add));
-	IRStmt* store = IRStmt_Store(Iend_LE, mkU64(&sbExecuted), IRExpr_RdTmp(t2));
-	addStmtToIRSB(sb, store);
+static VG_REGPARM(2) UInt processCvtI32U(Addr addr, UWord ca) {
+	if (!clo_analyze) return;
+	Double shadow_double = processCvtOpKernel(addr, ca);
+	return shadow_double;
 }
 
-static void reportUnsupportedOp(IROp op) {
-	if (!VG_(OSetWord_Contains)(unsupportedOps, (UWord)op)) {
-		VG_(OSetWord_Insert)(unsupportedOps, (UWord)op);
-	}
+static VG_REGPARM(2) Int processCvtI32S(Addr addr, UWord ca) {
+	if (!clo_analyze) return;
+	Double shadow_double = processCvtOpKernel(addr, ca);
+	return shadow_double;
 }
 
-static IRSB* fd_instrument(VgCallbackClosure* closure, IRSB* sbIn,
-                      VexGuestLayout* layout, VexGuestExtents* vge,
-                      IRType gWordTy, IRType hWordTy)
-{
-	Int			i;
-	IRSB*      	sbOut;
-   	IRType     	type;
-   	IRTypeEnv* 	tyenv = sbIn->tyenv;
-	IRExpr* 	expr;
-	/* address of current client instruction */
-	Addr		cia = 0, dst;
+static VG_REGPARM(2) ULong processCvtI64U(Addr addr, UWord ca) {
+	if (!clo_analyze) return;
+	Double shadow_double = processCvtOpKernel(addr, ca);
+	return shadow_double;
+}
 
-	if (gWordTy != hWordTy) {
-		/* This case is not supported yet. */
-		VG_(tool_panic)("host/guest word size mismatch");
-	}
+static VG_REGPARM(2) Long processCvtI64S(Addr addr, UWord ca) {
+	if (!clo_analyze) return;
+	Double shadow_double = processCvtOpKernel(addr, ca);
+	return shadow_double;
+}
 
-	sbCounter++;
-	totalIns += sbIn->stmts_used;
+static VG_REGPARM(2) Short processCvtI16S(Addr addr, UWord ca) {
+	if (!clo_analyze) return;
+	Double shadow_double = processCvtOpKernel(addr, ca);
+	return shadow_double;
+}
 
-	/* set up SB */
-	sbOut = deepCopyIRSBExceptStmts(sbIn);
+static void instrumentCvtOp (IRSB* sb, IRTypeEnv* env, Addr addr, IRTemp wrTemp, IRExpr* binop, Int arg2tmpInstead, RetType retType) {
+	tl_assert(binop->tag == Iex_Binop);
 
-	/* copy verbatim any IR preamble preceding the first IMark */
-	i = 0;
-	while (i < sbIn->stmts_used && sbIn->stmts[i]->tag != Ist_IMark) {
-		addStmtToIRSB( sbOut, sbIn->stmts[i] );
-		i++;
+	if (clo_ignoreLibraries && isInLibrary(addr)) {
+		return;
 	}
 
-	/* perform optimizations for each superblock */
+	IROp op = binop->Iex.Binop.op;
+	IRExpr* arg2 = binop->Iex.Binop.arg2;
 
-	Bool sbInstrNeeded = False;
-	if (maxTemps < tyenv->types_used) {
-		maxTemps = tyenv->types_used;
-	}
+	tl_assert(arg2->tag == Iex_RdTmp || arg2->tag == Iex_Const);
 
-	Int j;
+	Int constArgs = 0;
 
-	Bool impReg[MAX_REGISTERS];
-	for (j = 0; j < MAX_REGISTERS; j++) {
-		impReg[j] = True;
-	}
-	Int impTmp[tyenv->types_used];
-	for (j = 0; j < tyenv->types_used; j++) {
-		impTmp[j] = 0;
-	}
+	IRStmt* store = IRStmt_Store(Iend_LE, mkU64(&(binOpArgs->op)), mkU32(op));
+	addStmtToIRSB(sb, store);
 
-	/* backward */
-	for (j = sbIn->stmts_used - 1; j >= i; j--) {
-		IRStmt* st = sbIn->stmts[j];
-		if (!st || st->tag == Ist_NoOp) continue;
-      
-		switch (st->tag) {
-			case Ist_Put:
-				impReg[st->Ist.Put.offset] = False;
+	if (arg2->tag == Iex_RdTmp) {
+		if (arg2tmpInstead >= 0) {
+			store = IRStmt_Store(Iend_LE, mkU64(&(binOpArgs->arg2)), mkU32(arg2tmpInstead));
+		} else {
+			store = IRStmt_Store(Iend_LE, mkU64(&(binOpArgs->arg2)), mkU32(arg2->Iex.RdTmp.tmp));
+		}
+		addStmtToIRSB(sb, store);
 
-				if (st->Ist.Put.data->tag == Iex_RdTmp) {
-					impTmp[st->Ist.Put.data->Iex.RdTmp.tmp] = 1;
-				}
-				break;
-			case Ist_Store:
-				if (st->Ist.Store.data->tag == Iex_RdTmp) {
-					impTmp[st->Ist.Store.data->Iex.RdTmp.tmp] = 1;
-				}
-				break;
-			case Ist_WrTmp:
-				expr = st->Ist.WrTmp.data;
+		writeSTemp(sb, env, arg2->Iex.RdTmp.tmp, 1);
+	} else {
+		tl_assert(arg2->tag == Iex_Const);
 
-		        switch (expr->tag) {
-					case Iex_Get:
-						impReg[expr->Iex.Get.offset] = True;
-						break;
-					case Iex_Unop:
-						switch (expr->Iex.Unop.op) {
-							case Iop_Sqrt32F0x4:
-							case Iop_Sqrt64F0x2:
-							case Iop_NegF32:
-							case Iop_NegF64:
-							case Iop_AbsF32:
-							case Iop_AbsF64:
-							case Iop_F32toF64:
-							case Iop_ReinterpI64asF64:
-							case Iop_32UtoV128:
-							case Iop_V128to64:
-							case Iop_V128HIto64:
-							case Iop_64to32:
-							case Iop_64HIto32:
-							case Iop_64UtoV128:
-							case Iop_32Uto64:
-								if (expr->Iex.Unop.arg->tag == Iex_RdTmp) {
-									impTmp[expr->Iex.Unop.arg->Iex.RdTmp.tmp] = 1;
-								}
-								break;
-							default:
-								/* backward -> args are important */
-								if (expr->Iex.Unop.arg->tag == Iex_RdTmp && impTmp[expr->Iex.Unop.arg->Iex.RdTmp.tmp] == 0) {
-									impTmp[expr->Iex.Unop.arg->Iex.RdTmp.tmp] = -1;
-								}
-								break;
-						}
-						break;
-					case Iex_Binop:
-						switch (expr->Iex.Binop.op) {
-							case Iop_Add32F0x4:
-							case Iop_Sub32F0x4:
-							case Iop_Mul32F0x4:
-							case Iop_Div32F0x4:
-							case Iop_Add64F0x2:
-							case Iop_Sub64F0x2:
-							case Iop_Mul64F0x2:
-							case Iop_Div64F0x2:
-							case Iop_Min32F0x4:
-							case Iop_Min64F0x2:
-							case Iop_Max32F0x4:
-							case Iop_Max64F0x2:
-							case Iop_CmpF64: 
-							case Iop_F64toF32:
-							case Iop_64HLtoV128:
-							case Iop_32HLto64:
-								if (expr->Iex.Binop.arg1->tag == Iex_RdTmp) {
-									impTmp[expr->Iex.Binop.arg1->Iex.RdTmp.tmp] = 1;
-								}
-							case Iop_F64toI16S:
-							case Iop_F64toI32S:
-							case Iop_F64toI64S:
-							case Iop_F64toI64U:
-							case Iop_F64toI32U:
-								if (expr->Iex.Binop.arg2->tag == Iex_RdTmp) {
-									impTmp[expr->Iex.Binop.arg2->Iex.RdTmp.tmp] = 1;
-								}
-								break;
-							default:
-								/* backward -> args are important */
-								if (expr->Iex.Binop.arg1->tag == Iex_RdTmp && impTmp[expr->Iex.Binop.arg1->Iex.RdTmp.tmp] == 0) {
-									impTmp[expr->Iex.Binop.arg1->Iex.RdTmp.tmp] = -1;
-								}
-								if (expr->Iex.Binop.arg2->tag == Iex_RdTmp && impTmp[expr->Iex.Binop.arg2->Iex.RdTmp.tmp] == 0) {
-									impTmp[expr->Iex.Binop.arg2->Iex.RdTmp.tmp] = -1;
-								}
-								break;
-						}
-						break;
-					case Iex_Triop:
-						switch (expr->Iex.Triop.op) {
-							case Iop_AddF64:
-							case Iop_SubF64:
-							case Iop_MulF64:
-							case Iop_DivF64:
-								if (expr->Iex.Triop.arg2->tag == Iex_RdTmp) {
-									impTmp[expr->Iex.Triop.arg2->Iex.RdTmp.tmp] = 1;
-								}
-								if (expr->Iex.Triop.arg3->tag == Iex_RdTmp) {
-									impTmp[expr->Iex.Triop.arg3->Iex.RdTmp.tmp] = 1;
-								}
-								break;
-							default:
-								/* backward -> args are important */
-								if (expr->Iex.Triop.arg2->tag == Iex_RdTmp && impTmp[expr->Iex.Triop.arg2->Iex.RdTmp.tmp] == 0) {
-									impTmp[expr->Iex.Triop.arg2->Iex.RdTmp.tmp] = -1;
-								}
-								if (expr->Iex.Triop.arg3->tag == Iex_RdTmp && impTmp[expr->Iex.Triop.arg3->Iex.RdTmp.tmp] == 0) {
-									impTmp[expr->Iex.Triop.arg3->Iex.RdTmp.tmp] = -1;
-								}
-								break;
-						}
-						break;
-					case Iex_Mux0X:
-						/* nothing, impTmp is already true */
-						break;
-					default:
-						break;
-				}
-				break;
-			default:
-				break;
-		}
+		writeSConst(sb, arg2->Iex.Const.con, 1);
+		constArgs |= 0x2;
 	}
 
-	Int tmpInstead[tyenv->types_used];
-	for (j = 0; j < tyenv->types_used; j++) {
-		tmpInstead[j] = -1;
+	IRExpr** argv = mkIRExprVec_2(mkU64(addr), mkU64(constArgs));
+	IRDirty* di;
+	switch(retType) {
+		case Rt_I16S:
+			di = unsafeIRDirty_1_N(wrTemp, 2, "processCvtI16S", VG_(fnptr_to_fnentry)(&processCvtI16S), argv);
+			break;
+		case Rt_I32S:
+			di = unsafeIRDirty_1_N(wrTemp, 2, "processCvtI32S", VG_(fnptr_to_fnentry)(&processCvtI32S), argv);
+			break;
+		case Rt_I64S:
+			di = unsafeIRDirty_1_N(wrTemp, 2, "processCvtI64S", VG_(fnptr_to_fnentry)(&processCvtI64S), argv);
+			break;
+		case Rt_I32U:
+			di = unsafeIRDirty_1_N(wrTemp, 2, "processCvtI32U", VG_(fnptr_to_fnentry)(&processCvtI32U), argv);
+			break;
+		case Rt_I64U:
+			di = unsafeIRDirty_1_N(wrTemp, 2, "processCvtI64U", VG_(fnptr_to_fnentry)(&processCvtI64U), argv);
+			break;
+		default:
+			VG_(tool_panic)("Should not reach here\n");
 	}
+	
+	/* computes the result of the conversion, never guarded by sampling */
+	addStmtToIRSB(sb, IRStmt_Dirty(di));
+}
 
-	Int tmpInReg[MAX_REGISTERS];
-	for (j = 0; j < MAX_REGISTERS; j++) {
-		tmpInReg[j] = -1;
+/* Evaluates a wrapped library function with MPFR (see fpdebug.h). 
+   The return value is the ternary value. */
+static int computeFunction(UWord fn, mpfr_t res, mpfr_t x, mpfr_t y) {
+	switch (fn) {
+		case FD_FN_SIN:		return mpfr_sin(res, x, STD_RND);
+		case FD_FN_COS:		return mpfr_cos(res, x, STD_RND);
+		case FD_FN_TAN:		return mpfr_tan(res, x, STD_RND);
+		case FD_FN_ASIN:	return mpfr_asin(res, x, STD_RND);
+		case FD_FN_ACOS:	return mpfr_acos(res, x, STD_RND);
+		case FD_FN_ATAN:	return mpfr_atan(res, x, STD_RND);
+		case FD_FN_SINH:	return mpfr_sinh(res, x, STD_RND);
+		case FD_FN_COSH:	return mpfr_cosh(res, x, STD_RND);
+		case FD_FN_TANH:	return mpfr_tanh(res, x, STD_RND);
+		case FD_FN_EXP:		return mpfr_exp(res, x, STD_RND);
+		case FD_FN_EXP2:	return mpfr_exp2(res, x, STD_RND);
+		case FD_FN_EXPM1:	return mpfr_expm1(res, x, STD_RND);
+		case FD_FN_LOG:		return mpfr_log(res, x, STD_RND);
+		case FD_FN_LOG2:	return mpfr_log2(res, x, STD_RND);
+		case FD_FN_LOG10:	return mpfr_log10(res, x, STD_RND);
+		case FD_FN_LOG1P:	return mpfr_log1p(res, x, STD_RND);
+		case FD_FN_CBRT:	return mpfr_cbrt(res, x, STD_RND);
+		case FD_FN_ERF:		return mpfr_erf(res, x, STD_RND);
+		case FD_FN_ERFC:	return mpfr_erfc(res, x, STD_RND);
+		case FD_FN_POW:		return mpfr_pow(res, x, y, STD_RND);
+		case FD_FN_ATAN2:	return mpfr_atan2(res, x, y, STD_RND);
+		case FD_FN_HYPOT:	return mpfr_hypot(res, x, y, STD_RND);
+		case FD_FN_FMOD:	return mpfr_fmod(res, x, y, STD_RND);
+		default:
+			VG_(tool_panic)("Unhandled function in computeFunction\n");
+			break;
 	}
+	return 0;
+}
 
-	/* forward */
-	for (j = i; j < sbIn->stmts_used; j++) {
-		IRStmt* st = sbIn->stmts[j];
-		if (!st || st->tag == Ist_NoOp) continue;
-      
-		switch (st->tag) {
-			case Ist_Put:
-				if (st->Ist.Put.data->tag == Iex_RdTmp) {
-					tmpInReg[st->Ist.Put.offset] = st->Ist.Put.data->Iex.RdTmp.tmp;
-				} else {
-					tmpInReg[st->Ist.Put.offset] = -1;
-				}
-				break;
-			case Ist_Store:
-				break;
-			case Ist_WrTmp:
-				expr = st->Ist.WrTmp.data;
-		        switch (expr->tag) {
-					case Iex_Load:
-						break;
-					case Iex_Get:
-						if (tmpInReg[expr->Iex.Get.offset] >= 0) {
-							if (tmpInstead[tmpInReg[expr->Iex.Get.offset]] >= 0) {
-								tmpInstead[st->Ist.WrTmp.tmp] = tmpInstead[tmpInReg[expr->Iex.Get.offset]];
-							} else {
-								tmpInstead[st->Ist.WrTmp.tmp] = tmpInReg[expr->Iex.Get.offset];
-							}
-						}
-						break;
-					case Iex_RdTmp:
-						tmpInstead[st->Ist.WrTmp.tmp] = tmpInstead[expr->Iex.RdTmp.tmp];
-						break;
-					case Iex_Unop:
-						switch (expr->Iex.Unop.op) {
-							case Iop_F32toF64:
-							case Iop_ReinterpI64asF64:
-							case Iop_32UtoV128:
-							case Iop_V128to64:
-							case Iop_V128HIto64:
-							case Iop_64to32:
-							case Iop_64HIto32:
-							case Iop_64UtoV128:
-							case Iop_32Uto64:
-								if (expr->Iex.Unop.arg->tag == Iex_RdTmp) {
-									if (tmpInstead[expr->Iex.Unop.arg->Iex.RdTmp.tmp] >= 0) {
-										tmpInstead[st->Ist.WrTmp.tmp] = tmpInstead[expr->Iex.Unop.arg->Iex.RdTmp.tmp];
-									} else {
-										tmpInstead[st->Ist.WrTmp.tmp] = expr->Iex.Unop.arg->Iex.RdTmp.tmp;
-									}
-								}
-								break;
-							default:
-								break;
-						}
-						break;
-					case Iex_Binop:
-						switch (expr->Iex.Binop.op) {
-							case Iop_F64toF32:
-								if (expr->Iex.Binop.arg2->tag == Iex_RdTmp) {
-									if (tmpInstead[expr->Iex.Binop.arg2->Iex.RdTmp.tmp] >= 0) {
-										tmpInstead[st->Ist.WrTmp.tmp] = tmpInstead[expr->Iex.Binop.arg2->Iex.RdTmp.tmp]; 
-									} else {
-										tmpInstead[st->Ist.WrTmp.tmp] = expr->Iex.Binop.arg2->Iex.RdTmp.tmp;
-									}
-								}
-								break;
-							case Iop_64HLtoV128:
-							case Iop_32HLto64:
-								if (expr->Iex.Binop.arg1->tag == Iex_RdTmp) {
-									if (tmpInstead[expr->Iex.Binop.arg1->Iex.RdTmp.tmp] >= 0) {
-										tmpInstead[st->Ist.WrTmp.tmp] = tmpInstead[expr->Iex.Binop.arg1->Iex.RdTmp.tmp]; 
-									} else {
-										tmpInstead[st->Ist.WrTmp.tmp] = expr->Iex.Binop.arg1->Iex.RdTmp.tmp;
-									}
-								} else if (expr->Iex.Binop.arg2->tag == Iex_RdTmp) {
-									if (tmpInstead[expr->Iex.Binop.arg2->Iex.RdTmp.tmp] >= 0) {
-										tmpInstead[st->Ist.WrTmp.tmp] = tmpInstead[expr->Iex.Binop.arg2->Iex.RdTmp.tmp]; 
-									} else {
-										tmpInstead[st->Ist.WrTmp.tmp] = expr->Iex.Binop.arg2->Iex.RdTmp.tmp;
-									}
-								}
-								break;
-							default:
-								break;
-						}
-						break;
-					default:
-						break;
-				}
-				break;
-			default:
-				break;
-		}
+static ShadowValue* readWrappedArg(Addr addr, mpfr_t* tmpX, mpfr_t* midX, mpfr_t* oriX, mpfr_t irel) {
+	ShadowValue* sv = lookupShadow(addr);
+	int t;
+
+	if (sv && !sv->active) {
+		sv = NULL;
 	}
+	checkAndRecover(sv);
+	computeRelativeError(sv, irel);
 
-	instrumentEnterSB(sbOut);
+	if (sv) {
+		mpfr_set(*tmpX, sv->value, STD_RND);
+		mpfr_set(*midX, sv->midValue, STD_RND);
+		beginEmulateDouble();
+		t = mpfr_set(*oriX, sv->oriValue, STD_RND);
+		mpfr_subnormalize(*oriX, t, STD_RND);
+		endEmulate();
+	} else {
+		mpfr_set_d(*tmpX, *(Double*)addr, STD_RND);
+		mpfr_set(*midX, *tmpX, STD_RND);
+		beginEmulateDouble();
+		t = mpfr_set(*oriX, *tmpX, STD_RND);
+		mpfr_subnormalize(*oriX, t, STD_RND);
+		endEmulate();
+	}
+	return sv;
+}
 
-	Int arg1tmpInstead = -1;
-	Int arg2tmpInstead = -1;
-	RetType retType;
+/* A wrapped library function returned. The arguments are at argsAddr and 
+   argsAddr + 8, the (native) result is at resAddr. The shadow value of the 
+   result is computed with a single MPFR function instead of shadowing every 
+   operation inside the library. */
+static void processWrappedCall(UWord fn, Addr argsAddr, Addr resAddr, Addr callSite) {
+	if (!clo_analyze || !clo_wrap_libm) return;
+	tl_assert(fn <= FD_FN_FMOD);
 
-	/* This is the main loop which hads instructions for the analysis (instrumentation).*/
-	for (/*use current i*/; i < sbIn->stmts_used; i++) {
-		IRStmt* st = sbIn->stmts[i];
-		if (!st || st->tag == Ist_NoOp) continue;
-      
-		switch (st->tag) {
-			case Ist_AbiHint:
-				addStmtToIRSB(sbOut, st);
-				break;
-			case Ist_Put:
-				addStmtToIRSB(sbOut, st);
-				putCount++;
+	Bool isBinary = fn >= FD_FN_POW && fn <= FD_FN_FMOD;
+	Bool needFix = clo_detect_pso && VG_(HT_lookup)(detectedPSO, callSite) != NULL;
+	Double org = *(Double*)resAddr;
 
-				if (st->Ist.Put.offset != 168) {
-					arg1tmpInstead = -1;
-					if (st->Ist.Put.data->tag == Iex_RdTmp) {
-						arg1tmpInstead = tmpInstead[st->Ist.Put.data->Iex.RdTmp.tmp];
-					}
-					instrumentPut(sbOut, tyenv, st, arg1tmpInstead);
-				} else {
-					putsIgnored++;
-				}
-				break;
-			case Ist_PutI:
-				addStmtToIRSB(sbOut, st);
-				arg1tmpInstead = -1;
-				if (st->Ist.PutI.data->tag == Iex_RdTmp) {
-					arg1tmpInstead = tmpInstead[st->Ist.PutI.data->Iex.RdTmp.tmp];
-				}
-				instrumentPutI(sbOut, tyenv, st, arg1tmpInstead);
-				break;
-			case Ist_IMark:
-				/* address of current instruction */
-				cia = st->Ist.IMark.addr;
-				addStmtToIRSB(sbOut, st);
-				break;
-			case Ist_Exit:
-				addStmtToIRSB(sbOut, st);
-				break;
-			case Ist_WrTmp:
-				expr = st->Ist.WrTmp.data;
-		        type = typeOfIRExpr(sbOut->tyenv, expr);
-		        tl_assert(type != Ity_INVALID);
+	if (clo_simulateOriginal) {
+		mpfr_set_prec(arg1tmpX, 53);
+		mpfr_set_prec(arg2tmpX, 53);
+	}
+	mpfr_set_prec(arg1midX, 53);
+	mpfr_set_prec(arg2midX, 53);
+	mpfr_set_prec(arg1oriX, 53);
+	mpfr_set_prec(arg2oriX, 53);
 
-		        switch (expr->tag) {
-					case Iex_Const:
-						addStmtToIRSB(sbOut, st);
-						break;
-					case Iex_Load:
-						addStmtToIRSB(sbOut, st);
-						loadCount++;
-						instrumentLoad(sbOut, tyenv, st);
-						break;
-					case Iex_Get:
-						addStmtToIRSB(sbOut, st);
-						getCount++;
+	mpfr_t irel1, irel2;
+	mpfr_inits(irel1, irel2, NULL);
 
-						if (tmpInstead[st->Ist.WrTmp.tmp] < 0) {
-							instrumentGet(sbOut, tyenv, st);
-						} else {
-							getsIgnored++;
-						}
-						break;
-					case Iex_GetI:
-						addStmtToIRSB(sbOut, st);
+	ShadowValue* arg1sv = readWrappedArg(argsAddr, &arg1tmpX, &arg1midX, &arg1oriX, irel1);
+	ShadowValue* arg2sv = NULL;
+	if (isBinary) {
+		arg2sv = readWrappedArg(argsAddr + sizeof(Double), &arg2tmpX, &arg2midX, &arg2oriX, irel2);
+	} else {
+		mpfr_set_ui(irel2, 0, STD_RND);
+	}
 
-						if (tmpInstead[st->Ist.WrTmp.tmp] < 0) {
-							instrumentGetI(sbOut, tyenv, st);
-						}
-						break;
-					case Iex_Unop:
-						// opToStr(expr->Iex.Unop.op);
-						// VG_(umsg)("una : %s\n", opStr);
-						switch (expr->Iex.Unop.op) {
-							case Iop_Sqrt32F0x4:
-							case Iop_Sqrt64F0x2:
-							case Iop_NegF32:
-							case Iop_NegF64:
-							case Iop_AbsF32:
-							case Iop_AbsF64:
-								addStmtToIRSB(sbOut, st);
+	ShadowValue* res = VG_(HT_lookup)(globalMemory, resAddr);
+	if (!res) {
+		res = initShadowValue((UWord)resAddr);
+		VG_(HT_add_node)(globalMemory, res);
+	}
+	res->active = True;
+	res->epoch = scopeEpoch;
+	res->dd = False;
+	res->stoValid = False;
+	res->psoValid = 0;
+	selectPrecision(callSite);
+	adjustPrecision(res);
 
-								arg1tmpInstead = -1;
-								if (expr->Iex.Unop.arg->tag == Iex_RdTmp) {
-									arg1tmpInstead = tmpInstead[expr->Iex.Unop.arg->Iex.RdTmp.tmp];
-								}
-								instrumentUnOp(sbOut, tyenv, cia, st->Ist.WrTmp.tmp, expr, arg1tmpInstead);
-								break;
-							case Iop_F32toF64:
-							case Iop_ReinterpI64asF64:
-							case Iop_32UtoV128:
-							case Iop_V128to64:
-							case Iop_V128HIto64:
-							case Iop_64to32:
-							case Iop_64HIto32:
-							case Iop_64UtoV128:
-							case Iop_32Uto64:
-								/* ignored floating-point and related SSE operations */
-								addStmtToIRSB(sbOut, st);
-								break;
-							case Iop_Recip32Fx4:
-        					case Iop_Sqrt32Fx4:
-							case Iop_RSqrt32Fx4:
-							case Iop_RoundF32x4_RM:
-							case Iop_RoundF32x4_RP:
-							case Iop_RoundF32x4_RN:
-							case Iop_RoundF32x4_RZ:
-							case Iop_Recip32F0x4:
-							case Iop_RSqrt32F0x4:
-							case Iop_Recip64Fx2:
-							case Iop_Sqrt64Fx2:
-							case Iop_RSqrt64Fx2:
-							case Iop_Recip64F0x2:
-							case Iop_RSqrt64F0x2:
-							case Iop_SinF64:
-							case Iop_CosF64:
-							case Iop_TanF64:
-							case Iop_2xm1F64:
-							case Iop_Est5FRSqrt:
-							case Iop_RoundF64toF64_NEAREST:
-							case Iop_RoundF64toF64_NegINF:
-							case Iop_RoundF64toF64_PosINF:
-							case Iop_RoundF64toF64_ZERO:
-							case Iop_TruncF64asF32:
-								addStmtToIRSB(sbOut, st);
-								reportUnsupportedOp(expr->Iex.Unop.op);
-								break;
-							default:
-								addStmtToIRSB(sbOut, st);
-								break;
+	if (clo_simulateOriginal) {
+		mpfr_set_prec(res->value, 53);
+	}
+	mpfr_set_prec(res->midValue, 53);
+	mpfr_set_prec(res->oriValue, 53);
+
+	if (needFix) {
+		mpfr_set(arg1midX, arg1tmpX, STD_RND);
+		mpfr_set(arg2midX, arg2tmpX, STD_RND);
+	}
+
+	computeFunction(fn, res->value, arg1tmpX, arg2tmpX);
+	computeFunction(fn, res->midValue, arg1midX, arg2midX);
+	resetDerivedValues(res);
+	/* libm is not correctly rounded, so the emulated original value is the 
+	   native result. Otherwise it would be "recovered" at its next use. */
+	mpfr_set_d(res->oriValue, org, STD_RND);
+
+	fpOps++;
+
+	res->opCount = 1;
+	res->canceled = 0;
+	res->cancelOrigin = callSite;
+	if (arg1sv) {
+		res->opCount += arg1sv->opCount;
+		res->canceled = arg1sv->canceled;
+		res->cancelOrigin = arg1sv->cancelOrigin;
+	}
+	if (arg2sv) {
+		if (arg2sv->opCount + 1 > res->opCount) {
+			res->opCount = arg2sv->opCount + 1;
+		}
+		if (arg2sv->canceled > res->canceled) {
+			res->canceled = arg2sv->canceled;
+			res->cancelOrigin = arg2sv->cancelOrigin;
+		}
+	}
+	res->origin = callSite;
+	res->Org.db = org;
+	res->orgType = Ot_DOUBLE;
+
+	if (clo_computeMeanValue) {
+		mpfr_set_d(meanOrg, org, STD_RND);
+		updateMeanValue(callSite, FD_FUNCTION_OP(fn), &(res->value), 0, 
+			arg1sv ? arg1sv->origin : 0, arg2sv ? arg2sv->origin : 0, 0);
+	}
+
+	if (needFix) {
+		mpfr_set(res->value, res->midValue, STD_RND);
+	}
+	if (activeStages > 0) {
+		updateStages(resAddr, False);
+	}
+	if (clo_detect_pso && !finishPSO) {
+		mpfr_max(irel1, irel1, irel2, STD_RND);
+		analyzePSO(irel1, res);
+	}
+	if (clo_print_every_error) {
+		printErrorShort(res);
+	}
+	mpfr_clears(irel1, irel2, NULL);
+}
+
+static ShadowValue* newBlasOutput(BlasCall* call, Addr addr) {
+	if (call->count == call->size) {
+		call->size = call->size ? 2 * call->size : 64;
+		call->outputs = VG_(realloc)("fd.newBlasOutput.1", call->outputs, call->size * sizeof(ShadowValue*));
+	}
+	ShadowValue* sv = initShadowValue((UWord)addr);
+	if (clo_simulateOriginal) {
+		mpfr_set_prec(sv->value, 53);
+	}
+	mpfr_set_prec(sv->midValue, 53);
+	mpfr_set_prec(sv->oriValue, 53);
+	mpfr_set_ui(sv->value, 0, STD_RND);
+	mpfr_set_ui(sv->midValue, 0, STD_RND);
+	sv->canceled = 0;
+	sv->cancelOrigin = call->callSite;
+	call->outputs[call->count++] = sv;
+	return sv;
+}
+
+/* Reads the shadow value of a BLAS operand, or the native value if it has none. */
+static void readBlasElem(BlasCall* call, Addr addr, mpfr_t val, mpfr_t mid) {
+	ShadowValue* sv = lookupShadow(addr);
+	if (sv && sv->active && sv->orgType == Ot_DOUBLE) {
+		mpfr_set(val, sv->value, STD_RND);
+		mpfr_set(mid, sv->midValue, STD_RND);
+		if (sv->opCount > call->opCount) {
+			call->opCount = sv->opCount;
+		}
+	} else {
+		mpfr_set_d(val, *(Double*)addr, STD_RND);
+		mpfr_set(mid, val, STD_RND);
+	}
+}
+
+static __inline__
+Addr blasElemAddr(BlasMatrix* mat, Long i, Long j) {
+	return mat->base + (i * mat->rowStride + j * mat->colStride) * sizeof(Double);
+}
+
+/* Start of a vector with increment inc (negative increments go backwards). */
+static __inline__
+Addr blasVectorBase(Addr x, Int len, Int inc) {
+	if (inc < 0) {
+		return x + (Long)(1 - len) * inc * sizeof(Double);
+	}
+	return x;
+}
+
+static void loadBlasBlock(BlasCall* call, BlasMatrix* mat, Int i0, Int rows, Int j0, Int cols, mpfr_t* val, mpfr_t* mid) {
+	Int i, j;
+	for (i = 0; i < rows; i++) {
+		for (j = 0; j < cols; j++) {
+			readBlasElem(call, blasElemAddr(mat, i0 + i, j0 + j), val[i * BLAS_BLOCK + j], mid[i * BLAS_BLOCK + j]);
+		}
+	}
+}
+
+/* C = alpha * A * B + beta * C with A (m x k), B (k x n) and C (m x n). 
+   The shadow values of C are appended to the outputs of the call, column 
+   by column. Blocks of A and B are converted once and reused for a block 
+   of C, so the hash table is not searched for every multiplication. The 
+   value is accumulated with fused multiply-adds, the mid value like the 
+   naive double loop. If c is NULL, beta * C is omitted (ddot). */
+static void blasGemm(BlasCall* call, Int m, Int n, Int k, Addr alpha, BlasMatrix* a, BlasMatrix* b, Addr beta, BlasMatrix* c) {
+	Int ib, jb, lb, i, j, l;
+	if (m <= 0 || n <= 0) return;
+
+	UInt first = call->count;
+	for (j = 0; j < n; j++) {
+		for (i = 0; i < m; i++) {
+			newBlasOutput(call, c ? blasElemAddr(c, i, j) : 0);
+		}
+	}
+
+	for (jb = 0; jb < n; jb += BLAS_BLOCK) {
+		Int nb = n - jb < BLAS_BLOCK ? n - jb : BLAS_BLOCK;
+		for (lb = 0; lb < k; lb += BLAS_BLOCK) {
+			Int kb = k - lb < BLAS_BLOCK ? k - lb : BLAS_BLOCK;
+			loadBlasBlock(call, b, lb, kb, jb, nb, blasBVal, blasBMid);
+			for (ib = 0; ib < m; ib += BLAS_BLOCK) {
+				Int mb = m - ib < BLAS_BLOCK ? m - ib : BLAS_BLOCK;
+				loadBlasBlock(call, a, ib, mb, lb, kb, blasAVal, blasAMid);
+				for (j = 0; j < nb; j++) {
+					for (i = 0; i < mb; i++) {
+						ShadowValue* sv = call->outputs[first + (ib + i) + (jb + j) * m];
+						for (l = 0; l < kb; l++) {
+							mpfr_fma(sv->value, blasAVal[i * BLAS_BLOCK + l], blasBVal[l * BLAS_BLOCK + j], sv->value, STD_RND);
+							mpfr_mul(blasMidProd, blasAMid[i * BLAS_BLOCK + l], blasBMid[l * BLAS_BLOCK + j], STD_RND);
+							mpfr_add(sv->midValue, sv->midValue, blasMidProd, STD_RND);
 						}
-						break;
-					case Iex_Binop:
-						// opToStr(expr->Iex.Binop.op);
-						// VG_(umsg)("bin : %s\n", opStr);
-						switch (expr->Iex.Binop.op) {
-							case Iop_CmpF64:
-								if (clo_goto_shadow_branch) {
-									arg1tmpInstead = -1;
-									arg2tmpInstead = -1;
-									if (expr->Iex.Binop.arg1->tag == Iex_RdTmp) {
-										arg1tmpInstead = tmpInstead[expr->Iex.Binop.arg1->Iex.RdTmp.tmp];
-									}
-									if (expr->Iex.Binop.arg2->tag == Iex_RdTmp) {
-										arg2tmpInstead = tmpInstead[expr->Iex.Binop.arg2->Iex.RdTmp.tmp];
-									}
-									instrumentCmpF64(sbOut, tyenv, cia, st->Ist.WrTmp.tmp, expr, arg1tmpInstead, arg2tmpInstead);
-								} else {
-									addStmtToIRSB(sbOut, st);
-								}
-								break;
-							case Iop_Add32F0x4:
-							case Iop_Add64F0x2:
-							case Iop_Sub32F0x4:
-							case Iop_Mul32F0x4:
-							case Iop_Div32F0x4:
-							case Iop_Sub64F0x2:
-							case Iop_Mul64F0x2:
-							case Iop_Div64F0x2:
-							case Iop_Min32F0x4:
-							case Iop_Min64F0x2:
-							case Iop_Max32F0x4:
-							case Iop_Max64F0x2:
-								addStmtToIRSB(sbOut, st);
+					}
+				}
+			}
+		}
+	}
 
-								arg1tmpInstead = -1;
-								arg2tmpInstead = -1;
-								if (expr->Iex.Binop.arg1->tag == Iex_RdTmp) {
-									arg1tmpInstead = tmpInstead[expr->Iex.Binop.arg1->Iex.RdTmp.tmp];
-								}
-								if (expr->Iex.Binop.arg2->tag == Iex_RdTmp) {
-									arg2tmpInstead = tmpInstead[expr->Iex.Binop.arg2->Iex.RdTmp.tmp];
-								}
-								instrumentBinOp(sbOut, tyenv, cia, st->Ist.WrTmp.tmp, expr, arg1tmpInstead, arg2tmpInstead);
-								break;
-							case Iop_F64toF32:
-							case Iop_64HLtoV128:
-							case Iop_32HLto64:
-								/* ignored floating-point and related SSE operations */
-								addStmtToIRSB(sbOut, st);
-								break;
-							case Iop_F64toI16S:
-							case Iop_F64toI32S:
-							case Iop_F64toI64S:
-							case Iop_F64toI64U:
-							case Iop_F64toI32U:
-								if (clo_track_int) {
-									arg2tmpInstead = -1;
-									if (expr->Iex.Binop.arg2->tag == Iex_RdTmp) {
-										arg2tmpInstead = tmpInstead[expr->Iex.Binop.arg2->Iex.RdTmp.tmp];
-									}
-									switch(expr->Iex.Binop.op) {
+	/* scaling, beta == 0 means that C is not read */
+	Bool useBeta = c && *(Double*)beta != 0.0;
+	if (alpha) {
+		readBlasElem(call, alpha, blasAVal[0], blasAMid[0]);
+	}
+	if (useBeta) {
+		readBlasElem(call, beta, blasBVal[0], blasBMid[0]);
+	}
+	for (j = 0; j < n; j++) {
+		for (i = 0; i < m; i++) {
+			ShadowValue* sv = call->outputs[first + i + j * m];
+			if (alpha) {
+				mpfr_mul(sv->value, sv->value, blasAVal[0], STD_RND);
+				mpfr_mul(sv->midValue, sv->midValue, blasAMid[0], STD_RND);
+			}
+			if (useBeta) {
+				readBlasElem(call, blasElemAddr(c, i, j), blasBVal[1], blasBMid[1]);
+				mpfr_fma(sv->value, blasBVal[0], blasBVal[1], sv->value, STD_RND);
+				mpfr_mul(blasMidProd, blasBMid[0], blasBMid[1], STD_RND);
+				mpfr_add(sv->midValue, sv->midValue, blasMidProd, STD_RND);
+			}
+		}
+	}
+}
+
+static Bool isBlasNoTrans(Addr trans) {
+	Char t = *(Char*)trans;
+	return t == 'N' || t == 'n';
+}
+
+/* A wrapped BLAS function is called; args points to the (Fortran) arguments.
+   The shadow values of the outputs are computed now, because the native 
+   call may overwrite the inputs (y and C). */
+static void blasBegin(ThreadId tid, UWord fn, Addr args, Addr callSite) {
+	if (!clo_analyze || !clo_wrap_blas) return;
+
+	BlasCall* call = &(blasCalls[tid]);
+	UWord* w = (UWord*)args;
+	BlasMatrix a, b, c;
+	Int n, m, k, inc;
+
+	call->fn = fn;
+	call->callSite = callSite;
+	call->opCount = 0;
+	call->count = 0;
+
+	switch (fn) {
+		case FD_FN_DDOT:
+			/* 1 x n times n x 1 */
+			n = *(Int*)w[0];
+			inc = *(Int*)w[2];
+			a.base = blasVectorBase(w[1], n, inc);
+			a.rowStride = 0;
+			a.colStride = inc;
+			inc = *(Int*)w[4];
+			b.base = blasVectorBase(w[3], n, inc);
+			b.rowStride = inc;
+			b.colStride = 0;
+			blasGemm(call, 1, 1, n, 0, &a, &b, 0, NULL);
+			break;
+		case FD_FN_DAXPY: {
+			n = *(Int*)w[0];
+			Int incx = *(Int*)w[3];
+			Int incy = *(Int*)w[5];
+			Addr x = blasVectorBase(w[2], n, incx);
+			Addr y = blasVectorBase(w[4], n, incy);
+			readBlasElem(call, w[1], blasAVal[0], blasAMid[0]);
+			Int i;
+			for (i = 0; i < n; i++) {
+				ShadowValue* sv = newBlasOutput(call, y + (Long)i * incy * sizeof(Double));
+				readBlasElem(call, x + (Long)i * incx * sizeof(Double), blasBVal[0], blasBMid[0]);
+				readBlasElem(call, sv->key, sv->value, sv->midValue);
+				mpfr_fma(sv->value, blasAVal[0], blasBVal[0], sv->value, STD_RND);
+				mpfr_mul(blasMidProd, blasAMid[0], blasBMid[0], STD_RND);
+				mpfr_add(sv->midValue, sv->midValue, blasMidProd, STD_RND);
+			}
+			break;
+		}
+		case FD_FN_DGEMV: {
+			m = *(Int*)w[1];
+			n = *(Int*)w[2];
+			Int lda = *(Int*)w[5];
+			Int rows = m, cols = n;
+			a.base = w[4];
+			if (isBlasNoTrans(w[0])) {
+				a.rowStride = 1;
+				a.colStride = lda;
+			} else {
+				/* y = alpha * A^T * x + beta * y */
+				rows = n;
+				cols = m;
+				a.rowStride = lda;
+				a.colStride = 1;
+			}
+			inc = *(Int*)w[7];
+			b.base = blasVectorBase(w[6], cols, inc);
+			b.rowStride = inc;
+			b.colStride = 0;
+			inc = *(Int*)w[10];
+			c.base = blasVectorBase(w[9], rows, inc);
+			c.rowStride = inc;
+			c.colStride = 0;
+			blasGemm(call, rows, 1, cols, w[3], &a, &b, w[8], &c);
+			break;
+		}
+		case FD_FN_DGEMM: {
+			m = *(Int*)w[2];
+			n = *(Int*)w[3];
+			k = *(Int*)w[4];
+			Int lda = *(Int*)w[7];
+			Int ldb = *(Int*)w[9];
+			a.base = w[6];
+			if (isBlasNoTrans(w[0])) {
+				a.rowStride = 1;
+				a.colStride = lda;
+			} else {
+				a.rowStride = lda;
+				a.colStride = 1;
+			}
+			b.base = w[8];
+			if (isBlasNoTrans(w[1])) {
+				b.rowStride = 1;
+				b.colStride = ldb;
+			} else {
+				b.rowStride = ldb;
+				b.colStride = 1;
+			}
+			c.base = w[11];
+			c.rowStride = 1;
+			c.colStride = *(Int*)w[12];
+			blasGemm(call, m, n, k, w[5], &a, &b, w[10], &c);
+			break;
+		}
+		default:
+			VG_(tool_panic)("Unhandled function in blasBegin\n");
+			break;
+	}
+	fpOps += call->count;
+}
+
+/* The native BLAS call returned. The computed shadow values replace the 
+   shadow values of the outputs; resAddr is the result of ddot. */
+static void blasEnd(ThreadId tid, UWord fn, Addr resAddr) {
+	BlasCall* call = &(blasCalls[tid]);
+	if (call->count == 0) return;
+	tl_assert(call->fn == fn);
+
+	UInt i;
+	for (i = 0; i < call->count; i++) {
+		ShadowValue* sv = call->outputs[i];
+		if (fn == FD_FN_DDOT) {
+			sv->key = resAddr;
+		}
+		Double org = *(Double*)(sv->key);
+		mpfr_set_d(sv->oriValue, org, STD_RND);
+		sv->Org.db = org;
+		sv->orgType = Ot_DOUBLE;
+		sv->opCount = call->opCount + 1;
+		sv->origin = call->callSite;
+		sv->active = True;
+		resetDerivedValues(sv);
+
+		if (clo_computeMeanValue) {
+			mpfr_set_d(meanOrg, org, STD_RND);
+			updateMeanValue(call->callSite, FD_FUNCTION_OP(fn), &(sv->value), 0, 0, 0, 0);
+		}
+
+		ShadowValue* current = VG_(HT_lookup)(globalMemory, sv->key);
+		if (current) {
+			copyShadowValue(current, sv);
+			current->active = True;
+			current->epoch = scopeEpoch;
+			freeShadowValue(sv, True);
+		} else {
+			VG_(HT_add_node)(globalMemory, sv);
+		}
+		if (activeStages > 0) {
+			updateStages(sv->key, False);
+		}
+	}
+	call->count = 0;
+}
+
+static VG_REGPARM(1) void processMux0X(UWord ca) {
+	// VG_(umsg)("processMux0X\n");
+	if (!clo_analyze) return;
+
+	Int constArgs = (Int)ca;
+	ShadowValue *aexpr0 = NULL;
+	ShadowValue *aexprX = NULL;
+
+	if (constArgs & 0x2) {
+		if (!muxArgs->condVal) {
+			return;
+		}
+	} else {
+		aexpr0 = peekTemp(muxArgs->expr0);
+		if (!aexpr0 && !muxArgs->condVal) {
+			return;
+		}
+	}
+
+	if (constArgs & 0x4) {
+		if (muxArgs->condVal) {
+			return;
+		}
+	} else {
+		aexprX = peekTemp(muxArgs->exprX);
+		if (!aexprX && muxArgs->condVal) {
+			return;
+		}
+	}
+
+	ShadowValue* res = setTemp(muxArgs->wrTmp);
+	// VG_(umsg)("processMux0X %X\n", muxArgs->wrTmp);
+	if (muxArgs->condVal) {
+		copyShadowValue(res, aexprX);
+	} else {
+		copyShadowValue(res, aexpr0);
+	}
+}
+
+static void instrumentMux0X(IRSB* sb, IRTypeEnv* env, IRTemp wrTemp, IRExpr* mux, Int arg0tmpInstead, Int argXtmpInstead) {
+	tl_assert(mux->tag == Iex_Mux0X);
+
+	IRExpr* cond = mux->Iex.Mux0X.cond;
+	IRExpr* expr0 = mux->Iex.Mux0X.expr0;
+	IRExpr* exprX = mux->Iex.Mux0X.exprX;
+
+	tl_assert(cond->tag == Iex_RdTmp);
+	tl_assert(expr0->tag == Iex_RdTmp || expr0->tag == Iex_Const);
+	tl_assert(exprX->tag == Iex_RdTmp || exprX->tag == Iex_Const);
+
+	Int constArgs = 0;
+	IRStmt* store = IRStmt_Store(Iend_LE, mkU64(&(muxArgs->wrTmp)), mkU32(wrTemp));
+	addStmtToIRSB(sb, store);
+	store = IRStmt_Store(Iend_LE, mkU64(&(muxArgs->condVal)), mux->Iex.Mux0X.cond);
+	addStmtToIRSB(sb, store);
+
+	if (expr0->tag == Iex_RdTmp) {
+		if (arg0tmpInstead >= 0) {
+			store = IRStmt_Store(Iend_LE, mkU64(&(muxArgs->expr0)), mkU32(arg0tmpInstead));
+		} else {
+			store = IRStmt_Store(Iend_LE, mkU64(&(muxArgs->expr0)), mkU32(mux->Iex.Mux0X.expr0->Iex.RdTmp.tmp));
+		}
+		addStmtToIRSB(sb, store);
+	} else {
+		constArgs |= 0x2;
+	}
+
+	if (exprX->tag == Iex_RdTmp) {
+		if (argXtmpInstead >= 0) {
+			store = IRStmt_Store(Iend_LE, mkU64(&(muxArgs->exprX)), mkU32(argXtmpInstead));
+		} else {
+			store = IRStmt_Store(Iend_LE, mkU64(&(muxArgs->exprX)), mkU32(mux->Iex.Mux0X.exprX->Iex.RdTmp.tmp));
+		}
+		addStmtToIRSB(sb, store);
+	} else {
+		constArgs |= 0x4;
+	}
+
+	IRExpr** argv = mkIRExprVec_1(mkU64(constArgs));
+	IRDirty* di = unsafeIRDirty_0_N(1, "processMux0X", VG_(fnptr_to_fnentry)(&processMux0X), argv);
+	addHelperToIRSB(sb, di);
+}
+
+/* Code out of scope is not instrumented, so a shadow value of a register 
+   written before it ran is dropped. */
+static Bool isValidRegister(ShadowValue* av) {
+	if (!av || !(av->active)) {
+		return False;
+	}
+	if (av->epoch != scopeEpoch) {
+		av->active = False;
+		return False;
+	}
+	return True;
+}
+
+static VG_REGPARM(2) void processLoad(UWord tmp, Addr addr) {
+	if (!clo_analyze) return;
+
+	/* check if this memory address is shadowed */
+	ShadowValue* av = VG_(HT_lookup)(globalMemory, addr);
+	if (!isValidMemory(av)) {
+		return;
+	}
+	// VG_(umsg)("processLoad %X\n", tmp);
+	// VG_(umsg)("load address: %lX\n", addr);
+	ShadowValue* res = setTemp(tmp);
+	copyShadowValue(res, av);
+	// VG_(umsg)("av\n");
+	// printErrorShort(av);
+	// VG_(umsg)("res\n");
+	// printErrorShort(res);
+}
+
+static VG_REGPARM(2) void processLoadV128(UWord tmp, Addr addr) {
+	if (!clo_analyze) return;
+
+	ShadowValue* slots[MAX_LANES];
+	Int k;
+	for (k = 0; k < MAX_LANES; k++) {
+		ShadowValue* av = VG_(HT_lookup)(globalMemory, addr + 4 * k);
+		slots[k] = isValidMemory(av) ? av : NULL;
+	}
+	slotsToTemp((Int)tmp, slots);
+}
+
+static void instrumentLoad(IRSB* sb, IRTypeEnv* env, IRStmt* wrTmp) {
+	tl_assert(wrTmp->tag == Ist_WrTmp);
+	tl_assert(wrTmp->Ist.WrTmp.data->tag == Iex_Load);
+	IRExpr* load = wrTmp->Ist.WrTmp.data;
+
+	if (load->Iex.Load.addr->tag != Iex_RdTmp) {
+		return;
+	}
+	
+	IRExpr** argv = mkIRExprVec_2(mkU64(wrTmp->Ist.WrTmp.tmp), load->Iex.Load.addr);
+	IRDirty* di;
+	if (load->Iex.Load.ty == Ity_V128) {
+		di = unsafeIRDirty_0_N(2, "processLoadV128", VG_(fnptr_to_fnentry)(&processLoadV128), argv);
+	} else {
+		di = unsafeIRDirty_0_N(2, "processLoad", VG_(fnptr_to_fnentry)(&processLoad), argv);
+	}
+	addHelperToIRSB(sb, di);
+}
+
+static VG_REGPARM(3) void processStore(Addr addr, UWord t, UWord isFloat) {
+	// VG_(umsg)("processStore\n");
+	Int tmp = (Int)t;
+	ShadowValue* res = NULL;
+	ShadowValue* currentVal = VG_(HT_lookup)(globalMemory, addr);
+
+	if (clo_analyze && tmp >= 0) {
+		/* check if this memory address is shadowed */
+		ShadowValue* av = peekTemp(tmp);
+		// VG_(umsg)("processStore %X\n", tmp);
+		// VG_(umsg)("Store address: %lX\n", addr);
+		// Addr lastAddr = addr - 4;
+
+		if (av) {
+			// VG_(umsg)("processStore2 %X\n", tmp);
+			if (currentVal) {
+				res = currentVal;
+				copyShadowValue(res, av);
+				res->active = True;
+			} else {
+				res = initShadowValue((UWord)addr);
+				copyShadowValue(res, av);
+				VG_(HT_add_node)(globalMemory, res);
+				// VG_(umsg)("processStore create\n");
+			}
+			res->epoch = scopeEpoch;
+
+			if ((Bool)isFloat) {
+				res->orgType = Ot_FLOAT;
+			} else {
+				res->orgType = Ot_DOUBLE;
+			}
+			if (res->orgType == Ot_FLOAT) {
+				res->Org.fl = storeArgs->orgFloat;
+			} else if (res->orgType == Ot_DOUBLE) {
+				res->Org.db = storeArgs->orgDouble;
+			} else {
+				tl_assert(False);
+			}
+	
+			if (activeStages > 0) {
+				updateStages(addr, res->orgType == Ot_FLOAT);
+			}
+		}
+	}
+
+	if (currentVal && !res) {
+		currentVal->active = False;
+	}
+}
+
+static VG_REGPARM(2) void processStoreV128(Addr addr, UWord t) {
+	ShadowValue* slots[MAX_LANES];
+	tempToSlots((Int)t, slots);
+
+	Int k;
+	for (k = 0; k < MAX_LANES; k++) {
+		Addr slotAddr = addr + 4 * k;
+		ShadowValue* currentVal = VG_(HT_lookup)(globalMemory, slotAddr);
+
+		if (slots[k]) {
+			ShadowValue* res = currentVal;
+			if (res) {
+				copyShadowValue(res, slots[k]);
+				res->active = True;
+			} else {
+				res = initShadowValue((UWord)slotAddr);
+				copyShadowValue(res, slots[k]);
+				VG_(HT_add_node)(globalMemory, res);
+			}
+			res->epoch = scopeEpoch;
+
+			if (activeStages > 0) {
+				updateStages(slotAddr, res->orgType == Ot_FLOAT);
+			}
+		} else if (currentVal) {
+			currentVal->active = False;
+		}
+	}
+}
+
+static void instrumentStore(IRSB* sb, IRTypeEnv* env, IRStmt* store, Int argTmpInstead) {
+	tl_assert(store->tag == Ist_Store);
+
+	Bool isFloat = True;
+	IRExpr* data = store->Ist.Store.data;
+
+	if (typeOfIRExpr(env, data) == Ity_V128) {
+		/* the original values are taken from the shadow values of the lanes */
+		Int num = -1;
+		if (data->tag == Iex_RdTmp) {
+			num = argTmpInstead >= 0 ? argTmpInstead : data->Iex.RdTmp.tmp;
+		}
+		IRExpr** argv = mkIRExprVec_2(store->Ist.Store.addr, mkU64(num));
+		IRDirty* di = unsafeIRDirty_0_N(2, "processStoreV128", VG_(fnptr_to_fnentry)(&processStoreV128), argv);
+		addHelperToIRSB(sb, di);
+		return;
+	}
+	if (data->tag == Iex_RdTmp) {
+		/* I32 and I64 have to be instrumented due to SSE */
+		switch (typeOfIRTemp(env, data->Iex.RdTmp.tmp)) {
+			case Ity_I64:
+			case Ity_F64:
+			case Ity_V128:
+				isFloat = False;
+				break;
+			default:
+				break;
+		}
+	}
+
+	IRExpr* addr = store->Ist.Store.addr;
+	/* const needed, but only to delete */
+	tl_assert(data->tag == Iex_RdTmp || data->tag == Iex_Const);
+
+	Int num = -1;
+	IRType type = Ity_F32;
+	if (data->tag != Iex_Const) {
+		if (argTmpInstead >= 0) {
+			num = argTmpInstead;
+		} else {
+			num = data->Iex.RdTmp.tmp;
+		}
+		type = typeOfIRTemp(env, num);
+
+		if (isFloat) {
+			IRStmt* store = IRStmt_Store(Iend_LE, mkU64(&(storeArgs->orgFloat)), IRExpr_RdTmp(data->Iex.RdTmp.tmp));
+			addStmtToIRSB(sb, store);
+		} else {
+			IRStmt* store = IRStmt_Store(Iend_LE, mkU64(&(storeArgs->orgDouble)), IRExpr_RdTmp(data->Iex.RdTmp.tmp));
+			addStmtToIRSB(sb, store);
+		}
+	}
+	
+	IRExpr** argv = mkIRExprVec_3(addr, mkU64(num), mkU64(isFloat));
+	IRDirty* di = unsafeIRDirty_0_N(3, "processStore", VG_(fnptr_to_fnentry)(&processStore), argv);
+	addHelperToIRSB(sb, di);
+}
+
+static VG_REGPARM(2) void processPut(UWord offset, UWord t) {
+	// VG_(umsg)("processPut\n");
+	ShadowValue* res = NULL;
+	ThreadId tid = VG_(get_running_tid)();
+	ShadowValue* currentVal = threadRegisters[tid][offset];
+
+	Int tmp = (Int)t;
+	if (clo_analyze && tmp >= 0) {
+		/* check if a shadow value exits */
+		ShadowValue* av = peekTemp(tmp);
+		if (av) {
+			if (currentVal) {
+				/* reuse allocated space if possible ... */
+				res = currentVal;
+				copyShadowValue(res, av);
+			} else {
+				/* ... else allocate new space */
+				res = initShadowValue((UWord)offset);
+				copyShadowValue(res, av);
+				threadRegisters[tid][offset] = res;
+			}
+			res->active = True;
+			res->epoch = scopeEpoch;
+		}
+	}
+
+	if (currentVal && !res) {
+		/* Invalidate existing shadow value (not free) because 
+           something was stored in this register */
+		currentVal->active = False;
+	}
+}
+
+static VG_REGPARM(2) void processPutV128(UWord offset, UWord t) {
+	ThreadId tid = VG_(get_running_tid)();
+	ShadowValue* slots[MAX_LANES];
+	tempToSlots((Int)t, slots);
+
+	Int k;
+	for (k = 0; k < MAX_LANES; k++) {
+		ShadowValue* currentVal = threadRegisters[tid][offset + 4 * k];
+
+		if (slots[k]) {
+			if (currentVal) {
+				copyShadowValue(currentVal, slots[k]);
+			} else {
+				currentVal = initShadowValue((UWord)(offset + 4 * k));
+				copyShadowValue(currentVal, slots[k]);
+				threadRegisters[tid][offset + 4 * k] = currentVal;
+			}
+			currentVal->active = True;
+			currentVal->epoch = scopeEpoch;
+		} else if (currentVal) {
+			currentVal->active = False;
+		}
+	}
+}
+
+static void instrumentPut(IRSB* sb, IRTypeEnv* env, IRStmt* st, Int argTmpInstead) {
+	tl_assert(st->tag == Ist_Put);
+	IRExpr* data = st->Ist.Put.data;
+	tl_assert(data->tag == Iex_RdTmp || data->tag == Iex_Const);
+
+	Int offset = st->Ist.Put.offset;
+	tl_assert(offset >= 0 && offset < MAX_REGISTERS);
+
+	Int tmpNum = -1;
+	if (data->tag == Iex_RdTmp) {
+		if (argTmpInstead >= 0) {
+			tmpNum = argTmpInstead;
+		} else {
+			tmpNum = data->Iex.RdTmp.tmp;
+		}
+	}
+
+	IRExpr** argv = mkIRExprVec_2(mkU64(offset), mkU64(tmpNum));
+	IRDirty* di;
+	if (typeOfIRExpr(env, data) == Ity_V128) {
+		tl_assert(offset + 4 * (MAX_LANES - 1) < MAX_REGISTERS);
+		di = unsafeIRDirty_0_N(2, "processPutV128", VG_(fnptr_to_fnentry)(&processPutV128), argv);
+	} else {
+		di = unsafeIRDirty_0_N(2, "processPut", VG_(fnptr_to_fnentry)(&processPut), argv);
+	}
+	addHelperToIRSB(sb, di);
+}
+
+static VG_REGPARM(2) void processGet(UWord offset, UWord tmp) {
+	// VG_(umsg)("processGet\n");
+	if (!clo_analyze) return;
+
+	ThreadId tid = VG_(get_running_tid)();
+	ShadowValue* av = threadRegisters[tid][offset];
+	if (!isValidRegister(av)) {
+		return;
+	}
+
+	ShadowValue* res = setTemp((Int)tmp);
+	// VG_(umsg)("processGet %X\n", tmp);
+	copyShadowValue(res, av);
+}
+
+static VG_REGPARM(2) void processGetV128(UWord offset, UWord tmp) {
+	if (!clo_analyze) return;
+
+	ThreadId tid = VG_(get_running_tid)();
+	ShadowValue* slots[MAX_LANES];
+	Int k;
+	for (k = 0; k < MAX_LANES; k++) {
+		ShadowValue* av = threadRegisters[tid][offset + 4 * k];
+		slots[k] = isValidRegister(av) ? av : NULL;
+	}
+	slotsToTemp((Int)tmp, slots);
+}
+
+static void instrumentGet(IRSB* sb, IRTypeEnv* env, IRStmt* st) {
+	tl_assert(st->tag == Ist_WrTmp);
+	tl_assert(st->Ist.WrTmp.data->tag == Iex_Get);
+
+	Int tmpNum = st->Ist.WrTmp.tmp;
+	Int offset = st->Ist.WrTmp.data->Iex.Get.offset;
+	tl_assert(offset >= 0 && offset < MAX_REGISTERS);
+
+	IRExpr** argv = mkIRExprVec_2(mkU64(offset), mkU64(tmpNum));
+	IRDirty* di;
+	if (st->Ist.WrTmp.data->Iex.Get.ty == Ity_V128) {
+		tl_assert(offset + 4 * (MAX_LANES - 1) < MAX_REGISTERS);
+		di = unsafeIRDirty_0_N(2, "processGetV128", VG_(fnptr_to_fnentry)(&processGetV128), argv);
+	} else {
+		di = unsafeIRDirty_0_N(2, "processGet", VG_(fnptr_to_fnentry)(&processGet), argv);
+	}
+	addHelperToIRSB(sb, di);
+}
+
+static VG_REGPARM(3) void processPutI(UWord t, UWord b, UWord n) {
+	// VG_(umsg)("processPutI\n");
+	Int tmp = (Int)t;
+	Int nElems = (Int)n;
+	Int base = (Int)b;
+	Int bias = (Int)(circRegs->bias);
+
+	/* (ix + bias) % num-of-elems-in-the-array */
+	Int offset = base + ((circRegs->ix + bias) % nElems);
+	tl_assert(offset >= 0 && offset < MAX_REGISTERS);
+
+	ShadowValue* res = NULL;
+	ThreadId tid = VG_(get_running_tid)();
+	ShadowValue* currentVal = threadRegisters[tid][offset];
+
+	if (clo_analyze && tmp >= 0) {
+		/* check if a shadow value exits */
+		ShadowValue* av = peekTemp(tmp);
+		if (av) {
+			if (currentVal) {
+				/* reuse allocated space if possible ... */
+				res = currentVal;
+				copyShadowValue(res, av);
+			} else {
+				/* ... else allocate new space */
+				res = initShadowValue((UWord)offset);
+				copyShadowValue(res, av);
+				threadRegisters[tid][offset] = res;
+			}
+			res->active = True;
+			res->epoch = scopeEpoch;
+		}
+	}
+
+	if (currentVal && !res) {
+		/* Invalidate existing shadow value (not free) because 
+           something was stored in this register. */
+		currentVal->active = False;
+	}
+}
+
+static void instrumentPutI(IRSB* sb, IRTypeEnv* env, IRStmt* st, Int argTmpInstead) {
+	tl_assert(st->tag == Ist_PutI);
+	IRExpr* data = st->Ist.PutI.data;
+	IRExpr* ix = st->Ist.PutI.ix;
+	IRRegArray* descr = st->Ist.PutI.descr;
+	Int bias = st->Ist.PutI.bias;
+
+	tl_assert(data->tag == Iex_RdTmp || data->tag == Iex_Const);
+	tl_assert(ix->tag == Iex_RdTmp || ix->tag == Iex_Const);
+
+	tl_assert(ix->tag == Iex_RdTmp ? typeOfIRTemp(env, ix->Iex.RdTmp.tmp) == Ity_I32 : True);
+	tl_assert(ix->tag == Iex_Const ? ix->Iex.Const.con->tag == Ico_U32 : True);
+
+	Int tmpNum = -1;
+	if (data->tag == Iex_RdTmp) {
+		if (argTmpInstead >= 0) {
+			tmpNum = argTmpInstead;
+		} else {
+			tmpNum = data->Iex.RdTmp.tmp;
+		}
+	}
+
+	IRStmt* store = IRStmt_Store(Iend_LE, mkU64(&(circRegs->bias)), mkU64(bias));
+	addStmtToIRSB(sb, store);
+	store = IRStmt_Store(Iend_LE, mkU64(&(circRegs->ix)), ix);
+	addStmtToIRSB(sb, store);
+
+	IRExpr** argv = mkIRExprVec_3(mkU64(tmpNum), mkU64(descr->base), mkU64(descr->nElems));
+	IRDirty* di = unsafeIRDirty_0_N(3, "processPutI", VG_(fnptr_to_fnentry)(&processPutI), argv);
+	addHelperToIRSB(sb, di);
+}
+
+static VG_REGPARM(3) void processGetI(UWord tmp, UWord b, UWord n) {
+	// VG_(umsg)("processGetI\n");
+	if (!clo_analyze) return;
+
+	Int nElems = (Int)n;
+	Int base = (Int)b;
+	Int bias = (Int)(circRegs->bias);
+
+	/* (ix + bias) % num-of-elems-in-the-array */
+	Int offset = base + ((circRegs->ix + bias) % nElems);
+	tl_assert(offset >= 0 && offset < MAX_REGISTERS);
+
+	ThreadId tid = VG_(get_running_tid)();
+	ShadowValue* av = threadRegisters[tid][offset];
+	if (!isValidRegister(av)) {
+		return;
+	}
+
+	ShadowValue* res = setTemp((Int)tmp);
+	// VG_(umsg)("processGetI %X\n", tmp);
+	copyShadowValue(res, av);
+}
+
+static void instrumentGetI(IRSB* sb, IRTypeEnv* env, IRStmt* st) {
+	tl_assert(st->tag == Ist_WrTmp);
+	tl_assert(st->Ist.WrTmp.data->tag == Iex_GetI);
+	IRExpr* get = st->Ist.WrTmp.data;
+
+	IRExpr* ix = get->Iex.GetI.ix;
+	IRRegArray* descr = get->Iex.GetI.descr;
+	Int bias = get->Iex.GetI.bias;
+
+	tl_assert(ix->tag == Iex_RdTmp || ix->tag == Iex_Const);
+	tl_assert(ix->tag == Iex_RdTmp ? typeOfIRTemp(env, ix->Iex.RdTmp.tmp) == Ity_I32 : True);
+	tl_assert(ix->tag == Iex_Const ? ix->Iex.Const.con->tag == Ico_U32 : True);
+
+	Int tmpNum = st->Ist.WrTmp.tmp;
+
+	IRStmt* store = IRStmt_Store(Iend_LE, mkU64(&(circRegs->bias)), mkU64(bias));
+	addStmtToIRSB(sb, store);
+	store = IRStmt_Store(Iend_LE, mkU64(&(circRegs->ix)), ix);
+	addStmtToIRSB(sb, store);
+
+	IRExpr** argv = mkIRExprVec_3(mkU64(tmpNum), mkU64(descr->base), mkU64(descr->nElems));
+	IRDirty* di = unsafeIRDirty_0_N(3, "processGetI", VG_(fnptr_to_fnentry)(&processGetI), argv);
+	addHelperToIRSB(sb, di);
+}
+
+static void invalidateStaleShadowValues(void);
+
+/* Inlining of samplePos = (samplePos + 1) % (rate * window), the helpers 
+   are called only if samplePos < window. Nothing tracks the writes of the 
+   client between two windows, so the first superblock of a window 
+   (samplePos == 0) drops the stale shadow values once, as after switching 
+   the analysis on. Temporaries are invalidated by sbExecuted anyway. */
+static void instrumentSampling(IRSB* sb) {
+	ULong period = (ULong)clo_sample_rate * clo_sample_window;
+
+	IRTemp t1 = newIRTemp(sb->tyenv, Ity_I64);
+	addStmtToIRSB(sb, IRStmt_WrTmp(t1, IRExpr_Load(Iend_LE, Ity_I64, mkU64(&samplePos))));
+	IRTemp t2 = newIRTemp(sb->tyenv, Ity_I64);
+	addStmtToIRSB(sb, IRStmt_WrTmp(t2, IRExpr_Binop(Iop_Add64, IRExpr_RdTmp(t1), mkU64(1))));
+	IRTemp wrap = newIRTemp(sb->tyenv, Ity_I1);
+	addStmtToIRSB(sb, IRStmt_WrTmp(wrap, IRExpr_Binop(Iop_CmpEQ64, IRExpr_RdTmp(t2), mkU64(period))));
+	IRTemp cond = newIRTemp(sb->tyenv, Ity_I8);
+	addStmtToIRSB(sb, IRStmt_WrTmp(cond, IRExpr_Unop(Iop_1Uto8, IRExpr_RdTmp(wrap))));
+	IRTemp t3 = newIRTemp(sb->tyenv, Ity_I64);
+	addStmtToIRSB(sb, IRStmt_WrTmp(t3, IRExpr_Mux0X(IRExpr_RdTmp(cond), IRExpr_RdTmp(t2), mkU64(0))));
+	addStmtToIRSB(sb, IRStmt_Store(Iend_LE, mkU64(&samplePos), IRExpr_RdTmp(t3)));
+
+	IRTemp start = newIRTemp(sb->tyenv, Ity_I1);
+	addStmtToIRSB(sb, IRStmt_WrTmp(start, IRExpr_Binop(Iop_CmpEQ64, IRExpr_RdTmp(t3), mkU64(0))));
+	IRDirty* di = unsafeIRDirty_0_N(0, "invalidateStaleShadowValues", 
+		VG_(fnptr_to_fnentry)(&invalidateStaleShadowValues), mkIRExprVec_0());
+	di->guard = IRExpr_RdTmp(start);
+	addStmtToIRSB(sb, IRStmt_Dirty(di));
+
+	sampleGuard = newIRTemp(sb->tyenv, Ity_I1);
+	addStmtToIRSB(sb, IRStmt_WrTmp(sampleGuard, IRExpr_Binop(Iop_CmpLT64U, IRExpr_RdTmp(t3), mkU64(clo_sample_window))));
+}
+
+static void instrumentEnterSB(IRSB* sb) {
+	/* inlining of sbExecuted++ */
+	IRExpr* load = IRExpr_Load(Iend_LE, Ity_I64, mkU64(&sbExecuted));
+	IRTemp t1 = newIRTemp(sb->tyenv, Ity_I64);
+  	addStmtToIRSB(sb, IRStmt_WrTmp(t1, load));
+	IRExpr* add = IRExpr_Binop(Iop_Add64, IRExpr_RdTmp(t1), mkU64(1));
+  	IRTemp t2 = newIRTemp(sb->tyenv, Ity_I64);
+  	addStmtToIRSB(sb, IRStmt_WrTmp(t2, add));
+	IRStmt* store = IRStmt_Store(Iend_LE, mkU64(&sbExecuted), IRExpr_RdTmp(t2));
+	addStmtToIRSB(sb, store);
+
+	if (clo_sample_rate > 1) {
+		instrumentSampling(sb);
+	}
+}
+
+static Bool isInWrappedLibrary(Addr addr) {
+	Char objname[FILENAME_SIZE];
+	if (!VG_(get_objname)(addr, objname, FILENAME_SIZE)) {
+		return False;
+	}
+	if (clo_wrap_libm && (VG_(string_match)("*/libm.so*", objname) || VG_(string_match)("*/libm-*", objname))) {
+		return True;
+	}
+	if (clo_wrap_blas && (VG_(string_match)("*/libblas.so*", objname) || 
+			VG_(string_match)("*/libopenblas*", objname) || VG_(string_match)("*/libmkl_*", objname))) {
+		return True;
+	}
+	return False;
+}
+
+/* If the calls into a library are wrapped (--wrap-libm, --wrap-blas), the 
+   operations inside the library are not shadowed. As no temporary of such 
+   a superblock gets a shadow value, the instrumented Put and Store statements 
+   only invalidate the shadow values which are overwritten by the library. */
+static void instrumentWrappedLibrarySB(IRSB* sbOut, IRSB* sbIn, Int i) {
+	IRTypeEnv* tyenv = sbIn->tyenv;
+
+	instrumentEnterSB(sbOut);
+	for (/*use current i*/; i < sbIn->stmts_used; i++) {
+		IRStmt* st = sbIn->stmts[i];
+		if (!st || st->tag == Ist_NoOp) continue;
+
+		addStmtToIRSB(sbOut, st);
+		switch (st->tag) {
+			case Ist_Put:
+				if (st->Ist.Put.offset != 168) {
+					instrumentPut(sbOut, tyenv, st, -1);
+				}
+				break;
+			case Ist_PutI:
+				instrumentPutI(sbOut, tyenv, st, -1);
+				break;
+			case Ist_Store:
+				instrumentStore(sbOut, tyenv, st, -1);
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+/* Superblocks out of the scope of --include and --exclude get no helper 
+   calls, only an inline scopeEpoch++. Shadow values written before are 
+   validated when they are read next (isValidRegister, isValidMemory). */
+static void instrumentOutOfScopeSB(IRSB* sbOut, IRSB* sbIn, Int i) {
+	IRTemp t1 = newIRTemp(sbOut->tyenv, Ity_I64);
+	addStmtToIRSB(sbOut, IRStmt_WrTmp(t1, IRExpr_Load(Iend_LE, Ity_I64, mkU64(&scopeEpoch))));
+	IRTemp t2 = newIRTemp(sbOut->tyenv, Ity_I64);
+	addStmtToIRSB(sbOut, IRStmt_WrTmp(t2, IRExpr_Binop(Iop_Add64, IRExpr_RdTmp(t1), mkU64(1))));
+	addStmtToIRSB(sbOut, IRStmt_Store(Iend_LE, mkU64(&scopeEpoch), IRExpr_RdTmp(t2)));
+
+	for (/*use current i*/; i < sbIn->stmts_used; i++) {
+		IRStmt* st = sbIn->stmts[i];
+		if (!st || st->tag == Ist_NoOp) continue;
+		addStmtToIRSB(sbOut, st);
+	}
+}
+
+static void reportUnsupportedOp(IROp op) {
+	if (!VG_(OSetWord_Contains)(unsupportedOps, (UWord)op)) {
+		VG_(OSetWord_Insert)(unsupportedOps, (UWord)op);
+	}
+}
+
+static Bool matchesScope(Char** patterns, Int count, Char* fnname, Char* file, Char* objname) {
+	Int i;
+	for (i = 0; i < count; i++) {
+		if (VG_(string_match)(patterns[i], fnname) || VG_(string_match)(patterns[i], file) ||
+			VG_(string_match)(patterns[i], objname)) {
+			return True;
+		}
+	}
+	return False;
+}
+
+/* Decides with the debug information of the first instruction whether 
+   a superblock is analyzed (--include, --exclude). */
+static Bool isInScope(Addr addr) {
+	Char fnname[DESCRIPTION_SIZE];
+	Char file[FILENAME_SIZE];
+	Char objname[FILENAME_SIZE];
+
+	if (clo_include_count == 0 && clo_exclude_count == 0) {
+		return True;
+	}
+	if (!VG_(get_fnname)(addr, fnname, DESCRIPTION_SIZE)) fnname[0] = '\0';
+	if (!VG_(get_filename)(addr, file, FILENAME_SIZE)) file[0] = '\0';
+	if (!VG_(get_objname)(addr, objname, FILENAME_SIZE)) objname[0] = '\0';
+
+	if (clo_include_count > 0 && !matchesScope(clo_include, clo_include_count, fnname, file, objname)) {
+		return False;
+	}
+	return !matchesScope(clo_exclude, clo_exclude_count, fnname, file, objname);
+}
+
+static void setAnalyzing(Bool analyze);
+
+static VG_REGPARM(1) void triggerAnalysis(UWord analyze) {
+	setAnalyzing((Bool)analyze);
+}
+
+static Bool isTrigger(Addr addr, Char* fn, Addr triggerAddr) {
+	if (triggerAddr != 0 && addr == triggerAddr) {
+		return True;
+	}
+	Char fnname[DESCRIPTION_SIZE];
+	if (fn != NULL && VG_(get_fnname_if_entry)(addr, fnname, DESCRIPTION_SIZE)) {
+		return VG_(strcmp)(fnname, fn) == 0;
+	}
+	return False;
+}
+
+static void instrumentTrigger(IRSB* sb, Bool analyze) {
+	IRExpr** argv = mkIRExprVec_1(mkU64(analyze));
+	IRDirty* di = unsafeIRDirty_0_N(1, "triggerAnalysis", VG_(fnptr_to_fnentry)(&triggerAnalysis), argv);
+	addStmtToIRSB(sb, IRStmt_Dirty(di));
+}
+
+/* With --reinstrument-on-toggle switching the analysis discards all 
+   translations, which must not happen in the middle of a superblock. The 
+   superblock ends before the trigger instruction, calls triggerAnalysis 
+   on its way out and continues at the trigger, which is translated again 
+   with the new instrumentation. */
+static void endSBAtTrigger(IRSB* sbOut, Addr addr, Bool analyze) {
+	instrumentTrigger(sbOut, analyze);
+	sbOut->next = mkU64(addr);
+	sbOut->jumpkind = Ijk_Boring;
+}
+
+/* While the analysis is off, only the instructions given by --start-at-fn 
+   or --start-at-addr are instrumented. The SB ends before the trigger and 
+   switches the analysis on (endSBAtTrigger). */
+static IRSB* instrumentStartTrigger(IRSB* sbIn) {
+	Int i;
+	if (!clo_start_fn && !clo_start_addr) {
+		return sbIn;
+	}
+	for (i = 0; i < sbIn->stmts_used; i++) {
+		IRStmt* st = sbIn->stmts[i];
+		if (st->tag == Ist_IMark && isTrigger(st->Ist.IMark.addr, clo_start_fn, clo_start_addr)) {
+			break;
+		}
+	}
+	if (i == sbIn->stmts_used) {
+		return sbIn;
+	}
+
+	IRSB* sbOut = deepCopyIRSBExceptStmts(sbIn);
+	for (i = 0; i < sbIn->stmts_used; i++) {
+		IRStmt* st = sbIn->stmts[i];
+		if (st->tag == Ist_IMark && isTrigger(st->Ist.IMark.addr, clo_start_fn, clo_start_addr)) {
+			endSBAtTrigger(sbOut, st->Ist.IMark.addr, True);
+			break;
+		}
+		addStmtToIRSB(sbOut, st);
+	}
+	return sbOut;
+}
+
+/* --fma-contraction: a multiplication whose only use is an addition or 
+   subtraction of the same superblock could be contracted to a fused 
+   multiply-add. The fused result is computed in the original precision 
+   with one rounding and compared with the shadow value of the addition. */
+static __inline__
+Bool isContractiblePair(IROp mulOp, IROp addOp) {
+	switch (mulOp) {
+		case Iop_MulF64:
+			return addOp == Iop_AddF64 || addOp == Iop_SubF64;
+		case Iop_MulF32:
+			return addOp == Iop_AddF32 || addOp == Iop_SubF32;
+		case Iop_Mul64F0x2:
+			return addOp == Iop_Add64F0x2 || addOp == Iop_Sub64F0x2;
+		case Iop_Mul32F0x4:
+			return addOp == Iop_Add32F0x4 || addOp == Iop_Sub32F0x4;
+		default:
+			return False;
+	}
+}
+
+static void countTempUses(IRExpr* e, Int* uses) {
+	Int k;
+	if (e == NULL) {
+		return;
+	}
+	switch (e->tag) {
+		case Iex_RdTmp:
+			uses[e->Iex.RdTmp.tmp]++;
+			break;
+		case Iex_Load:
+			countTempUses(e->Iex.Load.addr, uses);
+			break;
+		case Iex_GetI:
+			countTempUses(e->Iex.GetI.ix, uses);
+			break;
+		case Iex_Unop:
+			countTempUses(e->Iex.Unop.arg, uses);
+			break;
+		case Iex_Binop:
+			countTempUses(e->Iex.Binop.arg1, uses);
+			countTempUses(e->Iex.Binop.arg2, uses);
+			break;
+		case Iex_Triop:
+			countTempUses(e->Iex.Triop.arg1, uses);
+			countTempUses(e->Iex.Triop.arg2, uses);
+			countTempUses(e->Iex.Triop.arg3, uses);
+			break;
+		case Iex_Qop:
+			countTempUses(e->Iex.Qop.arg1, uses);
+			countTempUses(e->Iex.Qop.arg2, uses);
+			countTempUses(e->Iex.Qop.arg3, uses);
+			countTempUses(e->Iex.Qop.arg4, uses);
+			break;
+		case Iex_Mux0X:
+			countTempUses(e->Iex.Mux0X.cond, uses);
+			countTempUses(e->Iex.Mux0X.expr0, uses);
+			countTempUses(e->Iex.Mux0X.exprX, uses);
+			break;
+		case Iex_CCall:
+			for (k = 0; e->Iex.CCall.args[k] != NULL; k++) {
+				countTempUses(e->Iex.CCall.args[k], uses);
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+static __inline__
+IRTemp contractionArg(IRExpr* e, Int pos) {
+	IRExpr* arg;
+	if (e->tag == Iex_Triop) {
+		arg = pos == 0 ? e->Iex.Triop.arg2 : e->Iex.Triop.arg3;
+	} else {
+		arg = pos == 0 ? e->Iex.Binop.arg1 : e->Iex.Binop.arg2;
+	}
+	return arg->tag == Iex_RdTmp ? arg->Iex.RdTmp.tmp : IRTemp_INVALID;
+}
+
+static __inline__
+IROp contractionOp(IRExpr* e) {
+	if (e->tag == Iex_Triop) return e->Iex.Triop.op;
+	if (e->tag == Iex_Binop) return e->Iex.Binop.op;
+	return Iop_INVALID;
+}
+
+/* For each addition or subtraction, mulStmt is the index of the statement 
+   with the multiplication it can be contracted with, otherwise -1. */
+static void findContractions(IRSB* sbIn, Int first, Int* mulStmt, Addr* mulAddr) {
+	Int n = sbIn->tyenv->types_used;
+	Int uses[n];
+	Int defStmt[n];
+	Addr defAddr[n];
+	Addr cia = 0;
+	Int j, k;
+	for (j = 0; j < n; j++) {
+		uses[j] = 0;
+		defStmt[j] = -1;
+		mulStmt[j] = -1;
+	}
+
+	for (j = first; j < sbIn->stmts_used; j++) {
+		IRStmt* st = sbIn->stmts[j];
+		if (!st) continue;
+		switch (st->tag) {
+			case Ist_Put:
+				countTempUses(st->Ist.Put.data, uses);
+				break;
+			case Ist_PutI:
+				countTempUses(st->Ist.PutI.ix, uses);
+				countTempUses(st->Ist.PutI.data, uses);
+				break;
+			case Ist_WrTmp:
+				countTempUses(st->Ist.WrTmp.data, uses);
+				break;
+			case Ist_Store:
+				countTempUses(st->Ist.Store.addr, uses);
+				countTempUses(st->Ist.Store.data, uses);
+				break;
+			case Ist_Exit:
+				countTempUses(st->Ist.Exit.guard, uses);
+				break;
+			case Ist_Dirty:
+				countTempUses(st->Ist.Dirty.details->guard, uses);
+				countTempUses(st->Ist.Dirty.details->mAddr, uses);
+				for (k = 0; st->Ist.Dirty.details->args[k] != NULL; k++) {
+					countTempUses(st->Ist.Dirty.details->args[k], uses);
+				}
+				break;
+			default:
+				break;
+		}
+	}
+
+	for (j = first; j < sbIn->stmts_used; j++) {
+		IRStmt* st = sbIn->stmts[j];
+		if (!st) continue;
+		if (st->tag == Ist_IMark) {
+			cia = st->Ist.IMark.addr;
+			continue;
+		}
+		if (st->tag != Ist_WrTmp) continue;
+
+		IRTemp wrTmp = st->Ist.WrTmp.tmp;
+		IRExpr* expr = st->Ist.WrTmp.data;
+		IROp op = contractionOp(expr);
+		if (op == Iop_MulF64 || op == Iop_MulF32 || op == Iop_Mul64F0x2 || op == Iop_Mul32F0x4) {
+			defStmt[wrTmp] = j;
+			defAddr[wrTmp] = cia;
+			continue;
+		}
+		for (k = 0; k < 2 && op != Iop_INVALID; k++) {
+			IRTemp t = contractionArg(expr, k);
+			if (t != IRTemp_INVALID && defStmt[t] >= 0 && uses[t] == 1 && 
+				isContractiblePair(contractionOp(sbIn->stmts[defStmt[t]]->Ist.WrTmp.data), op)) 
+			{
+				mulStmt[wrTmp] = defStmt[t];
+				mulAddr[wrTmp] = defAddr[t];
+				break;
+			}
+		}
+	}
+}
+
+static __inline__
+void writeContractionArg(IRSB* sb, IRTypeEnv* env, IRExpr* arg, Int num, Int* constArgs) {
+	if (arg->tag == Iex_RdTmp) {
+		writeSTemp(sb, env, arg->Iex.RdTmp.tmp, num);
+	} else {
+		writeSConst(sb, arg->Iex.Const.con, num);
+		*constArgs |= 1 << num;
+	}
+}
+
+static VG_REGPARM(3) void processContraction(Addr addr, Addr mulAddr, UWord ca);
+
+static void instrumentContraction(IRSB* sb, IRTypeEnv* env, Addr addr, Addr mulAddr, IRStmt* addSt, IRStmt* mulSt) {
+	if (clo_ignoreLibraries && isInLibrary(addr)) {
+		return;
+	}
+	if (!isSuspectSite(addr)) {
+		return;
+	}
+
+	IRExpr* add = addSt->Ist.WrTmp.data;
+	IRExpr* mul = mulSt->Ist.WrTmp.data;
+	IRExpr* a = mul->tag == Iex_Triop ? mul->Iex.Triop.arg2 : mul->Iex.Binop.arg1;
+	IRExpr* b = mul->tag == Iex_Triop ? mul->Iex.Triop.arg3 : mul->Iex.Binop.arg2;
+	Bool mulFirst = contractionArg(add, 0) == mulSt->Ist.WrTmp.tmp;
+	IRExpr* c;
+	if (add->tag == Iex_Triop) {
+		c = mulFirst ? add->Iex.Triop.arg3 : add->Iex.Triop.arg2;
+	} else {
+		c = mulFirst ? add->Iex.Binop.arg2 : add->Iex.Binop.arg1;
+	}
+	if ((a->tag == Iex_Const && a->Iex.Const.con->tag != Ico_F64) || 
+		(b->tag == Iex_Const && b->Iex.Const.con->tag != Ico_F64) || 
+		(c->tag == Iex_Const && c->Iex.Const.con->tag != Ico_F64)) 
+	{
+		return;
+	}
+
+	Int constArgs = 0;
+	writeContractionArg(sb, env, a, 4, &constArgs);
+	writeContractionArg(sb, env, b, 5, &constArgs);
+	writeContractionArg(sb, env, c, 6, &constArgs);
+	writeSTemp(sb, env, addSt->Ist.WrTmp.tmp, 7);
+
+	IRStmt* store = IRStmt_Store(Iend_LE, mkU64(&(contractionArgs->addOp)), mkU32(contractionOp(add)));
+	addStmtToIRSB(sb, store);
+	store = IRStmt_Store(Iend_LE, mkU64(&(contractionArgs->wrTmp)), mkU32(addSt->Ist.WrTmp.tmp));
+	addStmtToIRSB(sb, store);
+	store = IRStmt_Store(Iend_LE, mkU64(&(contractionArgs->mulFirst)), mkU32(mulFirst));
+	addStmtToIRSB(sb, store);
+
+	IRExpr** argv = mkIRExprVec_3(mkU64(addr), mkU64(mulAddr), mkU64(constArgs));
+	IRDirty* di = unsafeIRDirty_0_N(3, "processContraction", VG_(fnptr_to_fnentry)(&processContraction), argv);
+	addHelperToIRSB(sb, di);
+}
+
+static __inline__
+Double contractionError(Double x, ShadowValue* sv) {
+	mpfr_set_d(contractErr, x, STD_RND);
+	mpfr_reldiff(contractErr, contractErr, sv->value, STD_RND);
+	Double err = mpfr_get_d(contractErr, STD_RND);
+	return err < 0 ? -err : err;
+}
+
+static VG_REGPARM(3) void processContraction(Addr addr, Addr mulAddr, UWord ca) {
+	if (!clo_analyze) return;
+
+	Int constArgs = (Int)ca;
+	IROp addOp = contractionArgs->addOp;
+	Bool isFloat = isOpFloat(addOp);
+	Double a, b, c, r;
+	if (!readNativeOperand(4, constArgs & 0x10, isFloat, &a) || !readNativeOperand(5, constArgs & 0x20, isFloat, &b) || 
+		!readNativeOperand(6, constArgs & 0x40, isFloat, &c) || !readNativeOperand(7, False, isFloat, &r)) 
+	{
+		return;
+	}
+	ShadowValue* sv = getTemp(contractionArgs->wrTmp);
+	if (sv == NULL || !mpfr_number_p(sv->value) || mpfr_cmp_ui(sv->value, 0) == 0) {
+		return;
+	}
+
+	Bool isSub = addOp == Iop_SubF64 || addOp == Iop_SubF32 || addOp == Iop_Sub64F0x2 || addOp == Iop_Sub32F0x4;
+	if (isSub && contractionArgs->mulFirst) {
+		c = -c;
+	} else if (isSub) {
+		a = -a;
+	}
+	mpfr_set_prec(contractFused, isFloat ? 24 : 53);
+	mpfr_set_d(contractA, a, STD_RND);
+	mpfr_set_d(contractB, b, STD_RND);
+	mpfr_set_d(contractC, c, STD_RND);
+	beginEmulateDouble();
+	int t = mpfr_fma(contractFused, contractA, contractB, contractC, STD_RND);
+	mpfr_subnormalize(contractFused, t, STD_RND);
+	endEmulate();
+	Double fused = mpfr_get_d(contractFused, STD_RND);
+
+	ContractionSite* site = VG_(HT_lookup)(contractionSites, addr);
+	if (site == NULL) {
+		site = VG_(malloc)("fd.processContraction.1", sizeof(ContractionSite));
+		VG_(memset)(site, 0, sizeof(ContractionSite));
+		site->key = addr;
+		site->mulAddr = mulAddr;
+		site->op = addOp;
+		VG_(HT_add_node)(contractionSites, site);
+	}
+	site->count++;
+
+	Double errSeparate = contractionError(r, sv);
+	Double errFused = contractionError(fused, sv);
+	if (errSeparate > site->maxErrSeparate) {
+		site->maxErrSeparate = errSeparate;
+	}
+	if (errFused > site->maxErrFused) {
+		site->maxErrFused = errFused;
+	}
+	if (fused != r) {
+		site->changed++;
+		if (errFused < errSeparate) {
+			site->better++;
+		} else if (errFused > errSeparate) {
+			site->worse++;
+			if (errFused - errSeparate > site->maxIncrease) {
+				site->maxIncrease = errFused - errSeparate;
+			}
+		}
+	}
+}
+
+/* --local-error-only: the rounding error of each operation is computed 
+   from its native operands and result with error-free transformations, 
+   exact = r + err. No shadow values are created or propagated. */
+static UInt localOp = 0;
+
+/* normal numbers which can be split without overflow, or zero */
+static __inline__
+Bool localInRange(Double d) {
+	UInt e = ddBiasedExp(d);
+	return d == 0 || (e > 0 && e < 0x7E0);
+}
+
+static VG_REGPARM(2) void processLocalError(Addr addr, UWord ca) {
+	if (!clo_analyze) return;
+
+	Int constArgs = (Int)ca;
+	IROp op = (IROp)localOp;
+	Bool isFloat = isOpFloat(op);
+	Double a = 0.0, b, r;
+	if (!(constArgs & 0x8) && (!readNativeOperand(0, constArgs & 0x1, isFloat, &a) || !localInRange(a))) {
+		return;
+	}
+	if (!readNativeOperand(1, constArgs & 0x2, isFloat, &b) || !localInRange(b) || 
+		!readNativeOperand(2, False, isFloat, &r) || !localInRange(r)) 
+	{
+		return;
+	}
+
+	if (clo_reassociation && !(constArgs & 0x8)) {
+		updateReduction(addr, op, 0, 1, constArgs, r);
+	}
+
+	Double p, e, err;
+	mpfr_exp_t canceled = 0;
+	switch (op) {
+		case Iop_Add32F0x4:
+		case Iop_Add64F0x2:
+		case Iop_AddF32:
+		case Iop_AddF64:
+		case Iop_AddF64r32:
+			ddTwoSum(a, b, &p, &e);
+			err = (p - r) + e;
+			canceled = ddCanceledBits(r, 0.0, a, 0.0, b, 0.0);
+			break;
+		case Iop_Sub32F0x4:
+		case Iop_Sub64F0x2:
+		case Iop_SubF32:
+		case Iop_SubF64:
+		case Iop_SubF64r32:
+			ddTwoSum(a, -b, &p, &e);
+			err = (p - r) + e;
+			canceled = ddCanceledBits(r, 0.0, a, 0.0, b, 0.0);
+			break;
+		case Iop_Mul32F0x4:
+		case Iop_Mul64F0x2:
+		case Iop_MulF32:
+		case Iop_MulF64:
+		case Iop_MulF64r32:
+			if (r == 0 && a != 0 && b != 0) {
+				return;
+			}
+			ddTwoProd(a, b, &p, &e);
+			err = (p - r) + e;
+			break;
+		case Iop_Div32F0x4:
+		case Iop_Div64F0x2:
+		case Iop_DivF32:
+		case Iop_DivF64:
+		case Iop_DivF64r32:
+			if (b == 0 || (r == 0 && a != 0)) {
+				return;
+			}
+			/* a - r * b is exact, the error is the remainder divided by b */
+			ddTwoProd(r, b, &p, &e);
+			err = ((a - p) - e) / b;
+			break;
+		case Iop_Sqrt32F0x4:
+		case Iop_Sqrt64F0x2:
+		case Iop_SqrtF32:
+		case Iop_SqrtF64:
+			if (r == 0) {
+				err = 0.0;
+				break;
+			}
+			ddTwoProd(r, r, &p, &e);
+			err = ((b - p) - e) / (2 * r);
+			break;
+		default:
+			return;
+	}
+
+	fpOps++;
+	if (!clo_computeMeanValue) {
+		return;
+	}
+
+	UInt cancellationBadness = 0;
+	Int exactBits = isFloat ? 23 : 52;
+	if (clo_bad_cancellations && canceled > exactBits) {
+		cancellationBadness = canceled - exactBits;
+	}
+	mpfr_set_d(meanOrg, r, STD_RND);
+	mpfr_set_d(localExact, r, STD_RND);
+	mpfr_add_d(localExact, localExact, err, STD_RND);
+	updateMeanValue(addr, op, &localExact, canceled, 0, 0, cancellationBadness);
+	if (clo_condition) {
+		updateConditionNumber(addr, op, (constArgs & 0x8) ? -1 : 0, 1, constArgs, r);
+	}
+}
+
+/* arg1 is NULL for square roots */
+static void instrumentLocalError(IRSB* sb, IRTypeEnv* env, Addr addr, IRTemp wrTemp, IROp op, IRExpr* arg1, IRExpr* arg2) {
+	if (clo_ignoreLibraries && isInLibrary(addr)) {
+		return;
+	}
+	if ((arg1 && arg1->tag == Iex_Const && arg1->Iex.Const.con->tag != Ico_F64) || 
+		(arg2->tag == Iex_Const && arg2->Iex.Const.con->tag != Ico_F64)) 
+	{
+		return;
+	}
+	if (!isSuspectSite(addr) || instrumentSiteCount(sb, addr, op, 1)) {
+		return;
+	}
+
+	Int constArgs = 0;
+	if (!arg1) {
+		constArgs |= 0x8;
+	} else if (arg1->tag == Iex_RdTmp) {
+		writeSTemp(sb, env, arg1->Iex.RdTmp.tmp, 0);
+	} else {
+		writeSConst(sb, arg1->Iex.Const.con, 0);
+		constArgs |= 0x1;
+	}
+	if (arg2->tag == Iex_RdTmp) {
+		writeSTemp(sb, env, arg2->Iex.RdTmp.tmp, 1);
+	} else {
+		writeSConst(sb, arg2->Iex.Const.con, 1);
+		constArgs |= 0x2;
+	}
+	writeSTemp(sb, env, wrTemp, 2);
+	addStmtToIRSB(sb, IRStmt_Store(Iend_LE, mkU64(&localOp), mkU32(op)));
+
+	IRExpr** argv = mkIRExprVec_2(mkU64(addr), mkU64(constArgs));
+	IRDirty* di = unsafeIRDirty_0_N(2, "processLocalError", VG_(fnptr_to_fnentry)(&processLocalError), argv);
+	addHelperToIRSB(sb, di);
+}
+
+static void instrumentLocalErrorSB(IRSB* sbOut, IRSB* sbIn, Int i) {
+	IRTypeEnv* tyenv = sbIn->tyenv;
+	Addr cia = 0;
+
+	if (clo_sample_rate > 1) {
+		instrumentSampling(sbOut);
+	}
+	for (/*use current i*/; i < sbIn->stmts_used; i++) {
+		IRStmt* st = sbIn->stmts[i];
+		if (!st || st->tag == Ist_NoOp) continue;
+
+		if (st->tag == Ist_IMark) {
+			cia = st->Ist.IMark.addr;
+			if ((clo_stop_fn || clo_stop_addr) && isTrigger(cia, clo_stop_fn, clo_stop_addr)) {
+				if (clo_reinstrument) {
+					endSBAtTrigger(sbOut, cia, False);
+					return;
+				}
+				instrumentTrigger(sbOut, False);
+			}
+			addStmtToIRSB(sbOut, st);
+			continue;
+		}
+		addStmtToIRSB(sbOut, st);
+		if (st->tag != Ist_WrTmp) continue;
+
+		IRExpr* expr = st->Ist.WrTmp.data;
+		IRTemp wrTemp = st->Ist.WrTmp.tmp;
+		switch (expr->tag) {
+			case Iex_Unop:
+				switch (expr->Iex.Unop.op) {
+					case Iop_Sqrt32F0x4:
+					case Iop_Sqrt64F0x2:
+						instrumentLocalError(sbOut, tyenv, cia, wrTemp, expr->Iex.Unop.op, NULL, expr->Iex.Unop.arg);
+						break;
+					default:
+						break;
+				}
+				break;
+			case Iex_Binop:
+				switch (expr->Iex.Binop.op) {
+					case Iop_Add32F0x4:
+					case Iop_Sub32F0x4:
+					case Iop_Mul32F0x4:
+					case Iop_Div32F0x4:
+					case Iop_Add64F0x2:
+					case Iop_Sub64F0x2:
+					case Iop_Mul64F0x2:
+					case Iop_Div64F0x2:
+						instrumentLocalError(sbOut, tyenv, cia, wrTemp, expr->Iex.Binop.op, expr->Iex.Binop.arg1, expr->Iex.Binop.arg2);
+						break;
+					case Iop_SqrtF32:
+					case Iop_SqrtF64:
+						/* arg1 only contains the rounding mode */
+						instrumentLocalError(sbOut, tyenv, cia, wrTemp, expr->Iex.Binop.op, NULL, expr->Iex.Binop.arg2);
+						break;
+					default:
+						break;
+				}
+				break;
+			case Iex_Triop:
+				switch (expr->Iex.Triop.op) {
+					case Iop_AddF64:
+					case Iop_SubF64:
+					case Iop_MulF64:
+					case Iop_DivF64:
+					case Iop_AddF32:
+					case Iop_SubF32:
+					case Iop_MulF32:
+					case Iop_DivF32:
+					case Iop_AddF64r32:
+					case Iop_SubF64r32:
+					case Iop_MulF64r32:
+					case Iop_DivF64r32:
+						instrumentLocalError(sbOut, tyenv, cia, wrTemp, expr->Iex.Triop.op, expr->Iex.Triop.arg2, expr->Iex.Triop.arg3);
+						break;
+					default:
+						break;
+				}
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+static IRSB* fd_instrument(VgCallbackClosure* closure, IRSB* sbIn,
+                      VexGuestLayout* layout, VexGuestExtents* vge,
+                      IRType gWordTy, IRType hWordTy)
+{
+	Int			i;
+	IRSB*      	sbOut;
+   	IRType     	type;
+   	IRTypeEnv* 	tyenv = sbIn->tyenv;
+	IRExpr* 	expr;
+	/* address of current client instruction */
+	Addr		cia = 0, dst;
+
+	if (gWordTy != hWordTy) {
+		/* This case is not supported yet. */
+		VG_(tool_panic)("host/guest word size mismatch");
+	}
+
+	if (clo_reinstrument && !clo_analyze) {
+		/* retranslated as soon as the analysis is switched on */
+		return instrumentStartTrigger(sbIn);
+	}
+
+	/* code out of scope is not analyzed, the shadow values it may have 
+	   overwritten are checked when they are read */
+	for (i = 0; i < sbIn->stmts_used && sbIn->stmts[i]->tag != Ist_IMark; i++);
+	Bool inScope = i >= sbIn->stmts_used || isInScope(sbIn->stmts[i]->Ist.IMark.addr);
+	if (!inScope && clo_local_error) {
+		/* there are no shadow values */
+		return sbIn;
+	}
+
+	sbCounter++;
+	totalIns += sbIn->stmts_used;
+	sampleGuard = IRTemp_INVALID;
+
+	/* set up SB */
+	sbOut = deepCopyIRSBExceptStmts(sbIn);
+
+	/* copy verbatim any IR preamble preceding the first IMark */
+	i = 0;
+	while (i < sbIn->stmts_used && sbIn->stmts[i]->tag != Ist_IMark) {
+		addStmtToIRSB( sbOut, sbIn->stmts[i] );
+		i++;
+	}
+
+	if (clo_local_error) {
+		instrumentLocalErrorSB(sbOut, sbIn, i);
+		return sbOut;
+	}
+
+	if (!inScope) {
+		instrumentOutOfScopeSB(sbOut, sbIn, i);
+		return sbOut;
+	}
+
+	if ((clo_wrap_libm || clo_wrap_blas) && i < sbIn->stmts_used && isInWrappedLibrary(sbIn->stmts[i]->Ist.IMark.addr)) {
+		instrumentWrappedLibrarySB(sbOut, sbIn, i);
+		return sbOut;
+	}
+
+	/* perform optimizations for each superblock */
+
+	Bool sbInstrNeeded = False;
+	if (maxTemps < tyenv->types_used) {
+		maxTemps = tyenv->types_used;
+	}
+
+	Int j;
+
+	Bool impReg[MAX_REGISTERS];
+	for (j = 0; j < MAX_REGISTERS; j++) {
+		impReg[j] = True;
+	}
+	Int impTmp[tyenv->types_used];
+	for (j = 0; j < tyenv->types_used; j++) {
+		impTmp[j] = 0;
+	}
+
+	/* backward */
+	for (j = sbIn->stmts_used - 1; j >= i; j--) {
+		IRStmt* st = sbIn->stmts[j];
+		if (!st || st->tag == Ist_NoOp) continue;
+      
+		switch (st->tag) {
+			case Ist_Put:
+				impReg[st->Ist.Put.offset] = False;
+
+				if (st->Ist.Put.data->tag == Iex_RdTmp) {
+					impTmp[st->Ist.Put.data->Iex.RdTmp.tmp] = 1;
+				}
+				break;
+			case Ist_Store:
+				if (st->Ist.Store.data->tag == Iex_RdTmp) {
+					impTmp[st->Ist.Store.data->Iex.RdTmp.tmp] = 1;
+				}
+				break;
+			case Ist_WrTmp:
+				expr = st->Ist.WrTmp.data;
+
+		        switch (expr->tag) {
+					case Iex_Get:
+						impReg[expr->Iex.Get.offset] = True;
+						break;
+					case Iex_Unop:
+						switch (expr->Iex.Unop.op) {
+							case Iop_Sqrt32F0x4:
+							case Iop_Sqrt64F0x2:
+							case Iop_Sqrt32Fx4:
+							case Iop_Sqrt64Fx2:
+							case Iop_NegF32:
+							case Iop_NegF64:
+							case Iop_AbsF32:
+							case Iop_AbsF64:
+							case Iop_F32toF64:
+							case Iop_ReinterpI64asF64:
+							case Iop_32UtoV128:
+							case Iop_V128to64:
+							case Iop_V128HIto64:
+							case Iop_64to32:
+							case Iop_64HIto32:
+							case Iop_64UtoV128:
+							case Iop_32Uto64:
+								if (expr->Iex.Unop.arg->tag == Iex_RdTmp) {
+									impTmp[expr->Iex.Unop.arg->Iex.RdTmp.tmp] = 1;
+								}
+								break;
+							default:
+								/* backward -> args are important */
+								if (expr->Iex.Unop.arg->tag == Iex_RdTmp && impTmp[expr->Iex.Unop.arg->Iex.RdTmp.tmp] == 0) {
+									impTmp[expr->Iex.Unop.arg->Iex.RdTmp.tmp] = -1;
+								}
+								break;
+						}
+						break;
+					case Iex_Binop:
+						switch (expr->Iex.Binop.op) {
+							case Iop_Add32F0x4:
+							case Iop_Sub32F0x4:
+							case Iop_Mul32F0x4:
+							case Iop_Div32F0x4:
+							case Iop_Add64F0x2:
+							case Iop_Sub64F0x2:
+							case Iop_Mul64F0x2:
+							case Iop_Div64F0x2:
+							case Iop_Min32F0x4:
+							case Iop_Min64F0x2:
+							case Iop_Max32F0x4:
+							case Iop_Max64F0x2:
+							case Iop_Add32Fx4:
+							case Iop_Sub32Fx4:
+							case Iop_Mul32Fx4:
+							case Iop_Div32Fx4:
+							case Iop_Min32Fx4:
+							case Iop_Max32Fx4:
+							case Iop_Add64Fx2:
+							case Iop_Sub64Fx2:
+							case Iop_Mul64Fx2:
+							case Iop_Div64Fx2:
+							case Iop_Min64Fx2:
+							case Iop_Max64Fx2:
+							case Iop_CmpF64: 
+							case Iop_F64toF32:
+							case Iop_64HLtoV128:
+							case Iop_32HLto64:
+								if (expr->Iex.Binop.arg1->tag == Iex_RdTmp) {
+									impTmp[expr->Iex.Binop.arg1->Iex.RdTmp.tmp] = 1;
+								}
+							case Iop_SqrtF32:
+							case Iop_SqrtF64:
+							case Iop_SinF64:
+							case Iop_CosF64:
+							case Iop_TanF64:
+							case Iop_2xm1F64:
+							case Iop_F64toI16S:
+							case Iop_F64toI32S:
+							case Iop_F64toI64S:
+							case Iop_F64toI64U:
+							case Iop_F64toI32U:
+								if (expr->Iex.Binop.arg2->tag == Iex_RdTmp) {
+									impTmp[expr->Iex.Binop.arg2->Iex.RdTmp.tmp] = 1;
+								}
+								break;
+							default:
+								/* backward -> args are important */
+								if (expr->Iex.Binop.arg1->tag == Iex_RdTmp && impTmp[expr->Iex.Binop.arg1->Iex.RdTmp.tmp] == 0) {
+									impTmp[expr->Iex.Binop.arg1->Iex.RdTmp.tmp] = -1;
+								}
+								if (expr->Iex.Binop.arg2->tag == Iex_RdTmp && impTmp[expr->Iex.Binop.arg2->Iex.RdTmp.tmp] == 0) {
+									impTmp[expr->Iex.Binop.arg2->Iex.RdTmp.tmp] = -1;
+								}
+								break;
+						}
+						break;
+					case Iex_Triop:
+						switch (expr->Iex.Triop.op) {
+							case Iop_AddF64:
+							case Iop_SubF64:
+							case Iop_MulF64:
+							case Iop_DivF64:
+							case Iop_AddF32:
+							case Iop_SubF32:
+							case Iop_MulF32:
+							case Iop_DivF32:
+							case Iop_AddF64r32:
+							case Iop_SubF64r32:
+							case Iop_MulF64r32:
+							case Iop_DivF64r32:
+							case Iop_AtanF64:
+							case Iop_Yl2xF64:
+							case Iop_Yl2xp1F64:
+							case Iop_PRemF64:
+							case Iop_PRem1F64:
+							case Iop_ScaleF64:
+								if (expr->Iex.Triop.arg2->tag == Iex_RdTmp) {
+									impTmp[expr->Iex.Triop.arg2->Iex.RdTmp.tmp] = 1;
+								}
+								if (expr->Iex.Triop.arg3->tag == Iex_RdTmp) {
+									impTmp[expr->Iex.Triop.arg3->Iex.RdTmp.tmp] = 1;
+								}
+								break;
+							default:
+								/* backward -> args are important */
+								if (expr->Iex.Triop.arg2->tag == Iex_RdTmp && impTmp[expr->Iex.Triop.arg2->Iex.RdTmp.tmp] == 0) {
+									impTmp[expr->Iex.Triop.arg2->Iex.RdTmp.tmp] = -1;
+								}
+								if (expr->Iex.Triop.arg3->tag == Iex_RdTmp && impTmp[expr->Iex.Triop.arg3->Iex.RdTmp.tmp] == 0) {
+									impTmp[expr->Iex.Triop.arg3->Iex.RdTmp.tmp] = -1;
+								}
+								break;
+						}
+						break;
+					case Iex_Qop:
+						switch (expr->Iex.Qop.op) {
+							case Iop_MAddF64:
+							case Iop_MSubF64:
+							case Iop_MAddF64r32:
+							case Iop_MSubF64r32:
+								if (expr->Iex.Qop.arg2->tag == Iex_RdTmp) {
+									impTmp[expr->Iex.Qop.arg2->Iex.RdTmp.tmp] = 1;
+								}
+								if (expr->Iex.Qop.arg3->tag == Iex_RdTmp) {
+									impTmp[expr->Iex.Qop.arg3->Iex.RdTmp.tmp] = 1;
+								}
+								if (expr->Iex.Qop.arg4->tag == Iex_RdTmp) {
+									impTmp[expr->Iex.Qop.arg4->Iex.RdTmp.tmp] = 1;
+								}
+								break;
+							default:
+								break;
+						}
+						break;
+					case Iex_Mux0X:
+						/* nothing, impTmp is already true */
+						break;
+					default:
+						break;
+				}
+				break;
+			default:
+				break;
+		}
+	}
+
+	Int tmpInstead[tyenv->types_used];
+	for (j = 0; j < tyenv->types_used; j++) {
+		tmpInstead[j] = -1;
+	}
+
+	Int tmpInReg[MAX_REGISTERS];
+	for (j = 0; j < MAX_REGISTERS; j++) {
+		tmpInReg[j] = -1;
+	}
+
+	/* forward */
+	for (j = i; j < sbIn->stmts_used; j++) {
+		IRStmt* st = sbIn->stmts[j];
+		if (!st || st->tag == Ist_NoOp) continue;
+      
+		switch (st->tag) {
+			case Ist_Put:
+				if (st->Ist.Put.data->tag == Iex_RdTmp) {
+					tmpInReg[st->Ist.Put.offset] = st->Ist.Put.data->Iex.RdTmp.tmp;
+				} else {
+					tmpInReg[st->Ist.Put.offset] = -1;
+				}
+				break;
+			case Ist_Store:
+				break;
+			case Ist_WrTmp:
+				expr = st->Ist.WrTmp.data;
+		        switch (expr->tag) {
+					case Iex_Load:
+						break;
+					case Iex_Get:
+						if (tmpInReg[expr->Iex.Get.offset] >= 0) {
+							if (tmpInstead[tmpInReg[expr->Iex.Get.offset]] >= 0) {
+								tmpInstead[st->Ist.WrTmp.tmp] = tmpInstead[tmpInReg[expr->Iex.Get.offset]];
+							} else {
+								tmpInstead[st->Ist.WrTmp.tmp] = tmpInReg[expr->Iex.Get.offset];
+							}
+						}
+						break;
+					case Iex_RdTmp:
+						tmpInstead[st->Ist.WrTmp.tmp] = tmpInstead[expr->Iex.RdTmp.tmp];
+						break;
+					case Iex_Unop:
+						switch (expr->Iex.Unop.op) {
+							case Iop_F32toF64:
+							case Iop_ReinterpI64asF64:
+							case Iop_32UtoV128:
+							case Iop_V128to64:
+							case Iop_V128HIto64:
+							case Iop_64to32:
+							case Iop_64HIto32:
+							case Iop_64UtoV128:
+							case Iop_32Uto64:
+								if (expr->Iex.Unop.arg->tag == Iex_RdTmp) {
+									if (tmpInstead[expr->Iex.Unop.arg->Iex.RdTmp.tmp] >= 0) {
+										tmpInstead[st->Ist.WrTmp.tmp] = tmpInstead[expr->Iex.Unop.arg->Iex.RdTmp.tmp];
+									} else {
+										tmpInstead[st->Ist.WrTmp.tmp] = expr->Iex.Unop.arg->Iex.RdTmp.tmp;
+									}
+								}
+								break;
+							default:
+								break;
+						}
+						break;
+					case Iex_Binop:
+						switch (expr->Iex.Binop.op) {
+							case Iop_F64toF32:
+								if (expr->Iex.Binop.arg2->tag == Iex_RdTmp) {
+									if (tmpInstead[expr->Iex.Binop.arg2->Iex.RdTmp.tmp] >= 0) {
+										tmpInstead[st->Ist.WrTmp.tmp] = tmpInstead[expr->Iex.Binop.arg2->Iex.RdTmp.tmp]; 
+									} else {
+										tmpInstead[st->Ist.WrTmp.tmp] = expr->Iex.Binop.arg2->Iex.RdTmp.tmp;
+									}
+								}
+								break;
+							case Iop_64HLtoV128:
+							case Iop_32HLto64:
+								if (expr->Iex.Binop.arg1->tag == Iex_RdTmp) {
+									if (tmpInstead[expr->Iex.Binop.arg1->Iex.RdTmp.tmp] >= 0) {
+										tmpInstead[st->Ist.WrTmp.tmp] = tmpInstead[expr->Iex.Binop.arg1->Iex.RdTmp.tmp]; 
+									} else {
+										tmpInstead[st->Ist.WrTmp.tmp] = expr->Iex.Binop.arg1->Iex.RdTmp.tmp;
+									}
+								} else if (expr->Iex.Binop.arg2->tag == Iex_RdTmp) {
+									if (tmpInstead[expr->Iex.Binop.arg2->Iex.RdTmp.tmp] >= 0) {
+										tmpInstead[st->Ist.WrTmp.tmp] = tmpInstead[expr->Iex.Binop.arg2->Iex.RdTmp.tmp]; 
+									} else {
+										tmpInstead[st->Ist.WrTmp.tmp] = expr->Iex.Binop.arg2->Iex.RdTmp.tmp;
+									}
+								}
+								break;
+							default:
+								break;
+						}
+						break;
+					default:
+						break;
+				}
+				break;
+			default:
+				break;
+		}
+	}
+
+	/* multiply-add pairs (--fma-contraction) */
+	Int contractMul[tyenv->types_used];
+	Addr contractMulAddr[tyenv->types_used];
+	if (clo_fma_contraction) {
+		findContractions(sbIn, i, contractMul, contractMulAddr);
+	}
+
+	instrumentEnterSB(sbOut);
+
+	Int arg1tmpInstead = -1;
+	Int arg2tmpInstead = -1;
+	Int qopTmpInstead[3];
+	RetType retType;
+
+	/* This is the main loop which hads instructions for the analysis (instrumentation).*/
+	for (/*use current i*/; i < sbIn->stmts_used; i++) {
+		IRStmt* st = sbIn->stmts[i];
+		if (!st || st->tag == Ist_NoOp) continue;
+      
+		switch (st->tag) {
+			case Ist_AbiHint:
+				addStmtToIRSB(sbOut, st);
+				break;
+			case Ist_Put:
+				addStmtToIRSB(sbOut, st);
+				putCount++;
+
+				if (st->Ist.Put.offset != 168) {
+					arg1tmpInstead = -1;
+					if (st->Ist.Put.data->tag == Iex_RdTmp) {
+						arg1tmpInstead = tmpInstead[st->Ist.Put.data->Iex.RdTmp.tmp];
+					}
+					instrumentPut(sbOut, tyenv, st, arg1tmpInstead);
+				} else {
+					putsIgnored++;
+				}
+				break;
+			case Ist_PutI:
+				addStmtToIRSB(sbOut, st);
+				arg1tmpInstead = -1;
+				if (st->Ist.PutI.data->tag == Iex_RdTmp) {
+					arg1tmpInstead = tmpInstead[st->Ist.PutI.data->Iex.RdTmp.tmp];
+				}
+				instrumentPutI(sbOut, tyenv, st, arg1tmpInstead);
+				break;
+			case Ist_IMark:
+				/* address of current instruction */
+				cia = st->Ist.IMark.addr;
+				if ((clo_stop_fn || clo_stop_addr) && isTrigger(cia, clo_stop_fn, clo_stop_addr)) {
+					if (clo_reinstrument) {
+						endSBAtTrigger(sbOut, cia, False);
+						return sbOut;
+					}
+					instrumentTrigger(sbOut, False);
+				}
+				addStmtToIRSB(sbOut, st);
+				if (psoDbCount > 0) {
+					resolvePSODb(cia);
+				}
+				break;
+			case Ist_Exit:
+				addStmtToIRSB(sbOut, st);
+				break;
+			case Ist_WrTmp:
+				expr = st->Ist.WrTmp.data;
+		        type = typeOfIRExpr(sbOut->tyenv, expr);
+		        tl_assert(type != Ity_INVALID);
+
+		        switch (expr->tag) {
+					case Iex_Const:
+						addStmtToIRSB(sbOut, st);
+						break;
+					case Iex_Load:
+						addStmtToIRSB(sbOut, st);
+						loadCount++;
+						instrumentLoad(sbOut, tyenv, st);
+						break;
+					case Iex_Get:
+						addStmtToIRSB(sbOut, st);
+						getCount++;
+
+						if (tmpInstead[st->Ist.WrTmp.tmp] < 0) {
+							instrumentGet(sbOut, tyenv, st);
+						} else {
+							getsIgnored++;
+						}
+						break;
+					case Iex_GetI:
+						addStmtToIRSB(sbOut, st);
+
+						if (tmpInstead[st->Ist.WrTmp.tmp] < 0) {
+							instrumentGetI(sbOut, tyenv, st);
+						}
+						break;
+					case Iex_Unop:
+						// opToStr(expr->Iex.Unop.op);
+						// VG_(umsg)("una : %s\n", opStr);
+						switch (expr->Iex.Unop.op) {
+							case Iop_Sqrt32F0x4:
+							case Iop_Sqrt64F0x2:
+							case Iop_NegF32:
+							case Iop_NegF64:
+							case Iop_AbsF32:
+							case Iop_AbsF64:
+								addStmtToIRSB(sbOut, st);
+
+								arg1tmpInstead = -1;
+								if (expr->Iex.Unop.arg->tag == Iex_RdTmp) {
+									arg1tmpInstead = tmpInstead[expr->Iex.Unop.arg->Iex.RdTmp.tmp];
+								}
+								instrumentUnOp(sbOut, tyenv, cia, st->Ist.WrTmp.tmp, expr, arg1tmpInstead);
+								break;
+							case Iop_Sqrt32Fx4:
+							case Iop_Sqrt64Fx2:
+								addStmtToIRSB(sbOut, st);
+
+								arg1tmpInstead = -1;
+								if (expr->Iex.Unop.arg->tag == Iex_RdTmp) {
+									arg1tmpInstead = tmpInstead[expr->Iex.Unop.arg->Iex.RdTmp.tmp];
+								}
+								instrumentPackedOp(sbOut, tyenv, cia, st->Ist.WrTmp.tmp, expr, arg1tmpInstead, -1);
+								break;
+							case Iop_F32toF64:
+							case Iop_ReinterpI64asF64:
+							case Iop_32UtoV128:
+							case Iop_V128to64:
+							case Iop_V128HIto64:
+							case Iop_64to32:
+							case Iop_64HIto32:
+							case Iop_64UtoV128:
+							case Iop_32Uto64:
+								/* ignored floating-point and related SSE operations */
+								addStmtToIRSB(sbOut, st);
+								break;
+							case Iop_Recip32Fx4:
+							case Iop_RSqrt32Fx4:
+							case Iop_RoundF32x4_RM:
+							case Iop_RoundF32x4_RP:
+							case Iop_RoundF32x4_RN:
+							case Iop_RoundF32x4_RZ:
+							case Iop_Recip32F0x4:
+							case Iop_RSqrt32F0x4:
+							case Iop_Recip64Fx2:
+							case Iop_RSqrt64Fx2:
+							case Iop_Recip64F0x2:
+							case Iop_RSqrt64F0x2:
+							case Iop_SinF64:
+							case Iop_CosF64:
+							case Iop_TanF64:
+							case Iop_2xm1F64:
+							case Iop_Est5FRSqrt:
+							case Iop_RoundF64toF64_NEAREST:
+							case Iop_RoundF64toF64_NegINF:
+							case Iop_RoundF64toF64_PosINF:
+							case Iop_RoundF64toF64_ZERO:
+							case Iop_TruncF64asF32:
+								addStmtToIRSB(sbOut, st);
+								reportUnsupportedOp(expr->Iex.Unop.op);
+								break;
+							default:
+								addStmtToIRSB(sbOut, st);
+								break;
+						}
+						break;
+					case Iex_Binop:
+						// opToStr(expr->Iex.Binop.op);
+						// VG_(umsg)("bin : %s\n", opStr);
+						switch (expr->Iex.Binop.op) {
+							case Iop_CmpF64:
+								if (clo_goto_shadow_branch) {
+									arg1tmpInstead = -1;
+									arg2tmpInstead = -1;
+									if (expr->Iex.Binop.arg1->tag == Iex_RdTmp) {
+										arg1tmpInstead = tmpInstead[expr->Iex.Binop.arg1->Iex.RdTmp.tmp];
+									}
+									if (expr->Iex.Binop.arg2->tag == Iex_RdTmp) {
+										arg2tmpInstead = tmpInstead[expr->Iex.Binop.arg2->Iex.RdTmp.tmp];
+									}
+									instrumentCmpF64(sbOut, tyenv, cia, st->Ist.WrTmp.tmp, expr, arg1tmpInstead, arg2tmpInstead);
+								} else {
+									addStmtToIRSB(sbOut, st);
+								}
+								break;
+							case Iop_Add32F0x4:
+							case Iop_Add64F0x2:
+							case Iop_Sub32F0x4:
+							case Iop_Mul32F0x4:
+							case Iop_Div32F0x4:
+							case Iop_Sub64F0x2:
+							case Iop_Mul64F0x2:
+							case Iop_Div64F0x2:
+							case Iop_Min32F0x4:
+							case Iop_Min64F0x2:
+							case Iop_Max32F0x4:
+							case Iop_Max64F0x2:
+							case Iop_SqrtF32:
+							case Iop_SqrtF64:
+							case Iop_SinF64:
+							case Iop_CosF64:
+							case Iop_TanF64:
+							case Iop_2xm1F64:
+								addStmtToIRSB(sbOut, st);
+
+								arg1tmpInstead = -1;
+								arg2tmpInstead = -1;
+								if (expr->Iex.Binop.arg1->tag == Iex_RdTmp) {
+									arg1tmpInstead = tmpInstead[expr->Iex.Binop.arg1->Iex.RdTmp.tmp];
+								}
+								if (expr->Iex.Binop.arg2->tag == Iex_RdTmp) {
+									arg2tmpInstead = tmpInstead[expr->Iex.Binop.arg2->Iex.RdTmp.tmp];
+								}
+								instrumentBinOp(sbOut, tyenv, cia, st->Ist.WrTmp.tmp, expr, arg1tmpInstead, arg2tmpInstead);
+								if (clo_fma_contraction && contractMul[st->Ist.WrTmp.tmp] >= 0) {
+									instrumentContraction(sbOut, tyenv, cia, contractMulAddr[st->Ist.WrTmp.tmp], 
+										st, sbIn->stmts[contractMul[st->Ist.WrTmp.tmp]]);
+								}
+								break;
+							case Iop_Add32Fx4:
+							case Iop_Sub32Fx4:
+							case Iop_Mul32Fx4:
+							case Iop_Div32Fx4:
+							case Iop_Max32Fx4:
+							case Iop_Min32Fx4:
+							case Iop_Add64Fx2:
+							case Iop_Sub64Fx2:
+							case Iop_Mul64Fx2:
+							case Iop_Div64Fx2:
+							case Iop_Max64Fx2:
+							case Iop_Min64Fx2:
+								addStmtToIRSB(sbOut, st);
+
+								arg1tmpInstead = -1;
+								arg2tmpInstead = -1;
+								if (expr->Iex.Binop.arg1->tag == Iex_RdTmp) {
+									arg1tmpInstead = tmpInstead[expr->Iex.Binop.arg1->Iex.RdTmp.tmp];
+								}
+								if (expr->Iex.Binop.arg2->tag == Iex_RdTmp) {
+									arg2tmpInstead = tmpInstead[expr->Iex.Binop.arg2->Iex.RdTmp.tmp];
+								}
+								instrumentPackedOp(sbOut, tyenv, cia, st->Ist.WrTmp.tmp, expr, arg1tmpInstead, arg2tmpInstead);
+								break;
+							case Iop_F64toF32:
+							case Iop_64HLtoV128:
+							case Iop_32HLto64:
+								/* ignored floating-point and related SSE operations */
+								addStmtToIRSB(sbOut, st);
+								break;
+							case Iop_F64toI16S:
+							case Iop_F64toI32S:
+							case Iop_F64toI64S:
+							case Iop_F64toI64U:
+							case Iop_F64toI32U:
+								if (clo_track_int) {
+									arg2tmpInstead = -1;
+									if (expr->Iex.Binop.arg2->tag == Iex_RdTmp) {
+										arg2tmpInstead = tmpInstead[expr->Iex.Binop.arg2->Iex.RdTmp.tmp];
+									}
+									switch(expr->Iex.Binop.op) {
 										case Iop_F64toI16S:
 											retType = Rt_I16S;
 											break;
@@ -3432,21 +8162,7 @@ static IRSB* fd_instrument(VgCallbackClosure* closure, IRSB* sbIn,
 									addStmtToIRSB(sbOut, st);
 								}
 								break;
-							case Iop_Add32Fx4:
-							case Iop_Sub32Fx4:
-							case Iop_Mul32Fx4:
-							case Iop_Div32Fx4:
-							case Iop_Max32Fx4:
-							case Iop_Min32Fx4:
-							case Iop_Add64Fx2:
-							case Iop_Sub64Fx2:
-							case Iop_Mul64Fx2:
-							case Iop_Div64Fx2:
-							case Iop_Max64Fx2:
-							case Iop_Min64Fx2:
-							case Iop_SqrtF64:
 							case Iop_SqrtF64r32:
-							case Iop_SqrtF32:
 							case Iop_AtanF64:
 							case Iop_Yl2xF64:
 							case Iop_Yl2xp1F64:
@@ -3457,10 +8173,6 @@ static IRSB* fd_instrument(VgCallbackClosure* closure, IRSB* sbIn,
 							case Iop_ScaleF64:
 							case Iop_PwMax32Fx2:
 							case Iop_PwMin32Fx2:
-							case Iop_SinF64:
-							case Iop_CosF64:
-							case Iop_TanF64:
-							case Iop_2xm1F64:
 							case Iop_RoundF64toF32:
 								addStmtToIRSB(sbOut, st);
 								reportUnsupportedOp(expr->Iex.Binop.op);
@@ -3478,6 +8190,20 @@ static IRSB* fd_instrument(VgCallbackClosure* closure, IRSB* sbIn,
 							case Iop_SubF64:
 							case Iop_MulF64:
 							case Iop_DivF64:
+							case Iop_AddF32:
+							case Iop_SubF32:
+							case Iop_MulF32:
+							case Iop_DivF32:
+							case Iop_AddF64r32:
+							case Iop_SubF64r32:
+							case Iop_MulF64r32:
+							case Iop_DivF64r32:
+							case Iop_AtanF64:
+							case Iop_Yl2xF64:
+							case Iop_Yl2xp1F64:
+							case Iop_PRemF64:
+							case Iop_PRem1F64:
+							case Iop_ScaleF64:
 								addStmtToIRSB(sbOut, st);
 								
 								arg1tmpInstead = -1;
@@ -3489,23 +8215,13 @@ static IRSB* fd_instrument(VgCallbackClosure* closure, IRSB* sbIn,
 									arg2tmpInstead = tmpInstead[expr->Iex.Triop.arg3->Iex.RdTmp.tmp];
 								}
 								instrumentTriOp(sbOut, tyenv, cia, st->Ist.WrTmp.tmp, expr, arg1tmpInstead, arg2tmpInstead);
+								if (clo_fma_contraction && contractMul[st->Ist.WrTmp.tmp] >= 0) {
+									instrumentContraction(sbOut, tyenv, cia, contractMulAddr[st->Ist.WrTmp.tmp], 
+										st, sbIn->stmts[contractMul[st->Ist.WrTmp.tmp]]);
+								}
 								break;
-							case Iop_AddF32:
-							case Iop_SubF32:
-							case Iop_MulF32:
-							case Iop_DivF32:
-							case Iop_AddF64r32:
-							case Iop_SubF64r32:
-							case Iop_MulF64r32:
-							case Iop_DivF64r32:
-							case Iop_AtanF64:
-      						case Iop_Yl2xF64:
-      						case Iop_Yl2xp1F64:
-      						case Iop_PRemF64:
       						case Iop_PRemC3210F64:
-      						case Iop_PRem1F64:
       						case Iop_PRem1C3210F64:
-      						case Iop_ScaleF64:
 								addStmtToIRSB(sbOut, st);
 								reportUnsupportedOp(expr->Iex.Triop.op);
 								break;
@@ -3521,7 +8237,20 @@ static IRSB* fd_instrument(VgCallbackClosure* closure, IRSB* sbIn,
 							case Iop_MAddF64:
 							case Iop_MSubF64:
 								addStmtToIRSB(sbOut, st);
-								reportUnsupportedOp(expr->Iex.Qop.op);
+
+								qopTmpInstead[0] = -1;
+								qopTmpInstead[1] = -1;
+								qopTmpInstead[2] = -1;
+								if (expr->Iex.Qop.arg2->tag == Iex_RdTmp) {
+									qopTmpInstead[0] = tmpInstead[expr->Iex.Qop.arg2->Iex.RdTmp.tmp];
+								}
+								if (expr->Iex.Qop.arg3->tag == Iex_RdTmp) {
+									qopTmpInstead[1] = tmpInstead[expr->Iex.Qop.arg3->Iex.RdTmp.tmp];
+								}
+								if (expr->Iex.Qop.arg4->tag == Iex_RdTmp) {
+									qopTmpInstead[2] = tmpInstead[expr->Iex.Qop.arg4->Iex.RdTmp.tmp];
+								}
+								instrumentQop(sbOut, tyenv, cia, st->Ist.WrTmp.tmp, expr, qopTmpInstead);
 								break;
 							default:
 								addStmtToIRSB(sbOut, st);
@@ -3531,1157 +8260,1836 @@ static IRSB* fd_instrument(VgCallbackClosure* closure, IRSB* sbIn,
 					case Iex_Mux0X:
 						addStmtToIRSB(sbOut, st);
 
-						arg1tmpInstead = -1;
-						arg2tmpInstead = -1;
-						if (expr->Iex.Mux0X.expr0->tag == Iex_RdTmp) {
-							arg1tmpInstead = tmpInstead[expr->Iex.Mux0X.expr0->Iex.RdTmp.tmp];
-						}
-						if (expr->Iex.Mux0X.exprX->tag == Iex_RdTmp) {
-							arg2tmpInstead = tmpInstead[expr->Iex.Mux0X.exprX->Iex.RdTmp.tmp];
-						}
-						instrumentMux0X(sbOut, tyenv, st->Ist.WrTmp.tmp, expr, arg1tmpInstead, arg2tmpInstead);
-						break;
-					case Iex_CCall:
-						addStmtToIRSB(sbOut, st);
-						break;
-					default:
-						addStmtToIRSB(sbOut, st);
-						break;
-				}
-				break;
-			case Ist_Store:
-				addStmtToIRSB(sbOut, st);
+						arg1tmpInstead = -1;
+						arg2tmpInstead = -1;
+						if (expr->Iex.Mux0X.expr0->tag == Iex_RdTmp) {
+							arg1tmpInstead = tmpInstead[expr->Iex.Mux0X.expr0->Iex.RdTmp.tmp];
+						}
+						if (expr->Iex.Mux0X.exprX->tag == Iex_RdTmp) {
+							arg2tmpInstead = tmpInstead[expr->Iex.Mux0X.exprX->Iex.RdTmp.tmp];
+						}
+						instrumentMux0X(sbOut, tyenv, st->Ist.WrTmp.tmp, expr, arg1tmpInstead, arg2tmpInstead);
+						break;
+					case Iex_CCall:
+						addStmtToIRSB(sbOut, st);
+						break;
+					default:
+						addStmtToIRSB(sbOut, st);
+						break;
+				}
+				break;
+			case Ist_Store:
+				addStmtToIRSB(sbOut, st);
+
+				arg1tmpInstead = -1;
+				if (st->Ist.Store.data->tag == Iex_RdTmp) {
+					arg1tmpInstead = tmpInstead[st->Ist.Store.data->Iex.RdTmp.tmp];
+				}
+				instrumentStore(sbOut, tyenv, st, arg1tmpInstead);
+				storeCount++;
+				break;
+			default:
+				addStmtToIRSB(sbOut, st);
+				break;
+		}
+	}
+    return sbOut;
+}
+
+static void getIntroducedError(mpfr_t* introducedError, MeanValue* mv) {
+	mpfr_set_ui(*introducedError, 0, STD_RND);
+	mpfr_abs(introMaxError, mv->max, STD_RND);
+	if (mv->arg1 != 0 && mv->arg2 != 0) {
+		MeanValue* mv1 = VG_(HT_lookup)(meanValues, mv->arg1);
+		MeanValue* mv2 = VG_(HT_lookup)(meanValues, mv->arg2);
+		tl_assert(mv1 && mv2);
+		mpfr_abs(introErr1, mv1->max, STD_RND);
+		mpfr_abs(introErr2, mv2->max, STD_RND);
+
+		if (mv->arg1 == mv->key && mv->arg2 == mv->key) {
+			mpfr_set(*introducedError, introMaxError, STD_RND);
+		} else if (mpfr_cmp(introErr1, introErr2) > 0) {
+			if (mpfr_cmp(introMaxError, introErr1) > 0 || mpfr_cmp(introMaxError, introErr2) > 0) {
+				if (mv->arg1 == mv->key) {
+					mpfr_set(*introducedError, introMaxError, STD_RND);
+				} else {
+					mpfr_sub(*introducedError, introMaxError, introErr1, STD_RND);
+				}
+			} else {
+				/* introduced error gets negative */
+				mpfr_sub(*introducedError, introMaxError, introErr2, STD_RND);
+			}
+		} else if (mpfr_cmp(introMaxError, introErr2) > 0 || mpfr_cmp(introMaxError, introErr1) > 0) {
+			if (mv->arg2 == mv->key) {
+				mpfr_set(*introducedError, introMaxError, STD_RND);
+			} else {
+				mpfr_sub(*introducedError, introMaxError, introErr2, STD_RND);
+			}
+		} else {
+			/* introduced error gets negative */
+			mpfr_sub(*introducedError, introMaxError, introErr1, STD_RND);
+		}
+	} else if (mv->arg1 != 0) {
+		MeanValue* mv1 = VG_(HT_lookup)(meanValues, mv->arg1);
+		tl_assert(mv1);
+		mpfr_abs(introErr1, mv1->max, STD_RND);
+
+		if (mv->arg1 == mv->key) {
+			mpfr_set(*introducedError, introMaxError, STD_RND);
+		} else {
+			/* introduced error can get negative */
+			mpfr_sub(*introducedError, introMaxError, introErr1, STD_RND);
+		}
+	} else if (mv->arg2 != 0) {
+		MeanValue* mv2 = VG_(HT_lookup)(meanValues, mv->arg2);
+		tl_assert(mv2);
+		mpfr_abs(introErr2, mv2->max, STD_RND);
+
+		if (mv->arg2 == mv->key) {
+			mpfr_set(*introducedError, introMaxError, STD_RND);
+		} else {
+			/* introduced error can get negative */
+			mpfr_sub(*introducedError, introMaxError, introErr2, STD_RND);
+		}
+	} else {
+		mpfr_set(*introducedError, introMaxError, STD_RND);
+	}
+}
+
+static void writeOriginGraph(Int file, Addr oldAddr, Addr origin, Int arg, Int level, Int edgeColor, Bool careVisited) {
+	if (level > MAX_LEVEL_OF_GRAPH) {
+		if (careVisited) {
+			MeanValue* mv = VG_(HT_lookup)(meanValues, oldAddr);
+			mv->visited = True;
+		}
+		return;
+	}
+
+	if (level <= 1) {
+		my_fwrite(file, "graph: {\n", 9);
+		my_fwrite(file, "title: \"Created with FpDebug\"\n", 30);
+		my_fwrite(file, "classname 1 : \"FpDebug\"\n", 24);
+
+		Int i;
+		for (i = 50; i < 150; i++) {
+			VG_(sprintf)(formatBuf, "colorentry %d : 255 %d 0\n", i, (Int)((255.0 / 100.0) * (i - 50)));
+			my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+		}
+		for (i = 150; i < 250; i++) {
+			VG_(sprintf)(formatBuf, "colorentry %d : %d 255 0\n", i, (Int)((255.0 / 100.0) * (i - 150)));
+			my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+		}
+
+		/* the set is used to avoid cycles */
+		if (originAddrSet) {
+			VG_(OSetWord_Destroy)(originAddrSet);
+		}
+		originAddrSet = VG_(OSetWord_Create)(VG_(malloc), "fd.writeOriginGraph.1", VG_(free));
+	} 
+	tl_assert(originAddrSet);
+
+	MeanValue* mv = VG_(HT_lookup)(meanValues, origin);
+	tl_assert(mv);
+
+	if (careVisited) {
+		mv->visited = True;
+	}
+	
+	Bool cycle = False;
+	Bool inLibrary = False;
+	if (VG_(OSetWord_Contains)(originAddrSet, origin)) {
+		cycle = True;
+	} else {
+		/* create node */
+		VG_(describe_IP)(origin, description, DESCRIPTION_SIZE);
+		if (ignoreFile(description)) {
+			inLibrary = True;
+		}
+
+		if (clo_ignoreAccurate && mpfr_cmp_ui(mv->max, 0) == 0) {
+			return;
+		}
+
+		Int color = 150; /* green */
+
+		if (level > 1) {
+			MeanValue* oldMv = VG_(HT_lookup)(meanValues, oldAddr);
+			tl_assert(oldMv);
+
+			getIntroducedError(&dumpGraphDiff, mv);
+
+			if (mpfr_cmp_ui(dumpGraphDiff, 0) > 0) {
+				mpfr_exp_t exp = mpfr_get_exp(dumpGraphDiff);
+				if (exp > 1) exp = 1;
+				if (exp < -8) exp = -8;
+				exp = 9 + (exp - 1); /* range 0..9 */
+				color = 149 - (exp * 10);
+			}
+		} else {
+			color = 1; /* blue */
+		}
+		
+		mpfr_div_ui(dumpGraphMeanError, mv->sum, mv->sampled, STD_RND);
+
+		opToStr(mv->op);
+		Char meanErrorStr[MPFR_BUFSIZE];
+		mpfrToStringShort(meanErrorStr, &dumpGraphMeanError);
+		Char maxErrorStr[MPFR_BUFSIZE];
+		mpfrToStringShort(maxErrorStr, &(mv->max));
+
+		Char canceledAvg[10];
+		if (mv->overflow) {
+			VG_(sprintf)(canceledAvg, "overflow");
+		} else {
+			VG_(sprintf)(canceledAvg, "%ld", mv->canceledSum / mv->sampled);
+		}
+
+		Char filename[20];
+		filename[0] = '\0';
+		VG_(get_filename)(origin, filename, 19);
+
+		UInt linenum = -1;
+		Bool gotLine = VG_(get_linenum)(origin, &linenum);
+		Char linenumber[10];
+		linenumber[0] = '\0';
+		if (gotLine) {
+			VG_(sprintf)(linenumber, ":%u", linenum);
+		}
+
+		VG_(sprintf)(formatBuf, "node: { title: \"0x%lX\" label: \"%s (%s%s)\" color: %d info1: \"%s (%'u)\" info2: \"avg: %s, max: %s\" "
+			"info3: \"canceled - avg: %s, max: %ld\" }\n", 
+			origin, opStr, filename, linenumber, color, description, mv->count, meanErrorStr, maxErrorStr, canceledAvg, mv->canceledMax);
+		my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+	}
+
+	if (level > 1) {
+		/* create edge */
+		MeanValue* oldMv = VG_(HT_lookup)(meanValues, oldAddr);
+		tl_assert(oldMv);
+
+		getIntroducedError(&dumpGraphDiff, mv);
+
+		Char diffStr[30];
+		mpfrToStringShort(&diffStr, &dumpGraphDiff);
+
+		VG_(sprintf)(formatBuf, "edge: { sourcename: \"0x%lX\" targetname: \"0x%lX\" label: \"%s\" class: 1 color : %d }\n", origin, oldAddr, diffStr, edgeColor);
+		my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+	}
+	
+	if (cycle) {
+		return;
+	}
+
+	if (mv != NULL) {
+		VG_(OSetWord_Insert)(originAddrSet, origin);
+		if (mv->arg1 != 0 && mv->arg2 != 0) {
+			MeanValue* mv1 = VG_(HT_lookup)(meanValues, mv->arg1);
+			MeanValue* mv2 = VG_(HT_lookup)(meanValues, mv->arg2);
+			tl_assert(mv1 && mv2);
+
+			Bool leftErrGreater = True;
+			mpfr_abs(dumpGraphErr1, mv1->max, STD_RND);
+			mpfr_abs(dumpGraphErr2, mv2->max, STD_RND);
+
+			if (mpfr_cmp(dumpGraphErr1, dumpGraphErr2) < 0) {
+				leftErrGreater = False;
+			}
+			mpfr_sub(dumpGraphDiff, dumpGraphErr1, dumpGraphErr2, STD_RND);
+			mpfr_abs(dumpGraphDiff, dumpGraphDiff, STD_RND);
+			mpfr_exp_t exp = mpfr_get_exp(dumpGraphDiff);
+			if (exp > 1) exp = 1;
+			if (exp < -8) exp = -8;
+			exp = 9 + (exp - 1);
+			Int red = 149 - (exp * 10);
+			if (red > 120) red = 120;
+			Int green = red + 100;
+
+			VG_(describe_IP)(mv->arg1, description, DESCRIPTION_SIZE);
+			if (!inLibrary || !ignoreFile(description)) {
+				writeOriginGraph(file, origin, mv->arg1, 1, ++level, (leftErrGreater ? red : green), careVisited);
+			}
+			VG_(describe_IP)(mv->arg2, description, DESCRIPTION_SIZE);
+			if (!inLibrary || !ignoreFile(description)) {
+				writeOriginGraph(file, origin, mv->arg2, 2, level, (leftErrGreater ? green : red), careVisited);
+			}
+		} else if (mv->arg1 != 0) {
+			VG_(describe_IP)(mv->arg1, description, DESCRIPTION_SIZE);
+			if (!inLibrary || !ignoreFile(description)) {
+				writeOriginGraph(file, origin, mv->arg1, 1, ++level, 1, careVisited);
+			}
+		} else if (mv->arg2 != 0) {
+			VG_(describe_IP)(mv->arg2, description, DESCRIPTION_SIZE);
+			if (!inLibrary || !ignoreFile(description)) {
+				writeOriginGraph(file, origin, mv->arg2, 2, ++level, 1, careVisited);
+			}
+		}
+	}
+}
+
+static Bool dumpGraph(Char* fileName, ULong addr, Bool conditional, Bool careVisited) {
+	/*if (!clo_computeMeanValue) {
+		VG_(umsg)("DUMP GRAPH (%s): Mean error computation has to be active!\n", fileName);
+		return False;
+	}
+
+	ShadowValue* svalue = VG_(HT_lookup)(globalMemory, addr);
+	if (svalue) {
+		if (careVisited) {
+			MeanValue* mv = VG_(HT_lookup)(meanValues, svalue->origin);
+			tl_assert(mv);
+			if (mv->visited) {
+				return False;
+			}
+		}
+
+		VG_(describe_IP)(svalue->origin, description, DESCRIPTION_SIZE);
+		if (ignoreFile(description)) {
+			return False;
+		}
+
+		if (svalue->orgType == Ot_FLOAT) {
+			mpfr_set_flt(dumpGraphOrg, svalue->Org.fl, STD_RND);
+		} else if (svalue->orgType == Ot_DOUBLE) {
+			mpfr_set_d(dumpGraphOrg, svalue->Org.db, STD_RND);
+		} else {
+			tl_assert(False);
+		}
+
+		if (mpfr_cmp_ui(svalue->value, 0) != 0 || mpfr_cmp_ui(dumpGraphOrg, 0) != 0) {
+			mpfr_reldiff(dumpGraphRel, svalue->value, dumpGraphOrg, STD_RND);
+			mpfr_abs(dumpGraphRel, dumpGraphRel, STD_RND);
+		} else {
+			mpfr_set_ui(dumpGraphRel, 0, STD_RND);
+		}
+
+		if (conditional && mpfr_cmp_ui(dumpGraphRel, 0) == 0) {
+			return False;
+		}
+
+		SysRes file = VG_(open)(fileName, VKI_O_CREAT|VKI_O_TRUNC|VKI_O_WRONLY, VKI_S_IRUSR|VKI_S_IWUSR);
+		if (!sr_isError(file)) {
+			writeOriginGraph(sr_Res(file), 0, svalue->origin, 0, 1, 1, careVisited);
+			my_fwrite(sr_Res(file), "}\n", 2);
+			fwrite_flush();
+			VG_(close)(sr_Res(file));
+			VG_(umsg)("DUMP GRAPH (%s): successful\n", fileName);
+			return True;
+		} else {
+			VG_(umsg)("DUMP GRAPH (%s): Failed to create or open the file!\n", fileName);
+			return False;
+		}
+	} else {
+		VG_(umsg)("DUMP GRAPH (%s): Shadow variable was not found!\n", fileName);
+		VG_(get_and_pp_StackTrace)(VG_(get_running_tid)(), 16);
+		return False;
+	}*/
+	return False;
+}
+
+static void printError(Char* varName, ULong addr, Bool conditional) {
+	mpfr_t org, diff, rel;
+	ShadowValue* svalue = lookupShadow(addr);;
+	if (svalue) {
+		mpfr_inits(diff, rel, NULL);
+		
+		Bool isFloat = svalue->orgType == Ot_FLOAT;
+		if (svalue->orgType == Ot_FLOAT) {
+			mpfr_init(org);
+			mpfr_set_flt(org, svalue->Org.fl, STD_RND);
+		} else if (svalue->orgType == Ot_DOUBLE) {
+			mpfr_init_set_d(org, svalue->Org.db, STD_RND);
+		} else {
+			tl_assert(False);
+		}
+
+		if (mpfr_cmp_ui(svalue->value, 0) != 0 || mpfr_cmp_ui(org, 0) != 0) {
+			mpfr_reldiff(rel, svalue->value, org, STD_RND);
+			mpfr_abs(rel, rel, STD_RND);
+		} else {
+			mpfr_set_ui(rel, 0, STD_RND);
+		}
+
+		if (conditional && mpfr_cmp_ui(rel, 0) == 0) {
+			mpfr_clears(org, diff, rel, NULL);
+			return;
+		}
 
-				arg1tmpInstead = -1;
-				if (st->Ist.Store.data->tag == Iex_RdTmp) {
-					arg1tmpInstead = tmpInstead[st->Ist.Store.data->Iex.RdTmp.tmp];
-				}
-				instrumentStore(sbOut, tyenv, st, arg1tmpInstead);
-				storeCount++;
-				break;
-			default:
-				addStmtToIRSB(sbOut, st);
-				break;
+		mpfr_sub(diff, svalue->value, org, STD_RND);
+
+		Char typeName[7];
+		if (isFloat) {
+			VG_(strcpy)(typeName, "float");
+		} else {
+			VG_(strcpy)(typeName, "double");
+		}
+
+		VG_(umsg)("(%s) %s PRINT ERROR OF: 0x%lX\n", typeName, varName, addr);
+		Char mpfrBuf[MPFR_BUFSIZE];
+		mpfrToString(mpfrBuf, &org);
+		VG_(umsg)("(%s) %s ORIGINAL:         %s\n", typeName, varName, mpfrBuf);
+		mpfrToString(mpfrBuf, &(svalue->value));
+		VG_(umsg)("(%s) %s SHADOW VALUE:     %s\n", typeName, varName, mpfrBuf);
+		mpfrToString(mpfrBuf, &(svalue->midValue));
+		VG_(umsg)("(%s) %s MIDDLE:           %s\n", typeName, varName, mpfrBuf);
+		mpfrToString(mpfrBuf, &(svalue->oriValue));
+		VG_(umsg)("(%s) %s SIMULATE:         %s\n", typeName, varName, mpfrBuf);
+		mpfrToString(mpfrBuf, &diff);
+		VG_(umsg)("(%s) %s ABSOLUTE ERROR:   %s\n", typeName, varName, mpfrBuf);
+		mpfrToString(mpfrBuf, &rel);
+		VG_(umsg)("(%s) %s RELATIVE ERROR:   %s\n", typeName, varName, mpfrBuf);
+		VG_(umsg)("(%s) %s CANCELED BITS:     %lld\n", typeName, varName, svalue->canceled);
+		if (svalue->stoValid) {
+			VG_(umsg)("(%s) %s SIGNIFICANT DIGITS: %d\n", typeName, varName, stoSignificantDigits(svalue->sto));
 		}
+
+		VG_(describe_IP)(svalue->origin, description, DESCRIPTION_SIZE);
+		VG_(umsg)("(%s) %s Last operation: %s\n", typeName, varName, description);
+
+		if (svalue->canceled > 0 && svalue->cancelOrigin > 0) {
+			VG_(describe_IP)(svalue->cancelOrigin, description, DESCRIPTION_SIZE);
+			VG_(umsg)("(%s) %s Cancellation origin: %s\n", typeName, varName, description);
+		}
+		
+		VG_(umsg)("(%s) %s Operation count (max path): %'lu\n", typeName, varName, svalue->opCount);
+
+		mpfr_clears(org, diff, rel, NULL);
+	} else {
+		VG_(umsg)("There exists no shadow value for %s!\n", varName);
+		VG_(get_and_pp_StackTrace)(VG_(get_running_tid)(), 16);
 	}
-    return sbOut;
 }
 
-static void getIntroducedError(mpfr_t* introducedError, MeanValue* mv) {
-	mpfr_set_ui(*introducedError, 0, STD_RND);
-	mpfr_abs(introMaxError, mv->max, STD_RND);
-	if (mv->arg1 != 0 && mv->arg2 != 0) {
-		MeanValue* mv1 = VG_(HT_lookup)(meanValues, mv->arg1);
-		MeanValue* mv2 = VG_(HT_lookup)(meanValues, mv->arg2);
-		tl_assert(mv1 && mv2);
-		mpfr_abs(introErr1, mv1->max, STD_RND);
-		mpfr_abs(introErr2, mv2->max, STD_RND);
+static Bool isErrorGreater(ULong addrFp, ULong addrErr) {
+	mpfr_t org, rel;
+	Double* errorBound = (Double*)addrErr;
 
-		if (mv->arg1 == mv->key && mv->arg2 == mv->key) {
-			mpfr_set(*introducedError, introMaxError, STD_RND);
-		} else if (mpfr_cmp(introErr1, introErr2) > 0) {
-			if (mpfr_cmp(introMaxError, introErr1) > 0 || mpfr_cmp(introMaxError, introErr2) > 0) {
-				if (mv->arg1 == mv->key) {
-					mpfr_set(*introducedError, introMaxError, STD_RND);
-				} else {
-					mpfr_sub(*introducedError, introMaxError, introErr1, STD_RND);
-				}
-			} else {
-				/* introduced error gets negative */
-				mpfr_sub(*introducedError, introMaxError, introErr2, STD_RND);
+	ShadowValue* svalue = lookupShadow(addrFp);
+	if (svalue) {
+		mpfr_init(rel);
+		
+		Bool isFloat = svalue->orgType == Ot_FLOAT;
+		if (svalue->orgType == Ot_FLOAT) {
+			mpfr_init(org);
+			mpfr_set_flt(org, svalue->Org.fl, STD_RND);
+		} else if (svalue->orgType == Ot_DOUBLE) {
+			mpfr_init_set_d(org, svalue->Org.db, STD_RND);
+		} else {
+			tl_assert(False);
+		}
+
+		if (mpfr_cmp_ui(svalue->value, 0) != 0 || mpfr_cmp_ui(org, 0) != 0) {
+			mpfr_reldiff(rel, svalue->value, org, STD_RND);
+			mpfr_abs(rel, rel, STD_RND);
+		} else {
+			mpfr_set_ui(rel, 0, STD_RND);
+		}
+		
+		Bool isGreater = mpfr_cmp_d(rel, *errorBound) >= 0; 
+
+		mpfr_clears(org, rel, NULL);
+		return isGreater;
+	} else {
+		VG_(umsg)("Error greater: there exists no shadow value!\n");
+		VG_(get_and_pp_StackTrace)(VG_(get_running_tid)(), 16);
+		return False;
+	}
+}
+
+static void resetShadowValues(void) {
+	Int i, j;
+	for (i = 0; i < VG_N_THREADS; i++) {
+		for (j = 0; j < MAX_REGISTERS; j++) {
+			if (threadRegisters[i][j] != NULL) {
+				threadRegisters[i][j]->active = False;
 			}
-		} else if (mpfr_cmp(introMaxError, introErr2) > 0 || mpfr_cmp(introMaxError, introErr1) > 0) {
-			if (mv->arg2 == mv->key) {
-				mpfr_set(*introducedError, introMaxError, STD_RND);
-			} else {
-				mpfr_sub(*introducedError, introMaxError, introErr2, STD_RND);
+		}
+	}
+	for (i = 0; i < MAX_TEMPS; i++) {
+		if (localTemps[i] != NULL) {
+			localTemps[i]->version = 0;
+		}
+		for (j = 1; j < MAX_LANES; j++) {
+			if (laneTemps[j][i] != NULL) {
+				laneTemps[j][i]->version = 0;
 			}
+		}
+	}
+	ShadowValue* next;
+	VG_(HT_ResetIter)(globalMemory);
+	while (next = VG_(HT_Next)(globalMemory)) {
+		next->active = False;
+	}
+}
+
+static void insertShadow(ULong addrFp) {
+	ShadowValue* svalue = lookupShadow(addrFp);
+	if (svalue) {
+		if (svalue->orgType == Ot_FLOAT) {
+			mpfr_set_prec(svalue->midValue, 24);
+			mpfr_set(svalue->midValue, svalue->value, STD_RND);
+
+			// Float* orgFl = (Float*)addrFp;
+			// *orgFl = mpfr_get_flt(svalue->value, STD_RND);
+   //                      unsigned int ul = *(unsigned int*)addrFp;
+   //                      VG_(umsg)("----address-----%X\n", ul);
+   //                      double temp = mpfr_get_d(svalue->value, STD_RND);
+   //                      unsigned int ul2 = *(unsigned int*)(&temp);
+   //                      VG_(umsg)("---mpfr----%X\n", ul2);
+			// unsigned int ul3 = *(unsigned int*)(orgFl);
+			// VG_(umsg)("----orgfl---%X\n", ul3);
+		} else if (svalue->orgType == Ot_DOUBLE) {
+			mpfr_set_prec(svalue->midValue, 53);
+			mpfr_set(svalue->midValue, svalue->value, STD_RND);
+			// mpfr_set(svalue->midValue, svalue->value, STD_RND);
+			// Double* orgDb = (Double*)addrFp;
+			// *orgDb = mpfr_get_d(svalue->value, STD_RND);
+			// unsigned long long ull = *(unsigned long long*)addrFp;
+			// VG_(umsg)("----***-----%lX\n", ull);
+			// double temp = mpfr_get_d(svalue->value, STD_RND);
+			// unsigned long long ull2 = *(unsigned long long*)(&temp);
+			// VG_(umsg)("---second----%lX\n", ull2);
+			//mpfr_out_str(stdout, 10, 50, svalue->value, STD_RND);
 		} else {
-			/* introduced error gets negative */
-			mpfr_sub(*introducedError, introMaxError, introErr1, STD_RND);
+			tl_assert(False);
 		}
-	} else if (mv->arg1 != 0) {
-		MeanValue* mv1 = VG_(HT_lookup)(meanValues, mv->arg1);
-		tl_assert(mv1);
-		mpfr_abs(introErr1, mv1->max, STD_RND);
+	}
+}
 
-		if (mv->arg1 == mv->key) {
-			mpfr_set(*introducedError, introMaxError, STD_RND);
+/*********************/
+static void setShadow(ULong addrFp) {
+	ShadowValue* svalue = lookupShadow(addrFp);
+	if (svalue) {
+		mpfr_set(svalue->value, svalue->midValue, STD_RND);
+		resetDerivedValues(svalue);
+	}
+}
+
+static void shadowToOriginal(ULong addrFp) {
+	ShadowValue* svalue = lookupShadow(addrFp);
+	if (svalue) {
+		if (svalue->orgType == Ot_FLOAT) {
+			Float* orgFl = (Float*)addrFp;
+			*orgFl = mpfr_get_flt(svalue->value, STD_RND);
+		} else if (svalue->orgType == Ot_DOUBLE) {
+			Double* orgDb = (Double*)addrFp;
+			*orgDb = mpfr_get_d(svalue->value, STD_RND);
 		} else {
-			/* introduced error can get negative */
-			mpfr_sub(*introducedError, introMaxError, introErr1, STD_RND);
+			tl_assert(False);
 		}
-	} else if (mv->arg2 != 0) {
-		MeanValue* mv2 = VG_(HT_lookup)(meanValues, mv->arg2);
-		tl_assert(mv2);
-		mpfr_abs(introErr2, mv2->max, STD_RND);
+	}
+}
 
-		if (mv->arg2 == mv->key) {
-			mpfr_set(*introducedError, introMaxError, STD_RND);
+static void originalToShadow(ULong addrFp) {
+	ShadowValue* svalue = lookupShadow(addrFp);
+	if (svalue) {
+		if (svalue->orgType == Ot_FLOAT) {
+			Float* orgFl = (Float*)addrFp;
+			mpfr_set_flt(svalue->value, *orgFl, STD_RND);
+			mpfr_set_prec(svalue->midValue, 24);
+			mpfr_set_flt(svalue->midValue, *orgFl, STD_RND);
+		} else if (svalue->orgType == Ot_DOUBLE) {
+			Double* orgDb = (Double*)addrFp;
+			mpfr_set_d(svalue->value, *orgDb, STD_RND);
+			mpfr_set_prec(svalue->midValue, 53);
+			mpfr_set_d(svalue->midValue, *orgDb, STD_RND);
+		} else {
+			tl_assert(False);
+		}
+		resetDerivedValues(svalue);
+	}
+}
+
+static void setOriginal(ULong addrFp, ULong addrVal) {
+	ShadowValue* svalue = lookupShadow(addrFp);
+	if (svalue) {
+		if (svalue->orgType == Ot_FLOAT) {
+			Float* orgFl = (Float*)addrFp;
+			Float* value = (Float*)addrVal;
+			*orgFl = *value;
+			mpfr_set_prec(svalue->midValue, 24);
+			mpfr_set_flt(svalue->midValue, *orgFl, STD_RND);
+		} else if (svalue->orgType == Ot_DOUBLE) {
+			Double* orgDb = (Double*)addrFp;
+			Double* value = (Double*)addrVal;
+			*orgDb = *value;
+			mpfr_set_prec(svalue->midValue, 53);
+			mpfr_set_d(svalue->midValue, *orgDb, STD_RND);
 		} else {
-			/* introduced error can get negative */
-			mpfr_sub(*introducedError, introMaxError, introErr2, STD_RND);
+			tl_assert(False);
 		}
-	} else {
-		mpfr_set(*introducedError, introMaxError, STD_RND);
 	}
 }
 
-static void writeOriginGraph(Int file, Addr oldAddr, Addr origin, Int arg, Int level, Int edgeColor, Bool careVisited) {
-	if (level > MAX_LEVEL_OF_GRAPH) {
-		if (careVisited) {
-			MeanValue* mv = VG_(HT_lookup)(meanValues, oldAddr);
-			mv->visited = True;
-		}
-		return;
+static void setShadowBy(ULong addrDst, ULong addrSrc) {
+	ShadowValue* dvalue = lookupShadow(addrDst);
+	ShadowValue* svalue = lookupShadow(addrSrc);
+	if (dvalue && svalue) {
+		mpfr_set(dvalue->value, svalue->value, STD_RND);
+		mpfr_set(dvalue->midValue, svalue->midValue, STD_RND);
+		resetDerivedValues(dvalue);
 	}
+}
 
-	if (level <= 1) {
-		my_fwrite(file, "graph: {\n", 9);
-		my_fwrite(file, "title: \"Created with FpDebug\"\n", 30);
-		my_fwrite(file, "classname 1 : \"FpDebug\"\n", 24);
+/* relative error of the shadow value to the original value */
+static void computeShadowRelError(ShadowValue* svalue, mpfr_t rel) {
+	mpfr_t org;
+	mpfr_init(org);
+	if (svalue->orgType == Ot_FLOAT) {
+		mpfr_set_flt(org, svalue->Org.fl, STD_RND);
+	} else if (svalue->orgType == Ot_DOUBLE) {
+		mpfr_set_d(org, svalue->Org.db, STD_RND);
+	} else {
+		tl_assert(False);
+	}
+	if (mpfr_cmp_ui(svalue->value, 0) != 0 || mpfr_cmp_ui(org, 0) != 0) {
+		mpfr_reldiff(rel, svalue->value, org, STD_RND);
+		mpfr_abs(rel, rel, STD_RND);
+	} else {
+		mpfr_set_ui(rel, 0, STD_RND);
+	}
+	mpfr_clear(org);
+}
 
-		Int i;
-		for (i = 50; i < 150; i++) {
-			VG_(sprintf)(formatBuf, "colorentry %d : 255 %d 0\n", i, (Int)((255.0 / 100.0) * (i - 50)));
-			my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
-		}
-		for (i = 150; i < 250; i++) {
-			VG_(sprintf)(formatBuf, "colorentry %d : %d 255 0\n", i, (Int)((255.0 / 100.0) * (i - 150)));
-			my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
-		}
+static void getRelativeError(ULong addr, Char* rel_str) {
+	ShadowValue* svalue = lookupShadow(addr);
+	
+	if (svalue) {
+		mpfr_t rel;
+		mpfr_init(rel);
+		computeShadowRelError(svalue, rel);
+		mpfrToStringE(rel_str, &rel);
+		//VG_(umsg)("RELATIVE ERROR: %s\n", rel_str);
+		mpfr_clear(rel);
+	} else {
+		VG_(strcpy)(rel_str, "0.0e+0");
+		//VG_(get_and_pp_StackTrace)(VG_(get_running_tid)(), 16);
+	}
+}
 
-		/* the set is used to avoid cycles */
-		if (originAddrSet) {
-			VG_(OSetWord_Destroy)(originAddrSet);
-		}
-		originAddrSet = VG_(OSetWord_Create)(VG_(malloc), "fd.writeOriginGraph.1", VG_(free));
-	} 
-	tl_assert(originAddrSet);
+static void getShadow(ULong addr, Char* sd) {
+	ShadowValue* svalue = lookupShadow(addr);
+	if (svalue) {
+		Char mpfrBuf[MPFR_BUFSIZE];
+		mpfrToStringE(mpfrBuf, &(svalue->value));
+		VG_(strcpy)(sd, mpfrBuf);
+	} else {
+		VG_(strcpy)(sd, "noshadow");
+	}
+}
 
-	MeanValue* mv = VG_(HT_lookup)(meanValues, origin);
-	tl_assert(mv);
+static UWord getRelativeErrorBinary(ULong addr, Double* rel) {
+	ShadowValue* svalue = lookupShadow(addr);
+	if (!svalue) {
+		*rel = 0.0;
+		return 0;
+	}
+	mpfr_t r;
+	mpfr_init(r);
+	computeShadowRelError(svalue, r);
+	*rel = mpfr_get_d(r, STD_RND);
+	mpfr_clear(r);
+	return 1;
+}
 
-	if (careVisited) {
-		mv->visited = True;
+static UWord getShadowBinary(ULong addr, FdBinaryShadow* out, UWord* limbs, UWord maxLimbs) {
+	ShadowValue* svalue = lookupShadow(addr);
+	VG_(memset)(out, 0, sizeof(FdBinaryShadow));
+	if (!svalue) {
+		return 0;
 	}
-	
-	Bool cycle = False;
-	Bool inLibrary = False;
-	if (VG_(OSetWord_Contains)(originAddrSet, origin)) {
-		cycle = True;
-	} else {
-		/* create node */
-		VG_(describe_IP)(origin, description, DESCRIPTION_SIZE);
-		if (ignoreFile(description)) {
-			inLibrary = True;
-		}
 
-		if (clo_ignoreAccurate && mpfr_cmp_ui(mv->max, 0) == 0) {
-			return;
+	mpfr_t r;
+	mpfr_init(r);
+	out->hi = mpfr_get_d(svalue->value, STD_RND);
+	mpfr_sub_d(r, svalue->value, out->hi, STD_RND);
+	if (mpfr_number_p(r)) {
+		out->lo = mpfr_get_d(r, STD_RND);
+	}
+	computeShadowRelError(svalue, r);
+	out->relError = mpfr_get_d(r, STD_RND);
+	mpfr_clear(r);
+
+	out->canceled = (long)svalue->canceled;
+	out->sign = mpfr_sgn(svalue->value) < 0 ? -1 : 1;
+	out->precision = (unsigned long)mpfr_get_prec(svalue->value);
+	if (mpfr_number_p(svalue->value) && !mpfr_zero_p(svalue->value)) {
+		UWord n = mpfr_custom_get_size(mpfr_get_prec(svalue->value)) / sizeof(mp_limb_t);
+		out->exponent = (long)mpfr_get_exp(svalue->value);
+		out->limbCount = n;
+		if (limbs != NULL) {
+			mp_limb_t* d = (mp_limb_t*)mpfr_custom_get_significand(svalue->value);
+			UWord i;
+			for (i = 0; i < n && i < maxLimbs; i++) {
+				limbs[i] = (UWord)d[i];
+			}
 		}
+	}
+	return 1;
+}
 
-		Int color = 150; /* green */
+static void printOriginalAndShadow(Char* varName, Int type, ULong addr) {
+	mpfr_t org;
+	mpfr_init(org);
+	Char mpfrBuf[MPFR_BUFSIZE];
+	if (type == 0) {
+		Float* fl = (Float*)addr;
+		mpfr_set_flt(org, *fl, STD_RND);
+		mpfrToStringE(mpfrBuf, &org);
+		VG_(umsg)("(float) %s ORIGINAL VALUE:		%s\n", varName, mpfrBuf);
+		getShadow(addr, mpfrBuf);
+		VG_(umsg)("(float) %s SHADOW VALUE:		%s\n", varName, mpfrBuf);
+	} else if (type == 1) {
+		Double* db = (Double*)addr;
+		mpfr_set_d(org, *db, STD_RND);
+		mpfrToStringE(mpfrBuf, &org);
+		VG_(umsg)("(double) %s ORIGINAL VALUE:		%s\n", varName, mpfrBuf);
+		getShadow(addr, mpfrBuf);
+		VG_(umsg)("(double) %s SHADOW VALUE:		%s\n", varName, mpfrBuf);
+	} else {
+		VG_(tool_panic)("Unhandled value type\n");
+	}
+	mpfr_clear(org);
+}
 
-		if (level > 1) {
-			MeanValue* oldMv = VG_(HT_lookup)(meanValues, oldAddr);
-			tl_assert(oldMv);
+/*********************/
 
-			getIntroducedError(&dumpGraphDiff, mv);
 
-			if (mpfr_cmp_ui(dumpGraphDiff, 0) > 0) {
-				mpfr_exp_t exp = mpfr_get_exp(dumpGraphDiff);
-				if (exp > 1) exp = 1;
-				if (exp < -8) exp = -8;
-				exp = 9 + (exp - 1); /* range 0..9 */
-				color = 149 - (exp * 10);
+
+/* Without instrumentation nothing tracked the writes of the client. 
+   Shadow values of registers and temporaries are dropped, shadow values 
+   in memory are kept if the original value is still stored there. */
+static void invalidateStaleShadowValues(void) {
+	Int i, j;
+	for (i = 0; i < VG_N_THREADS; i++) {
+		for (j = 0; j < MAX_REGISTERS; j++) {
+			if (threadRegisters[i][j] != NULL) {
+				threadRegisters[i][j]->active = False;
 			}
-		} else {
-			color = 1; /* blue */
 		}
-		
-		mpfr_div_ui(dumpGraphMeanError, mv->sum, mv->count, STD_RND);
-
-		opToStr(mv->op);
-		Char meanErrorStr[MPFR_BUFSIZE];
-		mpfrToStringShort(meanErrorStr, &dumpGraphMeanError);
-		Char maxErrorStr[MPFR_BUFSIZE];
-		mpfrToStringShort(maxErrorStr, &(mv->max));
-
-		Char canceledAvg[10];
-		if (mv->overflow) {
-			VG_(sprintf)(canceledAvg, "overflow");
-		} else {
-			VG_(sprintf)(canceledAvg, "%ld", mv->canceledSum / mv->count);
+	}
+	for (i = 0; i < MAX_TEMPS; i++) {
+		if (localTemps[i] != NULL) {
+			localTemps[i]->version = 0;
+		}
+		for (j = 1; j < MAX_LANES; j++) {
+			if (laneTemps[j][i] != NULL) {
+				laneTemps[j][i]->version = 0;
+			}
 		}
+	}
 
-		Char filename[20];
-		filename[0] = '\0';
-		VG_(get_filename)(origin, filename, 19);
+	ShadowValue* next;
+	VG_(HT_ResetIter)(globalMemory);
+	while (next = VG_(HT_Next)(globalMemory)) {
+		if (!next->active) continue;
 
-		UInt linenum = -1;
-		Bool gotLine = VG_(get_linenum)(origin, &linenum);
-		Char linenumber[10];
-		linenumber[0] = '\0';
-		if (gotLine) {
-			VG_(sprintf)(linenumber, ":%u", linenum);
+		SizeT size = next->orgType == Ot_FLOAT ? sizeof(Float) : sizeof(Double);
+		if (next->orgType == Ot_INVALID ||
+			!VG_(am_is_valid_for_client)(next->key, size, VKI_PROT_READ) ||
+			VG_(memcmp)((void*)next->key, &(next->Org), size) != 0) {
+			next->active = False;
 		}
-
-		VG_(sprintf)(formatBuf, "node: { title: \"0x%lX\" label: \"%s (%s%s)\" color: %d info1: \"%s (%'u)\" info2: \"avg: %s, max: %s\" "
-			"info3: \"canceled - avg: %s, max: %ld\" }\n", 
-			origin, opStr, filename, linenumber, color, description, mv->count, meanErrorStr, maxErrorStr, canceledAvg, mv->canceledMax);
-		my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
 	}
+}
 
-	if (level > 1) {
-		/* create edge */
-		MeanValue* oldMv = VG_(HT_lookup)(meanValues, oldAddr);
-		tl_assert(oldMv);
-
-		getIntroducedError(&dumpGraphDiff, mv);
+/* With --reinstrument-on-toggle all translations are discarded when the 
+   analysis is switched on or off, so code which is not analyzed runs 
+   without any helper calls. */
+static void setAnalyzing(Bool analyze) {
+	if (clo_analyze == analyze) return;
 
-		Char diffStr[30];
-		mpfrToStringShort(&diffStr, &dumpGraphDiff);
+	clo_analyze = analyze;
+	if (clo_reinstrument) {
+		if (analyze) {
+			invalidateStaleShadowValues();
+		}
+		VG_(discard_translations)((Addr64)0x1000, (ULong)~0xfffl, "fpdebug");
+	}
+}
 
-		VG_(sprintf)(formatBuf, "edge: { sourcename: \"0x%lX\" targetname: \"0x%lX\" label: \"%s\" class: 1 color : %d }\n", origin, oldAddr, diffStr, edgeColor);
-		my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+static mpfr_prec_t setPrecision(mpfr_prec_t prec) {
+	mpfr_prec_t old = currentPrecision;
+	if (prec < MPFR_PREC_MIN || prec > MPFR_PREC_MAX) {
+		VG_(umsg)("Invalid precision %ld, keeping %ld\n", prec, currentPrecision);
+		return old;
 	}
-	
-	if (cycle) {
-		return;
+	if (prec == currentPrecision) {
+		return old;
 	}
 
-	if (mv != NULL) {
-		VG_(OSetWord_Insert)(originAddrSet, origin);
-		if (mv->arg1 != 0 && mv->arg2 != 0) {
-			MeanValue* mv1 = VG_(HT_lookup)(meanValues, mv->arg1);
-			MeanValue* mv2 = VG_(HT_lookup)(meanValues, mv->arg2);
-			tl_assert(mv1 && mv2);
-
-			Bool leftErrGreater = True;
-			mpfr_abs(dumpGraphErr1, mv1->max, STD_RND);
-			mpfr_abs(dumpGraphErr2, mv2->max, STD_RND);
-
-			if (mpfr_cmp(dumpGraphErr1, dumpGraphErr2) < 0) {
-				leftErrGreater = False;
-			}
-			mpfr_sub(dumpGraphDiff, dumpGraphErr1, dumpGraphErr2, STD_RND);
-			mpfr_abs(dumpGraphDiff, dumpGraphDiff, STD_RND);
-			mpfr_exp_t exp = mpfr_get_exp(dumpGraphDiff);
-			if (exp > 1) exp = 1;
-			if (exp < -8) exp = -8;
-			exp = 9 + (exp - 1);
-			Int red = 149 - (exp * 10);
-			if (red > 120) red = 120;
-			Int green = red + 100;
+	currentPrecision = prec;
+	mpfr_set_default_prec(prec);
+	if (!clo_simulateOriginal) {
+		mpfr_set_prec(arg1tmpX, prec);
+		mpfr_set_prec(arg2tmpX, prec);
+		mpfr_set_prec(arg3tmpX, prec);
+		mpfr_set_prec(arg4tmpX, prec);
+	}
+	return old;
+}
 
-			VG_(describe_IP)(mv->arg1, description, DESCRIPTION_SIZE);
-			if (!inLibrary || !ignoreFile(description)) {
-				writeOriginGraph(file, origin, mv->arg1, 1, ++level, (leftErrGreater ? red : green), careVisited);
-			}
-			VG_(describe_IP)(mv->arg2, description, DESCRIPTION_SIZE);
-			if (!inLibrary || !ignoreFile(description)) {
-				writeOriginGraph(file, origin, mv->arg2, 2, level, (leftErrGreater ? green : red), careVisited);
-			}
-		} else if (mv->arg1 != 0) {
-			VG_(describe_IP)(mv->arg1, description, DESCRIPTION_SIZE);
-			if (!inLibrary || !ignoreFile(description)) {
-				writeOriginGraph(file, origin, mv->arg1, 1, ++level, 1, careVisited);
-			}
-		} else if (mv->arg2 != 0) {
-			VG_(describe_IP)(mv->arg2, description, DESCRIPTION_SIZE);
-			if (!inLibrary || !ignoreFile(description)) {
-				writeOriginGraph(file, origin, mv->arg2, 2, ++level, 1, careVisited);
-			}
-		}
+static void pushPrecision(mpfr_prec_t prec) {
+	if (precisionStackSize == MAX_PRECISION_STACK) {
+		VG_(umsg)("Precision stack is full, ignoring push of %ld\n", prec);
+		return;
 	}
+	precisionStack[precisionStackSize++] = setPrecision(prec);
 }
 
-static Bool dumpGraph(Char* fileName, ULong addr, Bool conditional, Bool careVisited) {
-	/*if (!clo_computeMeanValue) {
-		VG_(umsg)("DUMP GRAPH (%s): Mean error computation has to be active!\n", fileName);
-		return False;
+static void popPrecision(void) {
+	if (precisionStackSize == 0) {
+		VG_(umsg)("Precision stack is empty, ignoring pop\n");
+		return;
 	}
+	setPrecision(precisionStack[--precisionStackSize]);
+}
 
-	ShadowValue* svalue = VG_(HT_lookup)(globalMemory, addr);
-	if (svalue) {
-		if (careVisited) {
-			MeanValue* mv = VG_(HT_lookup)(meanValues, svalue->origin);
-			tl_assert(mv);
-			if (mv->visited) {
-				return False;
-			}
-		}
+static void beginAnalyzing(void) {
+	setAnalyzing(True);
+}
+
+static void endAnalyzing(void) {
+    if (!clo_ignore_end) {
+		setAnalyzing(False);
+    }
+}
 
-		VG_(describe_IP)(svalue->origin, description, DESCRIPTION_SIZE);
-		if (ignoreFile(description)) {
-			return False;
-		}
+static void writeWarning(Int file) {
+	if (clo_sample_rate > 1) {
+		VG_(sprintf)(formatBuf, "Sampled: 1 of %u windows of %u superblock executions\n\n", clo_sample_rate, clo_sample_window);
+		my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+	}
+	if (VG_(OSetWord_Size)(unsupportedOps) == 0) {
+		return;
+	}
+	VG_(sprintf)(formatBuf, "Unsupported operations detected: ");
+	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
 
-		if (svalue->orgType == Ot_FLOAT) {
-			mpfr_set_flt(dumpGraphOrg, svalue->Org.fl, STD_RND);
-		} else if (svalue->orgType == Ot_DOUBLE) {
-			mpfr_set_d(dumpGraphOrg, svalue->Org.db, STD_RND);
+	VG_(OSetWord_ResetIter)(unsupportedOps);
+	UWord next = 0;
+	Bool first = True;
+	while (VG_(OSetWord_Next)(unsupportedOps, &next)) {
+		IROp op = (IROp)next;
+		opToStr(op);
+		if (first) {
+			VG_(sprintf)(formatBuf, "%s", opStr);
 		} else {
-			tl_assert(False);
+			VG_(sprintf)(formatBuf, ", %s", opStr);
 		}
+		my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+		first = False;
+	}
+	VG_(sprintf)(formatBuf, "\n\n");
+	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+}
 
-		if (mpfr_cmp_ui(svalue->value, 0) != 0 || mpfr_cmp_ui(dumpGraphOrg, 0) != 0) {
-			mpfr_reldiff(dumpGraphRel, svalue->value, dumpGraphOrg, STD_RND);
-			mpfr_abs(dumpGraphRel, dumpGraphRel, STD_RND);
-		} else {
-			mpfr_set_ui(dumpGraphRel, 0, STD_RND);
-		}
+static void writeShadowValue(Int file, ShadowValue* svalue, Int num) {
+	tl_assert(svalue);
+	promoteShadowValue(svalue);
 
-		if (conditional && mpfr_cmp_ui(dumpGraphRel, 0) == 0) {
-			return False;
-		}
+	Bool isFloat = svalue->orgType == Ot_FLOAT;
+	if (svalue->orgType == Ot_FLOAT) {
+		mpfr_set_flt(writeSvOrg, svalue->Org.fl, STD_RND);
+	} else if (svalue->orgType == Ot_DOUBLE) {
+		mpfr_set_d(writeSvOrg, svalue->Org.db, STD_RND);
+	} else {
+		tl_assert(False);
+	}
 
-		SysRes file = VG_(open)(fileName, VKI_O_CREAT|VKI_O_TRUNC|VKI_O_WRONLY, VKI_S_IRUSR|VKI_S_IWUSR);
-		if (!sr_isError(file)) {
-			writeOriginGraph(sr_Res(file), 0, svalue->origin, 0, 1, 1, careVisited);
-			my_fwrite(sr_Res(file), "}\n", 2);
-			fwrite_flush();
-			VG_(close)(sr_Res(file));
-			VG_(umsg)("DUMP GRAPH (%s): successful\n", fileName);
-			return True;
-		} else {
-			VG_(umsg)("DUMP GRAPH (%s): Failed to create or open the file!\n", fileName);
-			return False;
-		}
+	if (mpfr_cmp_ui(svalue->value, 0) != 0 || mpfr_cmp_ui(writeSvOrg, 0) != 0) {
+		mpfr_reldiff(writeSvRelError, svalue->value, writeSvOrg, STD_RND);
+		mpfr_abs(writeSvRelError, writeSvRelError, STD_RND);
 	} else {
-		VG_(umsg)("DUMP GRAPH (%s): Shadow variable was not found!\n", fileName);
-		VG_(get_and_pp_StackTrace)(VG_(get_running_tid)(), 16);
-		return False;
-	}*/
-	return False;
-}
+		mpfr_set_ui(writeSvRelError, 0, STD_RND);
+	}
 
-static void printError(Char* varName, ULong addr, Bool conditional) {
-	mpfr_t org, diff, rel;
-	ShadowValue* svalue = VG_(HT_lookup)(globalMemory, addr);;
-	if (svalue) {
-		mpfr_inits(diff, rel, NULL);
-		
-		Bool isFloat = svalue->orgType == Ot_FLOAT;
-		if (svalue->orgType == Ot_FLOAT) {
-			mpfr_init(org);
-			mpfr_set_flt(org, svalue->Org.fl, STD_RND);
-		} else if (svalue->orgType == Ot_DOUBLE) {
-			mpfr_init_set_d(org, svalue->Org.db, STD_RND);
-		} else {
-			tl_assert(False);
-		}
+	mpfr_sub(writeSvDiff, svalue->value, writeSvOrg, STD_RND);
 
-		if (mpfr_cmp_ui(svalue->value, 0) != 0 || mpfr_cmp_ui(org, 0) != 0) {
-			mpfr_reldiff(rel, svalue->value, org, STD_RND);
-			mpfr_abs(rel, rel, STD_RND);
-		} else {
-			mpfr_set_ui(rel, 0, STD_RND);
-		}
+	Char mpfrBuf[MPFR_BUFSIZE];
+	Char typeName[7];
+	if (isFloat) {
+		VG_(strcpy)(typeName, "float");
+	} else {
+		VG_(strcpy)(typeName, "double");
+	}
 
-		if (conditional && mpfr_cmp_ui(rel, 0) == 0) {
-			mpfr_clears(org, diff, rel, NULL);
-			return;
-		}
+	VG_(sprintf)(formatBuf, "%d: 0x%lX of type %s\n", num, svalue->key, typeName);
+	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+	mpfrToString(mpfrBuf, &writeSvOrg);
+	VG_(sprintf)(formatBuf, "    original:         %s\n", mpfrBuf);
+	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+	mpfrToString(mpfrBuf, &(svalue->value));
+	VG_(sprintf)(formatBuf, "    shadow value:     %s\n", mpfrBuf);
+	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+	mpfrToString(mpfrBuf, &writeSvDiff);
+	VG_(sprintf)(formatBuf, "    absolute error:   %s\n", mpfrBuf);
+	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+	mpfrToString(mpfrBuf, &writeSvRelError);
+	VG_(sprintf)(formatBuf, "    relative error:   %s\n", mpfrBuf);
+	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+	VG_(sprintf)(formatBuf, "    maximum number of canceled bits: %ld\n", svalue->canceled);
+	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
 
-		mpfr_sub(diff, svalue->value, org, STD_RND);
+	if (svalue->canceled > 0 && svalue->cancelOrigin > 0) {
+		VG_(describe_IP)(svalue->cancelOrigin, description, DESCRIPTION_SIZE);
+		VG_(sprintf)(formatBuf, "    origin of maximum cancellation: %s\n", description);
+		my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+	}
 
-		Char typeName[7];
-		if (isFloat) {
-			VG_(strcpy)(typeName, "float");
-		} else {
-			VG_(strcpy)(typeName, "double");
-		}
+	VG_(describe_IP)(svalue->origin, description, DESCRIPTION_SIZE);
+	VG_(sprintf)(formatBuf, "    last operation: %s\n", description);
+	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+	VG_(sprintf)(formatBuf, "    operation count (max path): %'lu\n", svalue->opCount);
+	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+}
 
-		VG_(umsg)("(%s) %s PRINT ERROR OF: 0x%lX\n", typeName, varName, addr);
-		Char mpfrBuf[MPFR_BUFSIZE];
-		mpfrToString(mpfrBuf, &org);
-		VG_(umsg)("(%s) %s ORIGINAL:         %s\n", typeName, varName, mpfrBuf);
-		mpfrToString(mpfrBuf, &(svalue->value));
-		VG_(umsg)("(%s) %s SHADOW VALUE:     %s\n", typeName, varName, mpfrBuf);
-		mpfrToString(mpfrBuf, &(svalue->midValue));
-		VG_(umsg)("(%s) %s MIDDLE:           %s\n", typeName, varName, mpfrBuf);
-		mpfrToString(mpfrBuf, &(svalue->oriValue));
-		VG_(umsg)("(%s) %s SIMULATE:         %s\n", typeName, varName, mpfrBuf);
-		mpfrToString(mpfrBuf, &diff);
-		VG_(umsg)("(%s) %s ABSOLUTE ERROR:   %s\n", typeName, varName, mpfrBuf);
-		mpfrToString(mpfrBuf, &rel);
-		VG_(umsg)("(%s) %s RELATIVE ERROR:   %s\n", typeName, varName, mpfrBuf);
-		VG_(umsg)("(%s) %s CANCELED BITS:     %lld\n", typeName, varName, svalue->canceled);
+static Bool areSvsEqual(ShadowValue* sv1, ShadowValue* sv2) {
+	if (sv1->opCount == sv2->opCount && sv1->origin == sv2->origin && 
+		sv1->canceled == sv2->canceled && sv1->cancelOrigin == sv2->cancelOrigin && 
+		sv1->orgType == sv2->orgType && mpfr_cmp(sv1->value, sv2->value) == 0)
+	{
+		return (sv1->orgType == Ot_FLOAT && sv1->Org.fl == sv2->Org.fl) || 
+			   (sv1->orgType == Ot_DOUBLE && sv1->Org.db == sv2->Org.db); 
+	}
+	return False;
+}
 
-		VG_(describe_IP)(svalue->origin, description, DESCRIPTION_SIZE);
-		VG_(umsg)("(%s) %s Last operation: %s\n", typeName, varName, description);
+static Int compareShadowValues(void* n1, void* n2) {
+	ShadowValue* sv1 = *(ShadowValue**)n1;
+	ShadowValue* sv2 = *(ShadowValue**)n2;
+	if (sv1->opCount < sv2->opCount) return 1;
+	if (sv1->opCount > sv2->opCount) return -1;
+	if (sv1->key < sv2->key) return -1;
+	if (sv1->key > sv2->key) return 1;
+	return 0;
+}
 
-		if (svalue->canceled > 0 && svalue->cancelOrigin > 0) {
-			VG_(describe_IP)(svalue->cancelOrigin, description, DESCRIPTION_SIZE);
-			VG_(umsg)("(%s) %s Cancellation origin: %s\n", typeName, varName, description);
-		}
-		
-		VG_(umsg)("(%s) %s Operation count (max path): %'lu\n", typeName, varName, svalue->opCount);
+static void writeMemorySpecial(ShadowValue** memory, UInt n_memory) {
+	Char fname[256];
+	HChar* clientName = VG_(args_the_exename);
+	VG_(sprintf)(fname, "%s_shadow_values_special", clientName);
 
-		mpfr_clears(org, diff, rel, NULL);
-	} else {
-		VG_(umsg)("There exists no shadow value for %s!\n", varName);
-		VG_(get_and_pp_StackTrace)(VG_(get_running_tid)(), 16);
+	getFileName(fname);
+	SysRes fileRes = VG_(open)(fname, VKI_O_CREAT|VKI_O_TRUNC|VKI_O_WRONLY, VKI_S_IRUSR|VKI_S_IWUSR);
+	if (sr_isError(fileRes)) {
+		VG_(umsg)("SHADOW VALUES (%s): Failed to create or open the file!\n", fname);
+		return;
 	}
-}
+	Int file = sr_Res(fileRes);
+	writeWarning(file);
 
-static Bool isErrorGreater(ULong addrFp, ULong addrErr) {
-	mpfr_t org, rel;
-	Double* errorBound = (Double*)addrErr;
+	UInt specialFps = 0;
+	UInt skippedLibrary = 0;
+	UInt numWritten = 0;
+	UInt total = 0;
+	Int i;
+	for (i = 0; i < n_memory; i++) {
+		if (i > 0 && areSvsEqual(memory[i-1], memory[i])) {
+			continue;
+		}
+		total++;
 
-	ShadowValue* svalue = VG_(HT_lookup)(globalMemory, addrFp);
-	if (svalue) {
-		mpfr_init(rel);
-		
-		Bool isFloat = svalue->orgType == Ot_FLOAT;
-		if (svalue->orgType == Ot_FLOAT) {
-			mpfr_init(org);
-			mpfr_set_flt(org, svalue->Org.fl, STD_RND);
-		} else if (svalue->orgType == Ot_DOUBLE) {
-			mpfr_init_set_d(org, svalue->Org.db, STD_RND);
+		if (memory[i]->orgType == Ot_FLOAT) {
+			mpfr_set_flt(endAnalysisOrg, memory[i]->Org.fl, STD_RND);
+		} else if (memory[i]->orgType == Ot_DOUBLE) {
+			mpfr_set_d(endAnalysisOrg, memory[i]->Org.db, STD_RND);
 		} else {
 			tl_assert(False);
 		}
 
-		if (mpfr_cmp_ui(svalue->value, 0) != 0 || mpfr_cmp_ui(org, 0) != 0) {
-			mpfr_reldiff(rel, svalue->value, org, STD_RND);
-			mpfr_abs(rel, rel, STD_RND);
-		} else {
-			mpfr_set_ui(rel, 0, STD_RND);
-		}
-		
-		Bool isGreater = mpfr_cmp_d(rel, *errorBound) >= 0; 
+		/* not a normal number => NaN, +Inf, or -Inf */
+		if (mpfr_number_p(endAnalysisOrg) == 0) {
+			specialFps++;
+
+			if (clo_ignoreLibraries) {
+				VG_(describe_IP)(memory[i]->origin, description, DESCRIPTION_SIZE);
+				if (ignoreFile(description)) {
+					skippedLibrary++;
+					continue;
+				}
+			}
+
+			if (numWritten < MAX_ENTRIES_PER_FILE) {
+				numWritten++;
+				writeShadowValue(file, memory[i], total);
+				VG_(sprintf)(formatBuf, "\n");
+				my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+			}
+		} else if (!clo_ignoreAccurate && numWritten < MAX_ENTRIES_PER_FILE) {
+			numWritten++;
+			writeShadowValue(file, memory[i], i);
+			VG_(sprintf)(formatBuf, "\n");
+			my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+		}
+	}
 
-		mpfr_clears(org, rel, NULL);
-		return isGreater;
-	} else {
-		VG_(umsg)("Error greater: there exists no shadow value!\n");
-		VG_(get_and_pp_StackTrace)(VG_(get_running_tid)(), 16);
-		return False;
+	VG_(sprintf)(formatBuf, "%'u%s out of %'u shadow values are in this file\n", numWritten, 
+		numWritten == MAX_ENTRIES_PER_FILE ? " (maximum number written to file)" : "", total);
+	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+	if (skippedLibrary > 0) {
+		VG_(sprintf)(formatBuf, "%'u are skipped because they are from a library\n", skippedLibrary);
+		my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
 	}
+	VG_(sprintf)(formatBuf, "%'u out of %'u shadow values are special (NaN, +Inf, or -Inf)\n", specialFps, n_memory);
+	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+	VG_(sprintf)(formatBuf, "total number of floating-point operations: %'lu\n", fpOps);
+	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+	VG_(sprintf)(formatBuf, "number of executed blocks: %'lu\n", sbExecuted);
+	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+
+	fwrite_flush();
+	VG_(close)(file);
+	VG_(umsg)("SHADOW VALUES (%s): successful\n", fname);
 }
 
-static void resetShadowValues(void) {
-	Int i, j;
-	for (i = 0; i < VG_N_THREADS; i++) {
-		for (j = 0; j < MAX_REGISTERS; j++) {
-			if (threadRegisters[i][j] != NULL) {
-				threadRegisters[i][j]->active = False;
-			}
-		}
+static void writeMemoryCanceled(ShadowValue** memory, UInt n_memory) {
+	Char fname[256];
+	HChar* clientName = VG_(args_the_exename);
+	VG_(sprintf)(fname, "%s_shadow_values_canceled", clientName);
+
+	getFileName(fname);
+	SysRes fileRes = VG_(open)(fname, VKI_O_CREAT|VKI_O_TRUNC|VKI_O_WRONLY, VKI_S_IRUSR|VKI_S_IWUSR);
+	if (sr_isError(fileRes)) {
+		VG_(umsg)("SHADOW VALUES (%s): Failed to create or open the file!\n", fname);
+		return;
 	}
-	for (i = 0; i < MAX_TEMPS; i++) {
-		if (localTemps[i] != NULL) {
-			localTemps[i]->version = 0;
+	Int file = sr_Res(fileRes);
+	writeWarning(file);
+
+	UInt fpsWithError = 0;
+	UInt skippedLibrary = 0;
+	UInt numWritten = 0;
+	UInt total = 0;
+	Int i;
+	for (i = 0; i < n_memory; i++) {
+		if (i > 0 && areSvsEqual(memory[i-1], memory[i])) {
+			continue;
 		}
-	}
-	ShadowValue* next;
-	VG_(HT_ResetIter)(globalMemory);
-	while (next = VG_(HT_Next)(globalMemory)) {
-		next->active = False;
-	}
-}
+		total++;
 
-static void insertShadow(ULong addrFp) {
-	ShadowValue* svalue = VG_(HT_lookup)(globalMemory, addrFp);
-	if (svalue) {
-		if (svalue->orgType == Ot_FLOAT) {
-			mpfr_set_prec(svalue->midValue, 24);
-			mpfr_set(svalue->midValue, svalue->value, STD_RND);
+		if (memory[i]->canceled > CANCEL_LIMIT) {
+			fpsWithError++;
 
-			// Float* orgFl = (Float*)addrFp;
-			// *orgFl = mpfr_get_flt(svalue->value, STD_RND);
-   //                      unsigned int ul = *(unsigned int*)addrFp;
-   //                      VG_(umsg)("----address-----%X\n", ul);
-   //                      double temp = mpfr_get_d(svalue->value, STD_RND);
-   //                      unsigned int ul2 = *(unsigned int*)(&temp);
-   //                      VG_(umsg)("---mpfr----%X\n", ul2);
-			// unsigned int ul3 = *(unsigned int*)(orgFl);
-			// VG_(umsg)("----orgfl---%X\n", ul3);
-		} else if (svalue->orgType == Ot_DOUBLE) {
-			mpfr_set_prec(svalue->midValue, 53);
-			mpfr_set(svalue->midValue, svalue->value, STD_RND);
-			// mpfr_set(svalue->midValue, svalue->value, STD_RND);
-			// Double* orgDb = (Double*)addrFp;
-			// *orgDb = mpfr_get_d(svalue->value, STD_RND);
-			// unsigned long long ull = *(unsigned long long*)addrFp;
-			// VG_(umsg)("----***-----%lX\n", ull);
-			// double temp = mpfr_get_d(svalue->value, STD_RND);
-			// unsigned long long ull2 = *(unsigned long long*)(&temp);
-			// VG_(umsg)("---second----%lX\n", ull2);
-			//mpfr_out_str(stdout, 10, 50, svalue->value, STD_RND);
-		} else {
-			tl_assert(False);
+			if (clo_ignoreLibraries) {
+				VG_(describe_IP)(memory[i]->origin, description, DESCRIPTION_SIZE);
+				if (ignoreFile(description)) {
+					skippedLibrary++;
+					continue;
+				}
+			}
+
+			if (numWritten < MAX_ENTRIES_PER_FILE) {
+				numWritten++;
+				writeShadowValue(file, memory[i], i);
+				VG_(sprintf)(formatBuf, "\n");
+				my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+			}
+		} else if (!clo_ignoreAccurate && numWritten < MAX_ENTRIES_PER_FILE) {
+			numWritten++;
+			writeShadowValue(file, memory[i], total);
+			VG_(sprintf)(formatBuf, "\n");
+			my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
 		}
 	}
-}
 
-/*********************/
-static void setShadow(ULong addrFp) {
-	ShadowValue* svalue = VG_(HT_lookup)(globalMemory, addrFp);
-	if (svalue) {
-		mpfr_set(svalue->value, svalue->midValue, STD_RND);
+	VG_(sprintf)(formatBuf, "%'u%s out of %'u shadow values are in this file\n", numWritten, 
+		numWritten == MAX_ENTRIES_PER_FILE ? " (maximum number written to file)" : "", total);
+	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+	if (skippedLibrary > 0) {
+		VG_(sprintf)(formatBuf, "%'u are skipped because they are from a library\n", skippedLibrary);
+		my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
 	}
+	VG_(sprintf)(formatBuf, "%'u out of %'u shadow values have more than %'d canceled bits\n", fpsWithError, total, CANCEL_LIMIT);
+	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+	VG_(sprintf)(formatBuf, "total number of floating-point operations: %'lu\n", fpOps);
+	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+	VG_(sprintf)(formatBuf, "number of executed blocks: %'lu\n", sbExecuted);
+	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+
+	fwrite_flush();
+	VG_(close)(file);
+	VG_(umsg)("SHADOW VALUES (%s): successful\n", fname);
 }
 
-static void shadowToOriginal(ULong addrFp) {
-	ShadowValue* svalue = VG_(HT_lookup)(globalMemory, addrFp);
-	if (svalue) {
-		if (svalue->orgType == Ot_FLOAT) {
-			Float* orgFl = (Float*)addrFp;
-			*orgFl = mpfr_get_flt(svalue->value, STD_RND);
-		} else if (svalue->orgType == Ot_DOUBLE) {
-			Double* orgDb = (Double*)addrFp;
-			*orgDb = mpfr_get_d(svalue->value, STD_RND);
-		} else {
-			tl_assert(False);
-		}
+static void writeMemoryRelError(ShadowValue** memory, UInt n_memory) {
+	Char fname[256];
+	HChar* clientName = VG_(args_the_exename);
+	VG_(sprintf)(fname, "%s_shadow_values_relative_error", clientName);
+
+	getFileName(fname);
+	SysRes fileRes = VG_(open)(fname, VKI_O_CREAT|VKI_O_TRUNC|VKI_O_WRONLY, VKI_S_IRUSR|VKI_S_IWUSR);
+	if (sr_isError(fileRes)) {
+		VG_(umsg)("SHADOW VALUES (%s): Failed to create or open the file!\n", fname);
+		return;
 	}
-}
+	Int file = sr_Res(fileRes);
+	writeWarning(file);
 
-static void originalToShadow(ULong addrFp) {
-	ShadowValue* svalue = VG_(HT_lookup)(globalMemory, addrFp);
-	if (svalue) {
-		if (svalue->orgType == Ot_FLOAT) {
-			Float* orgFl = (Float*)addrFp;
-			mpfr_set_flt(svalue->value, *orgFl, STD_RND);
-			mpfr_set_prec(svalue->midValue, 24);
-			mpfr_set_flt(svalue->midValue, *orgFl, STD_RND);
-		} else if (svalue->orgType == Ot_DOUBLE) {
-			Double* orgDb = (Double*)addrFp;
-			mpfr_set_d(svalue->value, *orgDb, STD_RND);
-			mpfr_set_prec(svalue->midValue, 53);
-			mpfr_set_d(svalue->midValue, *orgDb, STD_RND);
-		} else {
-			tl_assert(False);
+	UInt fpsWithError = 0;
+	UInt skippedLibrary = 0;
+	UInt numWritten = 0;
+	UInt total = 0;
+	Int j = 1;
+	Int i;
+	for (i = 0; i < n_memory; i++) {
+		if (i > 0 && areSvsEqual(memory[i-1], memory[i])) {
+			continue;
 		}
-	}
-}
+		total++;
 
-static void setOriginal(ULong addrFp, ULong addrVal) {
-	ShadowValue* svalue = VG_(HT_lookup)(globalMemory, addrFp);
-	if (svalue) {
-		if (svalue->orgType == Ot_FLOAT) {
-			Float* orgFl = (Float*)addrFp;
-			Float* value = (Float*)addrVal;
-			*orgFl = *value;
-			mpfr_set_prec(svalue->midValue, 24);
-			mpfr_set_flt(svalue->midValue, *orgFl, STD_RND);
-		} else if (svalue->orgType == Ot_DOUBLE) {
-			Double* orgDb = (Double*)addrFp;
-			Double* value = (Double*)addrVal;
-			*orgDb = *value;
-			mpfr_set_prec(svalue->midValue, 53);
-			mpfr_set_d(svalue->midValue, *orgDb, STD_RND);
+		if (memory[i]->orgType == Ot_FLOAT) {
+			mpfr_set_flt(endAnalysisOrg, memory[i]->Org.fl, STD_RND);
+		} else if (memory[i]->orgType == Ot_DOUBLE) {
+			mpfr_set_d(endAnalysisOrg, memory[i]->Org.db, STD_RND);
 		} else {
 			tl_assert(False);
 		}
-	}
-}
 
-static void setShadowBy(ULong addrDst, ULong addrSrc) {
-	ShadowValue* dvalue = VG_(HT_lookup)(globalMemory, addrDst);
-	ShadowValue* svalue = VG_(HT_lookup)(globalMemory, addrSrc);
-	if (dvalue && svalue) {
-		mpfr_set(dvalue->value, svalue->value, STD_RND);
-		mpfr_set(dvalue->midValue, svalue->midValue, STD_RND);
-	}
-}
+		Bool hasError = True;
+		if (mpfr_cmp_ui(memory[i]->value, 0) != 0 || mpfr_cmp_ui(endAnalysisOrg, 0) != 0) {
+			mpfr_reldiff(endAnalysisRelError, memory[i]->value, endAnalysisOrg, STD_RND);
 
-static void getRelativeError(ULong addr, Char* rel_str) {
-	mpfr_t org, diff, rel;
+			if (mpfr_cmp_ui(endAnalysisRelError, 0) != 0) {
+				fpsWithError++;
 
-	ShadowValue* svalue = VG_(HT_lookup)(globalMemory, addr);
-	
-	if (svalue) {
-		mpfr_inits(diff, rel, NULL);
-		
-		Bool isFloat = svalue->orgType == Ot_FLOAT;
-		if (svalue->orgType == Ot_FLOAT) {
-			mpfr_init(org);
-			mpfr_set_flt(org, svalue->Org.fl, STD_RND);
-		} else if (svalue->orgType == Ot_DOUBLE) {
-			mpfr_init_set_d(org, svalue->Org.db, STD_RND);
+				if (clo_ignoreLibraries) {
+					VG_(describe_IP)(memory[i]->origin, description, DESCRIPTION_SIZE);
+					if (ignoreFile(description)) {
+						skippedLibrary++;
+						continue;
+					}
+				}
+
+				if (numWritten < MAX_ENTRIES_PER_FILE) {
+					numWritten++;
+					writeShadowValue(file, memory[i], total);
+
+					if (j <= MAX_DUMPED_GRAPHS) {
+						VG_(sprintf)(filename, "%s_%d_%d.vcg", clientName, j, i);
+						if (dumpGraph(filename, memory[i]->key, True, True)) {
+							VG_(sprintf)(formatBuf, "    graph dumped: %s\n", filename);
+							my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+
+							j++;
+						}
+					}
+
+					VG_(sprintf)(formatBuf, "\n");
+					my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+				}
+			} else {
+				hasError = False;
+			}
 		} else {
-			tl_assert(False);
+			hasError = False;
 		}
-
-		if (mpfr_cmp_ui(svalue->value, 0) != 0 || mpfr_cmp_ui(org, 0) != 0) {
-			mpfr_reldiff(rel, svalue->value, org, STD_RND);
-			mpfr_abs(rel, rel, STD_RND);
-		} else {
-			mpfr_set_ui(rel, 0, STD_RND);
+		if (!clo_ignoreAccurate && !hasError && numWritten < MAX_ENTRIES_PER_FILE) {
+			numWritten++;
+			writeShadowValue(file, memory[i], i);
+			VG_(sprintf)(formatBuf, "\n");
+			my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
 		}
+	}
 
-		mpfrToStringE(rel_str, &rel);
-		//VG_(umsg)("RELATIVE ERROR: %s\n", rel_str);
-
-		mpfr_clears(org, diff, rel, NULL);
-	} else {
-		VG_(strcpy)(rel_str, "0.0e+0");
-		//VG_(get_and_pp_StackTrace)(VG_(get_running_tid)(), 16);
+	VG_(sprintf)(formatBuf, "%'u%s out of %'u shadow values are in this file\n", numWritten, 
+		numWritten == MAX_ENTRIES_PER_FILE ? " (maximum number written to file)" : "", total);
+	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+	if (skippedLibrary > 0) {
+		VG_(sprintf)(formatBuf, "%'u are skipped because they are from a library\n", skippedLibrary);
+		my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
 	}
+	VG_(sprintf)(formatBuf, "%'u out of %'u shadow values have an error\n", fpsWithError, total);
+	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+	VG_(sprintf)(formatBuf, "%'u graph(s) have been dumped\n", j - 1);
+	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+	VG_(sprintf)(formatBuf, "total number of floating-point operations: %'lu\n", fpOps);
+	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+	VG_(sprintf)(formatBuf, "number of executed blocks: %'lu\n", sbExecuted);
+	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+
+	fwrite_flush();
+	VG_(close)(file);
+	VG_(umsg)("SHADOW VALUES (%s): successful\n", fname);
 }
 
-static void getShadow(ULong addr, Char* sd) {
-	ShadowValue* svalue = VG_(HT_lookup)(globalMemory, addr);
-	if (svalue) {
-		Char mpfrBuf[MPFR_BUFSIZE];
-		mpfrToStringE(mpfrBuf, &(svalue->value));
-		VG_(strcpy)(sd, mpfrBuf);
-	} else {
-		VG_(strcpy)(sd, "noshadow");
+static void endAnalysis(void) {
+	UInt n_memory = 0;
+	ShadowValue** memory = VG_(HT_to_array)(globalMemory, &n_memory);
+	UInt i;
+	for (i = 0; i < n_memory; i++) {
+		promoteShadowValue(memory[i]);
 	}
+	VG_(ssort)(memory, n_memory, sizeof(VgHashNode*), compareShadowValues);
+
+	//writeMemoryRelError(memory, n_memory);
+	//writeMemoryCanceled(memory, n_memory);
+	//writeMemorySpecial(memory, n_memory);
+
+	VG_(free)(memory);
 }
 
-static void printOriginalAndShadow(Char* varName, Int type, ULong addr) {
-	mpfr_t org;
-	mpfr_init(org);
-	Char mpfrBuf[MPFR_BUFSIZE];
-	if (type == 0) {
-		Float* fl = (Float*)addr;
-		mpfr_set_flt(org, *fl, STD_RND);
-		mpfrToStringE(mpfrBuf, &org);
-		VG_(umsg)("(float) %s ORIGINAL VALUE:		%s\n", varName, mpfrBuf);
-		getShadow(addr, mpfrBuf);
-		VG_(umsg)("(float) %s SHADOW VALUE:		%s\n", varName, mpfrBuf);
-	} else if (type == 1) {
-		Double* db = (Double*)addr;
-		mpfr_set_d(org, *db, STD_RND);
-		mpfrToStringE(mpfrBuf, &org);
-		VG_(umsg)("(double) %s ORIGINAL VALUE:		%s\n", varName, mpfrBuf);
-		getShadow(addr, mpfrBuf);
-		VG_(umsg)("(double) %s SHADOW VALUE:		%s\n", varName, mpfrBuf);
-	} else {
-		VG_(tool_panic)("Unhandled value type\n");
-	}
-	mpfr_clear(org);
+static Int compareMVAddr(void* n1, void* n2) {
+	MeanValue* mv1 = *(MeanValue**)n1;
+	MeanValue* mv2 = *(MeanValue**)n2;
+	if (mv1->key < mv2->key) return -1;
+	if (mv1->key > mv2->key) return  1;
+	return 0;
 }
 
-/*********************/
+static Int compareMVCanceled(void* n1, void* n2) {
+	MeanValue* mv1 = *(MeanValue**)n1;
+	MeanValue* mv2 = *(MeanValue**)n2;
+	if (mv1->cancellationBadnessMax < mv2->cancellationBadnessMax) return 1;
+	if (mv1->cancellationBadnessMax > mv2->cancellationBadnessMax) return -1;
+	if (mv1->canceledMax < mv2->canceledMax) return 1;
+	if (mv1->canceledMax > mv2->canceledMax) return -1;
+	return 0;
+}
 
+static Int compareMVIntroError(void* n1, void* n2) {
+	MeanValue* mv1 = *(MeanValue**)n1;
+	MeanValue* mv2 = *(MeanValue**)n2;
 
+	getIntroducedError(&compareIntroErr1, mv1);
+	getIntroducedError(&compareIntroErr2, mv2);
+	Int cmp = mpfr_cmp(compareIntroErr1, compareIntroErr2);
 
-static void beginAnalyzing(void) {
-	clo_analyze = True;
+	if (cmp < 0) return 1;
+	if (cmp > 0) return -1;
+	return 0;
 }
 
-static void endAnalyzing(void) {
-    if (!clo_ignore_end) {
-		clo_analyze = False;
-    }
-}
+static void writeMeanValues(Char* fname, Int (*cmpFunc) (void*, void*), Bool forCanceled) {
+	if (!clo_computeMeanValue) {
+		return;
+	}
 
-static void writeWarning(Int file) {
-	if (VG_(OSetWord_Size)(unsupportedOps) == 0) {
+	getFileName(fname);
+	SysRes fileRes = VG_(open)(fname, VKI_O_CREAT|VKI_O_TRUNC|VKI_O_WRONLY, VKI_S_IRUSR|VKI_S_IWUSR);
+	if (sr_isError(fileRes)) {
+		VG_(umsg)("MEAN ERRORS (%s): Failed to create or open the file!\n", fname);
 		return;
 	}
-	VG_(sprintf)(formatBuf, "Unsupported operations detected: ");
-	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+	Int file = sr_Res(fileRes);
+	writeWarning(file);
 
-	VG_(OSetWord_ResetIter)(unsupportedOps);
-	UWord next = 0;
-	Bool first = True;
-	while (VG_(OSetWord_Next)(unsupportedOps, &next)) {
-		IROp op = (IROp)next;
-		opToStr(op);
-		if (first) {
-			VG_(sprintf)(formatBuf, "%s", opStr);
-		} else {
-			VG_(sprintf)(formatBuf, ", %s", opStr);
+	UInt n_values = 0;
+	MeanValue** values = VG_(HT_to_array)(meanValues, &n_values);
+	VG_(ssort)(values, n_values, sizeof(VgHashNode*), cmpFunc);
+
+	mpfr_t meanError, maxError, introducedError, err1, err2, cond;
+	mpfr_inits(meanError, maxError, introducedError, err1, err2, cond, NULL);
+	Int fpsWritten = 0;
+	Int skipped = 0;
+	Int skippedLibrary = 0;
+	Int i;
+	for (i = 0; i < n_values; i++) {
+		/* counted, but not analyzed yet (instrumentSiteCount) */
+		if (values[i]->sampled == 0) {
+			continue;
+		}
+		if (clo_ignoreAccurate && !forCanceled && mpfr_cmp_ui(values[i]->sum, 0) == 0) {
+			skipped++;
+			continue;
 		}
-		my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
-		first = False;
-	}
-	VG_(sprintf)(formatBuf, "\n\n");
-	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
-}
 
-static void writeShadowValue(Int file, ShadowValue* svalue, Int num) {
-	tl_assert(svalue);
+		if (clo_ignoreAccurate && forCanceled && values[i]->canceledMax == 0) {
+			skipped++;
+			continue;
+		} 
 
-	Bool isFloat = svalue->orgType == Ot_FLOAT;
-	if (svalue->orgType == Ot_FLOAT) {
-		mpfr_set_flt(writeSvOrg, svalue->Org.fl, STD_RND);
-	} else if (svalue->orgType == Ot_DOUBLE) {
-		mpfr_set_d(writeSvOrg, svalue->Org.db, STD_RND);
-	} else {
-		tl_assert(False);
-	}
+		VG_(describe_IP)(values[i]->key, description, DESCRIPTION_SIZE);
+		if (ignoreFile(description)) {
+			skippedLibrary++;
+			continue;
+		}
 
-	if (mpfr_cmp_ui(svalue->value, 0) != 0 || mpfr_cmp_ui(writeSvOrg, 0) != 0) {
-		mpfr_reldiff(writeSvRelError, svalue->value, writeSvOrg, STD_RND);
-		mpfr_abs(writeSvRelError, writeSvRelError, STD_RND);
-	} else {
-		mpfr_set_ui(writeSvRelError, 0, STD_RND);
-	}
+		if (i > MAX_ENTRIES_PER_FILE) {
+			continue;
+		}
 
-	mpfr_sub(writeSvDiff, svalue->value, writeSvOrg, STD_RND);
+		fpsWritten++;
+		mpfr_div_ui(meanError, values[i]->sum, values[i]->sampled, STD_RND);
 
-	Char mpfrBuf[MPFR_BUFSIZE];
-	Char typeName[7];
-	if (isFloat) {
-		VG_(strcpy)(typeName, "float");
-	} else {
-		VG_(strcpy)(typeName, "double");
-	}
+		opToStr(values[i]->op);
+		Char meanErrorStr[MPFR_BUFSIZE];
+		mpfrToString(meanErrorStr, &meanError);
+		Char maxErrorStr[MPFR_BUFSIZE];
+		mpfrToString(maxErrorStr, &(values[i]->max));
 
-	VG_(sprintf)(formatBuf, "%d: 0x%lX of type %s\n", num, svalue->key, typeName);
-	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
-	mpfrToString(mpfrBuf, &writeSvOrg);
-	VG_(sprintf)(formatBuf, "    original:         %s\n", mpfrBuf);
-	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
-	mpfrToString(mpfrBuf, &(svalue->value));
-	VG_(sprintf)(formatBuf, "    shadow value:     %s\n", mpfrBuf);
-	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
-	mpfrToString(mpfrBuf, &writeSvDiff);
-	VG_(sprintf)(formatBuf, "    absolute error:   %s\n", mpfrBuf);
-	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
-	mpfrToString(mpfrBuf, &writeSvRelError);
-	VG_(sprintf)(formatBuf, "    relative error:   %s\n", mpfrBuf);
-	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
-	VG_(sprintf)(formatBuf, "    maximum number of canceled bits: %ld\n", svalue->canceled);
-	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+		if (values[i]->sampled != values[i]->count) {
+			VG_(sprintf)(formatBuf, "%s %s (%'u, %'u analyzed)\n", description, opStr, values[i]->count, values[i]->sampled);
+		} else {
+			VG_(sprintf)(formatBuf, "%s %s (%'u)\n", description, opStr, values[i]->count);
+		}
+		my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+		VG_(sprintf)(formatBuf, "    avg error: %s\n", meanErrorStr);
+		my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+		VG_(sprintf)(formatBuf, "    max error: %s\n", maxErrorStr);
+		my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+		if (escalatedSites && VG_(OSetWord_Contains)(escalatedSites, values[i]->key)) {
+			VG_(sprintf)(formatBuf, "    precision escalated\n");
+			my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+		}
+		if (values[i]->saturated) {
+			VG_(sprintf)(formatBuf, "    site budget reached, later executions are only counted\n");
+			my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+		}
 
-	if (svalue->canceled > 0 && svalue->cancelOrigin > 0) {
-		VG_(describe_IP)(svalue->cancelOrigin, description, DESCRIPTION_SIZE);
-		VG_(sprintf)(formatBuf, "    origin of maximum cancellation: %s\n", description);
+		if (values[i]->overflow) {
+			VG_(sprintf)(formatBuf, "    canceled bits - max: %'ld, avg: overflow\n", values[i]->canceledMax);
+		} else {
+			mpfr_exp_t meanCanceledBits = values[i]->canceledSum / values[i]->sampled;
+			VG_(sprintf)(formatBuf, "    canceled bits - max: %'ld, avg: %'ld\n", values[i]->canceledMax, meanCanceledBits);
+		}
+		my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+		if (values[i]->stoCount > 0) {
+			VG_(sprintf)(formatBuf, "    significant digits (stochastic) - min: %d, avg: %lld\n", 
+				values[i]->stoDigitsMin, values[i]->stoDigitsSum / values[i]->stoCount);
+			my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+		}
+		if (values[i]->condCount > 0) {
+			Char condMaxStr[MPFR_BUFSIZE];
+			Char condMeanStr[MPFR_BUFSIZE];
+			mpfr_set_d(cond, values[i]->condMax, STD_RND);
+			mpfrToString(condMaxStr, &cond);
+			mpfr_set_d(cond, values[i]->condSum, STD_RND);
+			mpfr_div_ui(cond, cond, values[i]->condCount, STD_RND);
+			mpfrToString(condMeanStr, &cond);
+			VG_(sprintf)(formatBuf, "    condition number - max: %s, avg: %s\n", condMaxStr, condMeanStr);
+			my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+		}
+		if (values[i]->condInfinite > 0) {
+			VG_(sprintf)(formatBuf, "    infinite condition number (cancellation to zero): %'u\n", values[i]->condInfinite);
+			my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+		}
+
+		if (clo_bad_cancellations) {
+			Char avgCancellationBadness[10];
+			VG_(percentify)(values[i]->cancellationBadnessSum, values[i]->sampled * values[i]->cancellationBadnessMax, 2, 10, avgCancellationBadness);
+			VG_(sprintf)(formatBuf, "    cancellation badness - max: %'ld, avg (sum/(count*max)):%s\n", values[i]->cancellationBadnessMax, avgCancellationBadness);
+			my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+		}
+
+		getIntroducedError(&introducedError, values[i]);
+		if (mpfr_cmp_ui(introducedError, 0) > 0) {
+			Char introErrorStr[MPFR_BUFSIZE];
+			mpfrToString(introErrorStr, &introducedError);
+			VG_(sprintf)(formatBuf, "    introduced error (max path): %s\n", introErrorStr);
+		} else {
+			VG_(sprintf)(formatBuf, "    no error has been introduced (max path)\n");
+		}
+		my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+		VG_(sprintf)(formatBuf, "    origin of the arguments (max path): 0x%lX, 0x%lX\n\n", values[i]->arg1, values[i]->arg2);
 		my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
 	}
 
-	VG_(describe_IP)(svalue->origin, description, DESCRIPTION_SIZE);
-	VG_(sprintf)(formatBuf, "    last operation: %s\n", description);
-	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
-	VG_(sprintf)(formatBuf, "    operation count (max path): %'lu\n", svalue->opCount);
+	VG_(sprintf)(formatBuf, "%'d%s out of %'d operations are listed in this file\n", 
+		fpsWritten, fpsWritten == MAX_ENTRIES_PER_FILE ? " (maximum number written to file)" : "", n_values);
 	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+	if (skipped > 0) {
+		if (forCanceled) {
+			VG_(sprintf)(formatBuf, "%'d operations have been skipped because no bits were canceled\n", skipped);
+			my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+		} else {
+			VG_(sprintf)(formatBuf, "%'d operations have been skipped because they are accurate\n", skipped);
+			my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+		}
+	}
+	if (skippedLibrary > 0) {
+		VG_(sprintf)(formatBuf, "%'d operations have been skipped because they are in a library\n", skippedLibrary);
+		my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+	}
+	if (clo_stochastic) {
+		VG_(sprintf)(formatBuf, "significant digits (stochastic) are only computed for scalar SSE double additions, "
+			"subtractions, multiplications and divisions (%'llu of %'llu operations)\n", stoOps, fpOps);
+		my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+	}
+
+	fwrite_flush();
+	VG_(close)(file);
+	VG_(umsg)("MEAN ERRORS (%s): successful\n", fname);
+
+	mpfr_clears(meanError, maxError, introducedError, err1, err2, cond, NULL);
+	VG_(free)(values);
 }
 
-static Bool areSvsEqual(ShadowValue* sv1, ShadowValue* sv2) {
-	if (sv1->opCount == sv2->opCount && sv1->origin == sv2->origin && 
-		sv1->canceled == sv2->canceled && sv1->cancelOrigin == sv2->cancelOrigin && 
-		sv1->orgType == sv2->orgType && mpfr_cmp(sv1->value, sv2->value) == 0)
-	{
-		return (sv1->orgType == Ot_FLOAT && sv1->Org.fl == sv2->Org.fl) || 
-			   (sv1->orgType == Ot_DOUBLE && sv1->Org.db == sv2->Org.db); 
+static void addSliceSites(OSet* sites, Addr addr, Int level) {
+	if (addr == 0 || level > MAX_LEVEL_OF_GRAPH || VG_(OSetWord_Contains)(sites, addr)) {
+		return;
 	}
-	return False;
-}
+	VG_(OSetWord_Insert)(sites, addr);
 
-static Int compareShadowValues(void* n1, void* n2) {
-	ShadowValue* sv1 = *(ShadowValue**)n1;
-	ShadowValue* sv2 = *(ShadowValue**)n2;
-	if (sv1->opCount < sv2->opCount) return 1;
-	if (sv1->opCount > sv2->opCount) return -1;
-	if (sv1->key < sv2->key) return -1;
-	if (sv1->key > sv2->key) return 1;
-	return 0;
+	MeanValue* mv = VG_(HT_lookup)(meanValues, addr);
+	if (mv != NULL) {
+		addSliceSites(sites, mv->arg1, level + 1);
+		addSliceSites(sites, mv->arg2, level + 1);
+	}
 }
 
-static void writeMemorySpecial(ShadowValue** memory, UInt n_memory) {
-	Char fname[256];
-	HChar* clientName = VG_(args_the_exename);
-	VG_(sprintf)(fname, "%s_shadow_values_special", clientName);
-
-	getFileName(fname);
+/* Writes the operations with the largest introduced errors (--screen) and 
+   the operations they depend on, following the origins of the arguments 
+   at the maximum error. Each line has the address and the key of getPSOKey, 
+   by which the refining run finds the operations again (PIE executables, 
+   shared objects). Lines starting with '#' and the rest of a line after 
+   '#' are comments. */
+static void writeSuspects(Char* fname) {
 	SysRes fileRes = VG_(open)(fname, VKI_O_CREAT|VKI_O_TRUNC|VKI_O_WRONLY, VKI_S_IRUSR|VKI_S_IWUSR);
 	if (sr_isError(fileRes)) {
-		VG_(umsg)("SHADOW VALUES (%s): Failed to create or open the file!\n", fname);
+		VG_(umsg)("SUSPECTS (%s): Failed to create or open the file!\n", fname);
 		return;
 	}
 	Int file = sr_Res(fileRes);
-	writeWarning(file);
 
-	UInt specialFps = 0;
-	UInt skippedLibrary = 0;
-	UInt numWritten = 0;
-	UInt total = 0;
+	UInt n_values = 0;
+	MeanValue** values = VG_(HT_to_array)(meanValues, &n_values);
+	VG_(ssort)(values, n_values, sizeof(VgHashNode*), compareMVIntroError);
+
+	OSet* sites = VG_(OSetWord_Create)(VG_(malloc), "fd.writeSuspects.1", VG_(free));
+	Char key[PSO_KEY_SIZE];
+	mpfr_t introducedError;
+	mpfr_init(introducedError);
 	Int i;
-	for (i = 0; i < n_memory; i++) {
-		if (i > 0 && areSvsEqual(memory[i-1], memory[i])) {
-			continue;
+	Int suspects = 0;
+	VG_(sprintf)(formatBuf, "# FpDebug suspects, precision %ld: address, object:symbol+offset, introduced error, max error\n", clo_precision);
+	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+	for (i = 0; i < n_values && suspects < MAX_SUSPECTS; i++) {
+		getIntroducedError(&introducedError, values[i]);
+		if (mpfr_cmp_ui(introducedError, 0) <= 0) {
+			break;
 		}
-		total++;
-
-		if (memory[i]->orgType == Ot_FLOAT) {
-			mpfr_set_flt(endAnalysisOrg, memory[i]->Org.fl, STD_RND);
-		} else if (memory[i]->orgType == Ot_DOUBLE) {
-			mpfr_set_d(endAnalysisOrg, memory[i]->Org.db, STD_RND);
-		} else {
-			tl_assert(False);
+		Char introStr[MPFR_BUFSIZE];
+		mpfrToString(introStr, &introducedError);
+		Char maxErrorStr[MPFR_BUFSIZE];
+		mpfrToString(maxErrorStr, &(values[i]->max));
+		if (!getPSOKey(values[i]->key, key, PSO_KEY_SIZE)) {
+			VG_(strcpy)(key, "-");
 		}
+		VG_(sprintf)(formatBuf, "0x%lX %s # %s %s\n", values[i]->key, key, introStr, maxErrorStr);
+		my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
 
-		/* not a normal number => NaN, +Inf, or -Inf */
-		if (mpfr_number_p(endAnalysisOrg) == 0) {
-			specialFps++;
-
-			if (clo_ignoreLibraries) {
-				VG_(describe_IP)(memory[i]->origin, description, DESCRIPTION_SIZE);
-				if (ignoreFile(description)) {
-					skippedLibrary++;
-					continue;
-				}
-			}
-
-			if (numWritten < MAX_ENTRIES_PER_FILE) {
-				numWritten++;
-				writeShadowValue(file, memory[i], total);
-				VG_(sprintf)(formatBuf, "\n");
-				my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
-			}
-		} else if (!clo_ignoreAccurate && numWritten < MAX_ENTRIES_PER_FILE) {
-			numWritten++;
-			writeShadowValue(file, memory[i], i);
-			VG_(sprintf)(formatBuf, "\n");
-			my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
-		}
+		addSliceSites(sites, values[i]->key, 0);
+		suspects++;
 	}
 
-	VG_(sprintf)(formatBuf, "%'u%s out of %'u shadow values are in this file\n", numWritten, 
-		numWritten == MAX_ENTRIES_PER_FILE ? " (maximum number written to file)" : "", total);
+	VG_(sprintf)(formatBuf, "# backward slice\n");
 	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
-	if (skippedLibrary > 0) {
-		VG_(sprintf)(formatBuf, "%'u are skipped because they are from a library\n", skippedLibrary);
+	for (i = 0; i < suspects; i++) {
+		VG_(OSetWord_Remove)(sites, values[i]->key);
+	}
+	UWord addr;
+	VG_(OSetWord_ResetIter)(sites);
+	while (VG_(OSetWord_Next)(sites, &addr)) {
+		if (!getPSOKey(addr, key, PSO_KEY_SIZE)) {
+			VG_(strcpy)(key, "-");
+		}
+		VG_(sprintf)(formatBuf, "0x%lX %s\n", addr, key);
 		my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
 	}
-	VG_(sprintf)(formatBuf, "%'u out of %'u shadow values are special (NaN, +Inf, or -Inf)\n", specialFps, n_memory);
-	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
-	VG_(sprintf)(formatBuf, "total number of floating-point operations: %'lu\n", fpOps);
-	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
-	VG_(sprintf)(formatBuf, "number of executed blocks: %'lu\n", sbExecuted);
-	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
 
 	fwrite_flush();
 	VG_(close)(file);
-	VG_(umsg)("SHADOW VALUES (%s): successful\n", fname);
-}
+	VG_(umsg)("SUSPECTS (%s): %d suspects, %ld operations in their slices\n", fname, suspects, VG_(OSetWord_Size)(sites));
 
-static void writeMemoryCanceled(ShadowValue** memory, UInt n_memory) {
-	Char fname[256];
-	HChar* clientName = VG_(args_the_exename);
-	VG_(sprintf)(fname, "%s_shadow_values_canceled", clientName);
+	mpfr_clear(introducedError);
+	VG_(OSetWord_Destroy)(sites);
+	VG_(free)(values);
+}
 
-	getFileName(fname);
-	SysRes fileRes = VG_(open)(fname, VKI_O_CREAT|VKI_O_TRUNC|VKI_O_WRONLY, VKI_S_IRUSR|VKI_S_IWUSR);
+static void readSuspects(Char* fname) {
+	SysRes fileRes = VG_(open)(fname, VKI_O_RDONLY, 0);
 	if (sr_isError(fileRes)) {
-		VG_(umsg)("SHADOW VALUES (%s): Failed to create or open the file!\n", fname);
-		return;
+		VG_(fmsg)("SUSPECTS (%s): Failed to open the file!\n", fname);
+		VG_(exit)(1);
 	}
 	Int file = sr_Res(fileRes);
-	writeWarning(file);
 
-	UInt fpsWithError = 0;
-	UInt skippedLibrary = 0;
-	UInt numWritten = 0;
-	UInt total = 0;
-	Int i;
-	for (i = 0; i < n_memory; i++) {
-		if (i > 0 && areSvsEqual(memory[i-1], memory[i])) {
+	Char line[FORMATBUF_SIZE];
+	Int len = 0;
+	Int count = 0;
+	Char c;
+	while (True) {
+		Int n = VG_(read)(file, &c, 1);
+		if (n == 1 && c != '\n') {
+			if (len < FORMATBUF_SIZE - 1) {
+				line[len++] = c;
+			}
 			continue;
 		}
-		total++;
-
-		if (memory[i]->canceled > CANCEL_LIMIT) {
-			fpsWithError++;
-
-			if (clo_ignoreLibraries) {
-				VG_(describe_IP)(memory[i]->origin, description, DESCRIPTION_SIZE);
-				if (ignoreFile(description)) {
-					skippedLibrary++;
-					continue;
-				}
+		line[len] = '\0';
+		Int i;
+		for (i = 0; i < len && line[i] != '#'; i++);
+		line[i] = '\0';
+		Char* end;
+		Addr addr = (Addr)VG_(strtoull16)(line, &end);
+		if (end != line && addr != 0) {
+			if (addPSODbEntry(suspectDb, addr, end)) {
+				suspectDbHasKeys = True;
 			}
+			count++;
+		}
+		len = 0;
+		if (n != 1) break;
+	}
+	VG_(close)(file);
+	VG_(umsg)("SUSPECTS (%s): %d operations are analyzed\n", fname, count);
+}
 
-			if (numWritten < MAX_ENTRIES_PER_FILE) {
-				numWritten++;
-				writeShadowValue(file, memory[i], i);
-				VG_(sprintf)(formatBuf, "\n");
-				my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+static void parseDemoteFormats(Char* str) {
+	Char* s = str;
+	while (*s != '\0') {
+		Int i;
+		Int len = 0;
+		while (s[len] != ',' && s[len] != '\0') len++;
+		DemoteFormat* fmt = NULL;
+		for (i = 0; i < sizeof(demoteFormatTable) / sizeof(DemoteFormat); i++) {
+			if (VG_(strlen)(demoteFormatTable[i].name) == len && VG_(strncmp)(demoteFormatTable[i].name, s, len) == 0) {
+				fmt = &(demoteFormatTable[i]);
 			}
-		} else if (!clo_ignoreAccurate && numWritten < MAX_ENTRIES_PER_FILE) {
-			numWritten++;
-			writeShadowValue(file, memory[i], total);
-			VG_(sprintf)(formatBuf, "\n");
-			my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
 		}
+		if (fmt == NULL || demoteFormatCount == MAX_DEMOTE_FORMATS) {
+			VG_(fmsg_bad_option)(str, "Expected up to %d comma-separated formats out of fp32, fp16 and bf16\n", MAX_DEMOTE_FORMATS);
+		}
+		demoteFormats[demoteFormatCount++] = fmt;
+		s = s[len] == ',' ? s + len + 1 : s + len;
 	}
+}
 
-	VG_(sprintf)(formatBuf, "%'u%s out of %'u shadow values are in this file\n", numWritten, 
-		numWritten == MAX_ENTRIES_PER_FILE ? " (maximum number written to file)" : "", total);
-	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
-	if (skippedLibrary > 0) {
-		VG_(sprintf)(formatBuf, "%'u are skipped because they are from a library\n", skippedLibrary);
-		my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+/* Each line is the address of an operation (0x...) or a function name 
+   pattern, lines starting with '#' are comments. */
+static void readDemoteCandidates(Char* fname) {
+	SysRes fileRes = VG_(open)(fname, VKI_O_RDONLY, 0);
+	if (sr_isError(fileRes)) {
+		VG_(fmsg)("DEMOTION (%s): Failed to open the file!\n", fname);
+		VG_(exit)(1);
 	}
-	VG_(sprintf)(formatBuf, "%'u out of %'u shadow values have more than %'d canceled bits\n", fpsWithError, total, CANCEL_LIMIT);
-	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
-	VG_(sprintf)(formatBuf, "total number of floating-point operations: %'lu\n", fpOps);
-	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
-	VG_(sprintf)(formatBuf, "number of executed blocks: %'lu\n", sbExecuted);
-	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+	Int file = sr_Res(fileRes);
 
-	fwrite_flush();
+	Char line[FORMATBUF_SIZE];
+	Int len = 0;
+	Char c;
+	while (True) {
+		Int n = VG_(read)(file, &c, 1);
+		if (n == 1 && c != '\n') {
+			if (len < FORMATBUF_SIZE - 1) {
+				line[len++] = c;
+			}
+			continue;
+		}
+		while (len > 0 && (line[len - 1] == ' ' || line[len - 1] == '\t' || line[len - 1] == '\r')) {
+			len--;
+		}
+		line[len] = '\0';
+		if (len > 0 && line[0] != '#') {
+			if (demoteCandidateCount == MAX_DEMOTE_CANDIDATES) {
+				VG_(umsg)("DEMOTION (%s): only the first %d candidates are used\n", fname, MAX_DEMOTE_CANDIDATES);
+				break;
+			}
+			DemoteCandidate* dc = &(demoteCandidates[demoteCandidateCount++]);
+			VG_(memset)(dc, 0, sizeof(DemoteCandidate));
+			if (line[0] == '0' && line[1] == 'x') {
+				dc->addr = (Addr)VG_(strtoull16)(line, NULL);
+			} else {
+				dc->fn = VG_(strdup)("fd.readDemoteCandidates.1", line);
+			}
+		}
+		len = 0;
+		if (n != 1) break;
+	}
 	VG_(close)(file);
-	VG_(umsg)("SHADOW VALUES (%s): successful\n", fname);
+	VG_(umsg)("DEMOTION (%s): %d candidates\n", fname, demoteCandidateCount);
 }
 
-static void writeMemoryRelError(ShadowValue** memory, UInt n_memory) {
+/* For each candidate and format: the largest relative difference to the 
+   original precision which the demotion causes in any result. */
+static void writeDemoteCandidates(void) {
 	Char fname[256];
 	HChar* clientName = VG_(args_the_exename);
-	VG_(sprintf)(fname, "%s_shadow_values_relative_error", clientName);
+	VG_(sprintf)(fname, "%s_demotion", clientName);
 
 	getFileName(fname);
 	SysRes fileRes = VG_(open)(fname, VKI_O_CREAT|VKI_O_TRUNC|VKI_O_WRONLY, VKI_S_IRUSR|VKI_S_IWUSR);
 	if (sr_isError(fileRes)) {
-		VG_(umsg)("SHADOW VALUES (%s): Failed to create or open the file!\n", fname);
+		VG_(umsg)("DEMOTION (%s): Failed to create or open the file!\n", fname);
 		return;
 	}
 	Int file = sr_Res(fileRes);
-	writeWarning(file);
 
-	UInt fpsWithError = 0;
-	UInt skippedLibrary = 0;
-	UInt numWritten = 0;
-	UInt total = 0;
-	Int j = 1;
-	Int i;
-	for (i = 0; i < n_memory; i++) {
-		if (i > 0 && areSvsEqual(memory[i-1], memory[i])) {
-			continue;
-		}
-		total++;
+	VG_(sprintf)(formatBuf, "Demotion: %s (relative to the original precision)\n\n", clo_demote);
+	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
 
-		if (memory[i]->orgType == Ot_FLOAT) {
-			mpfr_set_flt(endAnalysisOrg, memory[i]->Org.fl, STD_RND);
-		} else if (memory[i]->orgType == Ot_DOUBLE) {
-			mpfr_set_d(endAnalysisOrg, memory[i]->Org.db, STD_RND);
+	mpfr_t maxDiff;
+	mpfr_init2(maxDiff, 53);
+	Int c, f;
+	Int harmless = 0;
+	for (c = 0; c < demoteCandidateCount; c++) {
+		DemoteCandidate* dc = &(demoteCandidates[c]);
+		if (dc->fn != NULL) {
+			VG_(sprintf)(formatBuf, "%s (%'llu operations)\n", dc->fn, dc->executions);
 		} else {
-			tl_assert(False);
+			VG_(describe_IP)(dc->addr, description, DESCRIPTION_SIZE);
+			VG_(sprintf)(formatBuf, "%s (%'llu operations)\n", description, dc->executions);
 		}
+		my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
 
-		Bool hasError = True;
-		if (mpfr_cmp_ui(memory[i]->value, 0) != 0 || mpfr_cmp_ui(endAnalysisOrg, 0) != 0) {
-			mpfr_reldiff(endAnalysisRelError, memory[i]->value, endAnalysisOrg, STD_RND);
-
-			if (mpfr_cmp_ui(endAnalysisRelError, 0) != 0) {
-				fpsWithError++;
-
-				if (clo_ignoreLibraries) {
-					VG_(describe_IP)(memory[i]->origin, description, DESCRIPTION_SIZE);
-					if (ignoreFile(description)) {
-						skippedLibrary++;
-						continue;
-					}
-				}
-
-				if (numWritten < MAX_ENTRIES_PER_FILE) {
-					numWritten++;
-					writeShadowValue(file, memory[i], total);
-
-					if (j <= MAX_DUMPED_GRAPHS) {
-						VG_(sprintf)(filename, "%s_%d_%d.vcg", clientName, j, i);
-						if (dumpGraph(filename, memory[i]->key, True, True)) {
-							VG_(sprintf)(formatBuf, "    graph dumped: %s\n", filename);
-							my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
-
-							j++;
-						}
-					}
-
-					VG_(sprintf)(formatBuf, "\n");
-					my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
-				}
-			} else {
-				hasError = False;
-			}
-		} else {
-			hasError = False;
-		}
-		if (!clo_ignoreAccurate && !hasError && numWritten < MAX_ENTRIES_PER_FILE) {
-			numWritten++;
-			writeShadowValue(file, memory[i], i);
-			VG_(sprintf)(formatBuf, "\n");
+		Bool changed = False;
+		for (f = 0; f < demoteFormatCount; f++) {
+			if (dc->changed[f] == 0) {
+				VG_(sprintf)(formatBuf, "    %s: no result changed\n", demoteFormats[f]->name);
+				my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+				continue;
+			}
+			changed = True;
+			Char diffStr[MPFR_BUFSIZE];
+			mpfr_set_d(maxDiff, dc->maxDiff[f], STD_RND);
+			mpfrToString(diffStr, &maxDiff);
+			VG_(sprintf)(formatBuf, "    %s: max relative error %s, %'llu results changed\n", 
+				demoteFormats[f]->name, diffStr, dc->changed[f]);
 			my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+			if (dc->maxSite[f] != 0) {
+				VG_(describe_IP)(dc->maxSite[f], description, DESCRIPTION_SIZE);
+				VG_(sprintf)(formatBuf, "        at %s\n", description);
+				my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+			}
 		}
+		if (!changed) {
+			harmless++;
+		}
+		my_fwrite(file, "\n", 1);
 	}
 
-	VG_(sprintf)(formatBuf, "%'u%s out of %'u shadow values are in this file\n", numWritten, 
-		numWritten == MAX_ENTRIES_PER_FILE ? " (maximum number written to file)" : "", total);
-	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
-	if (skippedLibrary > 0) {
-		VG_(sprintf)(formatBuf, "%'u are skipped because they are from a library\n", skippedLibrary);
-		my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
-	}
-	VG_(sprintf)(formatBuf, "%'u out of %'u shadow values have an error\n", fpsWithError, total);
-	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
-	VG_(sprintf)(formatBuf, "%'u graph(s) have been dumped\n", j - 1);
-	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
-	VG_(sprintf)(formatBuf, "total number of floating-point operations: %'lu\n", fpOps);
-	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
-	VG_(sprintf)(formatBuf, "number of executed blocks: %'lu\n", sbExecuted);
-	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
-
 	fwrite_flush();
 	VG_(close)(file);
-	VG_(umsg)("SHADOW VALUES (%s): successful\n", fname);
+	VG_(umsg)("DEMOTION (%s): %'d out of %'d candidates can be demoted without changing a result\n", fname, harmless, demoteCandidateCount);
+	mpfr_clear(maxDiff);
 }
 
-static void endAnalysis(void) {
-	UInt n_memory = 0;
-	ShadowValue** memory = VG_(HT_to_array)(globalMemory, &n_memory);
-	VG_(ssort)(memory, n_memory, sizeof(VgHashNode*), compareShadowValues);
-
-	//writeMemoryRelError(memory, n_memory);
-	//writeMemoryCanceled(memory, n_memory);
-	//writeMemorySpecial(memory, n_memory);
-
-	VG_(free)(memory);
+static Double reductionMaxDiff(ReductionSite* rs) {
+	Double max = 0.0;
+	Int w;
+	for (w = 0; w < REDUCTION_WIDTHS; w++) {
+		if (rs->maxDiff[w] > max) {
+			max = rs->maxDiff[w];
+		}
+	}
+	return max;
 }
 
-static Int compareMVAddr(void* n1, void* n2) {
-	MeanValue* mv1 = *(MeanValue**)n1;
-	MeanValue* mv2 = *(MeanValue**)n2;
-	if (mv1->key < mv2->key) return -1;
-	if (mv1->key > mv2->key) return  1;
+static Int compareReductionSites(void* n1, void* n2) {
+	ReductionSite* rs1 = *(ReductionSite**)n1;
+	ReductionSite* rs2 = *(ReductionSite**)n2;
+	Double d1 = reductionMaxDiff(rs1);
+	Double d2 = reductionMaxDiff(rs2);
+	if (d1 < d2) return 1;
+	if (d1 > d2) return -1;
+	if (rs1->count < rs2->count) return 1;
+	if (rs1->count > rs2->count) return -1;
 	return 0;
 }
 
-static Int compareMVCanceled(void* n1, void* n2) {
-	MeanValue* mv1 = *(MeanValue**)n1;
-	MeanValue* mv2 = *(MeanValue**)n2;
-	if (mv1->cancellationBadnessMax < mv2->cancellationBadnessMax) return 1;
-	if (mv1->cancellationBadnessMax > mv2->cancellationBadnessMax) return -1;
-	if (mv1->canceledMax < mv2->canceledMax) return 1;
-	if (mv1->canceledMax > mv2->canceledMax) return -1;
-	return 0;
-}
+/* For each accumulation: how much the interleaved sums differ from the 
+   sequential sum and their errors against the double-double sum. */
+static void writeReductionSites(void) {
+	Char fname[256];
+	HChar* clientName = VG_(args_the_exename);
+	VG_(sprintf)(fname, "%s_reassociation", clientName);
 
-static Int compareMVIntroError(void* n1, void* n2) {
-	MeanValue* mv1 = *(MeanValue**)n1;
-	MeanValue* mv2 = *(MeanValue**)n2;
+	getFileName(fname);
+	SysRes fileRes = VG_(open)(fname, VKI_O_CREAT|VKI_O_TRUNC|VKI_O_WRONLY, VKI_S_IRUSR|VKI_S_IWUSR);
+	if (sr_isError(fileRes)) {
+		VG_(umsg)("REASSOCIATION (%s): Failed to create or open the file!\n", fname);
+		return;
+	}
+	Int file = sr_Res(fileRes);
 
-	getIntroducedError(&compareIntroErr1, mv1);
-	getIntroducedError(&compareIntroErr2, mv2);
-	Int cmp = mpfr_cmp(compareIntroErr1, compareIntroErr2);
+	UInt n_sites = 0;
+	ReductionSite** sites = VG_(HT_to_array)(reductionSites, &n_sites);
+	VG_(ssort)(sites, n_sites, sizeof(VgHashNode*), compareReductionSites);
+
+	mpfr_t diff, err;
+	mpfr_inits2(53, diff, err, NULL);
+	Char diffStr[MPFR_BUFSIZE];
+	Char errStr[MPFR_BUFSIZE];
+	Int i, w;
+	Int reductions = 0;
+	Int unsafe = 0;
+	for (i = 0; i < n_sites; i++) {
+		if (sites[i]->maxLength < 2) {
+			continue;
+		}
+		reductions++;
+		if (reductionMaxDiff(sites[i]) > 0) {
+			unsafe++;
+		}
+		if (reductions > MAX_ENTRIES_PER_FILE) {
+			continue;
+		}
 
-	if (cmp < 0) return 1;
-	if (cmp > 0) return -1;
+		VG_(describe_IP)(sites[i]->key, description, DESCRIPTION_SIZE);
+		opToStr(sites[i]->op);
+		VG_(sprintf)(formatBuf, "%s %s (%'llu additions in %'llu chains, longest %'llu)\n", 
+			description, opStr, sites[i]->count, sites[i]->chains, sites[i]->maxLength);
+		my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+		mpfr_set_d(err, sites[i]->maxErrSeq, STD_RND);
+		mpfrToString(errStr, &err);
+		VG_(sprintf)(formatBuf, "    sequential: max error %s\n", errStr);
+		my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+		for (w = 0; w < REDUCTION_WIDTHS; w++) {
+			mpfr_set_d(diff, sites[i]->maxDiff[w], STD_RND);
+			mpfrToString(diffStr, &diff);
+			mpfr_set_d(err, sites[i]->maxErr[w], STD_RND);
+			mpfrToString(errStr, &err);
+			VG_(sprintf)(formatBuf, "    %d-way: max error %s, differs %'llu times, max relative difference %s\n", 
+				2 << w, errStr, sites[i]->diverged[w], diffStr);
+			my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+		}
+		my_fwrite(file, "\n", 1);
+	}
+
+	fwrite_flush();
+	VG_(close)(file);
+	VG_(umsg)("REASSOCIATION (%s): %'d out of %'d accumulations change when they are reordered\n", fname, unsafe, reductions);
+	mpfr_clears(diff, err, NULL);
+	VG_(free)(sites);
+}
+
+static Int compareContractionSites(void* n1, void* n2) {
+	ContractionSite* cs1 = *(ContractionSite**)n1;
+	ContractionSite* cs2 = *(ContractionSite**)n2;
+	if (cs1->maxIncrease < cs2->maxIncrease) return 1;
+	if (cs1->maxIncrease > cs2->maxIncrease) return -1;
+	if (cs1->changed < cs2->changed) return 1;
+	if (cs1->changed > cs2->changed) return -1;
 	return 0;
 }
 
-static void writeMeanValues(Char* fname, Int (*cmpFunc) (void*, void*), Bool forCanceled) {
-	if (!clo_computeMeanValue) {
-		return;
-	}
+/* For each multiply-add pair: how often the fused result differs and 
+   whether it is more or less accurate than the separate operations. */
+static void writeContractionSites(void) {
+	Char fname[256];
+	HChar* clientName = VG_(args_the_exename);
+	VG_(sprintf)(fname, "%s_fma_contraction", clientName);
 
 	getFileName(fname);
 	SysRes fileRes = VG_(open)(fname, VKI_O_CREAT|VKI_O_TRUNC|VKI_O_WRONLY, VKI_S_IRUSR|VKI_S_IWUSR);
 	if (sr_isError(fileRes)) {
-		VG_(umsg)("MEAN ERRORS (%s): Failed to create or open the file!\n", fname);
+		VG_(umsg)("FMA CONTRACTION (%s): Failed to create or open the file!\n", fname);
 		return;
 	}
 	Int file = sr_Res(fileRes);
-	writeWarning(file);
 
-	UInt n_values = 0;
-	MeanValue** values = VG_(HT_to_array)(meanValues, &n_values);
-	VG_(ssort)(values, n_values, sizeof(VgHashNode*), cmpFunc);
+	UInt n_sites = 0;
+	ContractionSite** sites = VG_(HT_to_array)(contractionSites, &n_sites);
+	VG_(ssort)(sites, n_sites, sizeof(VgHashNode*), compareContractionSites);
 
-	mpfr_t meanError, maxError, introducedError, err1, err2;
-	mpfr_inits(meanError, maxError, introducedError, err1, err2, NULL);
-	Int fpsWritten = 0;
-	Int skipped = 0;
-	Int skippedLibrary = 0;
+	mpfr_t err;
+	mpfr_init2(err, 53);
+	Char separateStr[MPFR_BUFSIZE];
+	Char fusedStr[MPFR_BUFSIZE];
+	Char mulDescription[DESCRIPTION_SIZE];
 	Int i;
-	for (i = 0; i < n_values; i++) {
-		if (clo_ignoreAccurate && !forCanceled && mpfr_cmp_ui(values[i]->sum, 0) == 0) {
-			skipped++;
-			continue;
+	Int worse = 0;
+	for (i = 0; i < n_sites; i++) {
+		if (sites[i]->worse > 0) {
+			worse++;
 		}
-
-		if (clo_ignoreAccurate && forCanceled && values[i]->canceledMax == 0) {
-			skipped++;
-			continue;
-		} 
-
-		VG_(describe_IP)(values[i]->key, description, DESCRIPTION_SIZE);
-		if (ignoreFile(description)) {
-			skippedLibrary++;
-			continue;
-		}
-
-		if (i > MAX_ENTRIES_PER_FILE) {
+		if (i >= MAX_ENTRIES_PER_FILE) {
 			continue;
 		}
 
-		fpsWritten++;
-		mpfr_div_ui(meanError, values[i]->sum, values[i]->count, STD_RND);
-
-		opToStr(values[i]->op);
-		Char meanErrorStr[MPFR_BUFSIZE];
-		mpfrToString(meanErrorStr, &meanError);
-		Char maxErrorStr[MPFR_BUFSIZE];
-		mpfrToString(maxErrorStr, &(values[i]->max));
-
-		VG_(sprintf)(formatBuf, "%s %s (%'u)\n", description, opStr, values[i]->count);
-		my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
-		VG_(sprintf)(formatBuf, "    avg error: %s\n", meanErrorStr);
+		VG_(describe_IP)(sites[i]->key, description, DESCRIPTION_SIZE);
+		VG_(describe_IP)(sites[i]->mulAddr, mulDescription, DESCRIPTION_SIZE);
+		opToStr(sites[i]->op);
+		VG_(sprintf)(formatBuf, "%s %s (%'llu)\n    multiplication: %s\n", description, opStr, sites[i]->count, mulDescription);
 		my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
-		VG_(sprintf)(formatBuf, "    max error: %s\n", maxErrorStr);
+		VG_(sprintf)(formatBuf, "    fused result differs %'llu times: %'llu more accurate, %'llu less accurate\n", 
+			sites[i]->changed, sites[i]->better, sites[i]->worse);
 		my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
-
-		if (values[i]->overflow) {
-			VG_(sprintf)(formatBuf, "    canceled bits - max: %'ld, avg: overflow\n", values[i]->canceledMax);
-		} else {
-			mpfr_exp_t meanCanceledBits = values[i]->canceledSum / values[i]->count;
-			VG_(sprintf)(formatBuf, "    canceled bits - max: %'ld, avg: %'ld\n", values[i]->canceledMax, meanCanceledBits);
-		}
+		mpfr_set_d(err, sites[i]->maxErrSeparate, STD_RND);
+		mpfrToString(separateStr, &err);
+		mpfr_set_d(err, sites[i]->maxErrFused, STD_RND);
+		mpfrToString(fusedStr, &err);
+		VG_(sprintf)(formatBuf, "    max error - separate: %s, fused: %s\n", separateStr, fusedStr);
 		my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
-
-		if (clo_bad_cancellations) {
-			Char avgCancellationBadness[10];
-			VG_(percentify)(values[i]->cancellationBadnessSum, values[i]->count * values[i]->cancellationBadnessMax, 2, 10, avgCancellationBadness);
-			VG_(sprintf)(formatBuf, "    cancellation badness - max: %'ld, avg (sum/(count*max)):%s\n", values[i]->cancellationBadnessMax, avgCancellationBadness);
+		if (sites[i]->worse > 0) {
+			mpfr_set_d(err, sites[i]->maxIncrease, STD_RND);
+			mpfrToString(fusedStr, &err);
+			VG_(sprintf)(formatBuf, "    max increase of the error: %s\n", fusedStr);
 			my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
 		}
+		my_fwrite(file, "\n", 1);
+	}
 
-		getIntroducedError(&introducedError, values[i]);
-		if (mpfr_cmp_ui(introducedError, 0) > 0) {
-			Char introErrorStr[MPFR_BUFSIZE];
-			mpfrToString(introErrorStr, &introducedError);
-			VG_(sprintf)(formatBuf, "    introduced error (max path): %s\n", introErrorStr);
-		} else {
-			VG_(sprintf)(formatBuf, "    no error has been introduced (max path)\n");
-		}
-		my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
-		VG_(sprintf)(formatBuf, "    origin of the arguments (max path): 0x%lX, 0x%lX\n\n", values[i]->arg1, values[i]->arg2);
-		my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+	fwrite_flush();
+	VG_(close)(file);
+	VG_(umsg)("FMA CONTRACTION (%s): contraction is less accurate for %'d out of %'u multiply-add pairs\n", fname, worse, n_sites);
+	mpfr_clear(err);
+	VG_(free)(sites);
+}
+
+static Int compareLadderSites(void* n1, void* n2) {
+	LadderSite* ls1 = *(LadderSite**)n1;
+	LadderSite* ls2 = *(LadderSite**)n2;
+	if (ls1->maxDiff < ls2->maxDiff) return 1;
+	if (ls1->maxDiff > ls2->maxDiff) return -1;
+	if (ls1->key < ls2->key) return -1;
+	if (ls1->key > ls2->key) return 1;
+	return 0;
+}
+
+/* For each operation: converged if the two highest precisions of the 
+   ladder always round to the same double. */
+static void writeLadderSites(void) {
+	Char fname[256];
+	HChar* clientName = VG_(args_the_exename);
+	VG_(sprintf)(fname, "%s_precision_ladder", clientName);
+
+	getFileName(fname);
+	SysRes fileRes = VG_(open)(fname, VKI_O_CREAT|VKI_O_TRUNC|VKI_O_WRONLY, VKI_S_IRUSR|VKI_S_IWUSR);
+	if (sr_isError(fileRes)) {
+		VG_(umsg)("PRECISION LADDER (%s): Failed to create or open the file!\n", fname);
+		return;
 	}
+	Int file = sr_Res(fileRes);
 
-	VG_(sprintf)(formatBuf, "%'d%s out of %'d operations are listed in this file\n", 
-		fpsWritten, fpsWritten == MAX_ENTRIES_PER_FILE ? " (maximum number written to file)" : "", n_values);
+	UInt n_sites = 0;
+	LadderSite** sites = VG_(HT_to_array)(ladderSites, &n_sites);
+	VG_(ssort)(sites, n_sites, sizeof(VgHashNode*), compareLadderSites);
+
+	VG_(sprintf)(formatBuf, "Precision ladder: %s (shadow value: %ld)\n\n", clo_precision_ladder, clo_precision);
 	my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
-	if (skipped > 0) {
-		if (forCanceled) {
-			VG_(sprintf)(formatBuf, "%'d operations have been skipped because no bits were canceled\n", skipped);
-			my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+
+	mpfr_t maxDiff;
+	mpfr_init2(maxDiff, 53);
+	Int i;
+	Int diverged = 0;
+	for (i = 0; i < n_sites; i++) {
+		if (sites[i]->diverged > 0) {
+			diverged++;
+		}
+		if (i >= MAX_ENTRIES_PER_FILE) {
+			continue;
+		}
+		VG_(describe_IP)(sites[i]->key, description, DESCRIPTION_SIZE);
+		opToStr(sites[i]->op);
+		VG_(sprintf)(formatBuf, "%s %s (%'u)\n", description, opStr, sites[i]->count);
+		my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+		Char diffStr[MPFR_BUFSIZE];
+		mpfr_set_d(maxDiff, sites[i]->maxDiff, STD_RND);
+		mpfrToString(diffStr, &maxDiff);
+		if (sites[i]->diverged > 0) {
+			VG_(sprintf)(formatBuf, "    NOT converged: %'u times, max relative difference %s\n", sites[i]->diverged, diffStr);
 		} else {
-			VG_(sprintf)(formatBuf, "%'d operations have been skipped because they are accurate\n", skipped);
-			my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
+			VG_(sprintf)(formatBuf, "    converged, max relative difference %s\n", diffStr);
 		}
-	}
-	if (skippedLibrary > 0) {
-		VG_(sprintf)(formatBuf, "%'d operations have been skipped because they are in a library\n", skippedLibrary);
 		my_fwrite(file, (void*)formatBuf, VG_(strlen)(formatBuf));
 	}
 
 	fwrite_flush();
 	VG_(close)(file);
-	VG_(umsg)("MEAN ERRORS (%s): successful\n", fname);
-
-	mpfr_clears(meanError, maxError, introducedError, err1, err2, NULL);
-	VG_(free)(values);
+	VG_(umsg)("PRECISION LADDER (%s): %'d out of %'u operations did not converge\n", fname, diverged, n_sites);
+	mpfr_clear(maxDiff);
+	VG_(free)(sites);
 }
 
 static Int compareStageReports(void* n1, void* n2) {
@@ -4781,8 +10189,50 @@ static void writeStageReports(Char* fname) {
 }
 
 static void fd_fini(Int exitcode) {
+	/* a child of --pso-fork-server which ended before VALGRIND_PSO_END_RUN, 
+	   the parent sees the closed pipe and executes the run again */
+	if (psoForkPipe >= 0) {
+		return;
+	}
 	endAnalysis();
 
+	if (clo_screen) {
+		writeSuspects(clo_screen);
+	}
+	if (ladderCount > 0) {
+		writeLadderSites();
+	}
+	if (demoteCount > 0) {
+		writeDemoteCandidates();
+	}
+	if (clo_reassociation) {
+		writeReductionSites();
+	}
+	if (clo_fma_contraction) {
+		writeContractionSites();
+	}
+	if (psoDbCount > 0) {
+		Int unresolved = 0;
+		PSODbEntry* e;
+		VG_(HT_ResetIter)(psoDb);
+		while (e = VG_(HT_Next)(psoDb)) {
+			if (e->resolved == 0) {
+				VG_(umsg)("PSO DATABASE: 0x%lX %s was not resolved\n", e->addr, e->key ? e->key : (Char*)"-");
+				unresolved++;
+			}
+		}
+		VG_(umsg)("PSO DATABASE: %d of %d operations resolved\n", psoDbCount - unresolved, psoDbCount);
+	}
+	if (clo_adaptive_precision > 0) {
+		VG_(umsg)("ADAPTIVE PRECISION: %'ld operations escalated to %ld bits\n", VG_(OSetWord_Size)(escalatedSites), clo_precision);
+	}
+	if (clo_stochastic) {
+		VG_(umsg)("STOCHASTIC: %'llu of %'llu operations computed with %u samples (scalar SSE double add/sub/mul/div)\n", stoOps, fpOps, clo_sto_samples);
+	}
+	if (clo_hybrid) {
+		VG_(umsg)("HYBRID SHADOWS: %'llu of %'llu operations computed with double-double, %'llu shadow values promoted to MPFR\n", ddOps, fpOps, ddPromoted);
+	}
+
 	/*HChar* clientName = VG_(args_the_exename);
 	VG_(sprintf)(filename, "%s_mean_errors_addr", clientName);
 	writeMeanValues(filename, &compareMVAddr, False);
@@ -4811,6 +10261,7 @@ static void fd_fini(Int exitcode) {
 
 /* Returns True if there is a return value. */
 static Bool fd_handle_client_request(ThreadId tid, UWord* arg, UWord* ret) {
+	discardSaturatedSites();
 	switch (arg[0]) {
 		case VG_USERREQ__PRINT_ERROR:
 			printError((Char*)arg[1], arg[2], False);
@@ -4886,6 +10337,33 @@ static Bool fd_handle_client_request(ThreadId tid, UWord* arg, UWord* ret) {
 		case VG_USERREQ__END:
 			endAnalyzing();
 			break;
+		/*****************/
+		case VG_USERREQ__WRAPPED_CALL:
+			processWrappedCall(arg[1], arg[2], arg[3], arg[4]);
+			break;
+		case VG_USERREQ__BLAS_BEGIN:
+			blasBegin(tid, arg[1], arg[2], arg[3]);
+			break;
+		case VG_USERREQ__BLAS_END:
+			blasEnd(tid, arg[1], arg[2]);
+			break;
+		/*****************/
+		case VG_USERREQ__SET_PRECISION:
+			*ret = (UWord)setPrecision((mpfr_prec_t)arg[1]);
+			return True;
+		case VG_USERREQ__PUSH_PRECISION:
+			pushPrecision((mpfr_prec_t)arg[1]);
+			break;
+		case VG_USERREQ__POP_PRECISION:
+			popPrecision();
+			break;
+		/*****************/
+		case VG_USERREQ__GET_RELATIVE_ERROR_BINARY:
+			*ret = getRelativeErrorBinary(arg[1], (Double*)arg[2]);
+			return True;
+		case VG_USERREQ__GET_SHADOW_BINARY:
+			*ret = getShadowBinary(arg[1], (FdBinaryShadow*)arg[2], (UWord*)arg[3], arg[4]);
+			return True;
 	}
 	return False;
 }
@@ -4902,22 +10380,159 @@ static void gmp_free(void* p, size_t t) {
 	VG_(free)(p);
 }
 
+static void parsePrecisionLadder(Char* str) {
+	Char* s = str;
+	while (*s != '\0') {
+		Char* end;
+		Long prec = VG_(strtoll10)(s, &end);
+		if (end == s || prec < MPFR_PREC_MIN || prec > MPFR_PREC_MAX || ladderCount == MAX_LADDER ||
+			(*end != ',' && *end != '\0')) {
+			VG_(fmsg_bad_option)(str, "Expected up to %d comma-separated precisions\n", MAX_LADDER);
+		}
+		/* the convergence check compares the two highest precisions */
+		if (ladderCount > 0 && prec <= ladderPrec[ladderCount - 1]) {
+			VG_(fmsg_bad_option)(str, "Expected strictly ascending precisions\n");
+		}
+		ladderPrec[ladderCount++] = (mpfr_prec_t)prec;
+		s = *end == ',' ? end + 1 : end;
+	}
+}
+
 static void fd_post_clo_init(void) {
+	if (clo_screen) {
+		/* double operations are screened with double-double shadow values, 
+		   the rest with MPFR at the same precision */
+		if (!precisionGiven) {
+			clo_precision = SCREEN_PRECISION;
+		}
+		if (!clo_stochastic) {
+			clo_hybrid = True;
+		}
+	}
 	VG_(umsg)("precision=%ld\n", clo_precision);
 	VG_(umsg)("mean-error=%s\n", clo_computeMeanValue ? "yes" : "no");
 	VG_(umsg)("ignore-libraries=%s\n", clo_ignoreLibraries ? "yes" : "no");
 	VG_(umsg)("ignore-accurate=%s\n", clo_ignoreAccurate ? "yes" : "no");
 	VG_(umsg)("sim-original=%s\n", clo_simulateOriginal ? "yes" : "no");
-	VG_(umsg)("analyze-all=%s\n", clo_analyze ? "yes" : "no");
 	VG_(umsg)("bad-cancellations=%s\n", clo_bad_cancellations ? "yes" : "no");
     VG_(umsg)("ignore-end=%s\n", clo_ignore_end ? "yes" : "no");
     VG_(umsg)("error-localization=%s\n", clo_error_localization ? "yes" : "no");
     VG_(umsg)("print-every-error=%s\n", clo_print_every_error ? "yes" : "no");
     VG_(umsg)("detect-pso=%s\n", clo_detect_pso ? "yes" : "no");
+    if (clo_pso_lanes > 0) {
+		VG_(umsg)("pso-lanes=%u\n", clo_pso_lanes);
+		if (!clo_detect_pso) {
+			VG_(fmsg_bad_option)("--pso-lanes", "Expected --detect-pso=yes\n");
+		}
+    }
+    if (clo_pso_fork) {
+		VG_(umsg)("pso-fork-server=yes\n");
+		if (!clo_detect_pso) {
+			VG_(fmsg_bad_option)("--pso-fork-server", "Expected --detect-pso=yes\n");
+		}
+    }
+    if (clo_pso_db) {
+		VG_(umsg)("pso-db=%s\n", clo_pso_db);
+		if (!clo_detect_pso) {
+			VG_(fmsg_bad_option)("--pso-db", "Expected --detect-pso=yes\n");
+		}
+    }
     VG_(umsg)("goto-shadow-branch=%s\n", clo_goto_shadow_branch ? "yes" : "no");
     VG_(umsg)("track-int=%s\n", clo_track_int ? "yes" : "no");
+    if (clo_local_error) {
+		VG_(umsg)("local-error-only=yes\n");
+		if (clo_wrap_libm || clo_wrap_blas) {
+			VG_(umsg)("wrap-libm and wrap-blas are ignored with --local-error-only\n");
+			clo_wrap_libm = False;
+			clo_wrap_blas = False;
+		}
+    }
+    VG_(umsg)("wrap-libm=%s\n", clo_wrap_libm ? "yes" : "no");
+    VG_(umsg)("wrap-blas=%s\n", clo_wrap_blas ? "yes" : "no");
+    if (clo_start_fn || clo_start_addr) {
+		clo_analyze = False;
+		clo_reinstrument = True;
+		if (clo_start_fn) VG_(umsg)("start-at-fn=%s\n", clo_start_fn);
+		if (clo_start_addr) VG_(umsg)("start-at-addr=%#lx\n", clo_start_addr);
+    }
+    if (clo_stop_fn || clo_stop_addr) {
+		clo_reinstrument = True;
+		if (clo_stop_fn) VG_(umsg)("stop-at-fn=%s\n", clo_stop_fn);
+		if (clo_stop_addr) VG_(umsg)("stop-at-addr=%#lx\n", clo_stop_addr);
+    }
+    VG_(umsg)("analyze-all=%s\n", clo_analyze ? "yes" : "no");
+    Int k;
+    for (k = 0; k < clo_include_count; k++) {
+		VG_(umsg)("include=%s\n", clo_include[k]);
+    }
+    for (k = 0; k < clo_exclude_count; k++) {
+		VG_(umsg)("exclude=%s\n", clo_exclude[k]);
+    }
+    VG_(umsg)("reinstrument-on-toggle=%s\n", clo_reinstrument ? "yes" : "no");
+    if (clo_sample_rate > 1) {
+		VG_(umsg)("sample-rate=1/%u\n", clo_sample_rate);
+		VG_(umsg)("sample-window=%u\n", clo_sample_window);
+    }
+    if (clo_site_budget > 0) {
+		VG_(umsg)("site-budget=%u\n", clo_site_budget);
+    }
+    if (clo_adaptive_precision > 0) {
+		if (clo_adaptive_precision < 53) {
+			VG_(fmsg_bad_option)("--adaptive-precision", "Expected 0 or at least 53 bits\n");
+		}
+		VG_(umsg)("adaptive-precision=%ld\n", clo_adaptive_precision);
+		VG_(umsg)("escalate-threshold=%u\n", clo_escalate_threshold);
+    }
+    if (clo_precision_ladder) {
+		parsePrecisionLadder(clo_precision_ladder);
+		VG_(umsg)("precision-ladder=%s\n", clo_precision_ladder);
+    }
+    if (clo_demote) {
+		parseDemoteFormats(clo_demote);
+		VG_(umsg)("demote=%s\n", clo_demote);
+		if (!clo_demote_candidates) {
+			VG_(fmsg_bad_option)("--demote", "Expected --demote-candidates=<file>\n");
+		}
+		VG_(umsg)("demote-candidates=%s\n", clo_demote_candidates);
+    }
+    if (clo_stochastic) {
+		VG_(umsg)("shadow-engine=stochastic\n");
+		VG_(umsg)("stochastic-samples=%u\n", clo_sto_samples);
+		if (clo_hybrid) {
+			VG_(umsg)("hybrid-shadows is ignored with the stochastic engine\n");
+			clo_hybrid = False;
+		}
+		/* fixed seeds, runs are reproducible */
+		for (k = 0; k < MAX_STO_SAMPLES; k++) {
+			stoState[k / STO_VEC_LANES][k % STO_VEC_LANES] = 0x9E3779B97F4A7C15ULL * (k + 1);
+		}
+    }
+    if (clo_hybrid) {
+		VG_(umsg)("hybrid-shadows=yes\n");
+    }
+    if (clo_condition) {
+		VG_(umsg)("condition-numbers=yes\n");
+    }
+    if (clo_reassociation) {
+		VG_(umsg)("reassociation=yes\n");
+    }
+    if (clo_fma_contraction) {
+		VG_(umsg)("fma-contraction=yes\n");
+		if (clo_local_error) {
+			VG_(umsg)("fma-contraction is ignored with --local-error-only\n");
+			clo_fma_contraction = False;
+		}
+    }
+    if (clo_screen) {
+		VG_(umsg)("screen=%s\n", clo_screen);
+    }
+    if (clo_suspects) {
+		VG_(umsg)("suspects=%s\n", clo_suspects);
+    }
 
 	mpfr_set_default_prec(clo_precision);
+	currentPrecision = clo_precision;
+	opPrecision = clo_precision;
 	defaultEmin = mpfr_get_emin();
 	defaultEmax = mpfr_get_emax();
 
@@ -4931,6 +10546,9 @@ static void fd_post_clo_init(void) {
 	binOpArgs = VG_(malloc)("fd.init.4", sizeof(BinOp));
 	triOpArgs = VG_(malloc)("fd.init.5", sizeof(TriOp));
 	circRegs = VG_(malloc)("fd.init.6", sizeof(CircularRegs));
+	packedOpArgs = VG_(malloc)("fd.init.11", sizeof(PackedOp));
+	quadOpArgs = VG_(malloc)("fd.init.12", sizeof(QuadOp));
+	contractionArgs = VG_(malloc)("fd.init.13", sizeof(Contraction));
 
 	mpfr_inits(meanOrg, meanRelError, NULL);
 	mpfr_inits(stageOrg, stageDiff, stageRelError, NULL);
@@ -4941,15 +10559,24 @@ static void fd_post_clo_init(void) {
 	mpfr_inits(compareIntroErr1, compareIntroErr2, NULL);
 	mpfr_inits(writeSvOrg, writeSvDiff, writeSvRelError, NULL);
 	mpfr_init(cancelTemp);
+	mpfr_init(ddValue);
+	mpfr_init(localExact);
+	mpfr_inits(demoteTemp, demoteArgs[0], demoteArgs[1], demoteArgs[2], NULL);
+	mpfr_inits(psoTemp, psoArgs[0], psoArgs[1], psoArgs[2], NULL);
+	mpfr_inits2(53, contractA, contractB, contractC, contractFused, NULL);
+	mpfr_init(contractErr);
 	mpfr_inits(arg1tmpX, arg2tmpX, arg3tmpX, NULL);
 	mpfr_inits(arg1midX, arg2midX, arg3midX, NULL);
 	mpfr_inits(arg1oriX, arg2oriX, arg3oriX, NULL);
+	mpfr_inits(arg4tmpX, arg4midX, arg4oriX, qopProduct, NULL);
 	mpfr_set_d(arg1midX, 1.0, STD_RND);
 	mpfr_set_d(arg2midX, 1.0, STD_RND);
 	mpfr_set_d(arg3midX, 1.0, STD_RND);
 	mpfr_set_d(arg1oriX, 1.0, STD_RND);
 	mpfr_set_d(arg2oriX, 1.0, STD_RND);
 	mpfr_set_d(arg3oriX, 1.0, STD_RND);
+	mpfr_set_d(arg4midX, 1.0, STD_RND);
+	mpfr_set_d(arg4oriX, 1.0, STD_RND);
 
 	Int i;
 	for (i = 0; i < TMP_COUNT; i++) {
@@ -4969,6 +10596,9 @@ static void fd_post_clo_init(void) {
 	}
 	for (i = 0; i < MAX_TEMPS; i++) {
 		localTemps[i] = NULL;
+		for (j = 0; j < MAX_LANES; j++) {
+			laneTemps[j][i] = NULL;
+		}
 	}
 
 	for (i = 0; i < MAX_STAGES; i++) {
@@ -4976,7 +10606,52 @@ static void fd_post_clo_init(void) {
 		stageReports[i] = NULL;
 	}
 
+	for (i = 0; i < BLAS_BLOCK * BLAS_BLOCK; i++) {
+		mpfr_inits(blasAVal[i], blasBVal[i], NULL);
+		mpfr_init2(blasAMid[i], 53);
+		mpfr_init2(blasBMid[i], 53);
+		if (clo_simulateOriginal) {
+			mpfr_set_prec(blasAVal[i], 53);
+			mpfr_set_prec(blasBVal[i], 53);
+		}
+	}
+	mpfr_init2(blasMidProd, 53);
+	for (i = 0; i < VG_N_THREADS; i++) {
+		blasCalls[i].outputs = NULL;
+		blasCalls[i].count = 0;
+		blasCalls[i].size = 0;
+	}
+
 	unsupportedOps = VG_(OSetWord_Create)(VG_(malloc), "fd.init.10", VG_(free));
+
+	if (clo_adaptive_precision > 0) {
+		escalatedSites = VG_(OSetWord_Create)(VG_(malloc), "fd.init.15", VG_(free));
+	}
+	if (clo_site_budget > 0) {
+		saturatedPending = VG_(OSetWord_Create)(VG_(malloc), "fd.init.16", VG_(free));
+	}
+	if (ladderCount > 0) {
+		ladderSites = VG_(HT_construct)("Precision ladder");
+	}
+	if (clo_reassociation) {
+		reductionSites = VG_(HT_construct)("Reductions");
+	}
+	if (clo_fma_contraction) {
+		contractionSites = VG_(HT_construct)("FMA contractions");
+	}
+	if (demoteFormatCount > 0) {
+		demoteSites = VG_(HT_construct)("Demotion candidates");
+		readDemoteCandidates(clo_demote_candidates);
+		demoteCount = demoteCandidateCount * demoteFormatCount;
+	}
+	if (clo_suspects) {
+		suspectSites = VG_(OSetWord_Create)(VG_(malloc), "fd.init.14", VG_(free));
+		suspectDb = VG_(HT_construct)("Suspects");
+		readSuspects(clo_suspects);
+	}
+	if (clo_pso_db) {
+		readPSODb(clo_pso_db);
+	}
 }
 
 static void fd_pre_clo_init(void) {
@@ -4995,6 +10670,7 @@ static void fd_pre_clo_init(void) {
 									fd_print_debug_usage);
 	
 	VG_(needs_client_requests)   (fd_handle_client_request);
+	VG_(track_start_client_code) (fd_start_client_code);
 
 	/* Calls to C library functions in GMP and MPFR have to be replaced with the Valgrind versions.
 	   The function mp_set_memory_functions is part of GMP and thus MPFR, all others have been added 
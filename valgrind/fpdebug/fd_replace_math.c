@@ -0,0 +1,296 @@
+
+/*--------------------------------------------------------------------*/
+/*--- Wrappers for math library functions.                         ---*/
+/*---                                              fd_replace_math.c ---*/
+/*--------------------------------------------------------------------*/
+
+/*
+   This file is part of FpDebug, a heavyweight Valgrind tool for
+   detecting floating-point accuracy problems.
+
+   Copyright (C) 2010-2011 Florian Benz
+      florianbenz1@gmail.com
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of the
+   License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+   02111-1307, USA.
+
+   The GNU General Public License is contained in the file COPYING.
+*/
+
+/*
+   The wrappers run the original function without redirection and hand
+   the arguments and the result to the tool with a client request. The
+   tool computes the shadow value of the result with the MPFR version of
+   the function, so the operations inside the library do not have to be
+   shadowed one by one (see --wrap-libm).
+
+   The arguments and the result are passed in memory, because this is
+   where the tool can find their shadow values.
+*/
+
+#include "pub_tool_basics.h"
+#include "pub_tool_redir.h"
+
+#include "valgrind.h"
+#include "fpdebug.h"
+
+#if defined(VGP_amd64_linux)
+
+/* Arguments and results of a call without redirection. The offsets are
+   used by callNoRedir and must not be changed. */
+typedef
+	struct {
+		UWord	w[16];		/*   0: integer arguments */
+		double	d[2];		/* 128: floating-point arguments */
+		double	dres;		/* 144: floating-point result */
+		UWord	target;		/* 152: address of the original function */
+		UWord	wres;		/* 160: integer result */
+	} FdCall;
+
+/* Calls call->target with the first six words in registers, the
+   remaining ten words on the stack and the two doubles in xmm0 and xmm1
+   (System V AMD64 calling convention). */
+static void callNoRedir(FdCall* call) {
+	__asm__ volatile(
+		"movq %%rsp, %%r14\n\t"
+		"subq $128, %%rsp\n\t"		/* skip the red zone */
+		"andq $-16, %%rsp\n\t"
+		"movq %%rax, %%r15\n\t"
+		"pushq 120(%%r15)\n\t"
+		"pushq 112(%%r15)\n\t"
+		"pushq 104(%%r15)\n\t"
+		"pushq 96(%%r15)\n\t"
+		"pushq 88(%%r15)\n\t"
+		"pushq 80(%%r15)\n\t"
+		"pushq 72(%%r15)\n\t"
+		"pushq 64(%%r15)\n\t"
+		"pushq 56(%%r15)\n\t"
+		"pushq 48(%%r15)\n\t"
+		"movq 0(%%r15), %%rdi\n\t"
+		"movq 8(%%r15), %%rsi\n\t"
+		"movq 16(%%r15), %%rdx\n\t"
+		"movq 24(%%r15), %%rcx\n\t"
+		"movq 32(%%r15), %%r8\n\t"
+		"movq 40(%%r15), %%r9\n\t"
+		"movsd 128(%%r15), %%xmm0\n\t"
+		"movsd 136(%%r15), %%xmm1\n\t"
+		"movq 152(%%r15), %%rax\n\t"
+		VALGRIND_CALL_NOREDIR_RAX
+		"movq %%rax, 160(%%r15)\n\t"
+		"movsd %%xmm0, 144(%%r15)\n\t"
+		"movq %%r14, %%rsp\n\t"
+		: /*out*/ "+a" (call)
+		: /*in*/
+		: /*trash*/ "cc", "memory", "rcx", "rdx", "rsi", "rdi",
+		  "r8", "r9", "r10", "r11", "r14", "r15",
+		  "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm7",
+		  "xmm8", "xmm9", "xmm10", "xmm11", "xmm12", "xmm13", "xmm14", "xmm15"
+	);
+}
+
+#define LIBM_SONAME  libmZdsoZa		/* libm.so* */
+
+#define WRAP_DOUBLE_1(soname, fnname, fnId)                               \
+	double I_WRAP_SONAME_FNNAME_ZU(soname, fnname) (double x);            \
+	double I_WRAP_SONAME_FNNAME_ZU(soname, fnname) (double x) {           \
+		OrigFn fn;                                                        \
+		FdCall call;                                                      \
+		volatile double args[2];                                          \
+		volatile double res;                                              \
+		VALGRIND_GET_ORIG_FN(fn);                                         \
+		args[0] = x;                                                      \
+		args[1] = 0.0;                                                    \
+		call.d[0] = args[0];                                              \
+		call.target = fn.nraddr;                                          \
+		callNoRedir(&call);                                               \
+		res = call.dres;                                                  \
+		VALGRIND_WRAPPED_CALL(fnId, args, &res,                           \
+			__builtin_return_address(0));                                 \
+		return res;                                                       \
+	}
+
+#define WRAP_DOUBLE_2(soname, fnname, fnId)                               \
+	double I_WRAP_SONAME_FNNAME_ZU(soname, fnname) (double x, double y);  \
+	double I_WRAP_SONAME_FNNAME_ZU(soname, fnname) (double x, double y) { \
+		OrigFn fn;                                                        \
+		FdCall call;                                                      \
+		volatile double args[2];                                          \
+		volatile double res;                                              \
+		VALGRIND_GET_ORIG_FN(fn);                                         \
+		args[0] = x;                                                      \
+		args[1] = y;                                                      \
+		call.d[0] = args[0];                                              \
+		call.d[1] = args[1];                                              \
+		call.target = fn.nraddr;                                          \
+		callNoRedir(&call);                                               \
+		res = call.dres;                                                  \
+		VALGRIND_WRAPPED_CALL(fnId, args, &res,                           \
+			__builtin_return_address(0));                                 \
+		return res;                                                       \
+	}
+
+WRAP_DOUBLE_1(LIBM_SONAME, sin, FD_FN_SIN)
+WRAP_DOUBLE_1(LIBM_SONAME, cos, FD_FN_COS)
+WRAP_DOUBLE_1(LIBM_SONAME, tan, FD_FN_TAN)
+WRAP_DOUBLE_1(LIBM_SONAME, asin, FD_FN_ASIN)
+WRAP_DOUBLE_1(LIBM_SONAME, acos, FD_FN_ACOS)
+WRAP_DOUBLE_1(LIBM_SONAME, atan, FD_FN_ATAN)
+WRAP_DOUBLE_1(LIBM_SONAME, sinh, FD_FN_SINH)
+WRAP_DOUBLE_1(LIBM_SONAME, cosh, FD_FN_COSH)
+WRAP_DOUBLE_1(LIBM_SONAME, tanh, FD_FN_TANH)
+WRAP_DOUBLE_1(LIBM_SONAME, exp, FD_FN_EXP)
+WRAP_DOUBLE_1(LIBM_SONAME, exp2, FD_FN_EXP2)
+WRAP_DOUBLE_1(LIBM_SONAME, expm1, FD_FN_EXPM1)
+WRAP_DOUBLE_1(LIBM_SONAME, log, FD_FN_LOG)
+WRAP_DOUBLE_1(LIBM_SONAME, log2, FD_FN_LOG2)
+WRAP_DOUBLE_1(LIBM_SONAME, log10, FD_FN_LOG10)
+WRAP_DOUBLE_1(LIBM_SONAME, log1p, FD_FN_LOG1P)
+WRAP_DOUBLE_1(LIBM_SONAME, cbrt, FD_FN_CBRT)
+WRAP_DOUBLE_1(LIBM_SONAME, erf, FD_FN_ERF)
+WRAP_DOUBLE_1(LIBM_SONAME, erfc, FD_FN_ERFC)
+
+WRAP_DOUBLE_2(LIBM_SONAME, pow, FD_FN_POW)
+WRAP_DOUBLE_2(LIBM_SONAME, atan2, FD_FN_ATAN2)
+WRAP_DOUBLE_2(LIBM_SONAME, hypot, FD_FN_HYPOT)
+WRAP_DOUBLE_2(LIBM_SONAME, fmod, FD_FN_FMOD)
+
+/* BLAS (Fortran interface). All arguments are passed by reference. The 
+   hidden lengths of the character arguments are passed on unchanged. 
+   The tool computes the shadow values of the outputs from the inputs 
+   before the native call (which may overwrite them) and stores them when 
+   the call returns (see --wrap-blas). */
+
+#define WRAP_DDOT(soname)                                                 \
+	double I_WRAP_SONAME_FNNAME_ZU(soname, ddot_) (void* n, void* x,      \
+		void* incx, void* y, void* incy);                                 \
+	double I_WRAP_SONAME_FNNAME_ZU(soname, ddot_) (void* n, void* x,      \
+		void* incx, void* y, void* incy) {                                \
+		OrigFn fn;                                                        \
+		FdCall call;                                                      \
+		volatile double res;                                              \
+		VALGRIND_GET_ORIG_FN(fn);                                         \
+		call.w[0] = (UWord)n;                                             \
+		call.w[1] = (UWord)x;                                             \
+		call.w[2] = (UWord)incx;                                          \
+		call.w[3] = (UWord)y;                                             \
+		call.w[4] = (UWord)incy;                                          \
+		call.target = fn.nraddr;                                          \
+		VALGRIND_BLAS_BEGIN(FD_FN_DDOT, call.w,                           \
+			__builtin_return_address(0));                                 \
+		callNoRedir(&call);                                               \
+		res = call.dres;                                                  \
+		VALGRIND_BLAS_END(FD_FN_DDOT, &res);                              \
+		return res;                                                       \
+	}
+
+#define WRAP_DAXPY(soname)                                                \
+	void I_WRAP_SONAME_FNNAME_ZU(soname, daxpy_) (void* n, void* alpha,   \
+		void* x, void* incx, void* y, void* incy);                        \
+	void I_WRAP_SONAME_FNNAME_ZU(soname, daxpy_) (void* n, void* alpha,   \
+		void* x, void* incx, void* y, void* incy) {                       \
+		OrigFn fn;                                                        \
+		FdCall call;                                                      \
+		VALGRIND_GET_ORIG_FN(fn);                                         \
+		call.w[0] = (UWord)n;                                             \
+		call.w[1] = (UWord)alpha;                                         \
+		call.w[2] = (UWord)x;                                             \
+		call.w[3] = (UWord)incx;                                          \
+		call.w[4] = (UWord)y;                                             \
+		call.w[5] = (UWord)incy;                                          \
+		call.target = fn.nraddr;                                          \
+		VALGRIND_BLAS_BEGIN(FD_FN_DAXPY, call.w,                          \
+			__builtin_return_address(0));                                 \
+		callNoRedir(&call);                                               \
+		VALGRIND_BLAS_END(FD_FN_DAXPY, 0);                                \
+	}
+
+#define WRAP_DGEMV(soname)                                                \
+	void I_WRAP_SONAME_FNNAME_ZU(soname, dgemv_) (void* trans, void* m,   \
+		void* n, void* alpha, void* a, void* lda, void* x, void* incx,    \
+		void* beta, void* y, void* incy, UWord transLen);                 \
+	void I_WRAP_SONAME_FNNAME_ZU(soname, dgemv_) (void* trans, void* m,   \
+		void* n, void* alpha, void* a, void* lda, void* x, void* incx,    \
+		void* beta, void* y, void* incy, UWord transLen) {                \
+		OrigFn fn;                                                        \
+		FdCall call;                                                      \
+		VALGRIND_GET_ORIG_FN(fn);                                         \
+		call.w[0] = (UWord)trans;                                         \
+		call.w[1] = (UWord)m;                                             \
+		call.w[2] = (UWord)n;                                             \
+		call.w[3] = (UWord)alpha;                                         \
+		call.w[4] = (UWord)a;                                             \
+		call.w[5] = (UWord)lda;                                           \
+		call.w[6] = (UWord)x;                                             \
+		call.w[7] = (UWord)incx;                                          \
+		call.w[8] = (UWord)beta;                                          \
+		call.w[9] = (UWord)y;                                             \
+		call.w[10] = (UWord)incy;                                         \
+		call.w[11] = transLen;                                            \
+		call.target = fn.nraddr;                                          \
+		VALGRIND_BLAS_BEGIN(FD_FN_DGEMV, call.w,                          \
+			__builtin_return_address(0));                                 \
+		callNoRedir(&call);                                               \
+		VALGRIND_BLAS_END(FD_FN_DGEMV, 0);                                \
+	}
+
+#define WRAP_DGEMM(soname)                                                \
+	void I_WRAP_SONAME_FNNAME_ZU(soname, dgemm_) (void* transa,           \
+		void* transb, void* m, void* n, void* k, void* alpha, void* a,    \
+		void* lda, void* b, void* ldb, void* beta, void* c, void* ldc,    \
+		UWord transaLen, UWord transbLen);                                \
+	void I_WRAP_SONAME_FNNAME_ZU(soname, dgemm_) (void* transa,           \
+		void* transb, void* m, void* n, void* k, void* alpha, void* a,    \
+		void* lda, void* b, void* ldb, void* beta, void* c, void* ldc,    \
+		UWord transaLen, UWord transbLen) {                               \
+		OrigFn fn;                                                        \
+		FdCall call;                                                      \
+		VALGRIND_GET_ORIG_FN(fn);                                         \
+		call.w[0] = (UWord)transa;                                        \
+		call.w[1] = (UWord)transb;                                        \
+		call.w[2] = (UWord)m;                                             \
+		call.w[3] = (UWord)n;                                             \
+		call.w[4] = (UWord)k;                                             \
+		call.w[5] = (UWord)alpha;                                         \
+		call.w[6] = (UWord)a;                                             \
+		call.w[7] = (UWord)lda;                                           \
+		call.w[8] = (UWord)b;                                             \
+		call.w[9] = (UWord)ldb;                                           \
+		call.w[10] = (UWord)beta;                                         \
+		call.w[11] = (UWord)c;                                            \
+		call.w[12] = (UWord)ldc;                                          \
+		call.w[13] = transaLen;                                           \
+		call.w[14] = transbLen;                                           \
+		call.target = fn.nraddr;                                          \
+		VALGRIND_BLAS_BEGIN(FD_FN_DGEMM, call.w,                          \
+			__builtin_return_address(0));                                 \
+		callNoRedir(&call);                                               \
+		VALGRIND_BLAS_END(FD_FN_DGEMM, 0);                                \
+	}
+
+#define WRAP_BLAS(soname)  \
+	WRAP_DDOT(soname)      \
+	WRAP_DAXPY(soname)     \
+	WRAP_DGEMV(soname)     \
+	WRAP_DGEMM(soname)
+
+WRAP_BLAS(libblasZdsoZa)		/* libblas.so* */
+WRAP_BLAS(libopenblasZa)		/* libopenblas* */
+WRAP_BLAS(libmklZurtZdsoZa)	/* libmkl_rt.so* */
+
+#endif /* VGP_amd64_linux */
+
+/*--------------------------------------------------------------------*/
+/*--- end                                                          ---*/
+/*--------------------------------------------------------------------*/
@@ -95,9 +95,72 @@ typedef
     VG_USERREQ__PRINT_VALUES,
     /**********************/
     VG_USERREQ__BEGIN,
-    VG_USERREQ__END
+    VG_USERREQ__END,
+    /**********************/
+    VG_USERREQ__WRAPPED_CALL,
+    VG_USERREQ__BLAS_BEGIN,
+    VG_USERREQ__BLAS_END,
+    /**********************/
+    VG_USERREQ__SET_PRECISION,
+    VG_USERREQ__PUSH_PRECISION,
+    VG_USERREQ__POP_PRECISION,
+    /**********************/
+    VG_USERREQ__GET_RELATIVE_ERROR_BINARY,
+    VG_USERREQ__GET_SHADOW_BINARY
    } Vg_FpDebugClientRequest;
 
+/* Shadow value written by VALGRIND_GET_SHADOW_BINARY. hi + lo is the 
+   shadow value as double-double. For finite non-zero values, the limbs 
+   and exponent are those of MPFR: the value is sign * 0.limbs * 2^exponent, 
+   least significant limb first, otherwise limbCount is 0. */
+typedef
+  struct {
+    double        hi;
+    double        lo;
+    double        relError;
+    long          canceled;
+    long          exponent;
+    int           sign;
+    unsigned long precision;
+    unsigned long limbCount;
+  } FdBinaryShadow;
+
+/* Functions which are wrapped by vgpreload_fpdebug (fd_replace_math.c).
+   The shadow value of the result of a libm function is computed with the 
+   corresponding MPFR function, FD_FN_POW to FD_FN_FMOD take two arguments.
+   The BLAS functions (FD_FN_DDOT on) are shadowed with MPFR kernels. */
+typedef
+  enum {
+    FD_FN_SIN,
+    FD_FN_COS,
+    FD_FN_TAN,
+    FD_FN_ASIN,
+    FD_FN_ACOS,
+    FD_FN_ATAN,
+    FD_FN_SINH,
+    FD_FN_COSH,
+    FD_FN_TANH,
+    FD_FN_EXP,
+    FD_FN_EXP2,
+    FD_FN_EXPM1,
+    FD_FN_LOG,
+    FD_FN_LOG2,
+    FD_FN_LOG10,
+    FD_FN_LOG1P,
+    FD_FN_CBRT,
+    FD_FN_ERF,
+    FD_FN_ERFC,
+    FD_FN_POW,
+    FD_FN_ATAN2,
+    FD_FN_HYPOT,
+    FD_FN_FMOD,
+    FD_FN_DDOT,
+    FD_FN_DAXPY,
+    FD_FN_DGEMV,
+    FD_FN_DGEMM,
+    FD_FN_COUNT
+   } Vg_FpDebugWrappedFunction;
+
 
 #define VALGRIND_PRINT_ERROR(_qzz_str, _qzz_fp)           \
    (__extension__({unsigned long _qzz_res;                       \
@@ -290,6 +353,80 @@ typedef
                             0, 0, 0, 0, 0);       \
     _qzz_res;                                                    \
    }))
+/****************************/
+#define VALGRIND_WRAPPED_CALL(_qzz_fn, _qzz_args, _qzz_res_addr, _qzz_site)           \
+   (__extension__({unsigned long _qzz_res;                       \
+    VALGRIND_DO_CLIENT_REQUEST(_qzz_res, 0 /* default return */, \
+                            VG_USERREQ__WRAPPED_CALL,       \
+                            _qzz_fn, _qzz_args, _qzz_res_addr, _qzz_site, 0);       \
+    _qzz_res;                                                    \
+   }))
+
+#define VALGRIND_BLAS_BEGIN(_qzz_fn, _qzz_args, _qzz_site)           \
+   (__extension__({unsigned long _qzz_res;                       \
+    VALGRIND_DO_CLIENT_REQUEST(_qzz_res, 0 /* default return */, \
+                            VG_USERREQ__BLAS_BEGIN,       \
+                            _qzz_fn, _qzz_args, _qzz_site, 0, 0);       \
+    _qzz_res;                                                    \
+   }))
+
+#define VALGRIND_BLAS_END(_qzz_fn, _qzz_res_addr)           \
+   (__extension__({unsigned long _qzz_res;                       \
+    VALGRIND_DO_CLIENT_REQUEST(_qzz_res, 0 /* default return */, \
+                            VG_USERREQ__BLAS_END,       \
+                            _qzz_fn, _qzz_res_addr, 0, 0, 0);       \
+    _qzz_res;                                                    \
+   }))
+/****************************/
+/* Results of the following operations are computed with the given number of 
+   bits, shadow values of other precisions are converted when they are used. 
+   Returns the previous precision. */
+#define VALGRIND_SET_PRECISION(_qzz_bits)           \
+   (__extension__({unsigned long _qzz_res;                       \
+    VALGRIND_DO_CLIENT_REQUEST(_qzz_res, 0 /* default return */, \
+                            VG_USERREQ__SET_PRECISION,       \
+                            _qzz_bits, 0, 0, 0, 0);       \
+    _qzz_res;                                                    \
+   }))
+
+/* Like VALGRIND_SET_PRECISION, VALGRIND_POP_PRECISION restores the precision 
+   before the matching push. */
+#define VALGRIND_PUSH_PRECISION(_qzz_bits)           \
+   (__extension__({unsigned long _qzz_res;                       \
+    VALGRIND_DO_CLIENT_REQUEST(_qzz_res, 0 /* default return */, \
+                            VG_USERREQ__PUSH_PRECISION,       \
+                            _qzz_bits, 0, 0, 0, 0);       \
+    _qzz_res;                                                    \
+   }))
+
+#define VALGRIND_POP_PRECISION()           \
+   (__extension__({unsigned long _qzz_res;                       \
+    VALGRIND_DO_CLIENT_REQUEST(_qzz_res, 0 /* default return */, \
+                            VG_USERREQ__POP_PRECISION,       \
+                            0, 0, 0, 0, 0);       \
+    _qzz_res;                                                    \
+   }))
+/****************************/
+/* Like VALGRIND_GET_RELATIVE_ERROR and VALGRIND_GET_SHADOW without decimal 
+   strings. Both return 1 if the value has a shadow value and 0 otherwise, 
+   in which case the relative error is 0. _qzz_rel is a double*, _qzz_out 
+   a FdBinaryShadow* and _qzz_limbs an unsigned long* with room for 
+   _qzz_max_limbs limbs or NULL. */
+#define VALGRIND_GET_RELATIVE_ERROR_BINARY(_qzz_fp, _qzz_rel)           \
+   (__extension__({unsigned long _qzz_res;                       \
+    VALGRIND_DO_CLIENT_REQUEST(_qzz_res, 0 /* default return */, \
+                            VG_USERREQ__GET_RELATIVE_ERROR_BINARY,       \
+                            _qzz_fp, _qzz_rel, 0, 0, 0);       \
+    _qzz_res;                                                    \
+   }))
+
+#define VALGRIND_GET_SHADOW_BINARY(_qzz_fp, _qzz_out, _qzz_limbs, _qzz_max_limbs)           \
+   (__extension__({unsigned long _qzz_res;                       \
+    VALGRIND_DO_CLIENT_REQUEST(_qzz_res, 0 /* default return */, \
+                            VG_USERREQ__GET_SHADOW_BINARY,       \
+                            _qzz_fp, _qzz_out, _qzz_limbs, _qzz_max_limbs, 0);       \
+    _qzz_res;                                                    \
+   }))
 
 #endif
 
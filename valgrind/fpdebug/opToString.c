@@ -36,9 +36,21 @@ static void storeOpStr(HChar* str) {
    VG_(strcpy)(opStr, str);
 }
 
+static HChar* fnNames[FD_FN_COUNT] = {
+   "sin", "cos", "tan", "asin", "acos", "atan", "sinh", "cosh", "tanh",
+   "exp", "exp2", "expm1", "log", "log2", "log10", "log1p", "cbrt",
+   "erf", "erfc", "pow", "atan2", "hypot", "fmod",
+   "ddot", "daxpy", "dgemv", "dgemm"
+};
+
 static void opToStr(IROp op) {
    HChar* str = NULL; 
    IROp   base;
+   if (FD_IS_FUNCTION_OP(op)) {
+      UInt fn = op - FD_FUNCTION_OP_BASE;
+      storeOpStr(fn < FD_FN_COUNT ? fnNames[fn] : "unknown function");
+      return;
+   }
    switch (op) {
       case Iop_Add8 ... Iop_Add64:
          str = "Add"; base = Iop_Add8; break;